@@ -1,21 +1,20 @@
 #pragma once
 
 #include "common.h"
+#include "memory.h"
 
-#include <atomic>
 #include <cassert>
-#include <memory>
 #include <utility>
 
 namespace uxs {
 
-template<typename Ty>
+template<typename Ty, typename RefCountPolicy = atomic_ref_count>
 class cow_ptr {
  private:
     struct object_body_t {
         template<typename... Args>
         object_body_t(Args&&... args) : obj(std::forward<Args>(args)...) {}
-        std::atomic<std::uint32_t> ref_count{1};
+        typename RefCountPolicy::template counter_type<std::uint32_t> ref_count{1};
         Ty obj;
     };
 
@@ -64,13 +63,14 @@ class cow_ptr {
         ptr_ = ptr;
     }
 
-    template<typename Ty_, typename... Args>
-    friend cow_ptr<Ty_> make_cow(Args&&...);
+    template<typename Ty_, typename RefCountPolicy_, typename... Args>
+    friend cow_ptr<Ty_, RefCountPolicy_> make_cow(Args&&...);
 };
 
-template<typename Ty, typename... Args>
-cow_ptr<Ty> make_cow(Args&&... args) {
-    return cow_ptr<Ty>(new typename cow_ptr<Ty>::object_body_t(std::forward<Args>(args)...));
+template<typename Ty, typename RefCountPolicy = atomic_ref_count, typename... Args>
+cow_ptr<Ty, RefCountPolicy> make_cow(Args&&... args) {
+    return cow_ptr<Ty, RefCountPolicy>(
+        new typename cow_ptr<Ty, RefCountPolicy>::object_body_t(std::forward<Args>(args)...));
 }
 
 }  // namespace uxs
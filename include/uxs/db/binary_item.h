@@ -0,0 +1,267 @@
+#pragma once
+
+#include "json.h"
+#include "value.h"
+
+namespace uxs {
+namespace db {
+
+// Decoded item of a binary format (*CBOR*, *MessagePack*): a scalar value of type `type` or a header of an array or
+// a record; `str` refers to the input or the decoder buffer and is valid until the next item is decoded
+struct binary_item {
+    static const std::uint64_t indefinite_count = ~std::uint64_t(0);
+
+    dtype type;
+    union {
+        bool b;
+        std::int32_t i;
+        std::uint32_t u;
+        std::int64_t i64;
+        std::uint64_t u64;
+        double d;
+        std::uint64_t count;  // count of array items or record key-value pairs, or `indefinite_count`
+    };
+    std::string_view str;
+
+    template<typename CharT, typename Alloc>
+    basic_value<CharT, Alloc> to_value(const Alloc& al) const {
+        switch (type) {
+            case dtype::null: return {nullptr, al};
+            case dtype::boolean: return {b, al};
+            case dtype::integer: return {i, al};
+            case dtype::unsigned_integer: return {u, al};
+            case dtype::long_integer: return {i64, al};
+            case dtype::unsigned_long_integer: return {u64, al};
+            case dtype::double_precision: return {d, al};
+            case dtype::string: return {utf_string_adapter<CharT>{}(str), al};
+            case dtype::array: return make_array<CharT>(al);
+            case dtype::record: return make_record<CharT>(al);
+            default: UXS_UNREACHABLE_CODE;
+        }
+    }
+};
+
+namespace detail {
+
+inline void write_big_endian(membuffer& out, std::uint64_t v, unsigned n) {
+    char bytes[8];
+    for (unsigned k = n; k > 0; --k, v >>= 8) { bytes[k - 1] = static_cast<char>(v & 0xff); }
+    out.append(bytes, n);
+}
+
+// Base of binary decoders: reads big-endian numbers and byte strings from the input
+struct binary_decoder_base {
+    ibuf& in;
+    inline_dynbuffer str;
+
+    explicit binary_decoder_base(ibuf& in) : in(in) {}
+
+    std::uint8_t read_byte() {
+        const auto ch = in.get();
+        if (ch == ibuf::traits_type::eof()) { throw database_error("unexpected end of file"); }
+        return static_cast<std::uint8_t>(ch);
+    }
+
+    std::uint64_t read_big_endian(unsigned n) {
+        std::uint64_t v = 0;
+        if (in.avail() >= n) {
+            const auto* p = reinterpret_cast<const std::uint8_t*>(in.curr());
+            for (unsigned k = 0; k < n; ++k) { v = (v << 8) | p[k]; }
+            in.advance(n);
+            return v;
+        }
+        for (unsigned k = 0; k < n; ++k) { v = (v << 8) | read_byte(); }
+        return v;
+    }
+
+    double read_double() {
+        const std::uint64_t bits = read_big_endian(8);
+        double d = 0;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    double read_float() {
+        const std::uint32_t bits = static_cast<std::uint32_t>(read_big_endian(4));
+        float f = 0;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    // Returns the view of the next `n` bytes: bytes are copied to `str` only if they aren't in the input buffer
+    std::string_view read_bytes(std::uint64_t n, bool append = false) {
+        if (!append) {
+            if (in.avail() >= n) {
+                const std::string_view s(in.curr(), static_cast<std::size_t>(n));
+                in.advance(static_cast<std::ptrdiff_t>(n));
+                return s;
+            }
+            str.clear();
+        }
+        while (n) {
+            if (in.peek() == ibuf::traits_type::eof()) { throw database_error("unexpected end of file"); }
+            const std::size_t chunk = static_cast<std::size_t>(std::min<std::uint64_t>(n, in.avail()));
+            str.append(in.curr(), chunk);
+            in.advance(chunk);
+            n -= chunk;
+        }
+        return std::string_view(str.data(), str.size());
+    }
+
+    void skip_bytes(std::uint64_t n) {
+        while (n) {
+            if (in.peek() == ibuf::traits_type::eof()) { throw database_error("unexpected end of file"); }
+            const std::size_t chunk = static_cast<std::size_t>(std::min<std::uint64_t>(n, in.avail()));
+            in.advance(chunk);
+            n -= chunk;
+        }
+    }
+};
+
+// SAX reading driver: `Decoder::next(item)` decodes the next item and returns `false` on the end of a container of
+// indefinite length, `Decoder::skip(item)` skips the contents of the container which header is just decoded
+template<typename Decoder, typename ValueFunc, typename ArrItemFunc, typename ObjItemFunc, typename PopFunc>
+void read_binary(Decoder& decoder, const ValueFunc& fn_value, const ArrItemFunc& fn_arr_item,
+                 const ObjItemFunc& fn_obj_item, const PopFunc& fn_pop) {
+    struct level_t {
+        bool is_record;
+        std::uint64_t count;
+    };
+
+    inline_basic_dynbuffer<level_t, 32> stack;
+    binary_item item;
+
+    if (!decoder.next(item)) { throw database_error("unexpected break code"); }
+    if (fn_value(item) != json::parse_step::into || item.type < dtype::array) { return; }
+    stack.push_back(level_t{item.type == dtype::record, item.count});
+
+    while (!stack.empty()) {
+        level_t& top = stack.back();
+        const bool is_record = top.is_record;
+        bool has_item = false;
+        if (top.count == binary_item::indefinite_count) {
+            has_item = decoder.next(item);
+        } else if (top.count) {
+            --top.count;
+            if (!(has_item = decoder.next(item))) { throw database_error("unexpected break code"); }
+        }
+
+        if (!has_item) {
+            stack.pop_back();
+            if (!stack.empty()) { fn_pop(); }
+            continue;
+        }
+
+        if (is_record) {
+            if (item.type != dtype::string) { throw database_error("expected string key"); }
+            fn_obj_item(item.str);
+            if (!decoder.next(item)) { throw database_error("unexpected break code"); }
+        } else {
+            fn_arr_item();
+        }
+
+        const auto ret = fn_value(item);
+        if (ret == json::parse_step::stop) { return; }
+        if (item.type >= dtype::array) {
+            if (ret == json::parse_step::into) {
+                stack.push_back(level_t{item.type == dtype::record, item.count});
+            } else {
+                decoder.skip(item);
+            }
+        }
+    }
+}
+
+// DOM reading driver
+template<typename CharT, typename Alloc, typename Decoder>
+basic_value<CharT, Alloc> read_binary_value(Decoder& decoder, const Alloc& al) {
+    basic_value<CharT, Alloc> result(al);
+    inline_basic_dynbuffer<basic_value<CharT, Alloc>*, 32> stack;
+
+    auto* val = &result;
+    read_binary(
+        decoder,
+        [&al, &stack, &val](const binary_item& item) {
+            *val = item.to_value<CharT>(al);
+            if (item.type >= dtype::array) {
+                // declared size is bounded, so that malformed input can't cause a huge allocation
+                if (item.type == dtype::array && item.count != binary_item::indefinite_count) {
+                    val->reserve(static_cast<std::size_t>(std::min<std::uint64_t>(item.count, 4096)));
+                }
+                stack.push_back(val);
+            }
+            return json::parse_step::into;
+        },
+        [&al, &stack, &val]() { val = &stack.back()->emplace_back(al); },
+        [&al, &stack, &val](std::string_view key) {
+            val = &stack.back()->emplace(utf_string_adapter<CharT>{}(key), al).value();
+        },
+        [&stack] { stack.pop_back(); });
+    return result;
+}
+
+// Writing driver: `Encoder` has a method for each scalar type and `begin_array(size)`, `begin_record(size)`
+template<typename Encoder, typename CharT, typename Alloc>
+void write_binary(Encoder& encoder, const basic_value<CharT, Alloc>& v) {
+    using value_t = basic_value<CharT, Alloc>;
+    using record_iterator = typename value_t::const_record_iterator;
+
+    struct level_t {
+        bool is_record;
+        const value_t* arr_first;
+        const value_t* arr_last;
+        record_iterator rec_first;
+        record_iterator rec_last;
+    };
+
+    inline_basic_dynbuffer<level_t, 32> stack;
+
+    const value_t* val = &v;
+    while (true) {
+        switch (val->type()) {
+            case dtype::null: encoder.null(); break;
+            case dtype::boolean: encoder.boolean(val->as_bool()); break;
+            case dtype::integer: encoder.integer(val->as_int()); break;
+            case dtype::unsigned_integer: encoder.unsigned_integer(val->as_uint()); break;
+            case dtype::long_integer: encoder.long_integer(val->as_int64()); break;
+            case dtype::unsigned_long_integer: encoder.unsigned_long_integer(val->as_uint64()); break;
+            case dtype::double_precision: encoder.double_precision(val->as_double()); break;
+            case dtype::string: {
+                const auto& s = utf_string_adapter<char>{}(val->as_string_view());
+                encoder.string(std::string_view(s));
+            } break;
+            case dtype::array: {
+                const auto items = val->as_array();
+                encoder.begin_array(items.size());
+                stack.push_back(level_t{false, items.data(), items.data() + items.size(), {}, {}});
+            } break;
+            case dtype::record: {
+                const auto items = val->as_record();
+                encoder.begin_record(val->size());
+                stack.push_back(level_t{true, nullptr, nullptr, items.begin(), items.end()});
+            } break;
+            default: UXS_UNREACHABLE_CODE;
+        }
+
+        while (true) {
+            if (stack.empty()) { return; }
+            level_t& top = stack.back();
+            if (top.is_record && top.rec_first != top.rec_last) {
+                const auto& key = utf_string_adapter<char>{}(top.rec_first->key());
+                encoder.string(std::string_view(key));
+                val = &(top.rec_first++)->value();
+                break;
+            }
+            if (!top.is_record && top.arr_first != top.arr_last) {
+                val = top.arr_first++;
+                break;
+            }
+            stack.pop_back();
+        }
+    }
+}
+
+}  // namespace detail
+
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "binary_item.h"
+
+#include <cmath>
+
+namespace uxs {
+namespace db {
+namespace cbor {
+
+namespace detail {
+struct decoder : db::detail::binary_decoder_base {
+    explicit decoder(ibuf& in) : binary_decoder_base(in) {}
+    UXS_EXPORT bool next(binary_item& item);
+    UXS_EXPORT void skip(const binary_item& item);
+
+ private:
+    std::uint64_t argument(std::uint8_t info);
+    bool decode(binary_item& item, bool skip_strings);
+};
+}  // namespace detail
+
+// Reads *CBOR* (RFC 8949) data item: handlers are the same as of SAX `json::read()`, but `fn_value` receives
+// decoded `binary_item`; integers get the narrowest of `int32`, `uint32`, `int64` and `uint64` types, which holds the
+// value, floating-point numbers of any precision are read as `double`, byte strings are read as strings, tags are
+// ignored; definite and indefinite length strings and containers are supported, record keys must be strings
+template<typename ValueFunc, typename ArrItemFunc, typename ObjItemFunc, typename PopFunc>
+void read(ibuf& in, const ValueFunc& fn_value, const ArrItemFunc& fn_arr_item, const ObjItemFunc& fn_obj_item,
+          const PopFunc& fn_pop) {
+    detail::decoder decoder(in);
+    db::detail::read_binary(decoder, fn_value, fn_arr_item, fn_obj_item, fn_pop);
+}
+
+template<typename CharT = char, typename Alloc = std::allocator<CharT>>
+UXS_EXPORT basic_value<CharT, Alloc> read(ibuf& in, const Alloc& al = Alloc());
+
+namespace detail {
+struct writer {
+    membuffer& out;
+
+    void head(std::uint8_t major, std::uint64_t arg) {
+        const char initial = static_cast<char>(major << 5);
+        if (arg < 24) {
+            out += static_cast<char>(initial | arg);
+        } else if (arg <= 0xff) {
+            out += static_cast<char>(initial | 24);
+            out += static_cast<char>(arg);
+        } else if (arg <= 0xffff) {
+            out += static_cast<char>(initial | 25);
+            db::detail::write_big_endian(out, arg, 2);
+        } else if (arg <= 0xffffffff) {
+            out += static_cast<char>(initial | 26);
+            db::detail::write_big_endian(out, arg, 4);
+        } else {
+            out += static_cast<char>(initial | 27);
+            db::detail::write_big_endian(out, arg, 8);
+        }
+    }
+
+    void null() { out += '\xf6'; }
+    void boolean(bool b) { out += b ? '\xf5' : '\xf4'; }
+    void integer(std::int32_t i) { long_integer(i); }
+    void unsigned_integer(std::uint32_t u) { head(0, u); }
+    void long_integer(std::int64_t i) {
+        if (i >= 0) {
+            head(0, static_cast<std::uint64_t>(i));
+        } else {
+            head(1, ~static_cast<std::uint64_t>(i));
+        }
+    }
+    void unsigned_long_integer(std::uint64_t u) { head(0, u); }
+    void double_precision(double d) {
+        // the shortest of single and double precision, which holds the value exactly
+        if (std::fabs(d) <= std::numeric_limits<float>::max() && static_cast<float>(d) == d) {
+            const float f = static_cast<float>(d);
+            std::uint32_t bits = 0;
+            std::memcpy(&bits, &f, sizeof(bits));
+            out += '\xfa';
+            db::detail::write_big_endian(out, bits, 4);
+            return;
+        }
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &d, sizeof(bits));
+        out += '\xfb';
+        db::detail::write_big_endian(out, bits, 8);
+    }
+    void string(std::string_view s) {
+        head(3, s.size());
+        out += s;
+    }
+    void begin_array(std::size_t size) { head(4, size); }
+    void begin_record(std::size_t size) { head(5, size); }
+
+    template<typename ValueCharT, typename Alloc>
+    UXS_EXPORT void do_write(const basic_value<ValueCharT, Alloc>& v);
+};
+}  // namespace detail
+
+// Writes the value as *CBOR* data item with definite lengths and the shortest forms of integers
+template<typename ValueCharT, typename Alloc>
+void write(membuffer& out, const basic_value<ValueCharT, Alloc>& v) {
+    detail::writer writer{out};
+    writer.do_write(v);
+}
+
+template<typename ValueCharT, typename Alloc>
+void write(iobuf& out, const basic_value<ValueCharT, Alloc>& v) {
+    iomembuffer buf(out);
+    detail::writer writer{buf};
+    writer.do_write(v);
+}
+
+}  // namespace cbor
+}  // namespace db
+}  // namespace uxs
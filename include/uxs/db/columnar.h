@@ -0,0 +1,453 @@
+#pragma once
+
+#include "json.h"
+#include "value.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <vector>
+
+namespace uxs {
+namespace db {
+
+enum class column_type : std::uint8_t { null = 0, boolean, integer, double_precision, string };
+
+//-----------------------------------------------------------------------------
+// Dictionary of distinct strings: each string gets a dense code in order of first appearance, the characters
+// of all strings are stored contiguously
+
+template<typename CharT>
+class basic_column_dictionary {
+ public:
+    using char_type = CharT;
+    using key_type = std::basic_string_view<char_type>;
+    using hasher_t = std::hash<key_type>;
+
+    enum : std::uint32_t { npos = ~std::uint32_t(0) };
+
+    basic_column_dictionary() : offsets_(1, 0) {}
+
+    std::size_t size() const noexcept { return hashes_.size(); }
+    bool empty() const noexcept { return hashes_.empty(); }
+
+    key_type operator[](std::uint32_t code) const noexcept {
+        assert(code < size());
+        return key_type(chars_.data() + offsets_[code], offsets_[code + 1] - offsets_[code]);
+    }
+
+    // Returns `npos` if the string is not in the dictionary
+    std::uint32_t find(key_type s) const noexcept {
+        if (tbl_.empty()) { return npos; }
+        const std::size_t hash_code = hasher_t{}(s);
+        const std::size_t mask = tbl_.size() - 1;
+        for (std::size_t pos = hash_code & mask;; pos = (pos + 1) & mask) {
+            const std::uint32_t code = tbl_[pos];
+            if (code == npos || (hashes_[code] == hash_code && (*this)[code] == s)) { return code; }
+        }
+    }
+
+    std::uint32_t intern(key_type s) {
+        if (2 * (size() + 1) > tbl_.size()) { rehash(); }
+        const std::size_t hash_code = hasher_t{}(s);
+        const std::size_t mask = tbl_.size() - 1;
+        std::size_t pos = hash_code & mask;
+        for (; tbl_[pos] != npos; pos = (pos + 1) & mask) {
+            const std::uint32_t code = tbl_[pos];
+            if (hashes_[code] == hash_code && (*this)[code] == s) { return code; }
+        }
+        if (size() >= npos) { throw std::length_error("too many distinct strings"); }
+        const auto code = static_cast<std::uint32_t>(size());
+        chars_.insert(chars_.end(), s.begin(), s.end());
+        offsets_.push_back(chars_.size());
+        hashes_.push_back(hash_code);
+        tbl_[pos] = code;
+        return code;
+    }
+
+ private:
+    std::vector<char_type> chars_;
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> hashes_;
+    std::vector<std::uint32_t> tbl_;
+
+    void rehash() {
+        std::vector<std::uint32_t> tbl(tbl_.empty() ? 64 : 2 * tbl_.size(), npos);
+        const std::size_t mask = tbl.size() - 1;
+        for (std::uint32_t code = 0; code < size(); ++code) {
+            std::size_t pos = hashes_[code] & mask;
+            while (tbl[pos] != npos) { pos = (pos + 1) & mask; }
+            tbl[pos] = code;
+        }
+        tbl_.swap(tbl);
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Typed column: values are stored contiguously in a vector of the column type, strings are dictionary-encoded;
+// the validity bitmap has a set bit for each non-null row, and null rows hold zeros (or `null_code` for strings),
+// so that sums and comparisons over the whole vector need no masking; a column of integers turns into a column of
+// doubles when a floating-point value is appended, other type mismatches are errors
+
+template<typename CharT>
+class basic_column {
+ public:
+    using char_type = CharT;
+    using string_view_type = std::basic_string_view<char_type>;
+    using dictionary_type = basic_column_dictionary<char_type>;
+
+    enum : std::uint32_t { null_code = dictionary_type::npos };
+
+    column_type type() const noexcept { return type_; }
+    std::size_t size() const noexcept { return size_; }
+    std::size_t count() const noexcept { return count_; }
+    std::size_t null_count() const noexcept { return size_ - count_; }
+    bool is_null(std::size_t i) const noexcept {
+        assert(i < size_);
+        return !((valid_[i >> 6] >> (i & 63)) & 1);
+    }
+
+    est::span<const std::uint64_t> validity() const noexcept { return est::as_span(valid_); }
+    est::span<const std::uint8_t> bools() const noexcept { return est::as_span(bools_); }
+    est::span<const std::int64_t> ints() const noexcept { return est::as_span(ints_); }
+    est::span<const double> doubles() const noexcept { return est::as_span(doubles_); }
+    est::span<const std::uint32_t> codes() const noexcept { return est::as_span(codes_); }
+    const dictionary_type& dictionary() const noexcept { return dict_; }
+
+    string_view_type string_at(std::size_t i) const noexcept {
+        assert(type_ == column_type::string && i < size_);
+        return codes_[i] != null_code ? dict_[codes_[i]] : string_view_type();
+    }
+
+    void push_null() {
+        switch (type_) {
+            case column_type::null: break;
+            case column_type::boolean: bools_.push_back(0); break;
+            case column_type::integer: ints_.push_back(0); break;
+            case column_type::double_precision: doubles_.push_back(0.); break;
+            case column_type::string: codes_.push_back(null_code); break;
+        }
+        push_validity(false);
+    }
+
+    void push_bool(bool b) {
+        if (type_ != column_type::boolean) { convert_to(column_type::boolean); }
+        bools_.push_back(b ? 1 : 0);
+        push_validity(true);
+    }
+
+    void push_int(std::int64_t i) {
+        if (type_ == column_type::double_precision) { return push_double(static_cast<double>(i)); }
+        if (type_ != column_type::integer) { convert_to(column_type::integer); }
+        ints_.push_back(i);
+        push_validity(true);
+    }
+
+    void push_double(double d) {
+        if (type_ != column_type::double_precision) { convert_to(column_type::double_precision); }
+        doubles_.push_back(d);
+        push_validity(true);
+    }
+
+    void push_string(string_view_type s) {
+        if (type_ != column_type::string) { convert_to(column_type::string); }
+        codes_.push_back(dict_.intern(s));
+        push_validity(true);
+    }
+
+    // Appends null rows up to `sz`
+    void pad(std::size_t sz) {
+        while (size_ < sz) { push_null(); }
+    }
+
+    // Sum of non-null values; integers are added exactly and then converted
+    double sum() const noexcept {
+        switch (type_) {
+            case column_type::boolean: return static_cast<double>(sum_bools());
+            case column_type::integer: return static_cast<double>(sum_ints());
+            case column_type::double_precision: return sum_doubles();
+            default: return 0.;
+        }
+    }
+
+    std::int64_t int_sum() const noexcept {
+        return type_ == column_type::integer ? sum_ints() :
+               type_ == column_type::boolean ? static_cast<std::int64_t>(sum_bools()) :
+                                               0;
+    }
+
+    double mean() const noexcept { return count_ ? sum() / static_cast<double>(count_) : 0.; }
+
+    // Minimum and maximum of non-null numeric values, empty if there are no such values
+    est::optional<double> min() const noexcept {
+        return reduce([](double a, double b) { return b < a ? b : a; });
+    }
+    est::optional<double> max() const noexcept {
+        return reduce([](double a, double b) { return a < b ? b : a; });
+    }
+
+    // Number of rows with the string value
+    std::size_t count_equal(string_view_type s) const noexcept {
+        if (type_ != column_type::string) { return 0; }
+        const std::uint32_t code = dict_.find(s);
+        if (code == dictionary_type::npos) { return 0; }
+        return static_cast<std::size_t>(std::count(codes_.begin(), codes_.end(), code));
+    }
+
+ private:
+    column_type type_ = column_type::null;
+    std::size_t size_ = 0;
+    std::size_t count_ = 0;
+    std::vector<std::uint64_t> valid_;
+    std::vector<std::uint8_t> bools_;
+    std::vector<std::int64_t> ints_;
+    std::vector<double> doubles_;
+    std::vector<std::uint32_t> codes_;
+    dictionary_type dict_;
+
+    void push_validity(bool valid) {
+        if ((size_ & 63) == 0) { valid_.push_back(0); }
+        if (valid) { valid_.back() |= std::uint64_t(1) << (size_ & 63), ++count_; }
+        ++size_;
+    }
+
+    void convert_to(column_type type) {
+        if (type_ == column_type::integer && type == column_type::double_precision) {
+            doubles_.assign(ints_.begin(), ints_.end());
+            std::vector<std::int64_t>().swap(ints_);
+        } else if (type_ != column_type::null) {
+            throw database_error("incompatible value types in column");
+        } else {
+            switch (type) {
+                case column_type::boolean: bools_.assign(size_, 0); break;
+                case column_type::integer: ints_.assign(size_, 0); break;
+                case column_type::double_precision: doubles_.assign(size_, 0.); break;
+                case column_type::string: codes_.assign(size_, null_code); break;
+                default: break;
+            }
+        }
+        type_ = type;
+    }
+
+    std::size_t sum_bools() const noexcept {
+        std::size_t acc = 0;
+        for (std::uint8_t b : bools_) { acc += b; }
+        return acc;
+    }
+
+    std::int64_t sum_ints() const noexcept {
+        // unsigned arithmetic wraps around without undefined behaviour
+        std::uint64_t acc = 0;
+        for (std::int64_t i : ints_) { acc += static_cast<std::uint64_t>(i); }
+        return static_cast<std::int64_t>(acc);
+    }
+
+    double sum_doubles() const noexcept {
+        // independent partial sums let the compiler use vector registers
+        double acc[4] = {0., 0., 0., 0.};
+        const double* p = doubles_.data();
+        const double* p_end = p + (doubles_.size() & ~std::size_t(3));
+        for (; p != p_end; p += 4) { acc[0] += p[0], acc[1] += p[1], acc[2] += p[2], acc[3] += p[3]; }
+        for (; p != doubles_.data() + doubles_.size(); ++p) { acc[0] += *p; }
+        return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+
+    template<typename Ty, typename Func>
+    double reduce_vector(const std::vector<Ty>& v, const Func& func) const noexcept {
+        double result = 0.;
+        bool has_value = false;
+        for (std::size_t word = 0; word < valid_.size(); ++word) {
+            const std::size_t first = word << 6, last = std::min(first + 64, size_);
+            const std::uint64_t bits = valid_[word];
+            if (!bits) { continue; }
+            std::size_t i = first;
+            if (!has_value) {
+                while (!((bits >> (i & 63)) & 1)) { ++i; }
+                result = static_cast<double>(v[i++]), has_value = true;
+            }
+            if (bits == ~std::uint64_t(0)) {
+                for (; i < last; ++i) { result = func(result, static_cast<double>(v[i])); }
+            } else {
+                for (; i < last; ++i) {
+                    if ((bits >> (i & 63)) & 1) { result = func(result, static_cast<double>(v[i])); }
+                }
+            }
+        }
+        return result;
+    }
+
+    template<typename Func>
+    est::optional<double> reduce(const Func& func) const noexcept {
+        if (!count_) { return est::nullopt(); }
+        switch (type_) {
+            case column_type::boolean: return reduce_vector(bools_, func);
+            case column_type::integer: return reduce_vector(ints_, func);
+            case column_type::double_precision: return reduce_vector(doubles_, func);
+            default: return est::nullopt();
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Columnar (struct-of-arrays) table built from an array of records: each distinct record key becomes a column,
+// a row missing the key gets a null; record field values must be scalars
+
+template<typename CharT>
+class basic_column_table {
+ public:
+    using char_type = CharT;
+    using string_view_type = std::basic_string_view<char_type>;
+    using column_t = basic_column<char_type>;
+
+    std::size_t row_count() const noexcept { return row_count_; }
+    std::size_t column_count() const noexcept { return columns_.size(); }
+    string_view_type column_name(std::size_t n) const noexcept { return names_[static_cast<std::uint32_t>(n)]; }
+    const column_t& column(std::size_t n) const noexcept { return columns_[n]; }
+
+    const column_t* find(string_view_type name) const noexcept {
+        const std::uint32_t n = names_.find(name);
+        return n != basic_column_dictionary<char_type>::npos ? &columns_[n] : nullptr;
+    }
+
+    const column_t& at(string_view_type name) const {
+        const column_t* col = find(name);
+        if (!col) { throw database_error("invalid key"); }
+        return *col;
+    }
+    const column_t& operator[](string_view_type name) const { return at(name); }
+
+    // Returns the column of the current row to append a value to; `n_hint` is the position of the field in the
+    // record: it saves a hash lookup when rows have the same key order
+    column_t& field(string_view_type name, std::size_t n_hint = 0) {
+        std::uint32_t n;
+        if (n_hint < columns_.size() && names_[static_cast<std::uint32_t>(n_hint)] == name) {
+            n = static_cast<std::uint32_t>(n_hint);
+        } else {
+            n = names_.intern(name);
+            if (n == columns_.size()) {
+                columns_.emplace_back();
+                columns_.back().pad(row_count_);
+            }
+        }
+        column_t& col = columns_[n];
+        if (col.size() > row_count_) { throw database_error("duplicate key in row"); }
+        return col;
+    }
+
+    // Completes the current row with nulls
+    void end_row() {
+        ++row_count_;
+        for (column_t& col : columns_) { col.pad(row_count_); }
+    }
+
+    template<typename Alloc>
+    void append(const basic_value<CharT, Alloc>& rec);
+
+ private:
+    std::size_t row_count_ = 0;
+    basic_column_dictionary<char_type> names_;
+    std::vector<column_t> columns_;
+};
+
+template<typename CharT>
+template<typename Alloc>
+void basic_column_table<CharT>::append(const basic_value<CharT, Alloc>& rec) {
+    if (!rec.is_record()) { throw database_error("not a record"); }
+    std::size_t n = 0;
+    for (const auto& item : rec.as_record()) {
+        column_t& col = field(item.key(), n++);
+        const auto& v = item.value();
+        switch (v.type()) {
+            case dtype::null: col.push_null(); break;
+            case dtype::boolean: col.push_bool(v.as_bool()); break;
+            case dtype::integer:
+            case dtype::unsigned_integer:
+            case dtype::long_integer: col.push_int(v.as_int64()); break;
+            case dtype::unsigned_long_integer: {
+                const std::uint64_t u64 = v.as_uint64();
+                if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                    col.push_int(static_cast<std::int64_t>(u64));
+                } else {
+                    col.push_double(static_cast<double>(u64));
+                }
+            } break;
+            case dtype::double_precision: col.push_double(v.as_double()); break;
+            case dtype::string: col.push_string(v.as_string_view()); break;
+            default: throw database_error("nested value in columnar table");
+        }
+    }
+    end_row();
+}
+
+using column_table = basic_column_table<char>;
+using wcolumn_table = basic_column_table<wchar_t>;
+
+template<typename CharT, typename Alloc>
+basic_column_table<CharT> make_column_table(const basic_value<CharT, Alloc>& v) {
+    basic_column_table<CharT> table;
+    for (const auto& rec : v.as_array()) { table.append(rec); }
+    return table;
+}
+
+namespace json {
+
+// Reads an array of records directly into a columnar table without building the DOM; numbers are taken as the
+// lexer decodes them, so the columns get the same values as `make_column_table()` of the value read with `read()`
+template<typename CharT = char>
+basic_column_table<CharT> read_column_table(ibuf& in) {
+    basic_column_table<CharT> table;
+    basic_column<CharT>* col = nullptr;
+    unsigned depth = 0;
+    std::size_t n = 0;
+    read(
+        in,
+        [&table, &col, &depth, &n](token_t tt, std::string_view lval, const number& num) {
+            if (depth == 0) {
+                if (tt != token_t::array) { throw database_error("expected array of records"); }
+            } else if (depth == 1) {
+                if (tt != token_t::object) { throw database_error("expected record"); }
+                n = 0;
+            } else if (tt < token_t::null_value) {
+                throw database_error("nested value in columnar table");
+            } else {
+                switch (tt) {
+                    case token_t::null_value: col->push_null(); break;
+                    case token_t::true_value: col->push_bool(true); break;
+                    case token_t::false_value: col->push_bool(false); break;
+                    case token_t::integer_number: {
+                        if (num.is_double) {
+                            col->push_double(num.f);
+                        } else if (num.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                            col->push_int(static_cast<std::int64_t>(num.u64));
+                        } else {
+                            col->push_double(static_cast<double>(num.u64));
+                        }
+                    } break;
+                    case token_t::negative_integer_number: {
+                        if (num.is_double) {
+                            col->push_double(num.f);
+                        } else {
+                            col->push_int(num.i64);
+                        }
+                    } break;
+                    case token_t::floating_point_number: col->push_double(num.f); break;
+                    case token_t::string: col->push_string(utf_string_adapter<CharT>{}(lval)); break;
+                    default: UXS_UNREACHABLE_CODE;
+                }
+                return parse_step::into;
+            }
+            ++depth;
+            return parse_step::into;
+        },
+        [] {},
+        [&table, &col, &n](std::string_view lval) { col = &table.field(utf_string_adapter<CharT>{}(lval), n++); },
+        [&table, &depth] {
+            if (--depth == 1) { table.end_row(); }
+        });
+    return table;
+}
+
+}  // namespace json
+
+}  // namespace db
+}  // namespace uxs
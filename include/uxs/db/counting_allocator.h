@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace uxs {
+namespace db {
+
+// Allocation counters shared by copies of `counting_allocator<>`; they are updated atomically, so values using the
+// allocator can be built and destroyed on several threads
+struct allocation_counters {
+    std::atomic<std::size_t> bytes{0};        // currently allocated bytes
+    std::atomic<std::size_t> peak_bytes{0};   // maximum of `bytes`
+    std::atomic<std::size_t> blocks{0};       // currently allocated blocks
+    std::atomic<std::size_t> allocations{0};  // total number of allocations
+
+    // Counters used by default-constructed allocators
+    static allocation_counters& global() {
+        static allocation_counters counters;
+        return counters;
+    }
+
+    void add(std::size_t sz) noexcept {
+        const std::size_t new_bytes = bytes.fetch_add(sz, std::memory_order_relaxed) + sz;
+        std::size_t peak = peak_bytes.load(std::memory_order_relaxed);
+        while (new_bytes > peak && !peak_bytes.compare_exchange_weak(peak, new_bytes, std::memory_order_relaxed)) {}
+        blocks.fetch_add(1, std::memory_order_relaxed);
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void remove(std::size_t sz) noexcept {
+        bytes.fetch_sub(sz, std::memory_order_relaxed);
+        blocks.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+// Allocator adaptor, which counts memory allocated through `Alloc`; it is derived from `Alloc`, so the key pool and
+// the reference count policy of the adapted allocator are still used, e.g.
+// `basic_value<char, counting_allocator<char, key_pool_allocator<char>>>`
+template<typename Ty, typename Alloc = std::allocator<Ty>>
+class counting_allocator : public std::allocator_traits<Alloc>::template rebind_alloc<Ty> {
+ public:
+    using base_type = typename std::allocator_traits<Alloc>::template rebind_alloc<Ty>;
+    using value_type = Ty;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template<typename Ty2>
+    struct rebind {
+        using other = counting_allocator<Ty2, Alloc>;
+    };
+
+    counting_allocator() : counters_(&allocation_counters::global()) {}
+    explicit counting_allocator(allocation_counters& counters, const base_type& al = base_type()) noexcept
+        : base_type(al), counters_(&counters) {}
+    template<typename Ty2>
+    counting_allocator(const counting_allocator<Ty2, Alloc>& other) noexcept
+        : base_type(other.base()), counters_(other.counters()) {}
+
+    const base_type& base() const noexcept { return *this; }
+    allocation_counters* counters() const noexcept { return counters_; }
+
+    Ty* allocate(std::size_t n) {
+        Ty* p = std::allocator_traits<base_type>::allocate(*this, n);
+        counters_->add(n * sizeof(Ty));
+        return p;
+    }
+
+    void deallocate(Ty* p, std::size_t n) noexcept {
+        counters_->remove(n * sizeof(Ty));
+        std::allocator_traits<base_type>::deallocate(*this, p, n);
+    }
+
+    friend bool operator==(const counting_allocator& lhs, const counting_allocator& rhs) noexcept {
+        return lhs.counters_ == rhs.counters_ && lhs.base() == rhs.base();
+    }
+    friend bool operator!=(const counting_allocator& lhs, const counting_allocator& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+ private:
+    allocation_counters* counters_;
+};
+
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "value.h"
+
+#include "uxs/io/iomembuffer.h"
+
+#include <cstring>
+
+namespace uxs {
+namespace db {
+namespace image {
+
+class document;
+class value_ref;
+
+namespace detail {
+
+// Image layout: all numbers are little-endian, all offsets are relative to the beginning of the image, nodes are
+// aligned to 8 bytes:
+//   header : "UXSI", version : u32, image size : u64, root slot
+//   slot   : type : u8, is inline string : u8, inline string size : u8, inline string chars (13 bytes),
+//            or type : u8, 3 bytes of padding, string size or item count : u32, value or node offset : u64
+//   array  : item slots
+//   record : index size : u32, padding : u32, hash index : u32[index size], padding to 8 bytes,
+//            items : (key slot, value slot)[count]
+// Hash index is an open-addressing table of item numbers plus 1 (0 is an empty entry) of power-of-two size
+enum : std::uint32_t { image_version = 1, header_size = 32, root_slot = 16, slot_size = 16, max_inline_size = 13 };
+
+// Key hash of record index: 32-bit FNV-1a, which must stay unchanged for compatibility
+inline std::uint32_t key_hash(std::string_view key) noexcept {
+    std::uint32_t h = 2166136261u;
+    for (char ch : key) { h = (h ^ static_cast<std::uint8_t>(ch)) * 16777619u; }
+    return h;
+}
+
+class value_ref_iterator : public iterator_facade<value_ref_iterator, value_ref, std::forward_iterator_tag,
+                                                  value_ref_iterator, void> {
+ public:
+    value_ref_iterator() noexcept = default;
+    value_ref_iterator(const document* doc, std::uint64_t offset, bool is_record) noexcept
+        : doc_(doc), offset_(offset), is_record_(is_record) {}
+
+    void increment() noexcept { offset_ += is_record_ ? 2 * slot_size : slot_size; }
+    bool is_equal_to(const value_ref_iterator& it) const noexcept { return offset_ == it.offset_; }
+    value_ref_iterator dereference() const noexcept { return *this; }
+
+    bool is_record() const noexcept { return is_record_; }
+    UXS_EXPORT std::string_view key() const;
+    UXS_EXPORT value_ref value() const noexcept;
+
+ private:
+    const document* doc_ = nullptr;
+    std::uint64_t offset_ = 0;
+    bool is_record_ = false;
+};
+
+class builder {
+ public:
+    UXS_EXPORT builder();
+    UXS_EXPORT void set_scalar(std::uint64_t slot, dtype type, std::uint64_t bits) noexcept;
+    UXS_EXPORT void set_string(std::uint64_t slot, std::string_view s);
+    // Allocates the node of a container and returns the offset of its first item
+    UXS_EXPORT std::uint64_t set_container(std::uint64_t slot, dtype type, std::size_t count);
+    // Fills the hash index of a record, which keys are already set
+    UXS_EXPORT void build_index(std::uint64_t slot) noexcept;
+    UXS_EXPORT void finish(membuffer& out);
+
+ private:
+    inline_dynbuffer buf_;
+
+    std::uint64_t alloc(std::size_t size);
+    template<typename Ty>
+    void store(std::uint64_t offset, Ty v) noexcept {
+        std::memcpy(buf_.data() + offset, &v, sizeof(Ty));
+    }
+    template<typename Ty>
+    Ty load(std::uint64_t offset) const noexcept {
+        Ty v;
+        std::memcpy(&v, buf_.data() + offset, sizeof(Ty));
+        return v;
+    }
+};
+
+}  // namespace detail
+
+// Lightweight read-only reference to a value stored in `image::document`; default-constructed reference and
+// references to missing elements behave as `null` values
+class value_ref {
+ public:
+    using key_type = std::string_view;
+    using iterator = detail::value_ref_iterator;
+    using const_iterator = detail::value_ref_iterator;
+
+    value_ref() noexcept = default;
+    value_ref(const document* doc, std::uint64_t offset) noexcept : doc_(doc), offset_(offset) {}
+
+    inline dtype type() const noexcept;
+
+    bool is_null() const noexcept { return type() == dtype::null; }
+    bool is_bool() const noexcept { return type() == dtype::boolean; }
+    bool is_int() const { return scalar().is_int(); }
+    bool is_uint() const { return scalar().is_uint(); }
+    bool is_int64() const { return scalar().is_int64(); }
+    bool is_uint64() const { return scalar().is_uint64(); }
+    bool is_integral() const { return scalar().is_integral(); }
+    bool is_double() const noexcept { return is_numeric(); }
+    bool is_numeric() const noexcept { return type() >= dtype::integer && type() <= dtype::double_precision; }
+    bool is_string() const noexcept { return type() == dtype::string; }
+    bool is_array() const noexcept { return type() == dtype::array; }
+    bool is_record() const noexcept { return type() == dtype::record; }
+
+    bool as_bool() const { return scalar().as_bool(); }
+    std::int32_t as_int() const { return scalar().as_int(); }
+    std::uint32_t as_uint() const { return scalar().as_uint(); }
+    std::int64_t as_int64() const { return scalar().as_int64(); }
+    std::uint64_t as_uint64() const { return scalar().as_uint64(); }
+    double as_double() const { return scalar().as_double(); }
+    std::string as_string() const { return std::string(as_string_view()); }
+    UXS_EXPORT std::string_view as_string_view() const;
+
+    est::optional<bool> get_bool() const { return scalar().get_bool(); }
+    est::optional<std::int32_t> get_int() const { return scalar().get_int(); }
+    est::optional<std::uint32_t> get_uint() const { return scalar().get_uint(); }
+    est::optional<std::int64_t> get_int64() const { return scalar().get_int64(); }
+    est::optional<std::uint64_t> get_uint64() const { return scalar().get_uint64(); }
+    est::optional<double> get_double() const { return scalar().get_double(); }
+    est::optional<std::string_view> get_string_view() const {
+        return is_string() ? est::make_optional(as_string_view()) : est::nullopt();
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+    UXS_EXPORT std::size_t size() const noexcept;
+
+    UXS_EXPORT const_iterator begin() const;
+    UXS_EXPORT const_iterator end() const;
+
+    UXS_EXPORT value_ref operator[](std::size_t i) const;
+    UXS_EXPORT value_ref operator[](key_type key) const;
+    UXS_EXPORT value_ref at(std::size_t i) const;
+    UXS_EXPORT value_ref at(key_type key) const;
+    // Looks the key up in the hash index of the record
+    UXS_EXPORT const_iterator find(key_type key) const;
+    bool contains(key_type key) const { return find(key) != end(); }
+
+    // Materializes referenced subtree as `basic_value`
+    template<typename CharT = char, typename Alloc = std::allocator<CharT>>
+    UXS_EXPORT basic_value<CharT, Alloc> to_value(const Alloc& al = Alloc()) const;
+
+ private:
+    friend class detail::value_ref_iterator;
+
+    const document* doc_ = nullptr;
+    std::uint64_t offset_ = 0;
+
+    UXS_EXPORT basic_value<char> scalar() const;
+    inline std::uint32_t count() const noexcept;
+    inline std::uint64_t payload() const noexcept;
+    std::uint64_t first_item() const;
+};
+
+// Immutable position-independent binary image of a value, which is used in place: arrays are slot vectors with
+// constant-time indexing, records have prebuilt hash indexes, strings are stored inline; the image is typically
+// mapped to memory with `mapped_file`, so that opening it costs nothing and the pages are shared between processes;
+// the header is checked on construction, and every offset is checked against the image size before it is used;
+// container nodes must follow the slots referring to them; the data must outlive the document
+class document {
+ public:
+    UXS_EXPORT explicit document(est::span<const char> data);
+
+    value_ref root() const noexcept { return value_ref(this, detail::root_slot); }
+    value_ref operator[](std::size_t i) const { return root()[i]; }
+    value_ref operator[](std::string_view key) const { return root()[key]; }
+
+    std::size_t size() const noexcept { return size_; }
+
+ private:
+    friend class value_ref;
+    friend class detail::value_ref_iterator;
+
+    const char* data_;
+    std::size_t size_;
+
+    template<typename Ty>
+    Ty load(std::uint64_t offset) const noexcept {
+        Ty v;
+        std::memcpy(&v, data_ + offset, sizeof(Ty));
+        return v;
+    }
+    void check(std::uint64_t offset, std::uint64_t size) const {
+        if (offset > size_ || size > size_ - offset) { throw database_error("invalid value image"); }
+    }
+    UXS_EXPORT std::string_view string_at(std::uint64_t slot) const;
+};
+
+dtype value_ref::type() const noexcept { return doc_ ? static_cast<dtype>(doc_->data_[offset_]) : dtype::null; }
+std::uint32_t value_ref::count() const noexcept { return doc_->load<std::uint32_t>(offset_ + 4); }
+std::uint64_t value_ref::payload() const noexcept { return doc_->load<std::uint64_t>(offset_ + 8); }
+
+// Writes the image of the value: strings are converted to UTF-8; written image can be opened with `document`
+template<typename CharT, typename Alloc>
+UXS_EXPORT void write(membuffer& out, const basic_value<CharT, Alloc>& v);
+
+template<typename CharT, typename Alloc>
+void write(iobuf& out, const basic_value<CharT, Alloc>& v) {
+    iomembuffer buf(out);
+    write(static_cast<membuffer&>(buf), v);
+}
+
+}  // namespace image
+}  // namespace db
+}  // namespace uxs
@@ -3,6 +3,7 @@
 #include "database_error.h"
 
 #include "uxs/io/iomembuffer.h"
+#include "uxs/memory.h"
 
 namespace uxs {
 namespace db {
@@ -26,26 +27,122 @@ enum class token_t : int {
 
 enum class parse_step { into = 0, over, stop };
 
+// Number decoded by the lexer: `u64` and `i64` hold `integer_number` and `negative_integer_number` tokens,
+// `f` holds `floating_point_number` tokens and integers out of 64-bit range, which are marked with `is_double`
+struct number {
+    bool is_double = false;
+    union {
+        std::uint64_t u64;
+        std::int64_t i64;
+        double f;
+    };
+};
+
 namespace detail {
+
 struct lexer {
     ibuf& in;
     unsigned ln = 1;
+    unsigned surrogate = 0;
+    bool has_more = false;  // end of input buffer is not the end of input: lexing can be resumed
     inline_dynbuffer str;
     inline_basic_dynbuffer<char, 32> stash;
     inline_basic_dynbuffer<std::int8_t, 32> stack;
+    bool decode_numbers = false;  // numbers are decoded to `num` while they are recognized
+    bool raw_strings = false;     // escape sequences are checked, but kept in strings as is
+    int putback = -1;             // look-ahead character, which is returned as the next token
+    number num;
     UXS_EXPORT explicit lexer(ibuf& in);
+    // Lexer reading `in` from the state of `other`: input, which `other` has already consumed, isn't read again
+    UXS_EXPORT lexer(ibuf& in, const lexer& other);
     UXS_EXPORT token_t lex(std::string_view& lval);
+    // Skips the rest of the container opened with `tt`: it is checked as by `read()`, but values aren't converted
+    UXS_EXPORT void skip(token_t tt);
 };
-}  // namespace detail
 
+// Checks that decimal `digits` without leading zeroes aren't greater than `limit`
+inline bool digits_not_greater(std::string_view digits, std::string_view limit) {
+    return digits.size() < limit.size() || (digits.size() == limit.size() && digits <= limit);
+}
+
+// Decodes number token lexeme: too big integers are treated as floating-point numbers; integer conversion can wrap
+// around on 20-digit numbers, so they are compared with the limits first
+inline number lexeme_to_number(token_t tt, std::string_view lval) {
+    number num;
+    if (tt == token_t::integer_number && digits_not_greater(lval, "18446744073709551615") &&
+        from_string(lval, num.u64) != 0) {
+        return num;
+    }
+    if (tt == token_t::negative_integer_number && digits_not_greater(lval.substr(1), "9223372036854775808") &&
+        from_string(lval, num.i64) != 0) {
+        return num;
+    }
+    num.is_double = true, num.f = from_string<double>(lval);
+    return num;
+}
+
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> number_to_value(token_t tt, const number& num, const Alloc& al) {
+    if (num.is_double) { return {num.f, al}; }
+    if (tt == token_t::integer_number) {
+        if (num.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max())) {
+            return {static_cast<std::int32_t>(num.u64), al};
+        }
+        if (num.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max())) {
+            return {static_cast<std::uint32_t>(num.u64), al};
+        }
+        if (num.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+            return {static_cast<std::int64_t>(num.u64), al};
+        }
+        return {num.u64, al};
+    }
+    if (num.i64 >= static_cast<std::int64_t>(std::numeric_limits<std::int32_t>::min())) {
+        return {static_cast<std::int32_t>(num.i64), al};
+    }
+    return {num.i64, al};
+}
+
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> token_to_value(token_t tt, std::string_view lval, const Alloc& al) {
+    switch (tt) {
+        case token_t::null_value: return {nullptr, al};
+        case token_t::true_value: return {true, al};
+        case token_t::false_value: return {false, al};
+        case token_t::integer_number:
+        case token_t::negative_integer_number:
+        case token_t::floating_point_number: return number_to_value<CharT>(tt, lexeme_to_number(tt, lval), al);
+        case token_t::string: return {utf_string_adapter<CharT>{}(lval), al};
+        default: UXS_UNREACHABLE_CODE;
+    }
+}
+
+// Value handler is called with decoded number as the third argument, if it accepts it
+template<typename Func, typename = void>
+struct accepts_number : std::false_type {};
+template<typename Func>
+struct accepts_number<Func, std::void_t<decltype(std::declval<const Func&>()(
+                                token_t::null_value, std::string_view(), std::declval<const number&>()))>>
+    : std::true_type {};
+
+template<typename Func>
+parse_step call_value_func(std::true_type, const Func& fn, token_t tt, std::string_view lval, const number& num) {
+    return fn(tt, lval, num);
+}
+template<typename Func>
+parse_step call_value_func(std::false_type, const Func& fn, token_t tt, std::string_view lval, const number&) {
+    return fn(tt, lval);
+}
+
+// Reads one value from the lexer calling SAX handlers, the root container isn't passed to `fn_pop`
 template<typename ValueFunc, typename ArrItemFunc, typename ObjItemFunc, typename PopFunc>
-void read(ibuf& in, const ValueFunc& fn_value, const ArrItemFunc& fn_arr_item, const ObjItemFunc& fn_obj_item,
-          const PopFunc& fn_pop) {
-    detail::lexer lexer(in);
+void read_value(lexer& lexer, const ValueFunc& fn_value, const ArrItemFunc& fn_arr_item, const ObjItemFunc& fn_obj_item,
+                const PopFunc& fn_pop) {
     inline_basic_dynbuffer<char, 32> stack;
 
     const auto fn_value_checked = [&lexer, &fn_value](token_t tt, std::string_view lval) -> parse_step {
-        if (tt >= token_t::null_value || tt == token_t('[') || tt == token_t('{')) { return fn_value(tt, lval); }
+        if (tt >= token_t::null_value || tt == token_t('[') || tt == token_t('{')) {
+            return call_value_func(accepts_number<ValueFunc>{}, fn_value, tt, lval, lexer.num);
+        }
         throw database_error(to_string(lexer.ln) + ": invalid value or unexpected character");
     };
 
@@ -72,6 +169,8 @@ loop:
                     }
                 } else if (ret == parse_step::stop) {
                     return;
+                } else if (tt < token_t::null_value) {
+                    lexer.skip(tt);
                 }
                 if ((tt = lexer.lex(lval)) == token_t(']')) { break; }
                 if (tt != token_t(',')) { throw database_error(to_string(lexer.ln) + ": expected `,` or `]`"); }
@@ -93,6 +192,8 @@ loop:
                 }
             } else if (ret == parse_step::stop) {
                 return;
+            } else if (tt < token_t::null_value) {
+                lexer.skip(tt);
             }
             if ((tt = lexer.lex(lval)) == token_t('}')) { break; }
             if (tt != token_t(',')) { throw database_error(to_string(lexer.ln) + ": expected `,` or `}`"); }
@@ -115,10 +216,193 @@ loop:
     }
 }
 
+}  // namespace detail
+
+// SAX reader: `fn_value(token_t, std::string_view lexeme)` is called for each value, the lexeme is passed as is, so
+// numbers can be converted exactly; if the handler accepts `const number&` as the third argument, numbers are also
+// decoded by the lexer in the same pass, in which they are recognized
+template<typename ValueFunc, typename ArrItemFunc, typename ObjItemFunc, typename PopFunc>
+void read(ibuf& in, const ValueFunc& fn_value, const ArrItemFunc& fn_arr_item, const ObjItemFunc& fn_obj_item,
+          const PopFunc& fn_pop) {
+    detail::lexer lexer(in);
+    lexer.decode_numbers = detail::accepts_number<ValueFunc>::value;
+    detail::read_value(lexer, fn_value, fn_arr_item, fn_obj_item, fn_pop);
+}
+
+namespace detail {
+class push_ibuf : public ibuf {
+ public:
+    push_ibuf() noexcept : ibuf(iomode::in) {}
+    void assign(est::span<const char> s) noexcept {
+        this->clear();
+        this->reset(const_cast<char*>(s.data()), 0, s.size());
+    }
+};
+}  // namespace detail
+
+// Push-mode counterpart of SAX `read()`: input is passed by chunks of arbitrary size with `feed()`, and `finish()`
+// must be called at the end of input; the parser calls the same handlers as `read()`, string views passed to
+// handlers are valid only during the call; `feed()` returns `false` if the value is completely parsed or parsing is
+// stopped by the handler, so the rest of input is not needed
+template<typename ValueFunc, typename ArrItemFunc, typename ObjItemFunc, typename PopFunc>
+class push_parser {
+ public:
+    push_parser(ValueFunc fn_value, ArrItemFunc fn_arr_item, ObjItemFunc fn_obj_item, PopFunc fn_pop)
+        : fn_value_(std::move(fn_value)), fn_arr_item_(std::move(fn_arr_item)), fn_obj_item_(std::move(fn_obj_item)),
+          fn_pop_(std::move(fn_pop)), lexer_(in_) {
+        lexer_.has_more = true;
+        lexer_.decode_numbers = detail::accepts_number<ValueFunc>::value;
+    }
+
+    // The lexer refers to the input buffer of its parser, so the state is copied to the lexer of the new parser
+    push_parser(const push_parser& other)
+        : fn_value_(other.fn_value_), fn_arr_item_(other.fn_arr_item_), fn_obj_item_(other.fn_obj_item_),
+          fn_pop_(other.fn_pop_), lexer_(in_, other.lexer_), skip_depth_(other.skip_depth_), state_(other.state_) {
+        stack_.append(other.stack_.data(), other.stack_.endp());
+    }
+    push_parser(push_parser&& other)
+        : fn_value_(std::move(other.fn_value_)), fn_arr_item_(std::move(other.fn_arr_item_)),
+          fn_obj_item_(std::move(other.fn_obj_item_)), fn_pop_(std::move(other.fn_pop_)), lexer_(in_, other.lexer_),
+          skip_depth_(other.skip_depth_), state_(other.state_) {
+        stack_.append(other.stack_.data(), other.stack_.endp());
+    }
+    push_parser& operator=(const push_parser&) = delete;
+    push_parser& operator=(push_parser&&) = delete;
+
+    bool feed(est::span<const char> s) {
+        if (state_ == state_t::done) { return false; }
+        in_.assign(s);
+        return run();
+    }
+
+    void finish() {
+        if (state_ == state_t::done) { return; }
+        in_.assign(est::span<const char>());
+        lexer_.has_more = false;
+        run();
+    }
+
+ private:
+    enum class state_t : std::uint8_t {
+        value = 0,
+        arr_first,
+        arr_value,
+        arr_next,
+        obj_first,
+        obj_key,
+        obj_colon,
+        obj_value,
+        obj_next,
+        done
+    };
+
+    ValueFunc fn_value_;
+    ArrItemFunc fn_arr_item_;
+    ObjItemFunc fn_obj_item_;
+    PopFunc fn_pop_;
+    detail::push_ibuf in_;
+    detail::lexer lexer_;
+    inline_basic_dynbuffer<char, 32> stack_;
+    std::size_t skip_depth_ = 0;  // count of containers being skipped with `parse_step::over`
+    state_t state_ = state_t::value;
+
+    bool run() {
+        std::string_view lval;
+        while (state_ != state_t::done) {
+            const auto tt = lexer_.lex(lval);
+            if (tt == token_t::eof && lexer_.has_more) { return true; }
+            step(tt, lval);
+        }
+        return false;
+    }
+
+    void step(token_t tt, std::string_view lval) {
+        switch (state_) {
+            case state_t::value: return value(tt, lval);
+            case state_t::arr_first: {
+                if (tt == token_t(']')) { return close(); }
+            } /* fallthrough */
+            case state_t::arr_value: {
+                if (!skip_depth_) { fn_arr_item_(); }
+                return value(tt, lval);
+            } break;
+            case state_t::arr_next: {
+                if (tt == token_t(']')) { return close(); }
+                if (tt != token_t(',')) { throw database_error(to_string(lexer_.ln) + ": expected `,` or `]`"); }
+                state_ = state_t::arr_value;
+            } break;
+            case state_t::obj_first: {
+                if (tt == token_t('}')) { return close(); }
+            } /* fallthrough */
+            case state_t::obj_key: {
+                if (tt != token_t::string) { throw database_error(to_string(lexer_.ln) + ": expected valid string"); }
+                if (!skip_depth_) { fn_obj_item_(lval); }
+                state_ = state_t::obj_colon;
+            } break;
+            case state_t::obj_colon: {
+                if (tt != token_t(':')) { throw database_error(to_string(lexer_.ln) + ": expected `:`"); }
+                state_ = state_t::obj_value;
+            } break;
+            case state_t::obj_value: return value(tt, lval);
+            case state_t::obj_next: {
+                if (tt == token_t('}')) { return close(); }
+                if (tt != token_t(',')) { throw database_error(to_string(lexer_.ln) + ": expected `,` or `}`"); }
+                state_ = state_t::obj_key;
+            } break;
+            default: UXS_UNREACHABLE_CODE;
+        }
+    }
+
+    void value(token_t tt, std::string_view lval) {
+        if (tt < token_t::null_value && tt != token_t('[') && tt != token_t('{')) {
+            throw database_error(to_string(lexer_.ln) + ": invalid value or unexpected character");
+        }
+        auto ret = parse_step::over;
+        if (!skip_depth_ && ((ret = detail::call_value_func(detail::accepts_number<ValueFunc>{}, fn_value_, tt, lval,
+                                                          lexer_.num)) == parse_step::stop ||
+                             (ret == parse_step::over && stack_.empty()))) {
+            state_ = state_t::done;
+            return;
+        }
+        if (tt >= token_t::null_value) { return next(); }
+        if (skip_depth_ || ret != parse_step::into) { ++skip_depth_; }
+        stack_ += static_cast<char>(tt);
+        state_ = tt == token_t('[') ? state_t::arr_first : state_t::obj_first;
+    }
+
+    void close() {
+        stack_.pop_back();
+        if (skip_depth_) {
+            --skip_depth_;
+        } else if (!stack_.empty()) {
+            fn_pop_();
+        }
+        next();
+    }
+
+    void next() {
+        if (stack_.empty()) {
+            state_ = state_t::done;
+            return;
+        }
+        state_ = stack_.back() == '[' ? state_t::arr_next : state_t::obj_next;
+    }
+};
+
 template<typename CharT = char, typename Alloc = std::allocator<CharT>>
 UXS_EXPORT basic_value<CharT, Alloc> read(ibuf& in, const Alloc& al = Alloc());
 
 namespace detail {
+// Reads the value with prepared lexer, which can be used after the value
+template<typename CharT, typename Alloc>
+UXS_EXPORT basic_value<CharT, Alloc> read_value(lexer& lexer, const Alloc& al);
+}  // namespace detail
+
+namespace detail {
+// Writes quoted string with escaped `"`, `\` and control characters
+template<typename CharT>
+UXS_EXPORT basic_membuffer<CharT>& write_text(basic_membuffer<CharT>& out, std::basic_string_view<CharT> text);
+
 template<typename CharT>
 struct writer {
     basic_membuffer<CharT>& out;
@@ -128,6 +412,9 @@ struct writer {
     char indent_char;
     template<typename ValueCharT, typename Alloc>
     UXS_EXPORT void do_write(const basic_value<ValueCharT, Alloc>& v, unsigned indent);
+    // Writes escaped record key followed by `: `
+    template<typename KeyCharT>
+    UXS_EXPORT void write_key(std::basic_string_view<KeyCharT> key);
 };
 }  // namespace detail
 
@@ -146,6 +433,108 @@ void write(basic_iobuf<CharT>& out, const basic_value<ValueCharT, Alloc>& v, uns
     writer.do_write(v, indent);
 }
 
+// Reformats JSON text without building DOM: string and number lexemes are copied as is, without unescaping and
+// conversion, and the output is formatted in the same way as with `write()`; throws `database_error` on invalid input
+UXS_EXPORT void reformat(membuffer& out, ibuf& in, unsigned indent_size = 0, char object_ws_char = ' ',
+                         char array_ws_char = ' ', char indent_char = ' ', unsigned indent = 0);
+inline void reformat(iobuf& out, ibuf& in, unsigned indent_size = 0, char object_ws_char = ' ',
+                     char array_ws_char = ' ', char indent_char = ' ', unsigned indent = 0) {
+    basic_iomembuffer<char> buf(out);
+    reformat(buf, in, indent_size, object_ws_char, array_ws_char, indent_char, indent);
+}
+
+// Same as `reformat()`, but writes no whitespaces at all
+UXS_EXPORT void minify(membuffer& out, ibuf& in);
+inline void minify(iobuf& out, ibuf& in) {
+    basic_iomembuffer<char> buf(out);
+    minify(buf, in);
+}
+
+// Checks JSON text without building anything; throws `database_error` on invalid input
+UXS_EXPORT void validate(ibuf& in);
+
+// Writes JSON sequentially without building DOM: containers are opened and closed with `begin_*()`/`end_*()`,
+// record items are written as `key()` followed by `value()` or nested container; the output is formatted in the
+// same way as with `write()`
+template<typename CharT>
+class stream_writer {
+ public:
+    explicit stream_writer(basic_membuffer<CharT>& out, unsigned indent_size = 0, char object_ws_char = ' ',
+                           char array_ws_char = ' ', char indent_char = ' ', unsigned indent = 0) noexcept
+        : out_(out), indent_size_(indent_size), object_ws_char_(object_ws_char), array_ws_char_(array_ws_char),
+          indent_char_(indent_char), indent_(indent) {}
+    explicit stream_writer(basic_iobuf<CharT>& out, unsigned indent_size = 0, char object_ws_char = ' ',
+                           char array_ws_char = ' ', char indent_char = ' ', unsigned indent = 0)
+        : iobuf_out_(est::make_unique<basic_iomembuffer<CharT>>(out)), out_(*iobuf_out_), indent_size_(indent_size),
+          object_ws_char_(object_ws_char), array_ws_char_(array_ws_char), indent_char_(indent_char), indent_(indent) {}
+
+    UXS_EXPORT stream_writer& begin_array();
+    UXS_EXPORT stream_writer& end_array();
+    UXS_EXPORT stream_writer& begin_object();
+    UXS_EXPORT stream_writer& end_object();
+    UXS_EXPORT stream_writer& key(std::basic_string_view<CharT> k);
+    template<typename KeyCharT, typename = std::enable_if_t<!std::is_same<KeyCharT, CharT>::value>>
+    stream_writer& key(std::basic_string_view<KeyCharT> k) {
+        return key(utf_string_adapter<CharT>{}(k));
+    }
+    template<typename KeyCharT, typename Traits, typename Alloc>
+    stream_writer& key(const std::basic_string<KeyCharT, Traits, Alloc>& k) {
+        return key(std::basic_string_view<KeyCharT>(k));
+    }
+    stream_writer& key(const char* k) { return key(std::string_view(k)); }
+    stream_writer& key(const wchar_t* k) { return key(std::wstring_view(k)); }
+
+    UXS_EXPORT stream_writer& value(std::nullptr_t);
+    UXS_EXPORT stream_writer& value(bool b);
+    UXS_EXPORT stream_writer& value(std::basic_string_view<CharT> s);
+    template<typename Ty, typename = std::enable_if_t<std::is_integral<Ty>::value>>
+    stream_writer& value(Ty v) {
+        begin_value();
+        to_basic_string(out_, v);
+        return *this;
+    }
+    stream_writer& value(float f) { return value(static_cast<double>(f)); }
+    UXS_EXPORT stream_writer& value(double f);
+    stream_writer& value(long double f) { return value(static_cast<double>(f)); }
+    template<typename StrCharT, typename = std::enable_if_t<!std::is_same<StrCharT, CharT>::value>>
+    stream_writer& value(std::basic_string_view<StrCharT> s) {
+        return value(utf_string_adapter<CharT>{}(s));
+    }
+    template<typename StrCharT, typename Traits, typename Alloc>
+    stream_writer& value(const std::basic_string<StrCharT, Traits, Alloc>& s) {
+        return value(std::basic_string_view<StrCharT>(s));
+    }
+    stream_writer& value(const char* s) { return value(std::string_view(s)); }
+    stream_writer& value(const wchar_t* s) { return value(std::wstring_view(s)); }
+    template<typename ValueCharT, typename Alloc>
+    stream_writer& value(const basic_value<ValueCharT, Alloc>& v) {
+        begin_value();
+        detail::writer<CharT> writer{out_, indent_size_, object_ws_char_, array_ws_char_, indent_char_};
+        writer.do_write(v, indent_);
+        return *this;
+    }
+
+ private:
+    struct level_t {
+        bool is_record;
+        bool is_first;
+    };
+
+    std::unique_ptr<basic_iomembuffer<CharT>> iobuf_out_;
+    basic_membuffer<CharT>& out_;
+    unsigned indent_size_;
+    char object_ws_char_;
+    char array_ws_char_;
+    char indent_char_;
+    unsigned indent_;
+    bool has_key_ = false;
+    inline_basic_dynbuffer<level_t, 32> stack_;
+
+    UXS_EXPORT void begin_value();
+    UXS_EXPORT void begin_item();
+    UXS_EXPORT void end_container(bool is_record);
+};
+
 }  // namespace json
 }  // namespace db
 
@@ -0,0 +1,418 @@
+#pragma once
+
+#if __cplusplus < 201703L
+#    error Header file `db/json_bind.h` requires C++17
+#endif  // __cplusplus < 201703L
+
+#include "json.h"
+
+#include <array>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace uxs {
+namespace db {
+namespace json {
+
+// Binding of a structure to JSON object: specialize it for the structure with the list of its fields, e.g.
+//   template<>
+//   struct json::binding<point> {
+//       static constexpr auto fields = std::make_tuple(json::field("x", &point::x), json::field("y", &point::y));
+//   };
+// Fields can be of boolean, integral, floating-point, string, `std::vector<>`, `std::optional<>` or bound types
+template<typename Ty>
+struct binding;
+
+template<typename Class, typename Ty>
+struct field_t {
+    std::string_view name;
+    Ty Class::*ptr;
+};
+
+template<typename Class, typename Ty>
+constexpr field_t<Class, Ty> field(std::string_view name, Ty Class::*ptr) noexcept {
+    return {name, ptr};
+}
+
+namespace detail {
+
+template<typename Ty, typename = void>
+struct is_bound : std::false_type {};
+template<typename Ty>
+struct is_bound<Ty, std::void_t<decltype(binding<Ty>::fields)>> : std::true_type {};
+
+template<typename Ty>
+struct is_vector : std::false_type {};
+template<typename Ty, typename Alloc>
+struct is_vector<std::vector<Ty, Alloc>> : std::true_type {};
+
+template<typename Ty>
+struct is_vector_of_bool : std::false_type {};
+template<typename Alloc>
+struct is_vector_of_bool<std::vector<bool, Alloc>> : std::true_type {};
+
+template<typename Ty>
+struct is_optional : std::false_type {};
+template<typename Ty>
+struct is_optional<std::optional<Ty>> : std::true_type {};
+
+template<typename Ty>
+struct is_string : std::false_type {};
+template<typename CharT, typename Traits, typename Alloc>
+struct is_string<std::basic_string<CharT, Traits, Alloc>> : std::true_type {};
+
+// Field name hash of the perfect hash table: only the length and three characters of the name are mixed in,
+// unless the whole name must be hashed to separate field names
+constexpr std::uint32_t field_name_hash(std::string_view name, std::uint32_t seed, std::size_t pos,
+                                        bool whole) noexcept {
+    std::uint32_t h = (seed * 0x9e3779b9u) ^ static_cast<std::uint32_t>(name.size());
+    const auto mix = [&h](char ch) { h = (h ^ static_cast<std::uint8_t>(ch)) * 16777619u; };
+    if (whole) {
+        for (char ch : name) { mix(ch); }
+    } else if (!name.empty()) {
+        mix(name[0]);
+        mix(name[name.size() - 1]);
+        mix(name[pos % name.size()]);
+    }
+    return h ^ (h >> 15);
+}
+
+constexpr std::size_t table_size(std::size_t count) noexcept {
+    std::size_t size = 4;
+    while (size < 4 * count) { size <<= 1; }
+    return size;
+}
+
+template<std::size_t N>
+constexpr bool has_duplicates(const std::array<std::string_view, N>& names) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t j = 0; j < i; ++j) {
+            if (names[i] == names[j]) { return true; }
+        }
+    }
+    return false;
+}
+
+// Perfect hash table of field names, which is built at compile time
+template<std::size_t N>
+struct field_table {
+    enum : std::size_t { size = table_size(N) };
+    std::uint32_t seed = 0;
+    std::size_t pos = 0;
+    bool whole = false;
+    bool valid = false;
+    std::array<std::uint8_t, size> slots{};  // field number plus 1, 0 - empty slot
+
+    constexpr std::size_t slot(std::string_view name) const noexcept {
+        return field_name_hash(name, seed, pos, whole) & (size - 1);
+    }
+
+    constexpr bool try_build(const std::array<std::string_view, N>& names) noexcept {
+        slots = {};
+        for (std::size_t n = 0; n < N; ++n) {
+            std::uint8_t& entry = slots[slot(names[n])];
+            if (entry) { return false; }
+            entry = static_cast<std::uint8_t>(n + 1);
+        }
+        return true;
+    }
+
+    constexpr explicit field_table(const std::array<std::string_view, N>& names) noexcept {
+        std::size_t max_len = 1;
+        for (std::string_view name : names) { max_len = std::max(max_len, name.size()); }
+        // try cheap hashes first: with the character at each position and a few seeds
+        for (pos = 0; pos < max_len; ++pos) {
+            for (seed = 0; seed < 64; ++seed) {
+                if ((valid = try_build(names))) { return; }
+            }
+        }
+        pos = 0, whole = true;
+        for (seed = 0; seed < 4096; ++seed) {
+            if ((valid = try_build(names))) { return; }
+        }
+    }
+};
+
+template<typename Ty>
+struct field_list {
+    using fields_t = std::decay_t<decltype(binding<Ty>::fields)>;
+    enum : std::size_t { count = std::tuple_size<fields_t>::value };
+    static_assert(count < 256, "too many fields");
+
+    template<std::size_t... Is>
+    static constexpr std::array<std::string_view, count> get_names(std::index_sequence<Is...>) {
+        return {{std::get<Is>(binding<Ty>::fields).name...}};
+    }
+
+    static constexpr std::array<std::string_view, count> names = get_names(std::make_index_sequence<count>{});
+    static_assert(!has_duplicates(names), "duplicate field names");
+    static constexpr field_table<count> table{names};
+    static_assert(table.valid || has_duplicates(names), "no perfect hash of field names is found");
+
+    // Returns field number or `count` if there is no such field
+    static std::size_t find(std::string_view name) noexcept {
+        const std::uint8_t entry = table.slots[table.slot(name)];
+        return entry && names[entry - 1] == name ? static_cast<std::size_t>(entry - 1) :
+                                                   static_cast<std::size_t>(count);
+    }
+};
+
+// Type-erased target of parsed values
+struct sink_vtable_t;
+struct sink_t {
+    void* obj;
+    const sink_vtable_t* vtable;
+};
+
+struct sink_vtable_t {
+    parse_step (*value)(void* obj, token_t tt, std::string_view lval, const number& num);
+    sink_t (*arr_item)(void* obj);
+    sink_t (*obj_item)(void* obj, std::string_view key);
+};
+
+template<typename Ty>
+struct sink;
+
+template<typename Ty>
+struct vector_bool_back_sink;
+
+template<typename Ty>
+sink_t make_sink(Ty& obj) noexcept {
+    return {&obj, &sink<Ty>::vtable};
+}
+
+template<typename Ty>
+Ty to_number(token_t tt, std::string_view lval, const number& num) {
+    if (tt < token_t::integer_number || tt > token_t::floating_point_number) {
+        throw database_error("bad value conversion");
+    }
+    if constexpr (std::is_same<Ty, double>::value) {
+        if (num.is_double) { return num.f; }
+        return tt == token_t::integer_number ? static_cast<double>(num.u64) : static_cast<double>(num.i64);
+    } else if constexpr (std::is_floating_point<Ty>::value) {
+        return from_string<Ty>(lval);  // converted from the lexeme to be rounded once
+    } else if (!num.is_double) {
+        if (tt == token_t::integer_number) {
+            if (num.u64 <= static_cast<std::uint64_t>(std::numeric_limits<Ty>::max())) {
+                return static_cast<Ty>(num.u64);
+            }
+        } else if (std::is_signed<Ty>::value &&
+                   num.i64 >= static_cast<std::int64_t>(std::numeric_limits<Ty>::min())) {
+            return static_cast<Ty>(num.i64);
+        }
+    }
+    throw database_error("bad value conversion");
+}
+
+template<typename Ty>
+struct sink {
+    static parse_step value(void* obj, token_t tt, std::string_view lval, const number& num) {
+        Ty& v = *static_cast<Ty*>(obj);
+        if constexpr (std::is_same<Ty, bool>::value) {
+            if (tt != token_t::true_value && tt != token_t::false_value) {
+                throw database_error("bad value conversion");
+            }
+            v = tt == token_t::true_value;
+        } else if constexpr (std::is_arithmetic<Ty>::value) {
+            v = to_number<Ty>(tt, lval, num);
+        } else if constexpr (is_string<Ty>::value) {
+            if (tt != token_t::string) { throw database_error("not a string"); }
+            v = utf_string_adapter<typename Ty::value_type>{}(lval);
+        } else if constexpr (is_vector<Ty>::value) {
+            if (tt != token_t::array) { throw database_error("not an array"); }
+            v.clear();
+        } else if constexpr (is_optional<Ty>::value) {
+            if (tt == token_t::null_value) {
+                v.reset();
+                return parse_step::over;
+            }
+            return sink<typename Ty::value_type>::value(&v.emplace(), tt, lval, num);
+        } else {
+            static_assert(is_bound<Ty>::value, "type is not bound to JSON");
+            if (tt != token_t::object) { throw database_error("not a record"); }
+        }
+        return parse_step::into;
+    }
+
+    static sink_t arr_item(void* obj) {
+        Ty& v = *static_cast<Ty*>(obj);
+        if constexpr (is_vector_of_bool<Ty>::value) {
+            v.emplace_back();
+            return {&v, &vector_bool_back_sink<Ty>::vtable};
+        } else if constexpr (is_vector<Ty>::value) {
+            return make_sink(v.emplace_back());
+        } else if constexpr (is_optional<Ty>::value) {
+            return sink<typename Ty::value_type>::arr_item(&*v);
+        } else {
+            UXS_UNREACHABLE_CODE;
+        }
+    }
+
+    static sink_t obj_item(void* obj, std::string_view key) {
+        Ty& v = *static_cast<Ty*>(obj);
+        if constexpr (is_optional<Ty>::value) {
+            return sink<typename Ty::value_type>::obj_item(&*v, key);
+        } else if constexpr (is_bound<Ty>::value) {
+            static constexpr auto sinks = field_sinks(std::make_index_sequence<field_list<Ty>::count>{});
+            return sinks[field_list<Ty>::find(key)](v);
+        } else {
+            UXS_UNREACHABLE_CODE;
+        }
+    }
+
+    template<std::size_t I>
+    static sink_t field_sink(Ty& v) noexcept {
+        if constexpr (I < field_list<Ty>::count) {
+            return make_sink(v.*(std::get<I>(binding<Ty>::fields).ptr));
+        } else {
+            return {nullptr, nullptr};  // unknown field is skipped
+        }
+    }
+
+    template<std::size_t... Is>
+    static constexpr std::array<sink_t (*)(Ty&), sizeof...(Is) + 1> field_sinks(std::index_sequence<Is...>) {
+        return {{&field_sink<Is>..., &field_sink<sizeof...(Is)>}};
+    }
+
+    static constexpr sink_vtable_t vtable{value, arr_item, obj_item};
+};
+
+// Target of the last item of `std::vector<bool>`: its items are not addressable, so the item is set through
+// the vector
+template<typename Ty>
+struct vector_bool_back_sink {
+    static parse_step value(void* obj, token_t tt, std::string_view lval, const number& num) {
+        bool item = false;
+        const parse_step step = sink<bool>::value(&item, tt, lval, num);
+        static_cast<Ty*>(obj)->back() = item;
+        return step;
+    }
+
+    static constexpr sink_vtable_t vtable{value, nullptr, nullptr};
+};
+
+template<typename CharT>
+struct bound_writer {
+    basic_membuffer<CharT>& out;
+    unsigned indent_size;
+    char object_ws_char;
+    char array_ws_char;
+    char indent_char;
+
+    void begin_container(char ch, char ws_char, unsigned& indent) {
+        out += ch;
+        if (ws_char == '\n') {
+            indent += indent_size;
+            out += '\n';
+            out.append(indent, indent_char);
+        }
+    }
+
+    void separator(char ws_char, unsigned indent) {
+        out += ',';
+        out += ws_char;
+        if (ws_char == '\n') { out.append(indent, indent_char); }
+    }
+
+    void end_container(char ch, char ws_char, unsigned& indent) {
+        if (ws_char == '\n') {
+            indent -= indent_size;
+            out += '\n';
+            out.append(indent, indent_char);
+        }
+        out += ch;
+    }
+
+    template<typename Ty>
+    void write(const Ty& v, unsigned indent) {
+        if constexpr (std::is_same<Ty, bool>::value) {
+            out += v ? string_literal<CharT, 't', 'r', 'u', 'e'>{}() :
+                       string_literal<CharT, 'f', 'a', 'l', 's', 'e'>{}();
+        } else if constexpr (std::is_integral<Ty>::value) {
+            to_basic_string(out, v);
+        } else if constexpr (std::is_floating_point<Ty>::value) {
+            to_basic_string(out, static_cast<double>(v), fmt_opts{fmt_flags::json_compat});
+        } else if constexpr (is_string<Ty>::value) {
+            write_text<CharT>(out, utf_string_adapter<CharT>{}(std::basic_string_view<typename Ty::value_type>(v)));
+        } else if constexpr (is_vector<Ty>::value) {
+            if (v.empty()) {
+                out += string_literal<CharT, '[', ']'>{}();
+                return;
+            }
+            begin_container('[', array_ws_char, indent);
+            for (auto it = v.begin(); it != v.end(); ++it) {
+                if (it != v.begin()) { separator(array_ws_char, indent); }
+                write(static_cast<const typename Ty::value_type&>(*it), indent);
+            }
+            end_container(']', array_ws_char, indent);
+        } else if constexpr (is_optional<Ty>::value) {
+            if (v) {
+                write(*v, indent);
+            } else {
+                out += string_literal<CharT, 'n', 'u', 'l', 'l'>{}();
+            }
+        } else {
+            static_assert(is_bound<Ty>::value, "type is not bound to JSON");
+            write_fields(v, indent, std::make_index_sequence<field_list<Ty>::count>{});
+        }
+    }
+
+    template<typename Ty, std::size_t... Is>
+    void write_fields(const Ty& v, unsigned indent, std::index_sequence<Is...>) {
+        if (sizeof...(Is) == 0) {
+            out += string_literal<CharT, '{', '}'>{}();
+            return;
+        }
+        begin_container('{', object_ws_char, indent);
+        const auto write_field = [this, &v, indent](const auto& field, bool is_first) {
+            if (!is_first) { separator(object_ws_char, indent); }
+            writer<CharT>{out, indent_size, object_ws_char, array_ws_char, indent_char}.write_key(field.name);
+            write(v.*(field.ptr), indent);
+        };
+        (write_field(std::get<Is>(binding<Ty>::fields), Is == 0), ...);
+        end_container('}', object_ws_char, indent);
+    }
+};
+
+}  // namespace detail
+
+// Reads JSON value directly into bound structure or other supported type without building DOM: record keys are
+// dispatched to fields with compile-time perfect hash table, unknown keys are skipped, missing fields are left
+// unchanged, `null` is accepted only for `std::optional<>` fields
+template<typename Ty>
+void read_bound(ibuf& in, Ty& obj) {
+    inline_basic_dynbuffer<detail::sink_t, 32> stack;
+    detail::sink_t curr = detail::make_sink(obj);
+    read(
+        in,
+        [&stack, &curr](token_t tt, std::string_view lval, const number& num) {
+            if (!curr.obj) { return parse_step::over; }
+            const parse_step step = curr.vtable->value(curr.obj, tt, lval, num);
+            if (tt < token_t::null_value && step == parse_step::into) { stack.push_back(curr); }
+            return step;
+        },
+        [&stack, &curr]() { curr = stack.back().vtable->arr_item(stack.back().obj); },
+        [&stack, &curr](std::string_view key) { curr = stack.back().vtable->obj_item(stack.back().obj, key); },
+        [&stack]() { stack.pop_back(); });
+}
+
+// Writes bound structure or other supported type: the output is the same as of `write()` for the same data
+template<typename CharT, typename Ty>
+void write_bound(basic_membuffer<CharT>& out, const Ty& obj, unsigned indent_size = 0, char object_ws_char = ' ',
+                 char array_ws_char = ' ', char indent_char = ' ', unsigned indent = 0) {
+    detail::bound_writer<CharT> writer{out, indent_size, object_ws_char, array_ws_char, indent_char};
+    writer.write(obj, indent);
+}
+
+template<typename CharT, typename Ty>
+void write_bound(basic_iobuf<CharT>& out, const Ty& obj, unsigned indent_size = 0, char object_ws_char = ' ',
+                 char array_ws_char = ' ', char indent_char = ' ', unsigned indent = 0) {
+    basic_iomembuffer<CharT> buf(out);
+    detail::bound_writer<CharT> writer{buf, indent_size, object_ws_char, array_ws_char, indent_char};
+    writer.write(obj, indent);
+}
+
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "json.h"
+#include "value.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace uxs {
+namespace db {
+namespace json {
+
+class document;
+class value_ref;
+
+namespace detail {
+
+// Tape node: containers store the number of items in `size` and the count of nodes occupied by their contents in
+// `extra`; scalars store lexeme position and length; strings keep escape state in `extra`
+struct tape_node_t {
+    token_t type;
+    std::uint32_t offset;
+    std::uint32_t size;
+    std::uint32_t extra;
+};
+
+enum : std::uint32_t { string_plain = 0, string_escaped, string_decoded };
+
+class value_ref_iterator : public iterator_facade<value_ref_iterator, value_ref, std::forward_iterator_tag,
+                                                  value_ref_iterator, void> {
+ public:
+    value_ref_iterator() noexcept = default;
+    value_ref_iterator(const document* doc, std::uint32_t index, bool is_record) noexcept
+        : doc_(doc), index_(index), is_record_(is_record) {}
+
+    UXS_EXPORT void increment() noexcept;
+    bool is_equal_to(const value_ref_iterator& it) const noexcept { return index_ == it.index_; }
+    value_ref_iterator dereference() const noexcept { return *this; }
+
+    bool is_record() const noexcept { return is_record_; }
+    UXS_EXPORT std::string_view key() const;
+    UXS_EXPORT value_ref value() const noexcept;
+
+ private:
+    const document* doc_ = nullptr;
+    std::uint32_t index_ = 0;
+    bool is_record_ = false;
+};
+
+}  // namespace detail
+
+// Lightweight read-only reference to a value stored in `json::document`; default-constructed
+// reference and references to missing elements behave as `null` values
+class value_ref {
+ public:
+    using key_type = std::string_view;
+    using iterator = detail::value_ref_iterator;
+    using const_iterator = detail::value_ref_iterator;
+
+    value_ref() noexcept = default;
+    value_ref(const document* doc, std::uint32_t index) noexcept : doc_(doc), index_(index) {}
+
+    UXS_EXPORT dtype type() const;
+
+    bool is_null() const noexcept { return !doc_ || node().type == token_t::null_value; }
+    bool is_bool() const noexcept {
+        return doc_ && (node().type == token_t::true_value || node().type == token_t::false_value);
+    }
+    // only numbers are converted to check the type, so that strings aren't copied
+    bool is_int() const { return is_numeric() && scalar().is_int(); }
+    bool is_uint() const { return is_numeric() && scalar().is_uint(); }
+    bool is_int64() const { return is_numeric() && scalar().is_int64(); }
+    bool is_uint64() const { return is_numeric() && scalar().is_uint64(); }
+    bool is_integral() const { return is_numeric() && scalar().is_integral(); }
+    bool is_double() const noexcept { return is_numeric(); }
+    bool is_numeric() const noexcept {
+        return doc_ && node().type >= token_t::integer_number && node().type <= token_t::floating_point_number;
+    }
+    bool is_string() const noexcept { return doc_ && node().type == token_t::string; }
+    bool is_array() const noexcept { return doc_ && node().type == token_t::array; }
+    bool is_record() const noexcept { return doc_ && node().type == token_t::object; }
+
+    bool as_bool() const { return scalar().as_bool(); }
+    std::int32_t as_int() const { return scalar().as_int(); }
+    std::uint32_t as_uint() const { return scalar().as_uint(); }
+    std::int64_t as_int64() const { return scalar().as_int64(); }
+    std::uint64_t as_uint64() const { return scalar().as_uint64(); }
+    double as_double() const { return scalar().as_double(); }
+    std::string as_string() const { return std::string(as_string_view()); }
+    UXS_EXPORT std::string_view as_string_view() const;
+
+    est::optional<bool> get_bool() const { return scalar().get_bool(); }
+    est::optional<std::int32_t> get_int() const { return scalar().get_int(); }
+    est::optional<std::uint32_t> get_uint() const { return scalar().get_uint(); }
+    est::optional<std::int64_t> get_int64() const { return scalar().get_int64(); }
+    est::optional<std::uint64_t> get_uint64() const { return scalar().get_uint64(); }
+    est::optional<double> get_double() const { return scalar().get_double(); }
+    est::optional<std::string_view> get_string_view() const {
+        return is_string() ? est::make_optional(as_string_view()) : est::nullopt();
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+    UXS_EXPORT std::size_t size() const noexcept;
+
+    UXS_EXPORT const_iterator begin() const noexcept;
+    UXS_EXPORT const_iterator end() const noexcept;
+
+    UXS_EXPORT value_ref operator[](std::size_t i) const noexcept;
+    UXS_EXPORT value_ref operator[](key_type key) const;
+    UXS_EXPORT value_ref at(std::size_t i) const;
+    UXS_EXPORT value_ref at(key_type key) const;
+    // Finds the first item with the key: small records are searched linearly, bigger ones are looked up in the hash
+    // index of the record, which is built on the first lookup
+    UXS_EXPORT const_iterator find(key_type key) const;
+    bool contains(key_type key) const { return find(key) != end(); }
+
+    // Materializes referenced subtree as `basic_value`
+    template<typename CharT = char, typename Alloc = std::allocator<CharT>>
+    UXS_EXPORT basic_value<CharT, Alloc> to_value(const Alloc& al = Alloc()) const;
+
+ private:
+    friend class detail::value_ref_iterator;
+
+    const document* doc_ = nullptr;
+    std::uint32_t index_ = 0;
+
+    inline const detail::tape_node_t& node() const noexcept;
+    UXS_EXPORT basic_value<char> scalar() const;
+};
+
+// JSON document parsed into a flat tape of nodes instead of `basic_value` tree: no node is allocated
+// while parsing, numbers are decoded and strings are unescaped only when accessed, in the same way as by `read()`;
+// strings are unescaped in place and record indexes are built on the first lookup, so concurrent access to the same
+// document requires external synchronization
+class document {
+ public:
+    UXS_EXPORT explicit document(std::string text);
+    UXS_EXPORT explicit document(ibuf& in);
+
+    value_ref root() const noexcept { return value_ref(this, 0); }
+    value_ref operator[](std::size_t i) const noexcept { return root()[i]; }
+    value_ref operator[](std::string_view key) const { return root()[key]; }
+
+    std::size_t tape_size() const noexcept { return tape_.size(); }
+    std::size_t text_size() const noexcept { return text_.size(); }
+
+ private:
+    friend class value_ref;
+    friend class detail::value_ref_iterator;
+
+    enum : std::uint32_t { small_record_max = 8 };
+
+    mutable std::string text_;
+    mutable std::vector<detail::tape_node_t> tape_;
+    // open-addressing hash tables of key node indexes plus 1 of bigger records by record node index
+    mutable std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> key_index_;
+
+    UXS_EXPORT void parse();
+    UXS_EXPORT token_t scan(std::size_t& pos, detail::tape_node_t& node) const;
+    UXS_EXPORT std::string_view string_at(std::uint32_t index) const;
+    UXS_EXPORT const std::vector<std::uint32_t>& key_index(std::uint32_t index) const;
+    std::string_view lexeme_at(std::uint32_t index) const noexcept {
+        return std::string_view(&text_[tape_[index].offset], tape_[index].size);
+    }
+    std::uint32_t next_sibling(std::uint32_t index) const noexcept {
+        const auto& node = tape_[index];
+        return index + 1 + (node.type == token_t::array || node.type == token_t::object ? node.extra : 0);
+    }
+    UXS_EXPORT database_error make_error(std::size_t pos, const char* msg) const;
+};
+
+const detail::tape_node_t& value_ref::node() const noexcept { return doc_->tape_[index_]; }
+
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "json.h"
+#include "value.h"
+
+#include "uxs/io/iflatbuf.h"
+#include "uxs/memory.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace uxs {
+namespace db {
+namespace json {
+
+struct lines_read_opts {
+    unsigned thread_count = 0;                      // 0 - `std::thread::hardware_concurrency()`
+    std::size_t block_size = std::size_t(1) << 20;  // approximate size of line-aligned block
+    unsigned max_blocks = 0;                        // max blocks not yet consumed, 0 - twice the thread count
+    bool ordered = true;                            // deliver results in input order
+};
+
+namespace detail {
+
+// Splits input into line-aligned blocks: each block except the last one ends with '\n'
+class line_splitter {
+ public:
+    explicit line_splitter(ibuf& in, std::size_t block_size) noexcept : in_(&in), block_size_(block_size) {}
+    explicit line_splitter(est::span<const char> text, std::size_t block_size) noexcept
+        : text_(text), block_size_(block_size) {}
+
+    UXS_EXPORT bool next(std::string& storage, std::string_view& block);
+
+ private:
+    ibuf* in_ = nullptr;
+    est::span<const char> text_;
+    std::size_t block_size_;
+    std::string carry_;
+};
+
+UXS_EXPORT bool is_blank_line(std::string_view line) noexcept;
+
+template<typename Ty>
+struct line_block {
+    std::string storage;
+    std::string_view text;
+    std::size_t first_line = 0;
+    std::vector<std::pair<std::size_t, Ty>> results;
+    std::exception_ptr error;
+    bool ready = false;
+};
+
+template<typename Ty, typename ParseFunc, typename ConsumeFunc>
+void process_lines(line_splitter& splitter, const ParseFunc& fn_parse, const ConsumeFunc& fn_consume,
+                   const lines_read_opts& opts) {
+    using block_t = line_block<Ty>;
+
+    unsigned thread_count = opts.thread_count;
+    if (!thread_count && !(thread_count = std::thread::hardware_concurrency())) { thread_count = 1; }
+    const std::size_t max_blocks = opts.max_blocks ? opts.max_blocks : 2 * thread_count;
+
+    std::mutex mtx;
+    std::condition_variable cv_work, cv_done;
+    std::deque<std::unique_ptr<block_t>> in_flight;  // must outlive workers
+    std::deque<block_t*> pending;
+    bool stop = false;
+
+    const auto worker_func = [&]() {
+        std::unique_lock<std::mutex> lk(mtx);
+        while (true) {
+            cv_work.wait(lk, [&]() { return stop || !pending.empty(); });
+            if (pending.empty()) { return; }
+            block_t* block = pending.front();
+            pending.pop_front();
+            lk.unlock();
+            try {
+                std::size_t line_no = block->first_line;
+                for (std::size_t pos = 0; pos < block->text.size(); ++line_no) {
+                    std::size_t pos_end = block->text.find('\n', pos);
+                    if (pos_end == std::string_view::npos) { pos_end = block->text.size(); }
+                    const auto line = block->text.substr(pos, pos_end - pos);
+                    if (!is_blank_line(line)) { block->results.emplace_back(line_no, fn_parse(line, line_no)); }
+                    pos = pos_end + 1;
+                }
+            } catch (...) {
+                block->error = std::current_exception();
+            }
+            lk.lock();
+            block->ready = true;
+            cv_done.notify_all();
+        }
+    };
+
+    struct workers_t {
+        std::mutex& mtx;
+        std::condition_variable& cv_work;
+        std::deque<block_t*>& pending;
+        bool& stop;
+        std::vector<std::thread> threads;
+        ~workers_t() {
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                stop = true;
+                pending.clear();
+            }
+            cv_work.notify_all();
+            for (auto& t : threads) { t.join(); }
+        }
+    } workers{mtx, cv_work, pending, stop, {}};
+
+    workers.threads.reserve(thread_count);
+    for (unsigned n = 0; n < thread_count; ++n) { workers.threads.emplace_back(worker_func); }
+
+    std::size_t line_no = 1;
+    bool eof = false;
+    while (true) {
+        while (!eof && in_flight.size() < max_blocks) {
+            auto block = est::make_unique<block_t>();
+            if (!splitter.next(block->storage, block->text)) {
+                eof = true;
+                break;
+            }
+            block->first_line = line_no;
+            line_no += std::count(block->text.begin(), block->text.end(), '\n');
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                pending.push_back(block.get());
+                in_flight.push_back(std::move(block));
+            }
+            cv_work.notify_one();
+        }
+
+        if (in_flight.empty()) { break; }
+
+        std::unique_ptr<block_t> block;
+        {
+            std::unique_lock<std::mutex> lk(mtx);
+            auto it = in_flight.begin();
+            cv_done.wait(lk, [&]() {
+                if (opts.ordered) { return in_flight.front()->ready; }
+                it = std::find_if(in_flight.begin(), in_flight.end(), [](const std::unique_ptr<block_t>& b) {
+                    return b->ready;
+                });
+                return it != in_flight.end();
+            });
+            block = std::move(*it);
+            in_flight.erase(it);
+        }
+
+        if (block->error) { std::rethrow_exception(block->error); }
+        for (auto& result : block->results) { fn_consume(std::move(result.second), result.first); }
+    }
+}
+
+}  // namespace detail
+
+// Parses newline-delimited JSON (JSON Lines) on a pool of worker threads: the input is split into
+// line-aligned blocks, which are parsed concurrently with `fn_parse(std::string_view line, std::size_t line_no)`;
+// its results are passed to `fn_consume(result&&, line_no)` on the calling thread in input order or in order of
+// completion; blank lines are skipped; SAX-style processing can be done by calling `json::read()` with custom
+// handlers inside `fn_parse`, which must be safe to call concurrently
+template<typename ParseFunc, typename ConsumeFunc>
+void process_lines(ibuf& in, const ParseFunc& fn_parse, const ConsumeFunc& fn_consume,
+                   const lines_read_opts& opts = lines_read_opts{}) {
+    using result_t = std::decay_t<decltype(fn_parse(std::string_view(), std::size_t()))>;
+    detail::line_splitter splitter(in, opts.block_size);
+    detail::process_lines<result_t>(splitter, fn_parse, fn_consume, opts);
+}
+
+template<typename ParseFunc, typename ConsumeFunc>
+void process_lines(est::span<const char> text, const ParseFunc& fn_parse, const ConsumeFunc& fn_consume,
+                   const lines_read_opts& opts = lines_read_opts{}) {
+    using result_t = std::decay_t<decltype(fn_parse(std::string_view(), std::size_t()))>;
+    detail::line_splitter splitter(text, opts.block_size);
+    detail::process_lines<result_t>(splitter, fn_parse, fn_consume, opts);
+}
+
+namespace detail {
+// Reads the value of the line: only whitespaces may follow the value
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> read_line(std::string_view line, std::size_t line_no, const Alloc& al) {
+    try {
+        iflatbuf in(line);
+        lexer lexer(in);
+        basic_value<CharT, Alloc> v = read_value<CharT>(lexer, al);
+        std::string_view lval;
+        if (lexer.lex(lval) != token_t::eof) {
+            throw database_error(to_string(lexer.ln) + ": unexpected character after the value");
+        }
+        return v;
+    } catch (const database_error& e) {
+        // replace line number in the message
+        const char* msg = std::strchr(e.what(), ':');
+        throw database_error(to_string(line_no) + (msg ? msg : std::string(": ") + e.what()));
+    }
+}
+}  // namespace detail
+
+// Reads newline-delimited JSON documents in parallel and passes them to `fn_value(basic_value&&, line_no)`
+template<typename CharT = char, typename Alloc = std::allocator<CharT>, typename ValueFunc>
+void read_lines(ibuf& in, const ValueFunc& fn_value, const lines_read_opts& opts = lines_read_opts{},
+                const Alloc& al = Alloc()) {
+    process_lines(
+        in, [&al](std::string_view line, std::size_t line_no) { return detail::read_line<CharT>(line, line_no, al); },
+        fn_value, opts);
+}
+
+template<typename CharT = char, typename Alloc = std::allocator<CharT>, typename ValueFunc>
+void read_lines(est::span<const char> text, const ValueFunc& fn_value, const lines_read_opts& opts = lines_read_opts{},
+                const Alloc& al = Alloc()) {
+    process_lines(
+        text, [&al](std::string_view line, std::size_t line_no) { return detail::read_line<CharT>(line, line_no, al); },
+        fn_value, opts);
+}
+
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "json.h"
+#include "value.h"
+
+#include <vector>
+
+namespace uxs {
+namespace db {
+namespace json {
+
+// Compiled path expression: `$` followed by steps `.name`, `['name']`, `[index]`, `.*`, `[*]` and filters
+// `[?(@.name op literal)]` or `[?(@.name)]`, where `op` is one of `==`, `!=`, `<`, `<=`, `>`, `>=`, and `literal`
+// is a number, a quoted string, `true`, `false` or `null`; filter and wildcard steps select items of arrays and
+// values of records; a key step selects only the first of duplicate keys, as `basic_value::find()` does;
+// recursive descent `..`, slices and negative indices are not supported
+template<typename CharT>
+class basic_path {
+ public:
+    using char_type = CharT;
+    using string_type = std::basic_string<char_type>;
+    using string_view_type = std::basic_string_view<char_type>;
+
+    enum class step_type : std::uint8_t { key = 0, index, wildcard, filter };
+    enum class compare_op : std::uint8_t { exists = 0, eq, ne, lt, le, gt, ge };
+
+    struct step_t {
+        step_type type;
+        string_type key;
+        std::size_t index;  // item index for `index` steps, filter index for `filter` steps
+    };
+
+    struct filter_t {
+        std::vector<step_t> operand_path;  // `key` and `index` steps relative to `@`
+        compare_op op;
+        basic_value<char_type> operand;
+    };
+
+    basic_path() = default;
+    explicit basic_path(string_view_type text) { compile(text); }
+
+    UXS_EXPORT void compile(string_view_type text);
+
+    const std::vector<step_t>& steps() const noexcept { return steps_; }
+    const std::vector<filter_t>& filters() const noexcept { return filters_; }
+
+    // Calls `func(const basic_value&)` for each matching value in document order
+    template<typename Alloc, typename Func>
+    void for_each_match(const basic_value<char_type, Alloc>& v, const Func& func) const {
+        for_each_match(v, 0, func);
+    }
+
+    // The same, but the steps are applied beginning with `first_step`
+    template<typename Alloc, typename Func>
+    void for_each_match(const basic_value<char_type, Alloc>& v, std::size_t first_step, const Func& func) const;
+
+    template<typename Alloc>
+    std::vector<const basic_value<char_type, Alloc>*> select(const basic_value<char_type, Alloc>& v) const {
+        std::vector<const basic_value<char_type, Alloc>*> result;
+        for_each_match(v, [&result](const basic_value<char_type, Alloc>& match) { result.push_back(&match); });
+        return result;
+    }
+
+    // Tests an item against the filter of a `filter` step
+    template<typename Alloc>
+    bool test_filter(const step_t& step, const basic_value<char_type, Alloc>& item) const;
+
+ private:
+    std::vector<step_t> steps_;
+    std::vector<filter_t> filters_;
+};
+
+using path = basic_path<char>;
+using wpath = basic_path<wchar_t>;
+
+namespace detail {
+
+// Compares scalars: returns -1, 0 or 1, or 2 if the values are of incomparable types
+template<typename CharT, typename Alloc1, typename Alloc2>
+int compare_scalars(const basic_value<CharT, Alloc1>& lhs, const basic_value<CharT, Alloc2>& rhs) {
+    const auto compare = [](bool less, bool greater) { return less ? -1 : (greater ? 1 : 0); };
+    if (lhs.is_numeric() && rhs.is_numeric()) {
+        if (lhs.type() != dtype::double_precision && rhs.type() != dtype::double_precision &&
+            lhs.type() != dtype::unsigned_long_integer && rhs.type() != dtype::unsigned_long_integer) {
+            return compare(lhs.as_int64() < rhs.as_int64(), rhs.as_int64() < lhs.as_int64());
+        }
+        return compare(lhs.as_double() < rhs.as_double(), rhs.as_double() < lhs.as_double());
+    }
+    if (lhs.is_string() && rhs.is_string()) {
+        return compare(lhs.as_string_view() < rhs.as_string_view(), rhs.as_string_view() < lhs.as_string_view());
+    }
+    if (lhs.is_bool() && rhs.is_bool()) { return lhs.as_bool() == rhs.as_bool() ? 0 : 2; }
+    if (lhs.is_null() && rhs.is_null()) { return 0; }
+    return 2;
+}
+
+}  // namespace detail
+
+template<typename CharT>
+template<typename Alloc, typename Func>
+void basic_path<CharT>::for_each_match(const basic_value<char_type, Alloc>& v, std::size_t first_step,
+                                       const Func& func) const {
+    if (first_step == steps_.size()) {
+        func(v);
+        return;
+    }
+    const step_t& step = steps_[first_step];
+    switch (step.type) {
+        case step_type::key: {
+            if (!v.is_record()) { return; }
+            const auto it = v.find(step.key);
+            if (it != v.end()) { for_each_match(it.value(), first_step + 1, func); }
+        } break;
+        case step_type::index: {
+            if (!v.is_array()) { return; }
+            const auto items = v.as_array();
+            if (step.index < items.size()) { for_each_match(items[step.index], first_step + 1, func); }
+        } break;
+        case step_type::wildcard:
+        case step_type::filter: {
+            if (v.is_array()) {
+                for (const auto& item : v.as_array()) {
+                    if (step.type == step_type::filter && !test_filter(step, item)) { continue; }
+                    for_each_match(item, first_step + 1, func);
+                }
+            } else if (v.is_record()) {
+                for (const auto& item : v.as_record()) {
+                    if (step.type == step_type::filter && !test_filter(step, item.value())) { continue; }
+                    for_each_match(item.value(), first_step + 1, func);
+                }
+            }
+        } break;
+    }
+}
+
+template<typename CharT>
+template<typename Alloc>
+bool basic_path<CharT>::test_filter(const step_t& step, const basic_value<char_type, Alloc>& item) const {
+    const filter_t& filter = filters_[step.index];
+    const basic_value<char_type, Alloc>* v = &item;
+    for (const step_t& operand_step : filter.operand_path) {
+        if (operand_step.type == step_type::key) {
+            const auto it = v->find(operand_step.key);
+            if (it == v->end()) { return filter.op == compare_op::ne; }
+            v = &it.value();
+        } else {
+            if (!v->is_array() || operand_step.index >= v->size()) { return filter.op == compare_op::ne; }
+            v = &v->as_array()[operand_step.index];
+        }
+    }
+    if (filter.op == compare_op::exists) { return true; }
+    const int result = v->is_array() || v->is_record() ? 2 : detail::compare_scalars(*v, filter.operand);
+    switch (filter.op) {
+        case compare_op::eq: return result == 0;
+        case compare_op::ne: return result != 0;
+        case compare_op::lt: return result == -1;
+        case compare_op::le: return result == -1 || result == 0;
+        case compare_op::gt: return result == 1;
+        case compare_op::ge: return result == 1 || result == 0;
+        default: return false;
+    }
+}
+
+// Reads a value and passes the values matching `path` to `fn_match(basic_value&&)` in document order: subtrees,
+// which can't match, are skipped with `parse_step::over` and never converted; the path is followed in the stream
+// up to the first filter, then each candidate item is materialized, tested and the rest of the path is applied
+// to it in memory
+template<typename CharT = char, typename Alloc = std::allocator<CharT>, typename MatchFunc>
+void select(ibuf& in, const basic_path<CharT>& path, const MatchFunc& fn_match, const Alloc& al = Alloc()) {
+    using path_t = basic_path<CharT>;
+    using value_t = basic_value<CharT, Alloc>;
+
+    const auto& steps = path.steps();
+    std::size_t filter_pos = 0;
+    while (filter_pos < steps.size() && steps[filter_pos].type != path_t::step_type::filter) { ++filter_pos; }
+    const std::size_t build_depth = filter_pos < steps.size() ? filter_pos + 1 : steps.size();
+
+    const auto deliver = [&path, &steps, &fn_match, filter_pos, build_depth](value_t&& v) {
+        if (filter_pos < steps.size() && !path.test_filter(steps[filter_pos], v)) { return; }
+        if (build_depth == steps.size()) {
+            fn_match(std::move(v));
+            return;
+        }
+        path.for_each_match(v, build_depth, [&fn_match](const value_t& match) { fn_match(value_t(match)); });
+    };
+
+    std::size_t depth = 0;                              // count of open containers on the path
+    inline_basic_dynbuffer<std::size_t, 32> counters;  // item counters of open containers on the path
+    bool is_match = true;                               // the next value is selected by the next step
+    value_t result(al);
+    inline_basic_dynbuffer<value_t*, 32> stack;  // open containers of the value being materialized
+    value_t* val = nullptr;
+
+    read(
+        in,
+        [&](token_t tt, std::string_view lval) {
+            if (!stack.empty()) {
+                if (tt >= token_t::null_value) {
+                    *val = detail::token_to_value<CharT>(tt, lval, al);
+                } else {
+                    *val = tt == token_t::array ? make_array<CharT>(al) : make_record<CharT>(al);
+                    stack.push_back(val);
+                }
+                return parse_step::into;
+            }
+            if (!is_match) { return parse_step::over; }
+            if (depth == build_depth) {
+                if (tt >= token_t::null_value) {
+                    deliver(detail::token_to_value<CharT>(tt, lval, al));
+                    return parse_step::over;
+                }
+                result = tt == token_t::array ? make_array<CharT>(al) : make_record<CharT>(al);
+                stack.push_back(&result);
+                return parse_step::into;
+            }
+            if (tt >= token_t::null_value) { return parse_step::over; }
+            ++depth;
+            counters.push_back(0);
+            return parse_step::into;
+        },
+        [&]() {
+            if (!stack.empty()) {
+                val = &stack.back()->emplace_back(al);
+                return;
+            }
+            const auto& step = steps[depth - 1];
+            const std::size_t index = counters.back()++;
+            is_match = step.type == path_t::step_type::index ? step.index == index :
+                                                               step.type != path_t::step_type::key;
+        },
+        [&](std::string_view lval) {
+            if (!stack.empty()) {
+                val = &stack.back()->emplace(utf_string_adapter<CharT>{}(lval), al).value();
+                return;
+            }
+            const auto& step = steps[depth - 1];
+            if (step.type != path_t::step_type::key) {
+                is_match = step.type != path_t::step_type::index;
+                return;
+            }
+            // only the first of duplicate keys is followed, as `find()` does in memory
+            is_match = counters.back() == 0 &&
+                       std::basic_string_view<CharT>(step.key) == utf_string_adapter<CharT>{}(lval);
+            if (is_match) { counters.back() = 1; }
+        },
+        [&]() {
+            if (!stack.empty()) {
+                stack.pop_back();
+                if (stack.empty()) { deliver(std::move(result)); }
+                return;
+            }
+            --depth;
+            counters.pop_back();
+        });
+
+    // the top-level container is not popped
+    if (!stack.empty()) { deliver(std::move(result)); }
+}
+
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "uxs/string_view.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace uxs {
+namespace db {
+
+// Table of interned record keys: each distinct key is stored once together with its hash code; a pool is meant to be
+// created for a document or a set of documents with the same keys: it must outlive all values using it, and keys are
+// freed only with the pool; the pool isn't thread-safe, so values using it must not be modified by several threads at
+// once, as values with their own keys
+template<typename CharT>
+class basic_key_pool {
+ public:
+    using char_type = CharT;
+    using key_type = std::basic_string_view<char_type>;
+    using hasher_t = std::hash<key_type>;
+
+    class entry {
+     public:
+        key_type key() const noexcept { return key_type(chars_, size_); }
+        std::size_t hash_code() const noexcept { return hash_code_; }
+
+     private:
+        friend class basic_key_pool;
+        std::size_t hash_code_;
+        std::size_t size_;
+        char_type chars_[16];
+
+        static std::size_t get_alloc_sz(std::size_t sz) noexcept {
+            return (offsetof(entry, chars_) + sz * sizeof(char_type) + sizeof(entry) - 1) / sizeof(entry);
+        }
+    };
+
+    basic_key_pool() = default;
+    ~basic_key_pool() {
+        for (entry* e : tbl_) {
+            if (e) { entry_al_.deallocate(e, entry::get_alloc_sz(e->size_)); }
+        }
+    }
+    basic_key_pool(const basic_key_pool&) = delete;
+    basic_key_pool& operator=(const basic_key_pool&) = delete;
+
+    std::size_t size() const noexcept { return size_; }
+
+    // Returned entries are never relocated, so they can be kept to look keys up in records without hashing, see
+    // `basic_value::find(const entry&)`
+    const entry* find(key_type key) const noexcept { return find(key, hasher_t{}(key)); }
+
+    const entry* find(key_type key, std::size_t hash_code) const noexcept {
+        if (tbl_.empty()) { return nullptr; }
+        const std::size_t mask = tbl_.size() - 1;
+        for (std::size_t pos = hash_code & mask;; pos = (pos + 1) & mask) {
+            const entry* e = tbl_[pos];
+            if (!e || (e->hash_code_ == hash_code && e->key() == key)) { return e; }
+        }
+    }
+
+    const entry* intern(key_type key) { return intern(key, hasher_t{}(key)); }
+
+    const entry* intern(key_type key, std::size_t hash_code) {
+        if (2 * (size_ + 1) > tbl_.size()) { rehash(); }
+        const std::size_t mask = tbl_.size() - 1;
+        std::size_t pos = hash_code & mask;
+        for (; tbl_[pos]; pos = (pos + 1) & mask) {
+            const entry* e = tbl_[pos];
+            if (e->hash_code_ == hash_code && e->key() == key) { return e; }
+        }
+        entry* e = entry_al_.allocate(entry::get_alloc_sz(key.size()));
+        e->hash_code_ = hash_code;
+        e->size_ = key.size();
+        std::copy_n(key.data(), key.size(), e->chars_);
+        tbl_[pos] = e;
+        ++size_;
+        return e;
+    }
+
+ private:
+    std::allocator<entry> entry_al_;
+    std::vector<entry*> tbl_;
+    std::size_t size_ = 0;
+
+    void rehash() {
+        std::vector<entry*> tbl(tbl_.empty() ? 64 : 2 * tbl_.size());
+        const std::size_t mask = tbl.size() - 1;
+        for (entry* e : tbl_) {
+            if (!e) { continue; }
+            std::size_t pos = e->hash_code_ & mask;
+            while (tbl[pos]) { pos = (pos + 1) & mask; }
+            tbl[pos] = e;
+        }
+        tbl_.swap(tbl);
+    }
+};
+
+using key_pool = basic_key_pool<char>;
+using wkey_pool = basic_key_pool<wchar_t>;
+
+// Allocator which makes records store pointers to keys interned in the pool instead of key characters:
+// such keys are hashed once per pool, and lookups compare pointers; a record keeps using the pool it
+// was created with, so copies and shared data stay valid across allocators; there is no default pool, so the
+// allocator is always constructed with the pool of the document
+template<typename Ty, typename CharT = Ty>
+class key_pool_allocator : public std::allocator<Ty> {
+ public:
+    using value_type = Ty;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template<typename Ty2>
+    struct rebind {
+        using other = key_pool_allocator<Ty2, CharT>;
+    };
+
+    explicit key_pool_allocator(basic_key_pool<CharT>& pool) noexcept : pool_(&pool) {}
+    template<typename Ty2>
+    key_pool_allocator(const key_pool_allocator<Ty2, CharT>& other) noexcept : pool_(other.key_pool()) {}
+
+    basic_key_pool<CharT>* key_pool() const noexcept { return pool_; }
+
+    friend bool operator==(const key_pool_allocator& lhs, const key_pool_allocator& rhs) noexcept {
+        return lhs.pool_ == rhs.pool_;
+    }
+    friend bool operator!=(const key_pool_allocator& lhs, const key_pool_allocator& rhs) noexcept {
+        return lhs.pool_ != rhs.pool_;
+    }
+
+ private:
+    basic_key_pool<CharT>* pool_;
+};
+
+namespace detail {
+template<typename CharT, typename Alloc, typename = void>
+struct has_key_pool : std::false_type {};
+template<typename CharT, typename Alloc>
+struct has_key_pool<CharT, Alloc,
+                    std::enable_if_t<std::is_same<decltype(std::declval<const Alloc&>().key_pool()),
+                                                  basic_key_pool<CharT>*>::value>> : std::true_type {};
+}  // namespace detail
+
+}  // namespace db
+}  // namespace uxs
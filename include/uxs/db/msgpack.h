@@ -0,0 +1,133 @@
+#pragma once
+
+#include "binary_item.h"
+
+#include <cmath>
+
+namespace uxs {
+namespace db {
+namespace msgpack {
+
+namespace detail {
+struct decoder : db::detail::binary_decoder_base {
+    explicit decoder(ibuf& in) : binary_decoder_base(in) {}
+    UXS_EXPORT bool next(binary_item& item);
+    UXS_EXPORT void skip(const binary_item& item);
+
+ private:
+    bool decode(binary_item& item, bool skip_strings);
+};
+}  // namespace detail
+
+// Reads *MessagePack* object: handlers are the same as of SAX `json::read()`, but `fn_value` receives decoded
+// `binary_item`; integer formats map to value types one-to-one: `uint 32` to `uint32`, `int 64` to `int64`, `uint 64`
+// to `uint64`, and all shorter formats and `int 32` to `int32`; `float 32` and `float 64` are read as `double`, binary
+// data is read as strings, extension types are not supported, record keys must be strings
+template<typename ValueFunc, typename ArrItemFunc, typename ObjItemFunc, typename PopFunc>
+void read(ibuf& in, const ValueFunc& fn_value, const ArrItemFunc& fn_arr_item, const ObjItemFunc& fn_obj_item,
+          const PopFunc& fn_pop) {
+    detail::decoder decoder(in);
+    db::detail::read_binary(decoder, fn_value, fn_arr_item, fn_obj_item, fn_pop);
+}
+
+template<typename CharT = char, typename Alloc = std::allocator<CharT>>
+UXS_EXPORT basic_value<CharT, Alloc> read(ibuf& in, const Alloc& al = Alloc());
+
+namespace detail {
+struct writer {
+    membuffer& out;
+
+    void head(char format, std::uint64_t v, unsigned n) {
+        out += format;
+        db::detail::write_big_endian(out, v, n);
+    }
+
+    void container(char fix_format, char format16, std::size_t size) {
+        if (size < 16) {
+            out += static_cast<char>(fix_format | size);
+        } else if (size <= 0xffff) {
+            head(format16, size, 2);
+        } else if (size <= 0xffffffff) {
+            head(static_cast<char>(format16 + 1), size, 4);
+        } else {
+            throw database_error("too big container");
+        }
+    }
+
+    void null() { out += '\xc0'; }
+    void boolean(bool b) { out += b ? '\xc3' : '\xc2'; }
+    void integer(std::int32_t i) {
+        if (i >= -32 && i < 128) {
+            out += static_cast<char>(i);
+        } else if (i >= 0) {
+            if (i <= 0xff) {
+                head('\xcc', static_cast<std::uint64_t>(i), 1);
+            } else if (i <= 0xffff) {
+                head('\xcd', static_cast<std::uint64_t>(i), 2);
+            } else {
+                head('\xd2', static_cast<std::uint64_t>(i), 4);
+            }
+        } else if (i >= -0x80) {
+            head('\xd0', static_cast<std::uint8_t>(i), 1);
+        } else if (i >= -0x8000) {
+            head('\xd1', static_cast<std::uint16_t>(i), 2);
+        } else {
+            head('\xd2', static_cast<std::uint32_t>(i), 4);
+        }
+    }
+    void unsigned_integer(std::uint32_t u) { head('\xce', u, 4); }
+    void long_integer(std::int64_t i) { head('\xd3', static_cast<std::uint64_t>(i), 8); }
+    void unsigned_long_integer(std::uint64_t u) { head('\xcf', u, 8); }
+    void double_precision(double d) {
+        // the shortest of single and double precision, which holds the value exactly
+        if (std::fabs(d) <= std::numeric_limits<float>::max() && static_cast<float>(d) == d) {
+            const float f = static_cast<float>(d);
+            std::uint32_t bits = 0;
+            std::memcpy(&bits, &f, sizeof(bits));
+            head('\xca', bits, 4);
+            return;
+        }
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &d, sizeof(bits));
+        head('\xcb', bits, 8);
+    }
+    void string(std::string_view s) {
+        if (s.size() < 32) {
+            out += static_cast<char>(0xa0 | s.size());
+        } else if (s.size() <= 0xff) {
+            head('\xd9', s.size(), 1);
+        } else if (s.size() <= 0xffff) {
+            head('\xda', s.size(), 2);
+        } else if (s.size() <= 0xffffffff) {
+            head('\xdb', s.size(), 4);
+        } else {
+            throw database_error("too long string");
+        }
+        out += s;
+    }
+    void begin_array(std::size_t size) { container('\x90', '\xdc', size); }
+    void begin_record(std::size_t size) { container('\x80', '\xde', size); }
+
+    template<typename ValueCharT, typename Alloc>
+    UXS_EXPORT void do_write(const basic_value<ValueCharT, Alloc>& v);
+};
+}  // namespace detail
+
+// Writes the value as *MessagePack* object: integer values are written in the formats, which are read back as the
+// same value types, other values use the shortest formats
+template<typename ValueCharT, typename Alloc>
+void write(membuffer& out, const basic_value<ValueCharT, Alloc>& v) {
+    detail::writer writer{out};
+    writer.do_write(v);
+}
+
+template<typename ValueCharT, typename Alloc>
+void write(iobuf& out, const basic_value<ValueCharT, Alloc>& v) {
+    iomembuffer buf(out);
+    detail::writer writer{buf};
+    writer.do_write(v);
+}
+
+}  // namespace msgpack
+}  // namespace db
+}  // namespace uxs
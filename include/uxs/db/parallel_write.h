@@ -0,0 +1,301 @@
+#pragma once
+
+#include "json.h"
+#include "value.h"
+
+#include "uxs/memory.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace uxs {
+namespace db {
+
+struct parallel_write_opts {
+    unsigned thread_count = 0;     // 0 - `std::thread::hardware_concurrency()`
+    std::size_t chunk_size = 1024;  // items of a bigger array or record, which are formatted by one task
+    unsigned max_chunks = 0;        // max formatted chunks not yet written, 0 - four times the thread count
+};
+
+namespace detail {
+
+// Formats a value on a pool of worker threads: arrays and records with more than `chunk_size` items are split
+// into ranges of items, each range is formatted into its own buffer, and the buffers are passed to
+// `fmt.output()` on the calling thread in document order; containers of split containers, separators and keys
+// between the ranges are formatted on the calling thread beforehand; `Formatter` provides:
+//   buffer_type, make_buffer(), output(buffer),
+//   begin_container(buf, v, indent), end_container(buf, v, indent), child_indent(v, indent),
+//   separator(buf, v, indent), key(buf, key), value(buf, v, indent)
+// `root_indent` is the indentation of the value itself
+template<typename CharT, typename Alloc, typename Formatter>
+void write_parallel(const basic_value<CharT, Alloc>& v, Formatter& fmt, const parallel_write_opts& opts,
+                    unsigned root_indent = 0) {
+    using value_t = basic_value<CharT, Alloc>;
+    using record_iterator = typename value_t::const_record_iterator;
+    using buffer_t = typename Formatter::buffer_type;
+
+    const std::size_t chunk_size = std::max<std::size_t>(opts.chunk_size, 1);
+    const auto is_split = [chunk_size](const value_t& v) {
+        return (v.is_array() || v.is_record()) && v.size() > chunk_size;
+    };
+
+    // task is either a formatted literal or a range of items, which is formatted by a worker
+    struct task_t {
+        const value_t* container = nullptr;
+        std::size_t first = 0;
+        record_iterator rec_first;
+        std::size_t count = 0;
+        bool is_first = false;
+        unsigned indent = 0;
+        std::unique_ptr<buffer_t> buf;
+        std::exception_ptr error;
+        bool ready = false;
+    };
+
+    struct level_t {
+        const value_t* container;
+        std::size_t pos;
+        record_iterator rec_pos;
+        unsigned indent;
+        bool is_first;
+    };
+
+    std::vector<task_t> tasks;
+    const auto literal = [&tasks, &fmt]() -> buffer_t& {
+        if (tasks.empty() || tasks.back().container) {
+            tasks.emplace_back();
+            tasks.back().buf = fmt.make_buffer();
+            tasks.back().ready = true;
+        }
+        return *tasks.back().buf;
+    };
+
+    inline_basic_dynbuffer<level_t, 32> stack;
+    const auto push_container = [&stack, &fmt, &literal](const value_t& v, unsigned indent) {
+        fmt.begin_container(literal(), v, indent);
+        stack.push_back(level_t{&v, 0, v.is_record() ? v.as_record().begin() : record_iterator(), indent, true});
+    };
+
+    if (!is_split(v)) {
+        fmt.value(literal(), v, root_indent);
+    } else {
+        push_container(v, root_indent);
+    }
+
+    while (!stack.empty()) {
+        level_t& top = stack.back();
+        const value_t& container = *top.container;
+        const bool is_record = container.is_record();
+        const unsigned indent = fmt.child_indent(container, top.indent);
+        const auto item_at = [&top, is_record]() -> const value_t& {
+            return is_record ? top.rec_pos->value() : top.container->as_array()[top.pos];
+        };
+
+        // collect a range of items, which are not split
+        task_t range;
+        range.container = &container, range.first = top.pos, range.rec_first = top.rec_pos;
+        range.is_first = top.is_first, range.indent = indent;
+        while (top.pos < container.size() && range.count < chunk_size && !is_split(item_at())) {
+            ++top.pos, ++range.count;
+            if (is_record) { ++top.rec_pos; }
+            top.is_first = false;
+        }
+        if (range.count) { tasks.emplace_back(std::move(range)); }
+
+        if (top.pos == container.size()) {
+            fmt.end_container(literal(), container, top.indent);
+            stack.pop_back();
+        } else if (is_split(item_at())) {
+            // split nested container is formatted in place
+            const value_t& item = item_at();
+            if (!top.is_first) { fmt.separator(literal(), container, indent); }
+            if (is_record) { fmt.key(literal(), top.rec_pos->key()); }
+            ++top.pos;
+            if (is_record) { ++top.rec_pos; }
+            top.is_first = false;
+            push_container(item, indent);
+        }
+    }
+
+    unsigned thread_count = opts.thread_count;
+    if (!thread_count && !(thread_count = std::thread::hardware_concurrency())) { thread_count = 1; }
+    const std::size_t max_chunks = opts.max_chunks ? opts.max_chunks : 4 * thread_count;
+
+    std::mutex mtx;
+    std::condition_variable cv_work, cv_done;
+    std::size_t next_task = 0, n_written = 0;
+    bool stop = false;
+
+    const auto worker_func = [&]() {
+        std::unique_lock<std::mutex> lk(mtx);
+        while (true) {
+            cv_work.wait(lk, [&]() {
+                while (next_task < tasks.size() && tasks[next_task].ready) { ++next_task; }
+                return stop || next_task == tasks.size() || next_task < n_written + max_chunks;
+            });
+            if (stop || next_task == tasks.size()) { return; }
+            task_t& task = tasks[next_task++];
+            lk.unlock();
+            try {
+                task.buf = fmt.make_buffer();
+                const value_t& container = *task.container;
+                const bool is_record = container.is_record();
+                const value_t* item = is_record ? nullptr : container.as_array().data() + task.first;
+                record_iterator rec_it = task.rec_first;
+                for (std::size_t n = 0; n < task.count; ++n) {
+                    if (n || !task.is_first) { fmt.separator(*task.buf, container, task.indent); }
+                    if (is_record) {
+                        fmt.key(*task.buf, rec_it->key());
+                        fmt.value(*task.buf, rec_it->value(), task.indent);
+                        ++rec_it;
+                    } else {
+                        fmt.value(*task.buf, *item++, task.indent);
+                    }
+                }
+            } catch (...) {
+                task.error = std::current_exception();
+            }
+            lk.lock();
+            task.ready = true;
+            cv_done.notify_all();
+        }
+    };
+
+    struct workers_t {
+        std::mutex& mtx;
+        std::condition_variable& cv_work;
+        bool& stop;
+        std::vector<std::thread> threads;
+        ~workers_t() {
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                stop = true;
+            }
+            cv_work.notify_all();
+            for (auto& t : threads) { t.join(); }
+        }
+    } workers{mtx, cv_work, stop, {}};
+
+    const std::size_t range_count = static_cast<std::size_t>(
+        std::count_if(tasks.begin(), tasks.end(), [](const task_t& task) { return task.container != nullptr; }));
+    thread_count = static_cast<unsigned>(std::min<std::size_t>(thread_count, range_count));
+    workers.threads.reserve(thread_count);
+    for (unsigned n = 0; n < thread_count; ++n) { workers.threads.emplace_back(worker_func); }
+
+    for (task_t& task : tasks) {
+        {
+            std::unique_lock<std::mutex> lk(mtx);
+            cv_done.wait(lk, [&task]() { return task.ready; });
+        }
+        if (task.error) { std::rethrow_exception(task.error); }
+        fmt.output(*task.buf);
+        task.buf.reset();
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            ++n_written;
+        }
+        cv_work.notify_all();
+    }
+}
+
+// Formatter of `write_parallel()` producing the same text as `json::write()`
+template<typename CharT, typename OutputFunc>
+struct json_chunk_formatter {
+    using buffer_type = basic_dynbuffer<CharT, std::allocator<CharT>>;
+
+    OutputFunc output;
+    unsigned indent_size;
+    char object_ws_char;
+    char array_ws_char;
+    char indent_char;
+
+    std::unique_ptr<buffer_type> make_buffer() const { return est::make_unique<buffer_type>(); }
+
+    template<typename ValueCharT, typename Alloc>
+    char ws_char(const basic_value<ValueCharT, Alloc>& v) const {
+        return v.is_record() ? object_ws_char : array_ws_char;
+    }
+
+    template<typename ValueCharT, typename Alloc>
+    unsigned child_indent(const basic_value<ValueCharT, Alloc>& v, unsigned indent) const {
+        return ws_char(v) == '\n' ? indent + indent_size : indent;
+    }
+
+    template<typename ValueCharT, typename Alloc>
+    void begin_container(buffer_type& buf, const basic_value<ValueCharT, Alloc>& v, unsigned indent) const {
+        buf += v.is_record() ? '{' : '[';
+        if (ws_char(v) == '\n') {
+            buf += '\n';
+            buf.append(indent + indent_size, indent_char);
+        }
+    }
+
+    template<typename ValueCharT, typename Alloc>
+    void end_container(buffer_type& buf, const basic_value<ValueCharT, Alloc>& v, unsigned indent) const {
+        if (ws_char(v) == '\n') {
+            buf += '\n';
+            buf.append(indent, indent_char);
+        }
+        buf += v.is_record() ? '}' : ']';
+    }
+
+    template<typename ValueCharT, typename Alloc>
+    void separator(buffer_type& buf, const basic_value<ValueCharT, Alloc>& v, unsigned indent) const {
+        const char ws = ws_char(v);
+        buf += ',';
+        buf += ws;
+        if (ws == '\n') { buf.append(indent, indent_char); }
+    }
+
+    template<typename KeyCharT>
+    void key(buffer_type& buf, std::basic_string_view<KeyCharT> k) const {
+        json::detail::writer<CharT>{buf, indent_size, object_ws_char, array_ws_char, indent_char}.write_key(k);
+    }
+
+    template<typename ValueCharT, typename Alloc>
+    void value(buffer_type& buf, const basic_value<ValueCharT, Alloc>& v, unsigned indent) const {
+        json::detail::writer<CharT>{buf, indent_size, object_ws_char, array_ws_char, indent_char}.do_write(v, indent);
+    }
+};
+
+template<typename CharT, typename OutputFunc>
+json_chunk_formatter<CharT, OutputFunc> make_json_chunk_formatter(OutputFunc output, unsigned indent_size,
+                                                                 char object_ws_char, char array_ws_char,
+                                                                 char indent_char) {
+    return {std::move(output), indent_size, object_ws_char, array_ws_char, indent_char};
+}
+
+}  // namespace detail
+
+namespace json {
+
+// Writes the same text as `write()` with the same arguments, but formats bigger arrays and records on a pool of
+// worker threads
+template<typename CharT, typename ValueCharT, typename Alloc>
+void write_parallel(basic_membuffer<CharT>& out, const basic_value<ValueCharT, Alloc>& v,
+                    const parallel_write_opts& opts = parallel_write_opts{}, unsigned indent_size = 0,
+                    char object_ws_char = ' ', char array_ws_char = ' ', char indent_char = ' ', unsigned indent = 0) {
+    auto fmt = db::detail::make_json_chunk_formatter<CharT>(
+        [&out](const basic_membuffer<CharT>& buf) { out.append(buf.data(), buf.size()); }, indent_size,
+        object_ws_char, array_ws_char, indent_char);
+    db::detail::write_parallel(v, fmt, opts, indent);
+}
+
+template<typename CharT, typename ValueCharT, typename Alloc>
+void write_parallel(basic_iobuf<CharT>& out, const basic_value<ValueCharT, Alloc>& v,
+                    const parallel_write_opts& opts = parallel_write_opts{}, unsigned indent_size = 0,
+                    char object_ws_char = ' ', char array_ws_char = ' ', char indent_char = ' ', unsigned indent = 0) {
+    auto fmt = db::detail::make_json_chunk_formatter<CharT>(
+        [&out](const basic_membuffer<CharT>& buf) { out.write(est::as_span(buf.data(), buf.size())); }, indent_size,
+        object_ws_char, array_ws_char, indent_char);
+    db::detail::write_parallel(v, fmt, opts, indent);
+}
+
+}  // namespace json
+
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,914 @@
+#pragma once
+
+#include "value.h"
+
+#include "uxs/memory.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace uxs {
+namespace db {
+
+namespace detail {
+inline unsigned popcount32(std::uint32_t x) noexcept {
+#if defined(__GNUC__)
+    return __builtin_popcount(x);
+#else   // defined(__GNUC__)
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    return (((x + (x >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+#endif  // defined(__GNUC__)
+}
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+// Persistent vector: a 32-way trie of leaves with a separate tail leaf; copying is O(1), and a modification
+// copies only shared nodes on the path to the item, so updating an item of a shared vector costs O(log n)
+
+template<typename Ty, typename Alloc = std::allocator<Ty>>
+class persistent_vector : protected std::allocator_traits<Alloc>::template rebind_alloc<Ty> {
+ private:
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<Ty>;
+    using ref_counter_t = typename alloc_ref_count_policy<Alloc>::type::template counter_type<std::size_t>;
+
+    enum : unsigned { bits = 5, width = 1 << bits, mask = width - 1 };
+
+    struct leaf_t {
+        ref_counter_t ref_count;
+        std::size_t count;
+        alignas(std::alignment_of<Ty>::value) std::uint8_t x[width * sizeof(Ty)];
+        Ty* items() noexcept { return reinterpret_cast<Ty*>(&x); }
+    };
+
+    // Children are inner nodes or leaves depending on the level
+    struct inner_t {
+        ref_counter_t ref_count;
+        std::size_t count;
+        void* child[width];
+    };
+
+    using leaf_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<leaf_t>;
+    using inner_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<inner_t>;
+
+ public:
+    using value_type = Ty;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const Ty&;
+    using const_reference = const Ty&;
+
+    class const_iterator {
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Ty;
+        using difference_type = std::ptrdiff_t;
+        using reference = const Ty&;
+        using pointer = const Ty*;
+
+        const_iterator() noexcept = default;
+        const_iterator(const persistent_vector* v, size_type i) noexcept
+            : v_(v), i_(i), leaf_(i < v->size_ ? v->leaf_for(i) : nullptr) {}
+
+        reference operator*() const noexcept {
+            assert(leaf_);
+            return leaf_->items()[i_ & mask];
+        }
+        pointer operator->() const noexcept { return std::addressof(**this); }
+
+        const_iterator& operator++() noexcept {
+            if ((++i_ & mask) == 0) { leaf_ = i_ < v_->size_ ? v_->leaf_for(i_) : nullptr; }
+            return *this;
+        }
+        const_iterator operator++(int) noexcept {
+            auto it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return lhs.i_ == rhs.i_;
+        }
+        friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return lhs.i_ != rhs.i_;
+        }
+
+     private:
+        const persistent_vector* v_ = nullptr;
+        size_type i_ = 0;
+        leaf_t* leaf_ = nullptr;
+    };
+
+    using iterator = const_iterator;
+
+    persistent_vector() noexcept(std::is_nothrow_default_constructible<alloc_type>::value) : alloc_type() {}
+    explicit persistent_vector(const Alloc& al) noexcept : alloc_type(al) {}
+    template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
+    persistent_vector(InputIt first, InputIt last, const Alloc& al = Alloc()) : alloc_type(al) {
+        try {
+            for (; first != last; ++first) { emplace_back(*first); }
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+    persistent_vector(std::initializer_list<Ty> init, const Alloc& al = Alloc())
+        : persistent_vector(init.begin(), init.end(), al) {}
+    ~persistent_vector() { clear(); }
+
+    persistent_vector(const persistent_vector& other) noexcept
+        : alloc_type(other), root_(other.root_), tail_(other.tail_), size_(other.size_), shift_(other.shift_) {
+        if (root_) { ++root_->ref_count; }
+        if (tail_) { ++tail_->ref_count; }
+    }
+    persistent_vector& operator=(const persistent_vector& other) noexcept {
+        if (&other == this) { return *this; }
+        persistent_vector tmp(other);
+        swap(tmp);
+        return *this;
+    }
+    persistent_vector(persistent_vector&& other) noexcept
+        : alloc_type(std::move(other)), root_(other.root_), tail_(other.tail_), size_(other.size_),
+          shift_(other.shift_) {
+        other.root_ = nullptr, other.tail_ = nullptr, other.size_ = 0, other.shift_ = bits;
+    }
+    persistent_vector& operator=(persistent_vector&& other) noexcept {
+        if (&other == this) { return *this; }
+        persistent_vector tmp(std::move(other));
+        swap(tmp);
+        return *this;
+    }
+
+    void swap(persistent_vector& other) noexcept {
+        if (&other == this) { return; }
+        std::swap(static_cast<alloc_type&>(*this), static_cast<alloc_type&>(other));
+        std::swap(root_, other.root_);
+        std::swap(tail_, other.tail_);
+        std::swap(size_, other.size_);
+        std::swap(shift_, other.shift_);
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type(*this); }
+
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, size_); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    const Ty& operator[](size_type i) const noexcept {
+        assert(i < size_);
+        return leaf_for(i)->items()[i & mask];
+    }
+    const Ty& at(size_type i) const {
+        if (i >= size_) { throw database_error("index out of range"); }
+        return (*this)[i];
+    }
+    const Ty& front() const noexcept { return (*this)[0]; }
+    const Ty& back() const noexcept { return (*this)[size_ - 1]; }
+
+    template<typename Func>
+    void for_each(const Func& func) const {
+        if (root_) { for_each_impl(root_, shift_, func); }
+        if (tail_) { for_each_leaf(tail_, func); }
+    }
+
+    // Returns a reference to the item, which can be modified until the vector is copied
+    Ty& mutable_at(size_type i) {
+        assert(i < size_);
+        if (i >= tail_offset()) {
+            unique(tail_);
+            return tail_->items()[i & mask];
+        }
+        unique(root_);
+        inner_t* node = root_;
+        for (unsigned level = shift_; level > bits; level -= bits) {
+            inner_t*& child = reinterpret_cast<inner_t*&>(node->child[(i >> level) & mask]);
+            unique(child);
+            node = child;
+        }
+        leaf_t*& leaf = reinterpret_cast<leaf_t*&>(node->child[(i >> bits) & mask]);
+        unique(leaf);
+        return leaf->items()[i & mask];
+    }
+
+    template<typename U>
+    void set(size_type i, U&& v) {
+        mutable_at(i) = std::forward<U>(v);
+    }
+
+    template<typename... Args>
+    Ty& emplace_back(Args&&... args);
+    void push_back(const Ty& v) { emplace_back(v); }
+    void push_back(Ty&& v) { emplace_back(std::move(v)); }
+    void pop_back();
+
+    void clear() noexcept {
+        if (root_) { release(root_, shift_); }
+        if (tail_) { release(tail_); }
+        root_ = nullptr, tail_ = nullptr, size_ = 0, shift_ = bits;
+    }
+
+ private:
+    inner_t* root_ = nullptr;
+    leaf_t* tail_ = nullptr;
+    size_type size_ = 0;
+    unsigned shift_ = bits;
+
+    size_type tail_offset() const noexcept { return size_ ? ((size_ - 1) >> bits) << bits : 0; }
+
+    leaf_t* leaf_for(size_type i) const noexcept {
+        if (i >= tail_offset()) { return tail_; }
+        void* node = root_;
+        for (unsigned level = shift_; level > 0; level -= bits) {
+            node = static_cast<inner_t*>(node)->child[(i >> level) & mask];
+        }
+        return static_cast<leaf_t*>(node);
+    }
+
+    leaf_t* new_leaf() {
+        leaf_alloc_type leaf_al(*this);
+        leaf_t* leaf = leaf_al.allocate(1);
+        new (&leaf->ref_count) ref_counter_t{1};
+        leaf->count = 0;
+        return leaf;
+    }
+
+    inner_t* new_inner() {
+        inner_alloc_type inner_al(*this);
+        inner_t* node = inner_al.allocate(1);
+        new (&node->ref_count) ref_counter_t{1};
+        node->count = 0;
+        return node;
+    }
+
+    void release(leaf_t* leaf) noexcept {
+        if (--leaf->ref_count != 0) { return; }
+        for (Ty *p = leaf->items(), *p_end = p + leaf->count; p != p_end; ++p) { p->~Ty(); }
+        leaf_alloc_type leaf_al(*this);
+        leaf_al.deallocate(leaf, 1);
+    }
+
+    void release(inner_t* node, unsigned level) noexcept {
+        if (--node->ref_count != 0) { return; }
+        for (std::size_t n = 0; n < node->count; ++n) {
+            if (level > bits) {
+                release(static_cast<inner_t*>(node->child[n]), level - bits);
+            } else {
+                release(static_cast<leaf_t*>(node->child[n]));
+            }
+        }
+        inner_alloc_type inner_al(*this);
+        inner_al.deallocate(node, 1);
+    }
+
+    void unique(leaf_t*& leaf) {
+        if (leaf->ref_count == 1) { return; }
+        leaf_t* new_leaf = this->new_leaf();
+        try {
+            for (; new_leaf->count < leaf->count; ++new_leaf->count) {
+                new (new_leaf->items() + new_leaf->count) Ty(leaf->items()[new_leaf->count]);
+            }
+        } catch (...) {
+            release(new_leaf);
+            throw;
+        }
+        --leaf->ref_count;
+        leaf = new_leaf;
+    }
+
+    void unique(inner_t*& node) {
+        if (node->ref_count == 1) { return; }
+        inner_t* new_node = new_inner();
+        new_node->count = node->count;
+        for (std::size_t n = 0; n < node->count; ++n) {
+            new_node->child[n] = node->child[n];
+            // children of inner nodes and leaves start with the reference counter
+            ++static_cast<leaf_t*>(node->child[n])->ref_count;
+        }
+        --node->ref_count;
+        node = new_node;
+    }
+
+    void* new_path(unsigned level, leaf_t* leaf) {
+        if (level == 0) { return leaf; }
+        inner_t* node = new_inner();
+        try {
+            node->child[0] = new_path(level - bits, leaf);
+        } catch (...) {
+            inner_alloc_type inner_al(*this);
+            inner_al.deallocate(node, 1);
+            throw;
+        }
+        node->count = 1;
+        return node;
+    }
+
+    void push_tail(leaf_t* leaf);
+    void push_tail(unsigned level, inner_t* parent, leaf_t* leaf);
+    bool pop_tail(unsigned level, inner_t*& node);
+
+    template<typename Func>
+    static void for_each_leaf(leaf_t* leaf, const Func& func) {
+        for (const Ty *p = leaf->items(), *p_end = p + leaf->count; p != p_end; ++p) { func(*p); }
+    }
+
+    template<typename Func>
+    static void for_each_impl(inner_t* node, unsigned level, const Func& func) {
+        for (std::size_t n = 0; n < node->count; ++n) {
+            if (level > bits) {
+                for_each_impl(static_cast<inner_t*>(node->child[n]), level - bits, func);
+            } else {
+                for_each_leaf(static_cast<leaf_t*>(node->child[n]), func);
+            }
+        }
+    }
+};
+
+template<typename Ty, typename Alloc>
+template<typename... Args>
+Ty& persistent_vector<Ty, Alloc>::emplace_back(Args&&... args) {
+    if (tail_ && tail_->count < width) {
+        unique(tail_);
+        Ty* item = new (tail_->items() + tail_->count) Ty(std::forward<Args>(args)...);
+        ++tail_->count, ++size_;
+        return *item;
+    }
+    leaf_t* leaf = new_leaf();
+    try {
+        new (leaf->items()) Ty(std::forward<Args>(args)...);
+        leaf->count = 1;
+        if (tail_) { push_tail(tail_); }
+    } catch (...) {
+        release(leaf);
+        throw;
+    }
+    tail_ = leaf, ++size_;
+    return *leaf->items();
+}
+
+template<typename Ty, typename Alloc>
+void persistent_vector<Ty, Alloc>::pop_back() {
+    assert(size_);
+    if (size_ == 1) { return clear(); }
+    if (tail_->count > 1) {
+        unique(tail_);
+        (tail_->items() + --tail_->count)->~Ty();
+        --size_;
+        return;
+    }
+    // the previous leaf becomes the tail
+    leaf_t* leaf = leaf_for(size_ - 2);
+    ++leaf->ref_count;
+    try {
+        if (!pop_tail(shift_, root_)) { root_ = nullptr; }
+    } catch (...) {
+        release(leaf);
+        throw;
+    }
+    release(tail_);
+    tail_ = leaf, --size_;
+    if (root_ && shift_ > bits && root_->count == 1) {
+        inner_t* child = static_cast<inner_t*>(root_->child[0]);
+        ++child->ref_count;
+        release(root_, shift_);
+        root_ = child, shift_ -= bits;
+    }
+}
+
+template<typename Ty, typename Alloc>
+void persistent_vector<Ty, Alloc>::push_tail(leaf_t* leaf) {
+    // `size_` items including full `leaf` are in the vector
+    if (!root_) {
+        root_ = new_inner();
+        shift_ = bits;
+    } else if ((size_ >> bits) > (size_type(1) << shift_)) {
+        inner_t* new_root = new_inner();
+        try {
+            new_root->child[1] = new_path(shift_, leaf);
+        } catch (...) {
+            release(new_root, shift_ + bits);
+            throw;
+        }
+        new_root->child[0] = root_;
+        new_root->count = 2;
+        root_ = new_root, shift_ += bits;
+        return;
+    }
+    unique(root_);
+    push_tail(shift_, root_, leaf);
+}
+
+template<typename Ty, typename Alloc>
+void persistent_vector<Ty, Alloc>::push_tail(unsigned level, inner_t* parent, leaf_t* leaf) {
+    const std::size_t n = ((size_ - 1) >> level) & mask;
+    if (level > bits && n < parent->count) {
+        inner_t*& child = reinterpret_cast<inner_t*&>(parent->child[n]);
+        unique(child);
+        return push_tail(level - bits, child, leaf);
+    }
+    parent->child[n] = new_path(level - bits, leaf);
+    ++parent->count;
+}
+
+template<typename Ty, typename Alloc>
+bool persistent_vector<Ty, Alloc>::pop_tail(unsigned level, inner_t*& node) {
+    // removes the last leaf from the tree, returns `false` if `node` became empty and was released
+    const std::size_t n = ((size_ - 2) >> level) & mask;
+    unique(node);
+    if (level > bits) {
+        inner_t*& child = reinterpret_cast<inner_t*&>(node->child[n]);
+        if (pop_tail(level - bits, child)) { return true; }
+    } else {
+        release(static_cast<leaf_t*>(node->child[n]));
+    }
+    if (--node->count) { return true; }
+    inner_alloc_type inner_al(*this);
+    inner_al.deallocate(node, 1);
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// Persistent record: a compressed hash array mapped trie (CHAMP) of key-value entries; copying is O(1), and
+// insertion, assignment or removal copies only shared nodes on the path to the entry, so it costs O(log n);
+// items are visited in the order of key hash codes, not in the order of insertion; keys with equal hash codes are
+// kept in collision nodes and compared one by one
+
+template<typename CharT, typename Ty, typename Alloc = std::allocator<Ty>,
+         typename Hash = std::hash<std::basic_string_view<CharT>>>
+class persistent_record : protected std::allocator_traits<Alloc>::template rebind_alloc<Ty> {
+ private:
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<Ty>;
+    using ref_counter_t = typename alloc_ref_count_policy<Alloc>::type::template counter_type<std::size_t>;
+
+    enum : unsigned { bits = 5, mask = (1 << bits) - 1, hash_bits = 8 * sizeof(std::size_t) };
+
+    struct entry_t {
+        ref_counter_t ref_count;
+        std::size_t hash_code;
+        std::size_t key_sz;
+        alignas(std::alignment_of<Ty>::value) std::uint8_t x[sizeof(Ty)];
+        CharT key_chars[16];
+        Ty& value() noexcept { return *reinterpret_cast<Ty*>(&x); }
+        std::basic_string_view<CharT> key() const noexcept { return std::basic_string_view<CharT>(key_chars, key_sz); }
+        static std::size_t get_alloc_sz(std::size_t key_sz) noexcept {
+            return (offsetof(entry_t, key_chars) + key_sz * sizeof(CharT) + sizeof(entry_t) - 1) / sizeof(entry_t);
+        }
+    };
+
+    // Entry slots go first, then child node slots; a node beyond the hash bits holds colliding entries only
+    struct node_t {
+        ref_counter_t ref_count;
+        std::uint32_t datamap;
+        std::uint32_t nodemap;
+        std::size_t size;
+        void* slots[4];
+        std::size_t data_count() const noexcept {
+            return datamap || nodemap ? detail::popcount32(datamap) : size;
+        }
+        static std::size_t get_alloc_sz(std::size_t size) noexcept {
+            return (offsetof(node_t, slots) + size * sizeof(void*) + sizeof(node_t) - 1) / sizeof(node_t);
+        }
+    };
+
+    using entry_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<entry_t>;
+    using node_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<node_t>;
+
+ public:
+    using key_type = std::basic_string_view<CharT>;
+    using mapped_type = Ty;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using hasher_t = Hash;
+
+    persistent_record() noexcept(std::is_nothrow_default_constructible<alloc_type>::value) : alloc_type() {}
+    explicit persistent_record(const Alloc& al) noexcept : alloc_type(al) {}
+    ~persistent_record() { clear(); }
+
+    persistent_record(const persistent_record& other) noexcept
+        : alloc_type(other), root_(other.root_), size_(other.size_) {
+        if (root_) { ++root_->ref_count; }
+    }
+    persistent_record& operator=(const persistent_record& other) noexcept {
+        if (&other == this) { return *this; }
+        persistent_record tmp(other);
+        swap(tmp);
+        return *this;
+    }
+    persistent_record(persistent_record&& other) noexcept
+        : alloc_type(std::move(other)), root_(other.root_), size_(other.size_) {
+        other.root_ = nullptr, other.size_ = 0;
+    }
+    persistent_record& operator=(persistent_record&& other) noexcept {
+        if (&other == this) { return *this; }
+        persistent_record tmp(std::move(other));
+        swap(tmp);
+        return *this;
+    }
+
+    void swap(persistent_record& other) noexcept {
+        if (&other == this) { return; }
+        std::swap(static_cast<alloc_type&>(*this), static_cast<alloc_type&>(other));
+        std::swap(root_, other.root_);
+        std::swap(size_, other.size_);
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type(*this); }
+
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    const Ty* find(key_type key) const noexcept {
+        entry_t* entry = find_entry(key, hasher_t{}(key));
+        return entry ? &entry->value() : nullptr;
+    }
+    bool contains(key_type key) const noexcept { return find(key) != nullptr; }
+    const Ty& at(key_type key) const {
+        const Ty* v = find(key);
+        if (!v) { throw database_error("invalid key"); }
+        return *v;
+    }
+
+    // Returns `true` if a new entry is inserted
+    template<typename U>
+    bool insert_or_assign(key_type key, U&& v);
+    size_type erase(key_type key);
+
+    template<typename Func>
+    void for_each(const Func& func) const {
+        if (root_) { for_each_impl(root_, func); }
+    }
+
+    void clear() noexcept {
+        if (root_) { release(root_); }
+        root_ = nullptr, size_ = 0;
+    }
+
+ private:
+    node_t* root_ = nullptr;
+    size_type size_ = 0;
+
+    static std::uint32_t bit_at(std::size_t hash_code, unsigned shift) noexcept {
+        return std::uint32_t(1) << ((hash_code >> shift) & mask);
+    }
+    static std::size_t data_index(const node_t* node, std::uint32_t bit) noexcept {
+        return detail::popcount32(node->datamap & (bit - 1));
+    }
+    static std::size_t node_index(const node_t* node, std::uint32_t bit) noexcept {
+        return detail::popcount32(node->datamap) + detail::popcount32(node->nodemap & (bit - 1));
+    }
+
+    entry_t* find_entry(key_type key, std::size_t hash_code) const noexcept {
+        const node_t* node = root_;
+        for (unsigned shift = 0; node; shift += bits) {
+            if (shift >= hash_bits) {
+                for (std::size_t n = 0; n < node->size; ++n) {
+                    entry_t* entry = static_cast<entry_t*>(node->slots[n]);
+                    if (entry->hash_code == hash_code && entry->key() == key) { return entry; }
+                }
+                return nullptr;
+            }
+            const std::uint32_t bit = bit_at(hash_code, shift);
+            if (node->datamap & bit) {
+                entry_t* entry = static_cast<entry_t*>(node->slots[data_index(node, bit)]);
+                return entry->hash_code == hash_code && entry->key() == key ? entry : nullptr;
+            }
+            node = node->nodemap & bit ? static_cast<node_t*>(node->slots[node_index(node, bit)]) : nullptr;
+        }
+        return nullptr;
+    }
+
+    template<typename U>
+    entry_t* new_entry(key_type key, std::size_t hash_code, U&& v) {
+        entry_alloc_type entry_al(*this);
+        const std::size_t alloc_sz = entry_t::get_alloc_sz(key.size());
+        entry_t* entry = entry_al.allocate(alloc_sz);
+        try {
+            new (&entry->value()) Ty(std::forward<U>(v));
+        } catch (...) {
+            entry_al.deallocate(entry, alloc_sz);
+            throw;
+        }
+        new (&entry->ref_count) ref_counter_t{1};
+        entry->hash_code = hash_code;
+        entry->key_sz = key.size();
+        std::copy_n(key.data(), key.size(), entry->key_chars);
+        return entry;
+    }
+
+    node_t* new_node(std::size_t size) {
+        node_alloc_type node_al(*this);
+        node_t* node = node_al.allocate(node_t::get_alloc_sz(size));
+        new (&node->ref_count) ref_counter_t{1};
+        node->datamap = 0, node->nodemap = 0, node->size = size;
+        return node;
+    }
+
+    void dealloc_node(node_t* node) noexcept {
+        node_alloc_type node_al(*this);
+        node_al.deallocate(node, node_t::get_alloc_sz(node->size));
+    }
+
+    void release(entry_t* entry) noexcept {
+        if (--entry->ref_count != 0) { return; }
+        entry->value().~Ty();
+        entry_alloc_type entry_al(*this);
+        entry_al.deallocate(entry, entry_t::get_alloc_sz(entry->key_sz));
+    }
+
+    void release(node_t* node) noexcept {
+        if (--node->ref_count != 0) { return; }
+        const std::size_t data_count = node->data_count();
+        for (std::size_t n = 0; n < node->size; ++n) {
+            if (n < data_count) {
+                release(static_cast<entry_t*>(node->slots[n]));
+            } else {
+                release(static_cast<node_t*>(node->slots[n]));
+            }
+        }
+        dealloc_node(node);
+    }
+
+    void unique(node_t*& node) {
+        if (node->ref_count == 1) { return; }
+        node_t* new_node = this->new_node(node->size);
+        new_node->datamap = node->datamap, new_node->nodemap = node->nodemap;
+        for (std::size_t n = 0; n < node->size; ++n) {
+            new_node->slots[n] = node->slots[n];
+            // entries and nodes start with the reference counter
+            ++static_cast<entry_t*>(node->slots[n])->ref_count;
+        }
+        --node->ref_count;
+        node = new_node;
+    }
+
+    // Replaces `node` with a node of `size + 1` slots with `slot` inserted at position `pos`
+    void insert_slot(node_t*& node, std::size_t pos, void* slot) {
+        node_t* new_node = this->new_node(node->size + 1);
+        new_node->datamap = node->datamap, new_node->nodemap = node->nodemap;
+        std::memcpy(new_node->slots, node->slots, pos * sizeof(void*));
+        new_node->slots[pos] = slot;
+        std::memcpy(new_node->slots + pos + 1, node->slots + pos, (node->size - pos) * sizeof(void*));
+        dealloc_node(node);
+        node = new_node;
+    }
+
+    // Replaces `node` with a node of `size - 1` slots without the slot at position `pos`
+    void remove_slot(node_t*& node, std::size_t pos) {
+        node_t* new_node = this->new_node(node->size - 1);
+        new_node->datamap = node->datamap, new_node->nodemap = node->nodemap;
+        std::memcpy(new_node->slots, node->slots, pos * sizeof(void*));
+        std::memcpy(new_node->slots + pos, node->slots + pos + 1, (node->size - pos - 1) * sizeof(void*));
+        dealloc_node(node);
+        node = new_node;
+    }
+
+    template<typename U>
+    void assign_value(entry_t*& entry, U&& v) {
+        if (entry->ref_count == 1) {
+            entry->value() = std::forward<U>(v);
+            return;
+        }
+        entry_t* new_entry = this->new_entry(entry->key(), entry->hash_code, std::forward<U>(v));
+        --entry->ref_count;
+        entry = new_entry;
+    }
+
+    node_t* merge(entry_t* entry1, entry_t* entry2, unsigned shift);
+
+    template<typename U>
+    bool insert_or_assign(node_t*& node, unsigned shift, key_type key, std::size_t hash_code, U&& v);
+    void erase(node_t*& node, unsigned shift, key_type key, std::size_t hash_code);
+
+    template<typename Func>
+    static void for_each_impl(const node_t* node, const Func& func) {
+        const std::size_t data_count = node->data_count();
+        for (std::size_t n = 0; n < data_count; ++n) {
+            entry_t* entry = static_cast<entry_t*>(node->slots[n]);
+            func(entry->key(), static_cast<const Ty&>(entry->value()));
+        }
+        for (std::size_t n = data_count; n < node->size; ++n) {
+            for_each_impl(static_cast<const node_t*>(node->slots[n]), func);
+        }
+    }
+};
+
+template<typename CharT, typename Ty, typename Alloc, typename Hash>
+template<typename U>
+bool persistent_record<CharT, Ty, Alloc, Hash>::insert_or_assign(key_type key, U&& v) {
+    const std::size_t hash_code = hasher_t{}(key);
+    if (!root_) {
+        entry_t* entry = new_entry(key, hash_code, std::forward<U>(v));
+        try {
+            root_ = new_node(1);
+        } catch (...) {
+            release(entry);
+            throw;
+        }
+        root_->datamap = bit_at(hash_code, 0);
+        root_->slots[0] = entry;
+        size_ = 1;
+        return true;
+    }
+    unique(root_);
+    if (!insert_or_assign(root_, 0, key, hash_code, std::forward<U>(v))) { return false; }
+    ++size_;
+    return true;
+}
+
+template<typename CharT, typename Ty, typename Alloc, typename Hash>
+template<typename U>
+bool persistent_record<CharT, Ty, Alloc, Hash>::insert_or_assign(node_t*& node, unsigned shift, key_type key,
+                                                                 std::size_t hash_code, U&& v) {
+    // `node` is unique
+    if (shift >= hash_bits) {
+        for (std::size_t n = 0; n < node->size; ++n) {
+            entry_t*& entry = reinterpret_cast<entry_t*&>(node->slots[n]);
+            if (entry->hash_code == hash_code && entry->key() == key) {
+                assign_value(entry, std::forward<U>(v));
+                return false;
+            }
+        }
+        entry_t* entry = new_entry(key, hash_code, std::forward<U>(v));
+        try {
+            insert_slot(node, node->size, entry);
+        } catch (...) {
+            release(entry);
+            throw;
+        }
+        return true;
+    }
+
+    const std::uint32_t bit = bit_at(hash_code, shift);
+    if (node->datamap & bit) {
+        const std::size_t pos = data_index(node, bit);
+        entry_t*& entry = reinterpret_cast<entry_t*&>(node->slots[pos]);
+        if (entry->hash_code == hash_code && entry->key() == key) {
+            assign_value(entry, std::forward<U>(v));
+            return false;
+        }
+        // push both entries down to a new child node
+        entry_t* new_entry = this->new_entry(key, hash_code, std::forward<U>(v));
+        node_t* child;
+        try {
+            child = merge(entry, new_entry, shift + bits);
+        } catch (...) {
+            release(new_entry);
+            throw;
+        }
+        node->datamap ^= bit, node->nodemap |= bit;
+        const std::size_t new_pos = node_index(node, bit);
+        std::memmove(node->slots + pos, node->slots + pos + 1, (new_pos - pos) * sizeof(void*));
+        node->slots[new_pos] = child;
+        return true;
+    }
+
+    if (node->nodemap & bit) {
+        node_t*& child = reinterpret_cast<node_t*&>(node->slots[node_index(node, bit)]);
+        unique(child);
+        return insert_or_assign(child, shift + bits, key, hash_code, std::forward<U>(v));
+    }
+
+    entry_t* entry = new_entry(key, hash_code, std::forward<U>(v));
+    try {
+        insert_slot(node, data_index(node, bit), entry);
+    } catch (...) {
+        release(entry);
+        throw;
+    }
+    node->datamap |= bit;
+    return true;
+}
+
+template<typename CharT, typename Ty, typename Alloc, typename Hash>
+auto persistent_record<CharT, Ty, Alloc, Hash>::merge(entry_t* entry1, entry_t* entry2, unsigned shift) -> node_t* {
+    if (shift >= hash_bits) {
+        node_t* node = new_node(2);
+        node->slots[0] = entry1, node->slots[1] = entry2;
+        return node;
+    }
+    const std::uint32_t bit1 = bit_at(entry1->hash_code, shift);
+    const std::uint32_t bit2 = bit_at(entry2->hash_code, shift);
+    if (bit1 != bit2) {
+        node_t* node = new_node(2);
+        node->datamap = bit1 | bit2;
+        if (bit1 > bit2) { std::swap(entry1, entry2); }
+        node->slots[0] = entry1, node->slots[1] = entry2;
+        return node;
+    }
+    node_t* node = new_node(1);
+    try {
+        node->slots[0] = merge(entry1, entry2, shift + bits);
+    } catch (...) {
+        dealloc_node(node);
+        throw;
+    }
+    node->nodemap = bit1;
+    return node;
+}
+
+template<typename CharT, typename Ty, typename Alloc, typename Hash>
+auto persistent_record<CharT, Ty, Alloc, Hash>::erase(key_type key) -> size_type {
+    const std::size_t hash_code = hasher_t{}(key);
+    if (!find_entry(key, hash_code)) { return 0; }
+    if (size_ == 1) {
+        clear();
+        return 1;
+    }
+    unique(root_);
+    erase(root_, 0, key, hash_code);
+    --size_;
+    return 1;
+}
+
+template<typename CharT, typename Ty, typename Alloc, typename Hash>
+void persistent_record<CharT, Ty, Alloc, Hash>::erase(node_t*& node, unsigned shift, key_type key,
+                                                      std::size_t hash_code) {
+    // `node` is unique and contains the key
+    if (shift >= hash_bits) {
+        std::size_t pos = 0;
+        while (static_cast<entry_t*>(node->slots[pos])->key() != key) { ++pos; }
+        entry_t* entry = static_cast<entry_t*>(node->slots[pos]);
+        remove_slot(node, pos);
+        release(entry);
+        return;
+    }
+
+    const std::uint32_t bit = bit_at(hash_code, shift);
+    if (node->datamap & bit) {
+        const std::size_t pos = data_index(node, bit);
+        entry_t* entry = static_cast<entry_t*>(node->slots[pos]);
+        remove_slot(node, pos);
+        node->datamap ^= bit;
+        release(entry);
+        return;
+    }
+
+    const std::size_t pos = node_index(node, bit);
+    node_t*& child = reinterpret_cast<node_t*&>(node->slots[pos]);
+    unique(child);
+    erase(child, shift + bits, key, hash_code);
+    if (child->size != 1 || child->nodemap) { return; }
+
+    // inline the last entry of the child node
+    entry_t* entry = static_cast<entry_t*>(child->slots[0]);
+    dealloc_node(child);
+    node->nodemap ^= bit, node->datamap |= bit;
+    const std::size_t new_pos = data_index(node, bit);
+    std::memmove(node->slots + new_pos + 1, node->slots + new_pos, (pos - new_pos) * sizeof(void*));
+    node->slots[new_pos] = entry;
+}
+
+//-----------------------------------------------------------------------------
+// Persistent snapshots of `basic_value` arrays and records: items are `basic_value`-s, which share their
+// own data copy-on-write
+
+template<typename CharT, typename Alloc = std::allocator<CharT>>
+using basic_persistent_array = persistent_vector<basic_value<CharT, Alloc>, Alloc>;
+
+template<typename CharT, typename Alloc = std::allocator<CharT>>
+using basic_persistent_record = persistent_record<CharT, basic_value<CharT, Alloc>, Alloc>;
+
+using persistent_array = basic_persistent_array<char>;
+using wpersistent_array = basic_persistent_array<wchar_t>;
+using persistent_record_value = basic_persistent_record<char>;
+using wpersistent_record_value = basic_persistent_record<wchar_t>;
+
+template<typename CharT, typename Alloc>
+basic_persistent_array<CharT, Alloc> make_persistent_array(const basic_value<CharT, Alloc>& v) {
+    const auto items = v.as_array();
+    return basic_persistent_array<CharT, Alloc>(items.begin(), items.end(), v.get_allocator());
+}
+
+// Items with duplicate keys are merged: the last item wins
+template<typename CharT, typename Alloc>
+basic_persistent_record<CharT, Alloc> make_persistent_record(const basic_value<CharT, Alloc>& v) {
+    basic_persistent_record<CharT, Alloc> rec(v.get_allocator());
+    for (const auto& item : v.as_record()) { rec.insert_or_assign(item.key(), item.value()); }
+    return rec;
+}
+
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> to_value(const basic_persistent_array<CharT, Alloc>& arr) {
+    basic_value<CharT, Alloc> v = make_array<CharT>(arr.get_allocator());
+    v.reserve(arr.size());
+    arr.for_each([&v](const basic_value<CharT, Alloc>& item) { v.push_back(item); });
+    return v;
+}
+
+// Items of the resulting record are in the order of key hash codes, as `for_each()` visits them, not in the order
+// of insertion or of the record the snapshot was made of, so a round trip through the snapshot can reorder keys
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> to_value(const basic_persistent_record<CharT, Alloc>& rec) {
+    basic_value<CharT, Alloc> v = make_record<CharT>(rec.get_allocator());
+    rec.for_each([&v](std::basic_string_view<CharT> key, const basic_value<CharT, Alloc>& item) {
+        v.emplace(key, item);
+    });
+    return v;
+}
+
+}  // namespace db
+}  // namespace uxs
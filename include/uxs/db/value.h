@@ -1,6 +1,7 @@
 #pragma once
 
 #include "database_error.h"
+#include "key_pool.h"
 
 #include "uxs/dllist.h"  // NOLINT
 #include "uxs/iterator.h"
@@ -13,12 +14,13 @@
 #include <atomic>
 #include <cstring>
 #include <functional>
+#include <limits>
 #include <tuple>
 
 namespace uxs {
 namespace db {
 
-enum class dtype {
+enum class dtype : std::uint8_t {
     null = 0,
     boolean,
     integer,
@@ -31,6 +33,28 @@ enum class dtype {
     record,
 };
 
+// Memory taken by a value tree, see `get_memory_stats()`; data shared by copy-on-write is counted once, and
+// unused capacity is a part of allocated bytes of the same category
+struct memory_stats {
+    std::size_t value_count = 0;          // values including the root one
+    std::size_t string_bytes = 0;         // long strings
+    std::size_t string_unused_bytes = 0;  // unused capacity of long strings
+    std::size_t array_bytes = 0;          // arrays of value cells
+    std::size_t array_unused_bytes = 0;   // unused capacity of arrays
+    std::size_t record_bytes = 0;         // record headers with node arenas
+    std::size_t record_node_bytes = 0;    // record nodes allocated outside of arenas
+    std::size_t record_index_bytes = 0;   // hash indexes of bigger records
+    std::size_t record_unused_bytes = 0;  // free space in arenas and free index slots
+    std::size_t shared_count = 0;         // strings, arrays and records with more than one reference
+    std::size_t shared_bytes = 0;         // memory of them and their subtrees
+    std::size_t total_bytes() const noexcept {
+        return string_bytes + array_bytes + record_bytes + record_node_bytes + record_index_bytes;
+    }
+    std::size_t unused_bytes() const noexcept {
+        return string_unused_bytes + array_unused_bytes + record_unused_bytes;
+    }
+};
+
 template<typename CharT, typename Alloc>
 class basic_value;
 
@@ -41,8 +65,10 @@ namespace detail {
 template<typename Ty, typename Alloc>
 class flexarray_t {
  private:
+    using ref_counter_t = typename alloc_ref_count_policy<Alloc>::type::template counter_type<std::size_t>;
+
     struct data_t {
-        std::atomic<std::size_t> ref_count;
+        ref_counter_t ref_count;
         std::size_t size;
         std::size_t capacity;
         alignas(std::alignment_of<Ty>::value) std::uint8_t x[4 * sizeof(Ty)];
@@ -168,6 +194,11 @@ class flexarray_t {
         if (p_->ref_count != 1) { unique_impl(al); }
     }
 
+    const void* data_ptr() const noexcept { return p_; }
+    bool is_shared() const noexcept { return p_ && p_->ref_count != 1; }
+    std::size_t alloc_bytes() const noexcept { return p_ ? get_alloc_sz(p_->capacity) * sizeof(data_t) : 0; }
+    std::size_t unused_bytes() const noexcept { return p_ ? (p_->capacity - p_->size) * sizeof(Ty) : 0; }
+
  private:
     data_t* p_;
 
@@ -320,6 +351,76 @@ using list_links_t = dllist_node_t;
 template<typename CharT, typename Alloc>
 class record_t;
 
+// Key used for record lookup or insertion: `entry` points to the interned key if the allocator has a key pool
+template<typename CharT>
+struct record_key_ref {
+    std::basic_string_view<CharT> key;
+    std::size_t hash_code;
+    const typename basic_key_pool<CharT>::entry* entry;
+};
+
+// Record key with inline characters
+template<typename CharT, typename Alloc, bool = has_key_pool<CharT, Alloc>::value>
+class record_key {
+ public:
+    using key_type = std::basic_string_view<CharT>;
+
+    key_type get() const noexcept { return key_type(chars_, sz_); }
+    std::size_t hash_code() const noexcept { return hash_code_; }
+    std::size_t stored_size() const noexcept { return sz_; }
+    const typename basic_key_pool<CharT>::entry* entry() const noexcept { return nullptr; }
+    bool equal_to(const record_key_ref<CharT>& ref) const noexcept { return get() == ref.key; }
+
+    void assign(const record_key_ref<CharT>& ref) noexcept {
+        hash_code_ = ref.hash_code;
+        sz_ = ref.key.size();
+        std::copy_n(ref.key.data(), ref.key.size(), chars_);
+    }
+
+    static std::size_t get_size(std::size_t key_sz) noexcept {
+        return offsetof(record_key, chars_) + key_sz * sizeof(CharT);
+    }
+
+ private:
+    std::size_t hash_code_;
+    std::size_t sz_;
+    CharT chars_[16];
+};
+
+// Record key interned in the key pool of the allocator
+template<typename CharT, typename Alloc>
+class record_key<CharT, Alloc, true> {
+ public:
+    using key_type = std::basic_string_view<CharT>;
+
+    key_type get() const noexcept { return entry_->key(); }
+    std::size_t hash_code() const noexcept { return entry_->hash_code(); }
+    std::size_t stored_size() const noexcept { return 0; }
+    const typename basic_key_pool<CharT>::entry* entry() const noexcept { return entry_; }
+    bool equal_to(const record_key_ref<CharT>& ref) const noexcept { return entry_ == ref.entry; }
+    void assign(const record_key_ref<CharT>& ref) noexcept { entry_ = ref.entry; }
+    static std::size_t get_size(std::size_t key_sz) noexcept { return sizeof(record_key); }
+
+ private:
+    const typename basic_key_pool<CharT>::entry* entry_;
+};
+
+// Record data refers to the key pool its keys are interned in
+template<typename CharT, typename Alloc, bool = has_key_pool<CharT, Alloc>::value>
+struct record_key_pool_ref {
+    template<typename Al>
+    void set(const Al&) noexcept {}
+};
+
+template<typename CharT, typename Alloc>
+struct record_key_pool_ref<CharT, Alloc, true> {
+    basic_key_pool<CharT>* ptr;
+    template<typename Al>
+    void set(const Al& al) noexcept {
+        ptr = al.key_pool();
+    }
+};
+
 template<typename CharT, typename Alloc>
 class record_value {
  public:
@@ -328,7 +429,7 @@ class record_value {
     using key_type = std::basic_string_view<char_type>;
     using value_type = basic_value<char_type, Alloc>;
 
-    key_type key() const noexcept { return key_type(key_chars_, key_sz_); }
+    key_type key() const noexcept { return key_.get(); }
     const value_type& value() const noexcept { return *reinterpret_cast<const value_type*>(&x_); }
     value_type& value() noexcept { return *reinterpret_cast<value_type*>(&x_); }
 
@@ -343,17 +444,18 @@ class record_value {
 
  private:
     friend class record_t<CharT, Alloc>;
+    using key_t = record_key<CharT, Alloc>;
+    using key_ref_t = record_key_ref<CharT>;
 
     list_links_t links_;
-    list_links_t* next_bucket_;
-    std::size_t hash_code_;
     alignas(std::alignment_of<value_type>::value) std::uint8_t x_[sizeof(value_type)];
-    std::size_t key_sz_;
-    char_type key_chars_[16];
+    key_t key_;
+
+    std::size_t hash_code() const noexcept { return key_.hash_code(); }
 
     template<typename... Args>
-    static record_value* create(alloc_type& al, key_type key, Args&&... args) {
-        record_value* node = alloc(al, key);
+    static record_value* create(alloc_type& al, const key_ref_t& ref, Args&&... args) {
+        record_value* node = alloc(al, ref);
         try {
             new (&node->value()) value_type(std::forward<Args>(args)...);
             return node;
@@ -363,26 +465,33 @@ class record_value {
         }
     }
 
+    template<typename... Args>
+    static record_value* create_at(record_value* node, const key_ref_t& ref, Args&&... args) {
+        new (&node->value()) value_type(std::forward<Args>(args)...);
+        node->key_.assign(ref);
+        return node;
+    }
+
     static void destroy(alloc_type& al, record_value* node) noexcept {
         node->value().~value_type();
         dealloc(al, node);
     }
 
     static std::size_t max_name_size(const alloc_type& al) noexcept {
-        return (std::allocator_traits<alloc_type>::max_size(al) * sizeof(record_value) -
-                offsetof(record_value, key_chars_)) /
+        return (std::allocator_traits<alloc_type>::max_size(al) * sizeof(record_value) - offsetof(record_value, key_) -
+                key_t::get_size(0)) /
                sizeof(CharT);
     }
 
     static std::size_t get_alloc_sz(std::size_t key_sz) noexcept {
-        return (offsetof(record_value, key_chars_) + key_sz * sizeof(CharT) + sizeof(record_value) - 1) /
+        return (offsetof(record_value, key_) + key_t::get_size(key_sz) + sizeof(record_value) - 1) /
                sizeof(record_value);
     }
 
-    UXS_NODISCARD UXS_EXPORT static record_value* alloc(alloc_type& al, key_type key);
+    UXS_NODISCARD UXS_EXPORT static record_value* alloc(alloc_type& al, const key_ref_t& ref);
 
     static void dealloc(alloc_type& al, record_value* node) noexcept {
-        al.deallocate(node, get_alloc_sz(node->key_sz_));
+        al.deallocate(node, get_alloc_sz(node->key_.stored_size()));
     }
 };
 
@@ -415,16 +524,44 @@ std::false_type initial_alloc_size(InputIt first, InputIt last, std::false_type
 template<typename CharT, typename Alloc>
 class record_t {
  private:
+    using node_t = record_value<CharT, Alloc>;
+
+    // Open-addressing hash index: `capacity` is a power of two; slot array is followed by
+    // `capacity + ctrl_tail_size` control bytes, and the tail mirrors the first control bytes, so a
+    // group of control bytes can be loaded at any position
+    struct slot_t {
+        std::size_t hash_code;
+        list_links_t* node;
+    };
+
+    enum : std::size_t { ctrl_tail_size = 16 };
+
+    struct index_t {
+        std::size_t capacity;
+        std::size_t growth_left;
+        slot_t slots[1];
+        std::int8_t* ctrl() noexcept { return reinterpret_cast<std::int8_t*>(&slots[capacity]); }
+    };
+
+    using ref_counter_t = typename alloc_ref_count_policy<Alloc>::type::template counter_type<std::size_t>;
+
+    // Items are linked in insertion order; nodes are placed in the arena following the header until
+    // it is exhausted, then allocated separately; small records have no hash index and are searched
+    // linearly, so such a record takes one allocation; nodes are never relocated
     struct data_t {
-        std::atomic<std::size_t> ref_count;
+        ref_counter_t ref_count;
         list_links_t head;
         std::size_t size;
-        std::size_t bucket_count;
-        list_links_t* hashtbl[4];
+        index_t* index;
+        std::uint32_t arena_size;
+        std::uint32_t arena_used;
+        record_key_pool_ref<CharT, Alloc> key_pool;
+        node_t arena[1];
         UXS_EXPORT void init() noexcept;
-        void init_from(data_t* p) noexcept;
     };
 
+    enum : std::size_t { small_record_max = 8 };
+
  public:
     using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<data_t>;
     using key_type = std::basic_string_view<CharT>;
@@ -437,7 +574,6 @@ class record_t {
     using reference = value_type&;
     using const_reference = const value_type&;
     using node_traits = record_node_traits<CharT, Alloc>;
-    using node_t = typename node_traits::node_t;
     using hasher_t = std::hash<key_type>;
     using iterator = list_iterator<record_t, node_traits, false>;
     using const_iterator = list_iterator<record_t, node_traits, true>;
@@ -445,7 +581,16 @@ class record_t {
     size_type size() const noexcept { return p_->size; }
     list_links_t* cbegin() const noexcept { return p_->head.next; }
     list_links_t* cend() const noexcept { return &p_->head; }
-    list_links_t* find(key_type key) const noexcept { return find_impl(key, hasher_t{}(key)); }
+    list_links_t* find(key_type key) const noexcept {
+        key_ref_t ref;
+        if (!lookup_key(key, ref, has_key_pool_t())) { return &p_->head; }
+        return p_->index ? find_impl(ref) : find_linear(ref);
+    }
+    // Looks the key up with its precomputed hash code; with a key pool the entry must be of the pool of the record
+    list_links_t* find(const typename basic_key_pool<CharT>::entry& key) const noexcept {
+        const key_ref_t ref{key.key(), key.hash_code(), &key};
+        return p_->index ? find_impl(ref) : find_linear(ref);
+    }
     UXS_EXPORT size_type count(key_type key) const noexcept;
 
     iterator_range<const_iterator> crange() const {
@@ -465,14 +610,10 @@ class record_t {
     void construct(alloc_type& al, std::false_type = {}) {
         p_ = alloc(al, 0);
         p_->init();
+        p_->key_pool.set(al);
     }
 
-    void construct(alloc_type& al, std::size_t bucket_count) {
-        if (bucket_count > max_size(al)) { throw std::length_error("too much to reserve"); }
-        p_ = alloc(al, bucket_count);
-        p_->init();
-    }
-
+    UXS_EXPORT void construct(alloc_type& al, std::size_t count);
     void construct(alloc_type& al, record_t rec);
     void construct(alloc_type& al, std::initializer_list<mapped_type> init);
     UXS_EXPORT void construct(alloc_type& al, std::initializer_list<std::pair<key_type, mapped_type>> init);
@@ -505,23 +646,21 @@ class record_t {
     template<typename... Args>
     list_links_t* emplace(alloc_type& al, key_type key, Args&&... args) {
         unique(al);
-        if (p_->size == p_->bucket_count) { rehash(al, 1); }
-        typename node_t::alloc_type node_al(al);
-        node_t* node = node_t::create(node_al, key, std::forward<Args>(args)...);
-        insert_node(node, hasher_t{}(key));
+        reserve(al, 1);
+        node_t* node = new_node(al, make_key(key, has_key_pool_t()), std::forward<Args>(args)...);
+        insert_node(node);
         return &node->links_;
     }
 
     template<typename... Args>
     std::pair<list_links_t*, bool> emplace_unique(alloc_type& al, key_type key, Args&&... args) {
         unique(al);
-        const std::size_t hash_code = hasher_t{}(key);
-        list_links_t* node = find_impl(key, hash_code);
+        const key_ref_t ref = make_key(key, has_key_pool_t());
+        list_links_t* node = p_->index ? find_impl(ref) : find_linear(ref);
         if (node != &p_->head) { return std::make_pair(node, false); }
-        if (p_->size == p_->bucket_count) { rehash(al, 1); }
-        typename node_t::alloc_type node_al(al);
-        node_t* new_node = node_t::create(node_al, key, std::forward<Args>(args)...);
-        insert_node(new_node, hash_code);
+        reserve(al, 1);
+        node_t* new_node = this->new_node(al, ref, std::forward<Args>(args)...);
+        insert_node(new_node);
         return std::make_pair(&new_node->links_, true);
     }
 
@@ -539,7 +678,22 @@ class record_t {
         if (p_->ref_count != 1) { unique_impl(al); }
     }
 
+    // Reserves space for `count` more items; the record must be unique
+    void reserve(alloc_type& al, std::size_t count) {
+        if (p_->index ? p_->index->growth_left < count : p_->size + count > small_record_max) { rehash(al, count); }
+        if (!p_->size && p_->arena_size < count) { grow_arena(al, count); }
+    }
+
+    const void* data_ptr() const noexcept { return p_; }
+    bool is_shared() const noexcept { return p_->ref_count != 1; }
+    // Adds memory of the header, nodes and the index, but not of item values
+    void add_memory_stats(memory_stats& st) const noexcept;
+
  private:
+    using index_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<index_t>;
+    using has_key_pool_t = has_key_pool<CharT, Alloc>;
+    using key_ref_t = record_key_ref<CharT>;
+
     data_t* p_;
 
     void insert_impl(alloc_type& al, std::initializer_list<mapped_type> init);
@@ -549,46 +703,120 @@ class record_t {
     template<typename InputIt>
     void insert_impl(alloc_type& al, InputIt first, InputIt last, std::false_type /* random access iterator */);
 
+    key_ref_t make_key(key_type key, std::false_type) const { return key_ref_t{key, hasher_t{}(key), nullptr}; }
+
+    template<bool Pooled = true>
+    key_ref_t make_key(key_type key, std::integral_constant<bool, Pooled>) const {
+        const auto* entry = p_->key_pool.ptr->intern(key);
+        return key_ref_t{entry->key(), entry->hash_code(), entry};
+    }
+
+    static key_ref_t make_key(const node_t& node) noexcept {
+        return key_ref_t{node.key(), node.hash_code(), node.key_.entry()};
+    }
+
+    // Returns `false` if the record can't contain the key
+    bool lookup_key(key_type key, key_ref_t& ref, std::false_type) const noexcept {
+        ref = key_ref_t{key, p_->index ? hasher_t{}(key) : 0, nullptr};
+        return true;
+    }
+
+    template<bool Pooled = true>
+    bool lookup_key(key_type key, key_ref_t& ref, std::integral_constant<bool, Pooled>) const noexcept {
+        const auto* entry = p_->size ? p_->key_pool.ptr->find(key) : nullptr;
+        if (!entry) { return false; }
+        ref = key_ref_t{entry->key(), entry->hash_code(), entry};
+        return true;
+    }
+
+    template<typename... Args>
+    node_t* new_node(alloc_type& al, const key_ref_t& ref, Args&&... args) {
+        const std::size_t alloc_sz = node_t::get_alloc_sz(ref.key.size());
+        if (p_->arena_size - p_->arena_used >= alloc_sz) {
+            node_t* node = node_t::create_at(&p_->arena[p_->arena_used], ref, std::forward<Args>(args)...);
+            p_->arena_used += static_cast<std::uint32_t>(alloc_sz);
+            return node;
+        }
+        typename node_t::alloc_type node_al(al);
+        return node_t::create(node_al, ref, std::forward<Args>(args)...);
+    }
+
+    // Pointers to unrelated objects are compared with `std::less<>`, which gives total order
+    bool is_in_arena(const node_t* node) const noexcept {
+        const std::less<const node_t*> less;
+        return !less(node, p_->arena) && less(node, p_->arena + p_->arena_size);
+    }
+
+    void delete_node(alloc_type& al, node_t* node) noexcept;
     void destruct_items(alloc_type& al) noexcept;
-    void add_to_hash(node_t* node) noexcept;
-    UXS_EXPORT void insert_node(node_t* node, std::size_t hash_code) noexcept;
+    void add_to_hash(list_links_t* node, std::size_t hash_code) noexcept;
+    void remove_from_hash(list_links_t* node) noexcept;
+    UXS_EXPORT void insert_node(node_t* node) noexcept;
     UXS_EXPORT void rehash(alloc_type& al, std::size_t extra);
+    UXS_EXPORT void grow_arena(alloc_type& al, std::size_t count);
     UXS_EXPORT void unique_impl(alloc_type& al);
     UXS_EXPORT void clear_impl(alloc_type& al, std::false_type = {});
-    UXS_EXPORT void clear_impl(alloc_type& al, std::size_t bucket_count);
+    UXS_EXPORT void clear_impl(alloc_type& al, std::size_t count);
     UXS_EXPORT void destruct(alloc_type& al) noexcept;
-    UXS_EXPORT list_links_t* find_impl(key_type key, std::size_t hash_code) const noexcept;
+    UXS_EXPORT list_links_t* find_impl(const key_ref_t& ref) const noexcept;
+    UXS_EXPORT list_links_t* find_linear(const key_ref_t& ref) const noexcept;
 
     void reset(alloc_type& al, data_t* p) noexcept {
         unref(al);
         p_ = p;
     }
 
+    static std::size_t growth_limit(std::size_t capacity) noexcept {
+        return capacity - (capacity >> 3);
+    }
+
+    static std::size_t capacity_for(std::size_t count) noexcept {
+        std::size_t capacity = 16;
+        while (growth_limit(capacity) < count) { capacity <<= 1; }
+        return capacity;
+    }
+
     static std::size_t max_size(const alloc_type& al) noexcept {
-        return (std::allocator_traits<alloc_type>::max_size(al) * sizeof(data_t) - offsetof(data_t, hashtbl)) /
-               sizeof(list_links_t*);
+        return growth_limit((std::allocator_traits<alloc_type>::max_size(al) * sizeof(data_t) -
+                             offsetof(index_t, slots) - ctrl_tail_size) /
+                            (sizeof(slot_t) + 1));
     }
 
-    static std::size_t get_alloc_sz(std::size_t bucket_count) noexcept {
-        return (offsetof(data_t, hashtbl) + bucket_count * sizeof(list_links_t*) + sizeof(data_t) - 1) / sizeof(data_t);
+    static std::size_t max_arena_size(const alloc_type& al) noexcept {
+        return std::min<std::size_t>(
+            (std::allocator_traits<alloc_type>::max_size(al) * sizeof(data_t) - offsetof(data_t, arena)) /
+                sizeof(node_t),
+            std::numeric_limits<std::uint32_t>::max() >> 1);
     }
 
-    UXS_NODISCARD UXS_EXPORT static data_t* alloc(alloc_type& al, std::size_t bucket_count);
+    static std::size_t get_alloc_sz(std::size_t arena_size) noexcept {
+        return (offsetof(data_t, arena) + arena_size * sizeof(node_t) + sizeof(data_t) - 1) / sizeof(data_t);
+    }
+
+    static std::size_t get_index_alloc_sz(std::size_t capacity) noexcept {
+        return (offsetof(index_t, slots) + capacity * (sizeof(slot_t) + 1) + ctrl_tail_size + sizeof(index_t) - 1) /
+               sizeof(index_t);
+    }
+
+    UXS_NODISCARD UXS_EXPORT static data_t* alloc(alloc_type& al, std::size_t arena_size);
+    UXS_NODISCARD UXS_EXPORT static index_t* alloc_index(alloc_type& al, std::size_t capacity);
 
-    static void dealloc(alloc_type& al, data_t* rec) noexcept { al.deallocate(rec, get_alloc_sz(rec->bucket_count)); }
+    static void dealloc(alloc_type& al, data_t* rec) noexcept { al.deallocate(rec, get_alloc_sz(rec->arena_size)); }
+
+    static void dealloc_index(alloc_type& al, index_t* index) noexcept {
+        index_alloc_type index_al(al);
+        index_al.deallocate(index, get_index_alloc_sz(index->capacity));
+    }
 };
 
 template<typename CharT, typename Alloc>
 template<typename RandIt>
 void record_t<CharT, Alloc>::insert_impl(alloc_type& al, RandIt first, RandIt last,
                                          std::true_type /* random access iterator */) {
-    const std::size_t count = static_cast<std::size_t>(last - first);
-    if (p_->bucket_count - p_->size < count) { rehash(al, count); }
-    typename node_t::alloc_type node_al(al);
+    reserve(al, static_cast<std::size_t>(last - first));
     for (; first != last; ++first) {
-        const auto key = std::get<0>(*first);
-        node_t* node = node_t::create(node_al, key, std::get<1>(*first));
-        insert_node(node, hasher_t{}(key));
+        const key_ref_t ref = make_key(key_type(std::get<0>(*first)), has_key_pool_t());
+        insert_node(new_node(al, ref, std::get<1>(*first)));
     }
 }
 
@@ -596,12 +824,10 @@ template<typename CharT, typename Alloc>
 template<typename InputIt>
 void record_t<CharT, Alloc>::insert_impl(alloc_type& al, InputIt first, InputIt last,
                                          std::false_type /* random access iterator */) {
-    typename node_t::alloc_type node_al(al);
     for (; first != last; ++first) {
-        if (p_->size == p_->bucket_count) { rehash(al, 1); }
-        const auto key = std::get<0>(*first);
-        node_t* node = node_t::create(node_al, key, std::get<1>(*first));
-        insert_node(node, hasher_t{}(key));
+        reserve(al, 1);
+        const key_ref_t ref = make_key(key_type(std::get<0>(*first)), has_key_pool_t());
+        insert_node(new_node(al, ref, std::get<1>(*first)));
     }
 }
 
@@ -770,97 +996,95 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
     using reference = iterator;
     using const_reference = const_iterator;
 
-    basic_value() noexcept(std::is_nothrow_default_constructible<alloc_type>::value)
-        : alloc_type(), type_(dtype::null) {}
-    basic_value(std::nullptr_t) noexcept(std::is_nothrow_default_constructible<alloc_type>::value)
-        : alloc_type(), type_(dtype::null) {}
-    basic_value(string_variant_t) noexcept(std::is_nothrow_default_constructible<alloc_type>::value)
-        : alloc_type(), type_(dtype::string) {
-        value_.str.construct();
+    basic_value() noexcept(std::is_nothrow_default_constructible<alloc_type>::value) : alloc_type() {
+        cell_.type = dtype::null;
     }
-    basic_value(array_variant_t) noexcept(std::is_nothrow_default_constructible<alloc_type>::value)
-        : alloc_type(), type_(dtype::array) {
-        value_.arr.construct();
+    basic_value(std::nullptr_t) noexcept(std::is_nothrow_default_constructible<alloc_type>::value) : alloc_type() {
+        cell_.type = dtype::null;
     }
-    basic_value(record_variant_t) : alloc_type(), type_(dtype::record) {
-        typename record_t::alloc_type rec_al(*this);
-        value_.rec.construct(rec_al);
+    basic_value(string_variant_t) noexcept(std::is_nothrow_default_constructible<alloc_type>::value) : alloc_type() {
+        init_short_string();
     }
-    basic_value(std::basic_string_view<char_type> s) : alloc_type(), type_(dtype::string) {
-        typename char_array_t::alloc_type str_al(*this);
-        value_.str.construct(str_al, s);
+    basic_value(array_variant_t) noexcept(std::is_nothrow_default_constructible<alloc_type>::value) : alloc_type() {
+        cell_.type = dtype::array;
+        cell_.value.arr.construct();
     }
+    basic_value(record_variant_t) : alloc_type() {
+        cell_.type = dtype::record;
+        typename record_t::alloc_type rec_al(*this);
+        cell_.value.rec.construct(rec_al);
+    }
+    basic_value(std::basic_string_view<char_type> s) : alloc_type() { init_string(s); }
     basic_value(const char_type* cstr) : basic_value(std::basic_string_view<char_type>(cstr)) {}
 
-    explicit basic_value(const Alloc& al) noexcept : alloc_type(al), type_(dtype::null) {}
-    basic_value(std::nullptr_t, const Alloc& al) noexcept : alloc_type(al), type_(dtype::null) {}
-    basic_value(string_variant_t, const Alloc& al) noexcept : alloc_type(al), type_(dtype::string) {
-        value_.str.construct();
+    explicit basic_value(const Alloc& al) noexcept : alloc_type(al) { cell_.type = dtype::null; }
+    basic_value(std::nullptr_t, const Alloc& al) noexcept : alloc_type(al) { cell_.type = dtype::null; }
+    basic_value(string_variant_t, const Alloc& al) noexcept : alloc_type(al) { init_short_string(); }
+    basic_value(array_variant_t, const Alloc& al) noexcept : alloc_type(al) {
+        cell_.type = dtype::array;
+        cell_.value.arr.construct();
     }
-    basic_value(array_variant_t, const Alloc& al) noexcept : alloc_type(al), type_(dtype::array) {
-        value_.arr.construct();
-    }
-    basic_value(record_variant_t, const Alloc& al) : alloc_type(al), type_(dtype::record) {
+    basic_value(record_variant_t, const Alloc& al) : alloc_type(al) {
+        cell_.type = dtype::record;
         typename record_t::alloc_type rec_al(*this);
-        value_.rec.construct(rec_al);
-    }
-    basic_value(std::basic_string_view<char_type> s, const Alloc& al) : alloc_type(al), type_(dtype::string) {
-        typename char_array_t::alloc_type str_al(*this);
-        value_.str.construct(str_al, s);
+        cell_.value.rec.construct(rec_al);
     }
+    basic_value(std::basic_string_view<char_type> s, const Alloc& al) : alloc_type(al) { init_string(s); }
     basic_value(const char_type* cstr, const Alloc& al) : basic_value(std::basic_string_view<char_type>(cstr), al) {}
 
     template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
     basic_value(InputIt first, InputIt last, const Alloc& al = Alloc())
         : basic_value(detail::select_construct_t<CharT, Alloc, InputIt>(), first, last, al) {}
     template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value>>
-    basic_value(array_variant_t, InputIt first, InputIt last, const Alloc& al = Alloc())
-        : alloc_type(al), type_(dtype::array) {
+    basic_value(array_variant_t, InputIt first, InputIt last, const Alloc& al = Alloc()) : alloc_type(al) {
+        cell_.type = dtype::array;
         typename value_array_t::alloc_type arr_al(*this);
-        value_.arr.construct(arr_al, first, last);
+        cell_.value.arr.construct(arr_al, first, last);
     }
     template<typename InputIt, typename = std::enable_if_t<is_input_iterator<InputIt>::value &&
                                                            detail::is_record_iterator<CharT, Alloc, InputIt>::value>>
-    basic_value(record_variant_t, InputIt first, InputIt last, const Alloc& al = Alloc())
-        : alloc_type(al), type_(dtype::record) {
+    basic_value(record_variant_t, InputIt first, InputIt last, const Alloc& al = Alloc()) : alloc_type(al) {
+        cell_.type = dtype::record;
         typename record_t::alloc_type rec_al(*this);
-        value_.rec.construct(rec_al, first, last);
+        cell_.value.rec.construct(rec_al, first, last);
     }
 
     UXS_EXPORT basic_value(std::initializer_list<basic_value> init, const Alloc& al = Alloc());
-    basic_value(array_variant_t, std::initializer_list<basic_value> init, const Alloc& al = Alloc())
-        : alloc_type(al), type_(dtype::array) {
+    basic_value(array_variant_t, std::initializer_list<basic_value> init, const Alloc& al = Alloc()) : alloc_type(al) {
+        cell_.type = dtype::array;
         typename value_array_t::alloc_type arr_al(al);
-        value_.arr.construct(arr_al, init);
+        cell_.value.arr.construct(arr_al, init);
     }
     basic_value(record_variant_t, std::initializer_list<std::pair<key_type, basic_value>> init,
                 const Alloc& al = Alloc())
-        : alloc_type(al), type_(dtype::record) {
+        : alloc_type(al) {
+        cell_.type = dtype::record;
         typename record_t::alloc_type rec_al(*this);
-        value_.rec.construct(rec_al, init);
+        cell_.value.rec.construct(rec_al, init);
     }
 
     template<typename Func>
-    basic_value(dtype type, const Func& func, const Alloc& al = Alloc()) : alloc_type(al), type_(type) {
-        switch (type_) {
+    basic_value(dtype type, const Func& func, const Alloc& al = Alloc()) : alloc_type(al) {
+        cell_.type = type;
+        switch (cell_.type) {
             case dtype::null: break;
-            case dtype::boolean: func(scalar_variant_t<bool>{}, (value_.b = false)); break;
-            case dtype::integer: func(scalar_variant_t<std::int32_t>{}, (value_.i = 0)); break;
-            case dtype::unsigned_integer: func(scalar_variant_t<std::uint32_t>{}, (value_.u = 0)); break;
-            case dtype::long_integer: func(scalar_variant_t<std::int64_t>{}, (value_.i64 = 0)); break;
-            case dtype::unsigned_long_integer: func(scalar_variant_t<std::uint64_t>{}, (value_.u64 = 0)); break;
-            case dtype::double_precision: func(scalar_variant_t<double>{}, (value_.dbl = 0)); break;
+            case dtype::boolean: func(scalar_variant_t<bool>{}, (cell_.value.b = false)); break;
+            case dtype::integer: func(scalar_variant_t<std::int32_t>{}, (cell_.value.i = 0)); break;
+            case dtype::unsigned_integer: func(scalar_variant_t<std::uint32_t>{}, (cell_.value.u = 0)); break;
+            case dtype::long_integer: func(scalar_variant_t<std::int64_t>{}, (cell_.value.i64 = 0)); break;
+            case dtype::unsigned_long_integer: func(scalar_variant_t<std::uint64_t>{}, (cell_.value.u64 = 0)); break;
+            case dtype::double_precision: func(scalar_variant_t<double>{}, (cell_.value.dbl = 0)); break;
             case dtype::string: {
-                value_.str.construct();
+                init_short_string();
                 func(string_variant_t{}, *this);
             } break;
             case dtype::array: {
-                value_.arr.construct();
+                cell_.value.arr.construct();
                 func(array_variant_t{}, *this);
             } break;
             case dtype::record: {
                 typename record_t::alloc_type rec_al(*this);
-                value_.rec.construct(rec_al);
+                cell_.value.rec.construct(rec_al);
                 func(record_variant_t{}, *this);
             } break;
             default: UXS_UNREACHABLE_CODE;
@@ -868,36 +1092,34 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
     }
 
     ~basic_value() {
-        if (type_ != dtype::null) { destroy(); }
+        if (cell_.type != dtype::null) { destroy(); }
     }
 
-    basic_value(const basic_value& other) noexcept(std::is_nothrow_default_constructible<alloc_type>::value)
-        : alloc_type(), type_(other.type_) {
-        init_from(other);
-    }
-    basic_value(const basic_value& other, const Alloc& al) noexcept : alloc_type(al), type_(other.type_) {
+    basic_value(const basic_value& other) noexcept
+        : alloc_type(std::allocator_traits<alloc_type>::select_on_container_copy_construction(other)) {
         init_from(other);
     }
+    basic_value(const basic_value& other, const Alloc& al) noexcept : alloc_type(al) { init_from(other); }
     basic_value& operator=(const basic_value& other) noexcept {
         if (&other == this) { return *this; }
-        if (type_ != dtype::null) { destroy(); }
-        type_ = other.type_;
+        if (cell_.type != dtype::null) { destroy(); }
         init_from(other);
         return *this;
     }
 
-    basic_value(basic_value&& other) noexcept : alloc_type(std::move(other)), type_(other.type_), value_(other.value_) {
-        other.type_ = dtype::null;
+    basic_value(basic_value&& other) noexcept : alloc_type(std::move(other)) {
+        copy_cell(other);
+        other.cell_.type = dtype::null;
     }
-    basic_value(basic_value&& other, const Alloc& al) noexcept : alloc_type(al), type_(other.type_) {
+    basic_value(basic_value&& other, const Alloc& al) noexcept : alloc_type(al) {
         move_construct_impl(std::move(other), is_alloc_always_equal<alloc_type>());
     }
     basic_value& operator=(basic_value&& other) noexcept {
         if (&other == this) { return *this; }
-        if (type_ != dtype::null) { destroy(); }
+        if (cell_.type != dtype::null) { destroy(); }
         static_cast<alloc_type&>(*this) = std::move(other);
-        type_ = other.type_, value_ = other.value_;
-        other.type_ = dtype::null;
+        copy_cell(other);
+        other.cell_.type = dtype::null;
         return *this;
     }
 
@@ -921,15 +1143,17 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
     UXS_EXPORT void assign(record_variant_t, std::initializer_list<std::pair<key_type, basic_value>> init);
 
 #define UXS_DB_VALUE_IMPLEMENT_SCALAR_INIT(ty, id, field) \
-    basic_value(ty v) noexcept(std::is_nothrow_default_constructible<alloc_type>::value) : alloc_type(), type_(id) { \
-        value_.field = static_cast<decltype(value_.field)>(v); \
+    basic_value(ty v) noexcept(std::is_nothrow_default_constructible<alloc_type>::value) : alloc_type() { \
+        cell_.type = id; \
+        cell_.value.field = static_cast<decltype(cell_.value.field)>(v); \
     } \
-    basic_value(ty v, const Alloc& al) noexcept : alloc_type(al), type_(id) { \
-        value_.field = static_cast<decltype(value_.field)>(v); \
+    basic_value(ty v, const Alloc& al) noexcept : alloc_type(al) { \
+        cell_.type = id; \
+        cell_.value.field = static_cast<decltype(cell_.value.field)>(v); \
     } \
     basic_value& operator=(ty v) noexcept { \
-        if (type_ != dtype::null) { destroy(); } \
-        type_ = id, value_.field = static_cast<decltype(value_.field)>(v); \
+        if (cell_.type != dtype::null) { destroy(); } \
+        cell_.type = id, cell_.value.field = static_cast<decltype(cell_.value.field)>(v); \
         return *this; \
     }
     UXS_DB_VALUE_IMPLEMENT_SCALAR_INIT(bool, dtype::boolean, b)
@@ -953,7 +1177,7 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
     basic_value& operator=(const char_type* cstr) { return (*this = std::basic_string_view<char_type>(cstr)); }
 
     basic_value& operator=(std::nullptr_t) noexcept {
-        if (type_ == dtype::null) { return *this; }
+        if (cell_.type == dtype::null) { return *this; }
         destroy();
         return *this;
     }
@@ -961,8 +1185,10 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
     void swap(basic_value& other) noexcept {
         if (&other == this) { return; }
         std::swap(static_cast<alloc_type&>(*this), static_cast<alloc_type&>(other));
-        std::swap(value_, other.value_);
-        std::swap(type_, other.type_);
+        cell_t tmp;
+        std::memcpy(&tmp, &cell_, sizeof(cell_));
+        copy_cell(other);
+        std::memcpy(&other.cell_, &tmp, sizeof(cell_));
     }
 
     UXS_EXPORT void string_reserve(std::size_t sz);
@@ -976,8 +1202,10 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
                                       const basic_value<CharT_, Alloc_>& rhs) noexcept;
     template<typename CharT_, typename Alloc_>
     friend bool operator!=(const basic_value<CharT_, Alloc_>& lhs, const basic_value<CharT_, Alloc_>& rhs) noexcept;
+    template<typename CharT_, typename Alloc_>
+    friend UXS_EXPORT memory_stats get_memory_stats(const basic_value<CharT_, Alloc_>& v);
 
-    dtype type() const noexcept { return type_; }
+    dtype type() const noexcept { return cell_.type; }
     allocator_type get_allocator() const noexcept { return allocator_type(*this); }
 
     template<typename Ty>
@@ -1040,19 +1268,19 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
         return it != end() ? it.value() : basic_value();
     }
 
-    bool is_null() const noexcept { return type_ == dtype::null; }
-    bool is_bool() const noexcept { return type_ == dtype::boolean; }
+    bool is_null() const noexcept { return cell_.type == dtype::null; }
+    bool is_bool() const noexcept { return cell_.type == dtype::boolean; }
     UXS_EXPORT bool is_int() const noexcept;
     UXS_EXPORT bool is_uint() const noexcept;
     UXS_EXPORT bool is_int64() const noexcept;
     UXS_EXPORT bool is_uint64() const noexcept;
     UXS_EXPORT bool is_integral() const noexcept;
     bool is_double() const noexcept { return is_numeric(); }
-    bool is_numeric() const noexcept { return type_ >= dtype::integer && type_ <= dtype::double_precision; }
-    bool is_string() const noexcept { return type_ == dtype::string; }
-    bool is_string_view() const noexcept { return type_ == dtype::string; }
-    bool is_array() const noexcept { return type_ == dtype::array; }
-    bool is_record() const noexcept { return type_ == dtype::record; }
+    bool is_numeric() const noexcept { return cell_.type >= dtype::integer && cell_.type <= dtype::double_precision; }
+    bool is_string() const noexcept { return cell_.type == dtype::string; }
+    bool is_string_view() const noexcept { return cell_.type == dtype::string; }
+    bool is_array() const noexcept { return cell_.type == dtype::array; }
+    bool is_record() const noexcept { return cell_.type == dtype::record; }
 
     bool as_bool() const;
     std::int32_t as_int() const;
@@ -1061,6 +1289,9 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
     std::uint64_t as_uint64() const;
     double as_double() const;
     std::basic_string<char_type> as_string() const;
+    // Short strings are stored inline, so the view of such a string refers to the value itself: the view is
+    // invalidated by modification, destruction or move of the value, including relocation of values by growth of
+    // the array containing it; views of longer strings are invalidated by modification or destruction only
     std::basic_string_view<char_type> as_string_view() const;
 
     UXS_EXPORT est::optional<bool> get_bool() const;
@@ -1071,7 +1302,7 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
     UXS_EXPORT est::optional<double> get_double() const;
     UXS_EXPORT est::optional<std::basic_string<char_type>> get_string() const;
     est::optional<std::basic_string_view<char_type>> get_string_view() const {
-        return type_ == dtype::string ? est::make_optional(value_.str.cview()) : est::nullopt();
+        return cell_.type == dtype::string ? est::make_optional(str_view()) : est::nullopt();
     }
 
     bool empty() const noexcept { return size() == 0; }
@@ -1134,33 +1365,46 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
         throw database_error("invalid key");
     }
 
+    // Returns the value of the first item with the key, or inserts a null item; if the record has several items with
+    // the same key (e.g. read from JSON with duplicate keys), they are found in insertion order
     basic_value& operator[](key_type key) {
         return emplace_unique(key, static_cast<const Alloc&>(*this)).first.value();
     }
 
     template<typename Func>
     auto visit(const Func& func) const -> decltype(func(nullptr)) {
-        switch (type_) {
+        switch (cell_.type) {
             case dtype::null: return func(nullptr);
-            case dtype::boolean: return func(value_.b);
-            case dtype::integer: return func(value_.i);
-            case dtype::unsigned_integer: return func(value_.u);
-            case dtype::long_integer: return func(value_.i64);
-            case dtype::unsigned_long_integer: return func(value_.u64);
-            case dtype::double_precision: return func(value_.dbl);
-            case dtype::string: return func(value_.str.cview());
-            case dtype::array: return func(value_.arr.cview());
-            case dtype::record: return func(value_.rec.crange());
+            case dtype::boolean: return func(cell_.value.b);
+            case dtype::integer: return func(cell_.value.i);
+            case dtype::unsigned_integer: return func(cell_.value.u);
+            case dtype::long_integer: return func(cell_.value.i64);
+            case dtype::unsigned_long_integer: return func(cell_.value.u64);
+            case dtype::double_precision: return func(cell_.value.dbl);
+            case dtype::string: return func(str_view());
+            case dtype::array: return func(cell_.value.arr.cview());
+            case dtype::record: return func(cell_.value.rec.crange());
             default: UXS_UNREACHABLE_CODE;
         }
     }
 
+    // Finds the first item with the key in insertion order
     UXS_EXPORT const_iterator find(key_type key) const noexcept;
     UXS_EXPORT iterator find(key_type key);
     bool contains(key_type key) const noexcept { return find(key) != end(); }
-    std::size_t count(key_type key) const noexcept { return type_ == dtype::record ? value_.rec.count(key) : 0; }
+    // Finds the first item with the key taken from a key pool, so that the key isn't hashed again; with
+    // `key_pool_allocator` items are matched by comparing entry pointers, so the entry must be of the pool of the
+    // record, e.g. returned by `find()` or `intern()` of the pool, which the document is read with
+    const_iterator find(const typename basic_key_pool<CharT>::entry& key) const noexcept {
+        return cell_.type == dtype::record ? const_iterator(cell_.value.rec.find(key)) : end();
+    }
+    bool contains(const typename basic_key_pool<CharT>::entry& key) const noexcept { return find(key) != end(); }
+    std::size_t count(key_type key) const noexcept {
+        return cell_.type == dtype::record ? cell_.value.rec.count(key) : 0;
+    }
 
     UXS_EXPORT void clear();
+    // Reserves space for `sz` items of array or record; other values are converted to empty arrays
     UXS_EXPORT void reserve(std::size_t sz);
     UXS_EXPORT void resize(std::size_t sz);
     UXS_EXPORT void resize(std::size_t sz, const basic_value& v);
@@ -1202,9 +1446,7 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
  private:
     friend class detail::record_t<CharT, Alloc>;
 
-    dtype type_;
-
-    union {
+    union payload_t {
         bool b;
         std::int32_t i;
         std::uint32_t u;
@@ -1214,7 +1456,37 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
         char_array_t str;
         value_array_t arr;
         record_t rec;
-    } value_;
+    };
+
+    enum : std::uint8_t { long_string = 0xff };
+
+    struct cell_t {
+        dtype type;
+        std::uint8_t short_size;  // `long_string` if string characters are allocated
+        payload_t value;
+    };
+
+    enum : std::size_t {
+        short_string_offset = (2 + alignof(CharT) - 1) & ~(alignof(CharT) - 1),
+        short_string_capacity = (sizeof(cell_t) - short_string_offset) / sizeof(CharT),
+    };
+
+    struct short_string_t {
+        dtype type;
+        std::uint8_t size;
+        char_type chars[short_string_capacity];
+    };
+
+    // Value cell: the type tag and the short string size are the common initial sequence of both
+    // representations; scalars are stored unboxed, strings of up to `short_string_capacity` characters are
+    // stored inline, longer strings, arrays and records refer to shared data; with an empty allocator the
+    // value takes 16 bytes on 64-bit targets (14 inline characters for `char`) and no more on 32-bit ones
+    union {
+        cell_t cell_;
+        short_string_t sstr_;
+    };
+
+    static_assert(sizeof(short_string_t) <= sizeof(cell_t), "short string doesn't fit in value cell");
 
     UXS_EXPORT void init_from(const basic_value& other) noexcept;
     UXS_EXPORT void destroy() noexcept;
@@ -1223,15 +1495,43 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
     UXS_EXPORT void init_as_record();
     UXS_EXPORT void convert_to_array();
 
+    bool is_short_string() const noexcept { return cell_.short_size != long_string; }
+
+    std::basic_string_view<char_type> str_view() const noexcept {
+        return is_short_string() ? std::basic_string_view<char_type>(sstr_.chars, sstr_.size) : cell_.value.str.cview();
+    }
+
+    void copy_cell(const basic_value& other) noexcept { std::memcpy(&cell_, &other.cell_, sizeof(cell_)); }
+
+    void init_short_string() noexcept {
+        sstr_.type = dtype::string;
+        sstr_.size = 0;
+    }
+
+    void init_string(std::basic_string_view<char_type> s) {
+        if (s.size() <= short_string_capacity) {
+            sstr_.type = dtype::string;
+            sstr_.size = static_cast<std::uint8_t>(s.size());
+            std::copy_n(s.data(), s.size(), sstr_.chars);
+            return;
+        }
+        typename char_array_t::alloc_type str_al(*this);
+        cell_.value.str.construct(str_al, s);
+        cell_.type = dtype::string;
+        cell_.short_size = long_string;
+    }
+
+    UXS_EXPORT void convert_to_long_string(std::size_t cap, std::basic_string_view<char_type> tail);
+
     void move_construct_impl(basic_value&& other, std::true_type) noexcept {
-        type_ = other.type_, value_ = other.value_;
-        other.type_ = dtype::null;
+        copy_cell(other);
+        other.cell_.type = dtype::null;
     }
 
     void move_construct_impl(basic_value&& other, std::false_type) noexcept {
         if (static_cast<alloc_type&>(*this) == static_cast<alloc_type&>(other)) {
-            type_ = other.type_, value_ = other.value_;
-            other.type_ = dtype::null;
+            copy_cell(other);
+            other.cell_.type = dtype::null;
         } else {
             init_from(other);
         }
@@ -1243,121 +1543,128 @@ class basic_value : protected std::allocator_traits<Alloc>::template rebind_allo
 template<typename CharT, typename Alloc>
 template<typename InputIt, typename>
 void basic_value<CharT, Alloc>::assign(array_variant_t, InputIt first, InputIt last) {
-    if (type_ != dtype::array) {
-        if (type_ != dtype::null) { destroy(); }
-        value_.arr.construct();
-        type_ = dtype::array;
+    if (cell_.type != dtype::array) {
+        if (cell_.type != dtype::null) { destroy(); }
+        cell_.value.arr.construct();
+        cell_.type = dtype::array;
     }
     typename value_array_t::alloc_type arr_al(*this);
-    value_.arr.assign(arr_al, first, last);
+    cell_.value.arr.assign(arr_al, first, last);
 }
 
 template<typename CharT, typename Alloc>
 template<typename InputIt, typename>
 void basic_value<CharT, Alloc>::assign(record_variant_t, InputIt first, InputIt last) {
     typename record_t::alloc_type rec_al(*this);
-    if (type_ != dtype::record) {
-        if (type_ != dtype::null) { destroy(); }
-        value_.rec.construct(rec_al, detail::initial_alloc_size(first, last, is_random_access_iterator<InputIt>()));
-        type_ = dtype::record;
+    if (cell_.type != dtype::record) {
+        if (cell_.type != dtype::null) { destroy(); }
+        cell_.value.rec.construct(rec_al,
+                                  detail::initial_alloc_size(first, last, is_random_access_iterator<InputIt>()));
+        cell_.type = dtype::record;
     }
-    value_.rec.assign(rec_al, first, last);
+    cell_.value.rec.assign(rec_al, first, last);
 }
 
 template<typename CharT, typename Alloc>
 template<typename... Args>
 basic_value<CharT, Alloc>& basic_value<CharT, Alloc>::emplace_back(Args&&... args) {
-    if (type_ != dtype::array) { convert_to_array(); }
+    if (cell_.type != dtype::array) { convert_to_array(); }
     typename value_array_t::alloc_type arr_al(*this);
-    return value_.arr.emplace_back(arr_al, std::forward<Args>(args)...);
+    return cell_.value.arr.emplace_back(arr_al, std::forward<Args>(args)...);
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::pop_back() {
-    if (type_ != dtype::array) { throw database_error("not an array"); }
+    if (cell_.type != dtype::array) { throw database_error("not an array"); }
     typename value_array_t::alloc_type arr_al(*this);
-    value_.arr.pop_back(arr_al);
+    cell_.value.arr.pop_back(arr_al);
 }
 
 template<typename CharT, typename Alloc>
 template<typename... Args>
 auto basic_value<CharT, Alloc>::emplace(std::size_t pos, Args&&... args) -> iterator {
-    if (type_ != dtype::array) { init_as_array(); }
+    if (cell_.type != dtype::array) { init_as_array(); }
     typename value_array_t::alloc_type arr_al(*this);
-    basic_value& item = value_.arr.emplace(arr_al, pos, std::forward<Args>(args)...);
-    return iterator(&item, value_.arr.cbegin(), value_.arr.cend());
+    basic_value& item = cell_.value.arr.emplace(arr_al, pos, std::forward<Args>(args)...);
+    return iterator(&item, cell_.value.arr.cbegin(), cell_.value.arr.cend());
 }
 
 template<typename CharT, typename Alloc>
 template<typename... Args>
 auto basic_value<CharT, Alloc>::emplace(key_type key, Args&&... args) -> iterator {
-    if (type_ != dtype::record) { init_as_record(); }
+    if (cell_.type != dtype::record) { init_as_record(); }
     typename record_t::alloc_type rec_al(*this);
-    return iterator(value_.rec.emplace(rec_al, key, std::forward<Args>(args)...));
+    return iterator(cell_.value.rec.emplace(rec_al, key, std::forward<Args>(args)...));
 }
 
 template<typename CharT, typename Alloc>
 template<typename... Args>
 auto basic_value<CharT, Alloc>::emplace_unique(key_type key, Args&&... args) -> std::pair<iterator, bool> {
-    if (type_ != dtype::record) { init_as_record(); }
+    if (cell_.type != dtype::record) { init_as_record(); }
     typename record_t::alloc_type rec_al(*this);
-    const auto result = value_.rec.emplace_unique(rec_al, key, std::forward<Args>(args)...);
+    const auto result = cell_.value.rec.emplace_unique(rec_al, key, std::forward<Args>(args)...);
     return std::make_pair(iterator(result.first), result.second);
 }
 
 template<typename CharT, typename Alloc>
 template<typename InputIt, typename>
 void basic_value<CharT, Alloc>::insert(std::size_t pos, InputIt first, InputIt last) {
-    if (type_ != dtype::array) { init_as_array(); }
+    if (cell_.type != dtype::array) { init_as_array(); }
     typename value_array_t::alloc_type arr_al(*this);
-    value_.arr.insert(arr_al, pos, first, last);
+    cell_.value.arr.insert(arr_al, pos, first, last);
 }
 
 template<typename CharT, typename Alloc>
 template<typename InputIt, typename>
 void basic_value<CharT, Alloc>::insert(InputIt first, InputIt last) {
     typename record_t::alloc_type rec_al(*this);
-    if (type_ != dtype::record) {
-        if (type_ != dtype::null) { throw database_error("not a record"); }
-        value_.rec.construct(rec_al, detail::initial_alloc_size(first, last, is_random_access_iterator<InputIt>()));
-        type_ = dtype::record;
+    if (cell_.type != dtype::record) {
+        if (cell_.type != dtype::null) { throw database_error("not a record"); }
+        cell_.value.rec.construct(rec_al,
+                                  detail::initial_alloc_size(first, last, is_random_access_iterator<InputIt>()));
+        cell_.type = dtype::record;
     }
-    value_.rec.insert(rec_al, first, last);
+    cell_.value.rec.insert(rec_al, first, last);
 }
 
 // --------------------------
 
 template<typename CharT, typename Alloc>
 est::span<typename basic_value<CharT, Alloc>::char_type> basic_value<CharT, Alloc>::as_string_span() {
-    if (type_ != dtype::string) { throw database_error("not a string"); }
+    if (cell_.type != dtype::string) { throw database_error("not a string"); }
+    if (is_short_string()) { return est::span<char_type>(sstr_.chars, sstr_.size); }
     typename char_array_t::alloc_type str_al(*this);
-    return value_.str.view(str_al);
+    return cell_.value.str.view(str_al);
 }
 
 template<typename CharT, typename Alloc>
 est::span<const basic_value<CharT, Alloc>> basic_value<CharT, Alloc>::as_array() const noexcept {
-    if (type_ != dtype::array) { return type_ != dtype::null ? est::as_span(this, 1) : est::span<basic_value>(); }
-    return value_.arr.cview();
+    if (cell_.type != dtype::array) {
+        return cell_.type != dtype::null ? est::as_span(this, 1) : est::span<basic_value>();
+    }
+    return cell_.value.arr.cview();
 }
 
 template<typename CharT, typename Alloc>
 est::span<basic_value<CharT, Alloc>> basic_value<CharT, Alloc>::as_array() {
-    if (type_ != dtype::array) { return type_ != dtype::null ? est::as_span(this, 1) : est::span<basic_value>(); }
+    if (cell_.type != dtype::array) {
+        return cell_.type != dtype::null ? est::as_span(this, 1) : est::span<basic_value>();
+    }
     typename value_array_t::alloc_type arr_al(*this);
-    return value_.arr.view(arr_al);
+    return cell_.value.arr.view(arr_al);
 }
 
 template<typename CharT, typename Alloc>
 auto basic_value<CharT, Alloc>::as_record() const -> iterator_range<const_record_iterator> {
-    if (type_ != dtype::record) { throw database_error("not a record"); }
-    return value_.rec.crange();
+    if (cell_.type != dtype::record) { throw database_error("not a record"); }
+    return cell_.value.rec.crange();
 }
 
 template<typename CharT, typename Alloc>
 auto basic_value<CharT, Alloc>::as_record() -> iterator_range<record_iterator> {
-    if (type_ != dtype::record) { throw database_error("not a record"); }
+    if (cell_.type != dtype::record) { throw database_error("not a record"); }
     typename record_t::alloc_type rec_al(*this);
-    return value_.rec.range(rec_al);
+    return cell_.value.rec.range(rec_al);
 }
 
 // --------------------------
@@ -1438,6 +1745,10 @@ bool operator!=(const basic_value<CharT, Alloc>& lhs, const basic_value<CharT, A
     return !(lhs == rhs);
 }
 
+// Walks the value tree and reports its node count and allocated memory by category
+template<typename CharT, typename Alloc>
+UXS_EXPORT memory_stats get_memory_stats(const basic_value<CharT, Alloc>& v);
+
 // --------------------------
 
 template<typename CharT = char, typename Alloc = std::allocator<CharT>>
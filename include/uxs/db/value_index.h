@@ -0,0 +1,312 @@
+#pragma once
+
+#include "value.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace uxs {
+namespace db {
+
+namespace detail {
+
+template<typename CharT, typename Alloc>
+bool is_big_unsigned(const basic_value<CharT, Alloc>& v) noexcept {
+    return v.type() == dtype::unsigned_long_integer &&
+           v.as_uint64() > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+}
+
+template<typename Ty>
+int compare_keys(const Ty& lhs, const Ty& rhs) noexcept {
+    return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+}
+
+// Spreads sequential numbers over the table: standard hashes of integers are often identity functions
+inline std::size_t mix_hash(std::uint64_t x) noexcept {
+    x *= 0x9e3779b97f4a7c15ull;
+    return static_cast<std::size_t>(x ^ (x >> 32));
+}
+
+// Hash code consistent with `operator==`: integers of different types with equal values have equal hash codes
+template<typename CharT, typename Alloc>
+std::size_t index_key_hash(const basic_value<CharT, Alloc>& v) noexcept {
+    switch (v.type()) {
+        case dtype::null: return 0;
+        case dtype::boolean: return v.as_bool() ? 1 : 2;
+        case dtype::integer:
+        case dtype::unsigned_integer:
+        case dtype::long_integer:
+        case dtype::unsigned_long_integer: {
+            return mix_hash(is_big_unsigned(v) ? v.as_uint64() : static_cast<std::uint64_t>(v.as_int64()));
+        } break;
+        case dtype::double_precision: return mix_hash(std::hash<double>{}(v.as_double()));
+        case dtype::string: return std::hash<std::basic_string_view<CharT>>{}(v.as_string_view());
+        default: return 0;
+    }
+}
+
+// Strict weak ordering of scalar keys: null < booleans < numbers < strings; integers are compared exactly, an
+// integer goes before a double with the same value, NaN-s go after all numbers
+template<typename CharT, typename Alloc>
+int compare_index_keys(const basic_value<CharT, Alloc>& lhs, const basic_value<CharT, Alloc>& rhs) noexcept {
+    const auto rank = [](const basic_value<CharT, Alloc>& v) {
+        return v.is_null() ? 0 : v.is_bool() ? 1 : v.is_numeric() ? 2 : 3;
+    };
+    const int lhs_rank = rank(lhs), rhs_rank = rank(rhs);
+    if (lhs_rank != rhs_rank) { return lhs_rank < rhs_rank ? -1 : 1; }
+    switch (lhs_rank) {
+        case 0: return 0;
+        case 1: return compare_keys(lhs.as_bool(), rhs.as_bool());
+        case 3: return compare_keys(lhs.as_string_view(), rhs.as_string_view());
+        default: break;
+    }
+    const bool lhs_is_dbl = lhs.type() == dtype::double_precision;
+    const bool rhs_is_dbl = rhs.type() == dtype::double_precision;
+    if (!lhs_is_dbl && !rhs_is_dbl) {
+        const bool lhs_big = is_big_unsigned(lhs), rhs_big = is_big_unsigned(rhs);
+        if (lhs_big || rhs_big) {
+            return lhs_big && rhs_big ? compare_keys(lhs.as_uint64(), rhs.as_uint64()) : (lhs_big ? 1 : -1);
+        }
+        return compare_keys(lhs.as_int64(), rhs.as_int64());
+    }
+    const double lhs_dbl = lhs.as_double(), rhs_dbl = rhs.as_double();
+    const bool lhs_nan = std::isnan(lhs_dbl), rhs_nan = std::isnan(rhs_dbl);
+    if (lhs_nan || rhs_nan) { return compare_keys(lhs_nan, rhs_nan); }
+    if (const int result = compare_keys(lhs_dbl, rhs_dbl)) { return result; }
+    return compare_keys(lhs_is_dbl, rhs_is_dbl);
+}
+
+template<typename CharT, typename Alloc>
+class array_index_base {
+ public:
+    using value_type = basic_value<CharT, Alloc>;
+    using key_type = std::basic_string_view<CharT>;
+    using result_type = est::span<const value_type* const>;
+
+    // Returns `true` if `arr` is not the indexed array or it has been modified since the index was built
+    bool is_stale(const value_type& arr) const noexcept {
+        return !arr.is_array() || arr.as_array().data() != snapshot_.as_array().data();
+    }
+
+    // The indexed array as it was when the index was built
+    const value_type& snapshot() const noexcept { return snapshot_; }
+
+ protected:
+    value_type snapshot_;
+    std::vector<std::basic_string<CharT>> path_;
+
+    array_index_base(const value_type& arr, std::initializer_list<key_type> path)
+        : snapshot_(arr), path_(path.begin(), path.end()) {
+        if (!arr.is_array()) { throw database_error("not an array"); }
+        if (path_.empty()) { throw database_error("empty key path"); }
+    }
+
+    // Returns the scalar value at the key path, or `nullptr` if there is no such value
+    const value_type* key_of(const value_type& item) const noexcept {
+        const value_type* v = &item;
+        for (const auto& key : path_) {
+            const auto it = v->find(key);
+            if (it == v->end()) { return nullptr; }
+            v = &it.value();
+        }
+        return v->is_array() || v->is_record() ? nullptr : v;
+    }
+};
+
+}  // namespace detail
+
+//-----------------------------------------------------------------------------
+// Secondary indexes over an array of records by the value at a key path: elements, which have no scalar value
+// at the path, are not indexed; an index shares the array data with the source value, so references returned by
+// queries stay valid as long as the index exists, and any modification of the source array makes it copy its data
+// first, which is detected with `is_stale()`; while an index is alive, access the source array through a const
+// reference to avoid such copying
+
+// Hash index: equality lookups in O(1), elements with equal keys are returned in array order
+template<typename CharT, typename Alloc = std::allocator<CharT>>
+class basic_hash_index : public detail::array_index_base<CharT, Alloc> {
+ private:
+    using super = detail::array_index_base<CharT, Alloc>;
+
+ public:
+    using value_type = typename super::value_type;
+    using key_type = typename super::key_type;
+    using result_type = typename super::result_type;
+
+    basic_hash_index(const value_type& arr, key_type key) : basic_hash_index(arr, {key}) {}
+    basic_hash_index(const value_type& arr, std::initializer_list<key_type> path) : super(arr, path) { build(); }
+
+    std::size_t size() const noexcept { return items_.size(); }
+
+    result_type equal_range(const value_type& key) const noexcept {
+        const std::size_t n = find_group(key, detail::index_key_hash(key));
+        return n != npos ? result_type(items_.data() + groups_[n].first, groups_[n].count) : result_type();
+    }
+
+    const value_type* find(const value_type& key) const noexcept {
+        const auto range = equal_range(key);
+        return !range.empty() ? range[0] : nullptr;
+    }
+
+    std::size_t count(const value_type& key) const noexcept { return equal_range(key).size(); }
+
+ private:
+    enum : std::size_t { npos = ~std::size_t(0) };
+
+    struct group_t {
+        std::size_t hash_code;
+        const value_type* key;
+        std::size_t first;
+        std::size_t count;
+    };
+
+    std::vector<group_t> groups_;
+    std::vector<std::size_t> tbl_;
+    std::vector<const value_type*> items_;
+
+    std::size_t find_group(const value_type& key, std::size_t hash_code) const noexcept {
+        if (tbl_.empty()) { return npos; }
+        const std::size_t mask = tbl_.size() - 1;
+        for (std::size_t pos = hash_code & mask;; pos = (pos + 1) & mask) {
+            const std::size_t n = tbl_[pos];
+            if (n == npos || (groups_[n].hash_code == hash_code && *groups_[n].key == key)) { return n; }
+        }
+    }
+
+    void rehash() {
+        std::vector<std::size_t> tbl(tbl_.empty() ? 64 : 2 * tbl_.size(), npos);
+        const std::size_t mask = tbl.size() - 1;
+        for (std::size_t n = 0; n < groups_.size(); ++n) {
+            std::size_t pos = groups_[n].hash_code & mask;
+            while (tbl[pos] != npos) { pos = (pos + 1) & mask; }
+            tbl[pos] = n;
+        }
+        tbl_.swap(tbl);
+    }
+
+    void build();
+};
+
+template<typename CharT, typename Alloc>
+void basic_hash_index<CharT, Alloc>::build() {
+    const auto arr = this->snapshot().as_array();
+    std::vector<std::size_t> group_of(arr.size(), npos);
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < arr.size(); ++i) {
+        const value_type* key = this->key_of(arr[i]);
+        if (!key) { continue; }
+        const std::size_t hash_code = detail::index_key_hash(*key);
+        std::size_t n = find_group(*key, hash_code);
+        if (n == npos) {
+            if (2 * (groups_.size() + 1) > tbl_.size()) { rehash(); }
+            const std::size_t mask = tbl_.size() - 1;
+            std::size_t pos = hash_code & mask;
+            while (tbl_[pos] != npos) { pos = (pos + 1) & mask; }
+            n = tbl_[pos] = groups_.size();
+            groups_.push_back(group_t{hash_code, key, 0, 0});
+        }
+        ++groups_[n].count, ++total;
+        group_of[i] = n;
+    }
+
+    // place elements of each group contiguously
+    std::size_t first = 0;
+    for (group_t& group : groups_) { group.first = first, first += group.count, group.count = 0; }
+    items_.resize(total);
+    for (std::size_t i = 0; i < arr.size(); ++i) {
+        if (group_of[i] == npos) { continue; }
+        group_t& group = groups_[group_of[i]];
+        items_[group.first + group.count++] = &arr[i];
+    }
+}
+
+// Sorted index: equality and range lookups in O(log n), elements with equal keys are returned in array order
+template<typename CharT, typename Alloc = std::allocator<CharT>>
+class basic_sorted_index : public detail::array_index_base<CharT, Alloc> {
+ private:
+    using super = detail::array_index_base<CharT, Alloc>;
+
+ public:
+    using value_type = typename super::value_type;
+    using key_type = typename super::key_type;
+    using result_type = typename super::result_type;
+
+    basic_sorted_index(const value_type& arr, key_type key) : basic_sorted_index(arr, {key}) {}
+    basic_sorted_index(const value_type& arr, std::initializer_list<key_type> path) : super(arr, path) { build(); }
+
+    std::size_t size() const noexcept { return items_.size(); }
+
+    // All indexed elements in key order
+    result_type items() const noexcept { return est::as_span(items_); }
+
+    result_type equal_range(const value_type& key) const noexcept { return range(lower_bound(key), upper_bound(key)); }
+
+    const value_type* find(const value_type& key) const noexcept {
+        const auto range = equal_range(key);
+        return !range.empty() ? range[0] : nullptr;
+    }
+
+    std::size_t count(const value_type& key) const noexcept { return equal_range(key).size(); }
+
+    // Elements with keys in [lo, hi)
+    result_type range(const value_type& lo, const value_type& hi) const noexcept {
+        const std::size_t first = lower_bound(lo);
+        return range(first, std::max(first, lower_bound(hi)));
+    }
+
+ private:
+    std::vector<const value_type*> keys_;
+    std::vector<const value_type*> items_;
+
+    result_type range(std::size_t first, std::size_t last) const noexcept {
+        return result_type(items_.data() + first, last - first);
+    }
+
+    std::size_t lower_bound(const value_type& key) const noexcept {
+        return static_cast<std::size_t>(
+            std::lower_bound(keys_.begin(), keys_.end(), &key,
+                             [](const value_type* lhs, const value_type* rhs) {
+                                 return detail::compare_index_keys(*lhs, *rhs) < 0;
+                             }) -
+            keys_.begin());
+    }
+
+    std::size_t upper_bound(const value_type& key) const noexcept {
+        return static_cast<std::size_t>(
+            std::upper_bound(keys_.begin(), keys_.end(), &key,
+                             [](const value_type* lhs, const value_type* rhs) {
+                                 return detail::compare_index_keys(*lhs, *rhs) < 0;
+                             }) -
+            keys_.begin());
+    }
+
+    void build();
+};
+
+template<typename CharT, typename Alloc>
+void basic_sorted_index<CharT, Alloc>::build() {
+    const auto arr = this->snapshot().as_array();
+    std::vector<std::pair<const value_type*, const value_type*>> entries;
+    entries.reserve(arr.size());
+    for (const value_type& item : arr) {
+        if (const value_type* key = this->key_of(item)) { entries.emplace_back(key, &item); }
+    }
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const std::pair<const value_type*, const value_type*>& lhs,
+                        const std::pair<const value_type*, const value_type*>& rhs) {
+                         return detail::compare_index_keys(*lhs.first, *rhs.first) < 0;
+                     });
+    keys_.reserve(entries.size());
+    items_.reserve(entries.size());
+    for (const auto& entry : entries) { keys_.push_back(entry.first), items_.push_back(entry.second); }
+}
+
+using hash_index = basic_hash_index<char>;
+using whash_index = basic_hash_index<wchar_t>;
+using sorted_index = basic_sorted_index<char>;
+using wsorted_index = basic_sorted_index<wchar_t>;
+
+}  // namespace db
+}  // namespace uxs
@@ -4,57 +4,284 @@
 #    error Header file `db/value_serialize.h` requires C++17
 #endif  // __cplusplus < 201703L
 
+#include "parallel_write.h"
 #include "value.h"
 
+#include "uxs/io/oflatbuf.h"
 #include "uxs/io/serialize.h"
+#include "uxs/string_cvt.h"
+
+#include <algorithm>
+#include <cstring>
 
 namespace uxs {
+namespace db {
+namespace detail {
 
-template<typename CharT, typename Alloc>
-biobuf& operator<<(biobuf& os, const db::basic_value<CharT, Alloc>& v) {
-    os << v.type();
-    return v.visit([&os, &v](auto x) -> biobuf& {
-        if constexpr (std::is_same_v<decltype(x), decltype(v.as_string_view())>) {
-            os << static_cast<std::uint64_t>(x.size());
-            return os.write_with_endian(
-                est::as_span(reinterpret_cast<const std::uint8_t*>(x.data()), x.size() * sizeof(CharT)), sizeof(CharT));
-        } else if constexpr (std::is_same_v<decltype(x), decltype(v.as_array())>) {
-            os << static_cast<std::uint64_t>(x.size());
-            for (const auto& el : x) { os << el; }
-        } else if constexpr (std::is_same_v<decltype(x), decltype(v.as_record())>) {
-            os << static_cast<std::uint64_t>(v.size());
-            for (const auto& [key, value] : x) { os << key << value; }
-        } else if constexpr (!std::is_same_v<decltype(x), std::nullptr_t>) {
-            os << x;
+// Stream format: 32-bit type tag, then the value: scalars in their native size, strings and containers as 64-bit
+// size followed by characters or items; record items are keys written as strings followed by values
+
+// Type tag keeps the size of `int`, which `dtype` was based on, so the stream format is not changed
+using type_tag_t = std::int32_t;
+
+inline void put_type(biobuf& os, dtype type) { os << static_cast<type_tag_t>(type); }
+
+template<typename Ty>
+void put_scalar(biobuf& os, dtype type, Ty v) {
+    // type and value are copied directly to the buffer, if there is enough room
+    if (os.avail() >= sizeof(type_tag_t) + sizeof(Ty)) {
+        const type_tag_t tag = static_cast<type_tag_t>(type);
+        std::uint8_t* p = os.curr();
+        std::memcpy(p, &tag, sizeof(tag));
+        std::memcpy(p + sizeof(tag), &v, sizeof(Ty));
+        if (!!(os.mode() & iomode::invert_endian)) {
+            std::reverse(p, p + sizeof(tag));
+            std::reverse(p + sizeof(tag), p + sizeof(tag) + sizeof(Ty));
         }
-        return os;
+        os.advance(sizeof(tag) + sizeof(Ty));
+        return;
+    }
+    os << static_cast<type_tag_t>(type) << v;
+}
+
+template<typename Ty>
+bool get_scalar(bibuf& is, Ty& v) {
+    if (is.avail() >= sizeof(Ty)) {
+        std::uint8_t* p = reinterpret_cast<std::uint8_t*>(&v);
+        std::memcpy(p, is.curr(), sizeof(Ty));
+        if (!!(is.mode() & iomode::invert_endian)) { std::reverse(p, p + sizeof(Ty)); }
+        is.advance(sizeof(Ty));
+        return true;
+    }
+    return !!(is >> v);
+}
+
+template<typename CharT>
+void put_string(biobuf& os, std::basic_string_view<CharT> s) {
+    put_scalar(os, dtype::string, static_cast<std::uint64_t>(s.size()));
+    os.write_with_endian(est::as_span(reinterpret_cast<const std::uint8_t*>(s.data()), s.size() * sizeof(CharT)),
+                         sizeof(CharT));
+}
+
+template<typename CharT>
+void put_key(biobuf& os, std::basic_string_view<CharT> key) {
+    // keys are written without type byte
+    os << static_cast<std::uint64_t>(key.size());
+    os.write_with_endian(est::as_span(reinterpret_cast<const std::uint8_t*>(key.data()), key.size() * sizeof(CharT)),
+                         sizeof(CharT));
+}
+
+// Reads `sz` characters, growing the string with `resize` returning its data; declared size can be corrupt, so the
+// string is grown with the input read, not allocated for the declared size at once
+template<typename CharT, typename ResizeFn>
+bool get_chars(bibuf& is, std::uint64_t sz, ResizeFn resize) {
+    std::size_t size = 0;
+    while (sz) {
+        const std::size_t chunk = static_cast<std::size_t>(
+            std::min<std::uint64_t>(sz, std::max<std::size_t>(size, 65536)));
+        CharT* p = resize(size + chunk) + size;
+        const std::size_t n = chunk * sizeof(CharT);
+        if (is.read_with_endian(est::as_span(reinterpret_cast<std::uint8_t*>(p), n), sizeof(CharT)) != n) {
+            return false;
+        }
+        size += chunk, sz -= chunk;
+    }
+    return true;
+}
+
+template<typename CharT>
+bool get_string(bibuf& is, std::basic_string<CharT>& s) {
+    std::uint64_t sz = 0;
+    if (!get_scalar(is, sz)) { return false; }
+    s.clear();
+    return get_chars<CharT>(is, sz, [&s](std::size_t n) {
+        s.resize(n);
+        return &s[0];
     });
 }
 
 template<typename CharT, typename Alloc>
-bibuf& operator>>(bibuf& is, db::basic_value<CharT, Alloc>& v) {
-    auto type = db::dtype::null;
-    is >> type;
-    v = db::basic_value<CharT, Alloc>(type, [&is](auto type, auto& x) {
-        if constexpr (std::is_same_v<decltype(type), db::string_variant_t>) {
-            std::uint64_t sz = 0;
-            if (!(is >> sz)) { return; }
-            x.string_resize(static_cast<std::size_t>(sz));
-            const auto s = x.as_string_span();
-            is.read_with_endian(est::as_span(reinterpret_cast<std::uint8_t*>(s.data()), s.size() * sizeof(CharT)),
-                                sizeof(CharT));
-        } else if constexpr (std::is_same_v<decltype(type), db::array_variant_t>) {
-            std::uint64_t sz = 0;
-            if (!(is >> sz)) { return; }
-            for (; sz; --sz) { is >> x.emplace_back(x.get_allocator()); }
-        } else if constexpr (std::is_same_v<decltype(type), db::record_variant_t>) {
-            std::uint64_t sz = 0;
-            if (!(is >> sz)) { return; }
-            for (std::string key; sz; --sz) { is >> key >> x.emplace(key, x.get_allocator()).value(); }
-        } else {
-            is >> x;
+void serialize(biobuf& os, const basic_value<CharT, Alloc>& v) {
+    using value_t = basic_value<CharT, Alloc>;
+    using record_iterator = typename value_t::const_record_iterator;
+
+    struct level_t {
+        bool is_record;
+        const value_t* arr_first;
+        const value_t* arr_last;
+        record_iterator rec_first;
+        record_iterator rec_last;
+    };
+
+    inline_basic_dynbuffer<level_t, 32> stack;
+
+    const value_t* val = &v;
+    while (os) {
+        switch (val->type()) {
+            case dtype::null: put_type(os, dtype::null); break;
+            case dtype::boolean: put_scalar<std::uint8_t>(os, dtype::boolean, val->as_bool() ? 1 : 0); break;
+            case dtype::integer: put_scalar(os, dtype::integer, val->as_int()); break;
+            case dtype::unsigned_integer: put_scalar(os, dtype::unsigned_integer, val->as_uint()); break;
+            case dtype::long_integer: put_scalar(os, dtype::long_integer, val->as_int64()); break;
+            case dtype::unsigned_long_integer: put_scalar(os, dtype::unsigned_long_integer, val->as_uint64()); break;
+            case dtype::double_precision: put_scalar(os, dtype::double_precision, val->as_double()); break;
+            case dtype::string: put_string(os, val->as_string_view()); break;
+            case dtype::array: {
+                const auto items = val->as_array();
+                put_scalar(os, dtype::array, static_cast<std::uint64_t>(items.size()));
+                stack.push_back(level_t{false, items.data(), items.data() + items.size(), {}, {}});
+            } break;
+            case dtype::record: {
+                const auto items = val->as_record();
+                put_scalar(os, dtype::record, static_cast<std::uint64_t>(val->size()));
+                stack.push_back(level_t{true, nullptr, nullptr, items.begin(), items.end()});
+            } break;
+            default: UXS_UNREACHABLE_CODE;
         }
-    });
+
+        while (true) {
+            if (stack.empty()) { return; }
+            level_t& top = stack.back();
+            if (top.is_record && top.rec_first != top.rec_last) {
+                put_key(os, top.rec_first->key());
+                val = &(top.rec_first++)->value();
+                break;
+            }
+            if (!top.is_record && top.arr_first != top.arr_last) {
+                val = top.arr_first++;
+                break;
+            }
+            stack.pop_back();
+        }
+    }
+}
+
+template<typename CharT, typename Alloc>
+void deserialize(bibuf& is, basic_value<CharT, Alloc>& v) {
+    using value_t = basic_value<CharT, Alloc>;
+
+    struct level_t {
+        value_t* val;
+        std::uint64_t count;
+    };
+
+    inline_basic_dynbuffer<level_t, 32> stack;
+    std::basic_string<CharT> key;
+    const Alloc al = v.get_allocator();
+
+    value_t* val = &v;
+    while (true) {
+        type_tag_t tag = 0;
+        if (!get_scalar(is, tag)) { return; }
+        if (tag < 0 || tag > static_cast<type_tag_t>(dtype::record)) {
+            is.setstate(iostate_bits::fail);
+            return;
+        }
+        const auto type = static_cast<dtype>(tag);
+
+        std::uint64_t count = 0;
+        *val = value_t(
+            type,
+            [&is, &count](auto type, auto& x) {
+                if constexpr (std::is_same_v<decltype(type), string_variant_t>) {
+                    std::uint64_t sz = 0;
+                    if (!get_scalar(is, sz)) { return; }
+                    get_chars<CharT>(is, sz, [&x](std::size_t n) {
+                        x.string_resize(n);
+                        return x.as_string_span().data();
+                    });
+                } else if constexpr (std::is_same_v<decltype(type), array_variant_t> ||
+                                     std::is_same_v<decltype(type), record_variant_t>) {
+                    if (!get_scalar(is, count)) { return; }
+                    // declared size is bounded, so that malformed input can't cause a huge allocation
+                    x.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(count, 65536)));
+                } else if constexpr (std::is_same_v<decltype(type), scalar_variant_t<bool>>) {
+                    std::uint8_t b = 0;
+                    if (get_scalar(is, b)) { x = b != 0; }
+                } else {
+                    get_scalar(is, x);
+                }
+            },
+            al);
+
+        if (count) { stack.push_back(level_t{val, count}); }
+
+        while (true) {
+            if (stack.empty() || !is) { return; }
+            level_t& top = stack.back();
+            if (!top.count) {
+                stack.pop_back();
+                continue;
+            }
+            --top.count;
+            if (top.val->is_record()) {
+                if (!get_string(is, key)) { return; }
+                val = &top.val->emplace(key, al).value();
+            } else {
+                val = &top.val->emplace_back(al);
+            }
+            break;
+        }
+    }
+}
+
+class serialize_chunk : public boflatbuf {
+ public:
+    explicit serialize_chunk(iomode mode) { setmode(iomode::out | (mode & iomode::invert_endian)); }
+};
+
+// Formatter of `write_parallel()` producing the same stream as `serialize()`
+struct serialize_chunk_formatter {
+    using buffer_type = serialize_chunk;
+
+    biobuf& out;
+
+    std::unique_ptr<buffer_type> make_buffer() const { return est::make_unique<buffer_type>(out.mode()); }
+    void output(const buffer_type& buf) const { out.write(buf.view()); }
+
+    template<typename CharT, typename Alloc>
+    unsigned child_indent(const basic_value<CharT, Alloc>&, unsigned indent) const {
+        return indent;
+    }
+    template<typename CharT, typename Alloc>
+    void begin_container(buffer_type& buf, const basic_value<CharT, Alloc>& v, unsigned) const {
+        put_scalar(buf, v.type(), static_cast<std::uint64_t>(v.size()));
+    }
+    template<typename CharT, typename Alloc>
+    void end_container(buffer_type&, const basic_value<CharT, Alloc>&, unsigned) const {}
+    template<typename CharT, typename Alloc>
+    void separator(buffer_type&, const basic_value<CharT, Alloc>&, unsigned) const {}
+    template<typename CharT>
+    void key(buffer_type& buf, std::basic_string_view<CharT> k) const {
+        put_key(buf, k);
+    }
+    template<typename CharT, typename Alloc>
+    void value(buffer_type& buf, const basic_value<CharT, Alloc>& v, unsigned) const {
+        serialize(buf, v);
+    }
+};
+
+}  // namespace detail
+
+// Writes the same stream as `operator<<`, but serializes bigger arrays and records on a pool of worker threads
+template<typename CharT, typename Alloc>
+void serialize_parallel(biobuf& os, const basic_value<CharT, Alloc>& v,
+                        const parallel_write_opts& opts = parallel_write_opts{}) {
+    detail::serialize_chunk_formatter fmt{os};
+    detail::write_parallel(v, fmt, opts);
+}
+
+}  // namespace db
+
+template<typename CharT, typename Alloc>
+biobuf& operator<<(biobuf& os, const db::basic_value<CharT, Alloc>& v) {
+    db::detail::serialize(os, v);
+    return os;
+}
+
+template<typename CharT, typename Alloc>
+bibuf& operator>>(bibuf& is, db::basic_value<CharT, Alloc>& v) {
+    db::detail::deserialize(is, v);
     return is;
 }
 
@@ -2,14 +2,19 @@
 
 #include "uxs/io/iomembuffer.h"
 
-#include <forward_list>
-#include <map>
+#include <algorithm>
+#include <stdexcept>
 
 namespace uxs {
 namespace db {
 template<typename CharT, typename Alloc>
 class basic_value;
 
+namespace json {
+template<typename CharT>
+class stream_writer;
+}
+
 namespace xml {
 
 enum class token_t : int {
@@ -62,23 +67,56 @@ struct lexer {
 };
 }  // namespace detail
 
-class attributes_t : public std::map<std::string_view, std::string> {
+// Attributes of the last read element with a subset of `std::map` interface: items are ordered by names, and
+// `emplace` keeps the first of same-named attributes; names and values are views of a buffer, which is reused by
+// following elements, so elements with a few short attributes are read without allocations, and the views are
+// valid until the next element is read
+class attributes_t {
  public:
-    using underlying_t = std::map<std::string_view, std::string>;
+    struct value_type {
+        std::string_view first;
+        std::string_view second;
+    };
+    using key_type = std::string_view;
+    using mapped_type = std::string_view;
+    using size_type = std::size_t;
+    using const_iterator = const value_type*;
+    using iterator = const_iterator;
 
     attributes_t() = default;
-#if __cplusplus < 201703L
-    ~attributes_t() = default;
-    attributes_t(const attributes_t&) = default;
-    attributes_t& operator=(const attributes_t&) = default;
-    attributes_t(attributes_t&& other) noexcept : underlying_t(std::move(other)) {}
-    attributes_t& operator=(attributes_t&& other) noexcept {
-        underlying_t::operator=(std::move(other));
+    attributes_t(const attributes_t& other) { assign(other); }
+    attributes_t& operator=(const attributes_t& other) {
+        if (&other != this) {
+            clear();
+            assign(other);
+        }
         return *this;
     }
-#endif  // __cplusplus < 201703L
 
-    bool contains(std::string_view key) const { return find(key) != end(); }
+    bool empty() const noexcept { return items_.empty(); }
+    size_type size() const noexcept { return items_.size(); }
+    const_iterator begin() const noexcept { return items_.data(); }
+    const_iterator end() const noexcept { return items_.endp(); }
+
+    const_iterator lower_bound(std::string_view key) const noexcept {
+        return std::lower_bound(begin(), end(), key, [](const value_type& item, std::string_view name) {
+            return item.first < name;
+        });
+    }
+
+    const_iterator find(std::string_view key) const noexcept {
+        const auto it = lower_bound(key);
+        return it != end() && it->first == key ? it : end();
+    }
+
+    size_type count(std::string_view key) const noexcept { return find(key) != end() ? 1 : 0; }
+    bool contains(std::string_view key) const noexcept { return find(key) != end(); }
+
+    std::string_view at(std::string_view key) const {
+        const auto it = find(key);
+        if (it != end()) { return it->second; }
+        throw std::out_of_range("invalid attribute name");
+    }
 
     std::string_view value_or(std::string_view key, std::string_view default_value) const {
         auto it = find(key);
@@ -97,6 +135,40 @@ class attributes_t : public std::map<std::string_view, std::string> {
     Ty value(std::string_view key) const {
         return value_or<Ty>(key, Ty());
     }
+
+    void clear() noexcept { items_.clear(), text_.clear(); }
+
+    // adds an attribute, if there is no attribute with the same name yet
+    std::pair<const_iterator, bool> emplace(std::string_view name, std::string_view value) {
+        const std::size_t pos = lower_bound(name) - begin();
+        if (pos != size() && items_[pos].first == name) { return std::make_pair(begin() + pos, false); }
+        push_back(name, value);
+        std::rotate(items_.data() + pos, items_.endp() - 1, items_.endp());
+        return std::make_pair(begin() + pos, true);
+    }
+
+ private:
+    inline_dynbuffer text_;
+    inline_basic_dynbuffer<value_type, 8> items_;
+
+    void assign(const attributes_t& other) {
+        for (const auto& item : other) { push_back(item.first, item.second); }
+    }
+
+    void push_back(std::string_view name, std::string_view value) {
+        if (text_.avail() < name.size() + value.size()) {
+            // names and values are moved to the new buffer: fix views to them
+            const char* old_data = text_.data();
+            text_.reserve(name.size() + value.size());
+            for (auto* item = items_.data(); item != items_.endp(); ++item) {
+                item->first = std::string_view(text_.data() + (item->first.data() - old_data), item->first.size());
+                item->second = std::string_view(text_.data() + (item->second.data() - old_data), item->second.size());
+            }
+        }
+        const char* p = text_.endp();
+        text_.append(name.data(), name.size()).append(value.data(), value.size());
+        items_.push_back(value_type{std::string_view(p, name.size()), std::string_view(p + name.size(), value.size())});
+    }
 };
 
 class parser {
@@ -125,6 +197,15 @@ class parser {
     template<typename CharT = char, typename Alloc = std::allocator<CharT>>
     UXS_EXPORT basic_value<CharT, Alloc> read(std::string_view root_element, const Alloc& al = Alloc());
 
+    // Converts the element to JSON without building the DOM, the output is the same as with `json::write()` of the
+    // value read with `read()`, except that same-named elements are gathered to an array only if they are adjacent:
+    // non-adjacent ones are written as duplicate keys, which `read()` gathers to one array;
+    // the first element of each run of same-named siblings is read to a value as a whole, until the next sibling
+    // tells whether it is an array item; so only items following the first one are streamed: for
+    // `<feed><items><item/>...</items></feed>` the single `items` element is buffered with all its items
+    template<typename CharT>
+    UXS_EXPORT void to_json(std::string_view root_element, json::stream_writer<CharT>& out);
+
     class iterator
         : public iterator_facade<iterator, value_type, std::input_iterator_tag, const value_type&, const value_type*> {
      public:
@@ -165,8 +246,9 @@ class parser {
  private:
     detail::lexer lexer_;
     bool is_end_element_pending_ = false;
-    std::forward_list<std::string> name_cache_;
     std::pair<token_t, std::string_view> token_;
+    std::string name_;
+    inline_dynbuffer attr_name_;
     attributes_t attrs_;
 
     UXS_EXPORT std::pair<token_t, std::string_view> next_impl();
@@ -182,6 +264,10 @@ struct writer {
     UXS_EXPORT void do_write(const basic_value<ValueCharT, Alloc>& v, std::basic_string_view<ValueCharT> element,
                              unsigned indent);
 };
+
+template<typename CharT>
+UXS_EXPORT void json_to_xml(basic_membuffer<CharT>& out, ibuf& in, std::string_view element, unsigned indent_size,
+                            char indent_char, unsigned indent);
 }  // namespace detail
 
 template<typename CharT, typename ValueCharT, typename Alloc>
@@ -201,6 +287,21 @@ void write(basic_iobuf<CharT>& out, const basic_value<ValueCharT, Alloc>& v,
     writer.do_write(v, element, indent);
 }
 
+// Converts JSON input to XML without building the DOM, the output is the same as with `write()` of the value
+// read with `json::read()`
+template<typename CharT>
+void from_json(basic_membuffer<CharT>& out, ibuf& in, std::string_view element, unsigned indent_size = 0,
+               char indent_char = ' ', unsigned indent = 0) {
+    detail::json_to_xml(out, in, element, indent_size, indent_char, indent);
+}
+
+template<typename CharT>
+void from_json(basic_iobuf<CharT>& out, ibuf& in, std::string_view element, unsigned indent_size = 0,
+               char indent_char = ' ', unsigned indent = 0) {
+    basic_iomembuffer<CharT> buf(out);
+    detail::json_to_xml(buf, in, element, indent_size, indent_char, indent);
+}
+
 }  // namespace xml
 }  // namespace db
 }  // namespace uxs
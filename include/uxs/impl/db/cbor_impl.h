@@ -0,0 +1,22 @@
+#pragma once
+
+#include "uxs/db/cbor.h"
+
+namespace uxs {
+namespace db {
+namespace cbor {
+
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> read(ibuf& in, const Alloc& al) {
+    detail::decoder decoder(in);
+    return db::detail::read_binary_value<CharT>(decoder, al);
+}
+
+template<typename ValueCharT, typename Alloc>
+void detail::writer::do_write(const basic_value<ValueCharT, Alloc>& v) {
+    db::detail::write_binary(*this, v);
+}
+
+}  // namespace cbor
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "uxs/db/image.h"
+
+namespace uxs {
+namespace db {
+namespace image {
+
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> value_ref::to_value(const Alloc& al) const {
+    using value_t = basic_value<CharT, Alloc>;
+
+    const auto scalar_to_value = [&al](const value_ref& ref) -> value_t {
+        switch (ref.type()) {
+            case dtype::null: return value_t(al);
+            case dtype::boolean: return {ref.payload() != 0, al};
+            case dtype::integer: return {static_cast<std::int32_t>(ref.payload()), al};
+            case dtype::unsigned_integer: return {static_cast<std::uint32_t>(ref.payload()), al};
+            case dtype::long_integer: return {static_cast<std::int64_t>(ref.payload()), al};
+            case dtype::unsigned_long_integer: return {ref.payload(), al};
+            case dtype::double_precision: {
+                const std::uint64_t bits = ref.payload();
+                double d = 0;
+                std::memcpy(&d, &bits, sizeof(d));
+                return {d, al};
+            }
+            case dtype::string: return {utf_string_adapter<CharT>{}(ref.as_string_view()), al};
+            default: throw database_error("invalid value image");
+        }
+    };
+
+    if (!is_array() && !is_record()) { return scalar_to_value(*this); }
+
+    struct stack_item_t {
+        value_t* val;
+        const_iterator it;
+        const_iterator last;
+    };
+
+    // the count of items is checked against the image size by `begin()`, so it is reserved after that; nodes
+    // shared by several slots of a corrupt image could make a tree much bigger than the image, so the count of
+    // materialized items is bounded by the count of slots fitting in the image
+    value_t result = is_array() ? make_array<CharT>(al) : make_record<CharT>(al);
+    std::size_t slots_left = doc_->size() / detail::slot_size;
+    inline_basic_dynbuffer<stack_item_t, 32> stack;
+    stack.push_back(stack_item_t{&result, begin(), end()});
+    result.reserve(count());
+
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        if (top.it == top.last) {
+            stack.pop_back();
+            continue;
+        }
+        if (!slots_left--) { throw database_error("invalid value image"); }
+        const const_iterator it = top.it;
+        ++top.it;
+        value_t* val = top.val->is_record() ? &top.val->emplace(utf_string_adapter<CharT>{}(it.key()), al).value() :
+                                              &top.val->emplace_back(al);
+        const value_ref ref = it.value();
+        if (ref.is_array() || ref.is_record()) {
+            *val = ref.is_array() ? make_array<CharT>(al) : make_record<CharT>(al);
+            stack.push_back(stack_item_t{val, ref.begin(), ref.end()});
+            val->reserve(ref.count());
+        } else {
+            *val = scalar_to_value(ref);
+        }
+    }
+
+    return result;
+}
+
+template<typename CharT, typename Alloc>
+void write(membuffer& out, const basic_value<CharT, Alloc>& v) {
+    using value_t = basic_value<CharT, Alloc>;
+
+    struct job_t {
+        const value_t* val;
+        std::uint64_t slot;
+        std::uint64_t first_item;
+    };
+
+    detail::builder builder;
+    inline_basic_dynbuffer<job_t, 32> jobs;
+
+    const auto put = [&builder, &jobs](std::uint64_t slot, const value_t& x) {
+        switch (x.type()) {
+            case dtype::null: builder.set_scalar(slot, dtype::null, 0); break;
+            case dtype::boolean: builder.set_scalar(slot, dtype::boolean, x.as_bool() ? 1 : 0); break;
+            case dtype::integer: {
+                builder.set_scalar(slot, dtype::integer, static_cast<std::uint64_t>(std::int64_t(x.as_int())));
+            } break;
+            case dtype::unsigned_integer: builder.set_scalar(slot, dtype::unsigned_integer, x.as_uint()); break;
+            case dtype::long_integer: {
+                builder.set_scalar(slot, dtype::long_integer, static_cast<std::uint64_t>(x.as_int64()));
+            } break;
+            case dtype::unsigned_long_integer: {
+                builder.set_scalar(slot, dtype::unsigned_long_integer, x.as_uint64());
+            } break;
+            case dtype::double_precision: {
+                const double d = x.as_double();
+                std::uint64_t bits = 0;
+                std::memcpy(&bits, &d, sizeof(bits));
+                builder.set_scalar(slot, dtype::double_precision, bits);
+            } break;
+            case dtype::string: builder.set_string(slot, utf_string_adapter<char>{}(x.as_string_view())); break;
+            case dtype::array:
+            case dtype::record: {
+                jobs.push_back(job_t{&x, slot, builder.set_container(slot, x.type(), x.size())});
+            } break;
+            default: UXS_UNREACHABLE_CODE;
+        }
+    };
+
+    // containers are laid out level by level
+    put(detail::root_slot, v);
+    for (std::size_t n = 0; n < jobs.size(); ++n) {
+        const job_t job = jobs[n];
+        std::uint64_t item = job.first_item;
+        if (job.val->is_array()) {
+            for (const auto& el : job.val->as_array()) {
+                put(item, el);
+                item += detail::slot_size;
+            }
+            continue;
+        }
+        for (const auto& el : job.val->as_record()) {
+            builder.set_string(item, utf_string_adapter<char>{}(el.key()));
+            put(item + detail::slot_size, el.value());
+            item += 2 * detail::slot_size;
+        }
+        builder.build_index(job.slot);
+    }
+
+    builder.finish(out);
+}
+
+}  // namespace image
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "json_impl.h"
+
+#include "uxs/db/json_document.h"
+
+namespace uxs {
+namespace db {
+namespace json {
+
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> value_ref::to_value(const Alloc& al) const {
+    if (!doc_) { return basic_value<CharT, Alloc>(al); }
+
+    const auto scalar_to_value = [this, &al](std::uint32_t index) {
+        const auto tt = doc_->tape_[index].type;
+        const auto lval = tt == token_t::string ? doc_->string_at(index) : doc_->lexeme_at(index);
+        return detail::token_to_value<CharT>(tt, lval, al);
+    };
+
+    if (!is_array() && !is_record()) { return scalar_to_value(index_); }
+
+    struct stack_item_t {
+        basic_value<CharT, Alloc>* val;
+        std::uint32_t last;
+    };
+
+    basic_value<CharT, Alloc> result = is_array() ? make_array<CharT>(al) : make_record<CharT>(al);
+    if (is_array()) { result.reserve(node().size); }
+    inline_basic_dynbuffer<stack_item_t, 32> stack;
+    stack.push_back(stack_item_t{&result, doc_->next_sibling(index_)});
+
+    std::uint32_t index = index_ + 1;
+    while (!stack.empty()) {
+        auto* top = stack.back().val;
+        if (index == stack.back().last) {
+            stack.pop_back();
+            continue;
+        }
+        basic_value<CharT, Alloc>* val = nullptr;
+        if (top->is_record()) {
+            val = &top->emplace(utf_string_adapter<CharT>{}(doc_->string_at(index++)), al).value();
+        } else {
+            val = &top->emplace_back(al);
+        }
+        const auto& node = doc_->tape_[index];
+        if (node.type == token_t::array || node.type == token_t::object) {
+            if (node.type == token_t::array) {
+                *val = make_array<CharT>(al);
+                val->reserve(node.size);
+            } else {
+                *val = make_record<CharT>(al);
+            }
+            stack.push_back(stack_item_t{val, doc_->next_sibling(index++)});
+        } else {
+            *val = scalar_to_value(index++);
+        }
+    }
+
+    return result;
+}
+
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
@@ -11,55 +11,24 @@ namespace json {
 
 template<typename CharT, typename Alloc>
 basic_value<CharT, Alloc> read(ibuf& in, const Alloc& al) {
-    static const auto token_to_value = [](token_t tt, std::string_view lval,
-                                          const Alloc& al) -> basic_value<CharT, Alloc> {
-        switch (tt) {
-            case token_t::null_value: return {nullptr, al};
-            case token_t::true_value: return {true, al};
-            case token_t::false_value: return {false, al};
-            case token_t::integer_number: {
-                std::uint64_t u64 = 0;
-                if (from_string(lval, u64) != 0) {
-                    if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max())) {
-                        return {static_cast<std::int32_t>(u64), al};
-                    }
-                    if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max())) {
-                        return {static_cast<std::uint32_t>(u64), al};
-                    }
-                    if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
-                        return {static_cast<std::int64_t>(u64), al};
-                    }
-                    return {u64, al};
-                }
-                // too big integer - treat as double
-                return {from_string<double>(lval), al};
-            } break;
-            case token_t::negative_integer_number: {
-                std::int64_t i64 = 0;
-                if (from_string(lval, i64) != 0) {
-                    if (i64 >= static_cast<std::int64_t>(std::numeric_limits<std::int32_t>::min())) {
-                        return {static_cast<std::int32_t>(i64), al};
-                    }
-                    return {i64, al};
-                }
-                // too big integer - treat as double
-                return {from_string<double>(lval), al};
-            } break;
-            case token_t::floating_point_number: return {from_string<double>(lval), al};
-            case token_t::string: return {utf_string_adapter<CharT>{}(lval), al};
-            default: UXS_UNREACHABLE_CODE;
-        }
-    };
+    detail::lexer lexer(in);
+    return detail::read_value<CharT>(lexer, al);
+}
 
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> detail::read_value(lexer& lexer, const Alloc& al) {
     basic_value<CharT, Alloc> result(al);
     inline_basic_dynbuffer<basic_value<CharT, Alloc>*, 32> stack;
 
     auto* val = &result;
-    read(
-        in,
-        [&al, &stack, &val](token_t tt, std::string_view lval) {
-            if (tt >= token_t::null_value) {
-                *val = token_to_value(tt, lval, al);
+    lexer.decode_numbers = true;
+    read_value(
+        lexer,
+        [&al, &stack, &val](token_t tt, std::string_view lval, const number& num) {
+            if (tt >= token_t::integer_number && tt <= token_t::floating_point_number) {
+                *val = detail::number_to_value<CharT>(tt, num, al);
+            } else if (tt >= token_t::null_value) {
+                *val = detail::token_to_value<CharT>(tt, lval, al);
             } else {
                 *val = tt == token_t::array ? make_array<CharT>(al) : make_record<CharT>(al);
                 stack.push_back(val);
@@ -104,11 +73,21 @@ struct writer_stack_item_t {
     };
 };
 
+// Returns the first character, which needs escaping: `"`, `\` or control character
+UXS_EXPORT const char* find_escaped_char(const char* first, const char* last) noexcept;
+
+inline const wchar_t* find_escaped_char(const wchar_t* first, const wchar_t* last) noexcept {
+    return std::find_if(first, last, [](wchar_t ch) {
+        return ch == '\"' || ch == '\\' || static_cast<unsigned char>(ch) < 32;
+    });
+}
+
 template<typename CharT>
 basic_membuffer<CharT>& write_text(basic_membuffer<CharT>& out, std::basic_string_view<CharT> text) {
-    auto it0 = text.begin();
+    const CharT* it0 = text.data();
+    const CharT* last = text.data() + text.size();
     out += '\"';
-    for (auto it = it0; it != text.end(); ++it) {
+    for (const CharT* it = find_escaped_char(it0, last); it != last; it = find_escaped_char(it + 1, last)) {
         char esc = '\0';
         switch (*it) {
             case '\"': esc = '\"'; break;
@@ -119,13 +98,11 @@ basic_membuffer<CharT>& write_text(basic_membuffer<CharT>& out, std::basic_strin
             case '\r': esc = 'r'; break;
             case '\t': esc = 't'; break;
             default: {
-                if (static_cast<unsigned char>(*it) < 32) {
-                    out += to_string_view(it0, it);
-                    out += string_literal<CharT, '\\', 'u', '0', '0'>{}();
-                    out += '0' + (*it >> 4);
-                    out += "0123456789ABCDEF"[*it & 15];
-                    it0 = it + 1;
-                }
+                out += to_string_view(it0, it);
+                out += string_literal<CharT, '\\', 'u', '0', '0'>{}();
+                out += '0' + (*it >> 4);
+                out += "0123456789ABCDEF"[*it & 15];
+                it0 = it + 1;
                 continue;
             } break;
         }
@@ -134,7 +111,7 @@ basic_membuffer<CharT>& write_text(basic_membuffer<CharT>& out, std::basic_strin
         out += esc;
         it0 = it + 1;
     }
-    out += to_string_view(it0, text.end());
+    out += to_string_view(it0, last);
     out += '\"';
     return out;
 }
@@ -232,10 +209,7 @@ loop:
             out += ws_char;
             if (ws_char == '\n') { out.append(indent, indent_char); }
         }
-        if (top.is_record()) {
-            detail::write_text<CharT>(out, utf_string_adapter<CharT>{}(top.key()));
-            out += string_literal<CharT, ':', ' '>{}();
-        }
+        if (top.is_record()) { write_key(top.key()); }
         if (top.get_and_advance().visit(visitor)) {
             is_first_element = true;
             goto loop;
@@ -254,8 +228,127 @@ loop:
     if (!stack.empty()) { goto loop; }
 }
 
+template<typename CharT>
+template<typename KeyCharT>
+void writer<CharT>::write_key(std::basic_string_view<KeyCharT> key) {
+    detail::write_text<CharT>(out, utf_string_adapter<CharT>{}(key));
+    out += string_literal<CharT, ':', ' '>{}();
+}
+
 }  // namespace detail
 
+// --------------------------
+
+template<typename CharT>
+void stream_writer<CharT>::begin_item() {
+    auto& top = stack_.back();
+    const char ws_char = top.is_record ? object_ws_char_ : array_ws_char_;
+    if (top.is_first) {
+        if (ws_char == '\n') {
+            indent_ += indent_size_;
+            out_ += '\n';
+            out_.append(indent_, indent_char_);
+        }
+        top.is_first = false;
+    } else {
+        out_ += ',';
+        out_ += ws_char;
+        if (ws_char == '\n') { out_.append(indent_, indent_char_); }
+    }
+}
+
+template<typename CharT>
+void stream_writer<CharT>::begin_value() {
+    if (stack_.empty()) { return; }
+    if (stack_.back().is_record) {
+        if (!has_key_) { throw database_error("record item must be started with a key"); }
+        has_key_ = false;
+        return;
+    }
+    begin_item();
+}
+
+template<typename CharT>
+void stream_writer<CharT>::end_container(bool is_record) {
+    if (stack_.empty() || stack_.back().is_record != is_record || has_key_) {
+        throw database_error(is_record ? "no record to end" : "no array to end");
+    }
+    const auto top = stack_.back();
+    stack_.pop_back();
+    if (!top.is_first && (is_record ? object_ws_char_ : array_ws_char_) == '\n') {
+        indent_ -= indent_size_;
+        out_ += '\n';
+        out_.append(indent_, indent_char_);
+    }
+    out_ += is_record ? '}' : ']';
+}
+
+template<typename CharT>
+stream_writer<CharT>& stream_writer<CharT>::begin_array() {
+    begin_value();
+    out_ += '[';
+    stack_.push_back(level_t{false, true});
+    return *this;
+}
+
+template<typename CharT>
+stream_writer<CharT>& stream_writer<CharT>::end_array() {
+    end_container(false);
+    return *this;
+}
+
+template<typename CharT>
+stream_writer<CharT>& stream_writer<CharT>::begin_object() {
+    begin_value();
+    out_ += '{';
+    stack_.push_back(level_t{true, true});
+    return *this;
+}
+
+template<typename CharT>
+stream_writer<CharT>& stream_writer<CharT>::end_object() {
+    end_container(true);
+    return *this;
+}
+
+template<typename CharT>
+stream_writer<CharT>& stream_writer<CharT>::key(std::basic_string_view<CharT> k) {
+    if (stack_.empty() || !stack_.back().is_record || has_key_) { throw database_error("unexpected record key"); }
+    begin_item();
+    detail::write_text<CharT>(out_, k);
+    out_ += string_literal<CharT, ':', ' '>{}();
+    has_key_ = true;
+    return *this;
+}
+
+template<typename CharT>
+stream_writer<CharT>& stream_writer<CharT>::value(std::nullptr_t) {
+    begin_value();
+    out_ += string_literal<CharT, 'n', 'u', 'l', 'l'>{}();
+    return *this;
+}
+
+template<typename CharT>
+stream_writer<CharT>& stream_writer<CharT>::value(bool b) {
+    begin_value();
+    out_ += b ? string_literal<CharT, 't', 'r', 'u', 'e'>{}() : string_literal<CharT, 'f', 'a', 'l', 's', 'e'>{}();
+    return *this;
+}
+
+template<typename CharT>
+stream_writer<CharT>& stream_writer<CharT>::value(std::basic_string_view<CharT> s) {
+    begin_value();
+    detail::write_text<CharT>(out_, s);
+    return *this;
+}
+
+template<typename CharT>
+stream_writer<CharT>& stream_writer<CharT>::value(double f) {
+    begin_value();
+    to_basic_string(out_, f, fmt_opts{fmt_flags::json_compat});
+    return *this;
+}
+
 }  // namespace json
 }  // namespace db
 }  // namespace uxs
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "uxs/db/json_path.h"
+
+namespace uxs {
+namespace db {
+namespace json {
+
+namespace detail {
+
+template<typename CharT>
+class path_parser {
+ public:
+    using string_view_type = std::basic_string_view<CharT>;
+
+    explicit path_parser(string_view_type text) noexcept : text_(text) {}
+
+    bool at_end() const noexcept { return pos_ == text_.size(); }
+    CharT peek() const noexcept { return pos_ < text_.size() ? text_[pos_] : CharT(0); }
+    bool skip_if(CharT ch) noexcept {
+        if (peek() != ch) { return false; }
+        ++pos_;
+        return true;
+    }
+
+    void expect(CharT ch) {
+        if (!skip_if(ch)) { throw error(); }
+    }
+
+    void skip_spaces() noexcept {
+        while (peek() == ' ') { ++pos_; }
+    }
+
+    database_error error() const { return database_error("invalid path at " + to_string(pos_ + 1)); }
+
+    std::basic_string<CharT> name() {
+        const std::size_t first = pos_;
+        while (!at_end() && text_[pos_] != '.' && text_[pos_] != '[' && text_[pos_] != ' ' && text_[pos_] != ')' &&
+               text_[pos_] != ']' && text_[pos_] != '=' && text_[pos_] != '!' && text_[pos_] != '<' &&
+               text_[pos_] != '>') {
+            ++pos_;
+        }
+        if (pos_ == first) { throw error(); }
+        return std::basic_string<CharT>(text_.substr(first, pos_ - first));
+    }
+
+    std::basic_string<CharT> quoted() {
+        const CharT quot = peek();
+        ++pos_;
+        std::basic_string<CharT> s;
+        while (true) {
+            if (at_end()) { throw error(); }
+            CharT ch = text_[pos_++];
+            if (ch == quot) { break; }
+            if (ch == '\\') {
+                if (at_end()) { throw error(); }
+                ch = text_[pos_++];
+            }
+            s.push_back(ch);
+        }
+        return s;
+    }
+
+    // Reads digits and characters of a number literal into ASCII string
+    std::string number() {
+        std::string s;
+        while (!at_end() && ((text_[pos_] >= '0' && text_[pos_] <= '9') || text_[pos_] == '-' ||
+                             text_[pos_] == '+' || text_[pos_] == '.' || text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            s.push_back(static_cast<char>(text_[pos_++]));
+        }
+        if (s.empty()) { throw error(); }
+        return s;
+    }
+
+    // Reads a non-negative item index: counting from the end with negative indices is not supported
+    std::size_t index() {
+        std::string s;
+        while (!at_end() && text_[pos_] >= '0' && text_[pos_] <= '9') { s.push_back(static_cast<char>(text_[pos_++])); }
+        std::size_t index = 0;
+        if (s.empty() || from_string(s, index) != s.size()) { throw error(); }
+        return index;
+    }
+
+    bool skip_word(const char* word) noexcept {
+        std::size_t n = 0;
+        for (; word[n]; ++n) {
+            if (pos_ + n >= text_.size() || text_[pos_ + n] != word[n]) { return false; }
+        }
+        pos_ += n;
+        return true;
+    }
+
+ private:
+    string_view_type text_;
+    std::size_t pos_ = 0;
+};
+
+}  // namespace detail
+
+template<typename CharT>
+void basic_path<CharT>::compile(string_view_type text) {
+    detail::path_parser<CharT> parser(text);
+    std::vector<step_t> steps;
+    std::vector<filter_t> filters;
+
+    parser.expect('$');
+    while (!parser.at_end()) {
+        if (parser.skip_if('.')) {
+            if (parser.skip_if('*')) {
+                steps.push_back(step_t{step_type::wildcard, string_type(), 0});
+            } else if (parser.peek() == '.') {
+                throw database_error("recursive descent in path is not supported");
+            } else {
+                steps.push_back(step_t{step_type::key, parser.name(), 0});
+            }
+            continue;
+        }
+
+        parser.expect('[');
+        parser.skip_spaces();
+        if (parser.skip_if('*')) {
+            steps.push_back(step_t{step_type::wildcard, string_type(), 0});
+        } else if (parser.peek() == '\'' || parser.peek() == '\"') {
+            steps.push_back(step_t{step_type::key, parser.quoted(), 0});
+        } else if (parser.skip_if('?')) {
+            parser.skip_spaces();
+            const bool parenthesized = parser.skip_if('(');
+            parser.skip_spaces();
+            parser.expect('@');
+            filter_t filter{{}, compare_op::exists, basic_value<char_type>()};
+            while (true) {
+                if (parser.skip_if('.')) {
+                    filter.operand_path.push_back(step_t{step_type::key, parser.name(), 0});
+                } else if (parser.skip_if('[')) {
+                    parser.skip_spaces();
+                    if (parser.peek() == '\'' || parser.peek() == '\"') {
+                        filter.operand_path.push_back(step_t{step_type::key, parser.quoted(), 0});
+                    } else {
+                        filter.operand_path.push_back(step_t{step_type::index, string_type(), parser.index()});
+                    }
+                    parser.skip_spaces();
+                    parser.expect(']');
+                } else {
+                    break;
+                }
+            }
+            parser.skip_spaces();
+            if (parser.skip_word("==")) {
+                filter.op = compare_op::eq;
+            } else if (parser.skip_word("!=")) {
+                filter.op = compare_op::ne;
+            } else if (parser.skip_word("<=")) {
+                filter.op = compare_op::le;
+            } else if (parser.skip_word(">=")) {
+                filter.op = compare_op::ge;
+            } else if (parser.skip_word("<")) {
+                filter.op = compare_op::lt;
+            } else if (parser.skip_word(">")) {
+                filter.op = compare_op::gt;
+            }
+            if (filter.op != compare_op::exists) {
+                parser.skip_spaces();
+                if (parser.peek() == '\'' || parser.peek() == '\"') {
+                    filter.operand = parser.quoted();
+                } else if (parser.skip_word("true")) {
+                    filter.operand = true;
+                } else if (parser.skip_word("false")) {
+                    filter.operand = false;
+                } else if (parser.skip_word("null")) {
+                    filter.operand = nullptr;
+                } else {
+                    const std::string s = parser.number();
+                    std::int64_t i64 = 0;
+                    double d = 0;
+                    if (from_string(s, i64) == s.size()) {
+                        filter.operand = i64;
+                    } else if (from_string(s, d) == s.size()) {
+                        filter.operand = d;
+                    } else {
+                        throw parser.error();
+                    }
+                }
+                parser.skip_spaces();
+            }
+            if (parenthesized) {
+                parser.expect(')');
+                parser.skip_spaces();
+            }
+            steps.push_back(step_t{step_type::filter, string_type(), filters.size()});
+            filters.push_back(std::move(filter));
+        } else {
+            steps.push_back(step_t{step_type::index, string_type(), parser.index()});
+        }
+        parser.skip_spaces();
+        parser.expect(']');
+    }
+
+    steps_.swap(steps);
+    filters_.swap(filters);
+}
+
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
@@ -4,6 +4,12 @@
 #include "uxs/string_cvt.h"
 
 #include <cmath>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif  // defined(_MSC_VER)
 
 namespace uxs {
 namespace db {
@@ -13,43 +19,108 @@ namespace db {
 template<typename CharT, typename Alloc>
 UXS_EXPORT bool operator==(const basic_value<CharT, Alloc>& lhs, const basic_value<CharT, Alloc>& rhs) noexcept {
     static const auto compare_long_integer = [](std::int64_t lhs, const basic_value<CharT, Alloc>& rhs) {
-        switch (rhs.type_) {
-            case dtype::integer: return lhs == rhs.value_.i;
-            case dtype::unsigned_integer: return lhs == static_cast<std::int64_t>(rhs.value_.u);
-            case dtype::long_integer: return lhs == rhs.value_.i64;
+        switch (rhs.cell_.type) {
+            case dtype::integer: return lhs == rhs.cell_.value.i;
+            case dtype::unsigned_integer: return lhs == static_cast<std::int64_t>(rhs.cell_.value.u);
+            case dtype::long_integer: return lhs == rhs.cell_.value.i64;
             case dtype::unsigned_long_integer: {
-                return rhs.value_.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) &&
-                       lhs == static_cast<std::int64_t>(rhs.value_.u64);
+                return rhs.cell_.value.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) &&
+                       lhs == static_cast<std::int64_t>(rhs.cell_.value.u64);
             } break;
             default: return false;
         }
     };
 
     static const auto compare_unsigned_long_integer = [](std::uint64_t lhs, const basic_value<CharT, Alloc>& rhs) {
-        switch (rhs.type_) {
-            case dtype::integer: return rhs.value_.i >= 0 && lhs == static_cast<std::uint64_t>(rhs.value_.i);
-            case dtype::unsigned_integer: return lhs == rhs.value_.u;
-            case dtype::long_integer: return rhs.value_.i64 >= 0 && lhs == static_cast<std::uint64_t>(rhs.value_.i64);
-            case dtype::unsigned_long_integer: return lhs == rhs.value_.u64;
+        switch (rhs.cell_.type) {
+            case dtype::integer: return rhs.cell_.value.i >= 0 && lhs == static_cast<std::uint64_t>(rhs.cell_.value.i);
+            case dtype::unsigned_integer: return lhs == rhs.cell_.value.u;
+            case dtype::long_integer:
+                return rhs.cell_.value.i64 >= 0 && lhs == static_cast<std::uint64_t>(rhs.cell_.value.i64);
+            case dtype::unsigned_long_integer: return lhs == rhs.cell_.value.u64;
             default: return false;
         }
     };
 
-    switch (lhs.type_) {
-        case dtype::null: return rhs.type_ == dtype::null;
-        case dtype::boolean: return rhs.type_ == dtype::boolean && lhs.value_.b == rhs.value_.b;
-        case dtype::integer: return compare_long_integer(lhs.value_.i, rhs);
-        case dtype::unsigned_integer: return compare_unsigned_long_integer(lhs.value_.u, rhs);
-        case dtype::long_integer: return compare_long_integer(lhs.value_.i64, rhs);
-        case dtype::unsigned_long_integer: return compare_unsigned_long_integer(lhs.value_.u64, rhs);
-        case dtype::double_precision: return rhs.type_ == dtype::double_precision && lhs.value_.dbl == rhs.value_.dbl;
-        case dtype::string: return rhs.type_ == dtype::string && lhs.value_.str == rhs.value_.str;
-        case dtype::array: return rhs.type_ == dtype::array && lhs.value_.arr == rhs.value_.arr;
-        case dtype::record: return rhs.type_ == dtype::record && lhs.value_.rec == rhs.value_.rec;
+    switch (lhs.cell_.type) {
+        case dtype::null: return rhs.cell_.type == dtype::null;
+        case dtype::boolean: return rhs.cell_.type == dtype::boolean && lhs.cell_.value.b == rhs.cell_.value.b;
+        case dtype::integer: return compare_long_integer(lhs.cell_.value.i, rhs);
+        case dtype::unsigned_integer: return compare_unsigned_long_integer(lhs.cell_.value.u, rhs);
+        case dtype::long_integer: return compare_long_integer(lhs.cell_.value.i64, rhs);
+        case dtype::unsigned_long_integer: return compare_unsigned_long_integer(lhs.cell_.value.u64, rhs);
+        case dtype::double_precision:
+            return rhs.cell_.type == dtype::double_precision && lhs.cell_.value.dbl == rhs.cell_.value.dbl;
+        case dtype::string: return rhs.cell_.type == dtype::string && lhs.str_view() == rhs.str_view();
+        case dtype::array: return rhs.cell_.type == dtype::array && lhs.cell_.value.arr == rhs.cell_.value.arr;
+        case dtype::record: return rhs.cell_.type == dtype::record && lhs.cell_.value.rec == rhs.cell_.value.rec;
         default: UXS_UNREACHABLE_CODE;
     }
 }
 
+template<typename CharT, typename Alloc>
+UXS_EXPORT memory_stats get_memory_stats(const basic_value<CharT, Alloc>& v) {
+    using value_t = basic_value<CharT, Alloc>;
+
+    struct item_t {
+        const value_t* val;  // `nullptr` marks the end of shared subtree
+        std::size_t total_bytes;
+    };
+
+    memory_stats st;
+    std::unordered_set<const void*> visited;  // shared data, which is already counted
+    std::vector<item_t> stack;
+    bool in_shared = false;
+
+    stack.push_back(item_t{&v, 0});
+    while (!stack.empty()) {
+        const item_t item = stack.back();
+        stack.pop_back();
+        if (!item.val) {
+            st.shared_bytes += st.total_bytes() - item.total_bytes;
+            in_shared = false;
+            continue;
+        }
+
+        const auto enter = [&st, &visited, &stack, &in_shared](const void* data, bool is_shared) {
+            if (!is_shared) { return true; }
+            if (!visited.insert(data).second) { return false; }
+            ++st.shared_count;
+            if (!in_shared) {
+                stack.push_back(item_t{nullptr, st.total_bytes()});
+                in_shared = true;
+            }
+            return true;
+        };
+
+        const value_t& val = *item.val;
+        ++st.value_count;
+        switch (val.cell_.type) {
+            case dtype::string: {
+                const auto& str = val.cell_.value.str;
+                if (val.is_short_string() || !enter(str.data_ptr(), str.is_shared())) { break; }
+                st.string_bytes += str.alloc_bytes();
+                st.string_unused_bytes += str.unused_bytes();
+            } break;
+            case dtype::array: {
+                const auto& arr = val.cell_.value.arr;
+                if (!enter(arr.data_ptr(), arr.is_shared())) { break; }
+                st.array_bytes += arr.alloc_bytes();
+                st.array_unused_bytes += arr.unused_bytes();
+                for (const value_t& elem : arr.cview()) { stack.push_back(item_t{&elem, 0}); }
+            } break;
+            case dtype::record: {
+                const auto& rec = val.cell_.value.rec;
+                if (!enter(rec.data_ptr(), rec.is_shared())) { break; }
+                rec.add_memory_stats(st);
+                for (const auto& elem : rec.crange()) { stack.push_back(item_t{&elem.value(), 0}); }
+            } break;
+            default: break;
+        }
+    }
+    return st;
+}
+
 //-----------------------------------------------------------------------------
 // Flexible array implementation
 namespace detail {
@@ -58,12 +129,12 @@ template<typename Alloc, typename Ty,
          typename = std::enable_if_t<
              std::is_trivially_move_constructible<Ty>::value ||
              std::is_same<typename std::allocator_traits<Alloc>::template rebind_alloc<Ty>, std::allocator<Ty>>::value>>
-static void move_values(const Ty* first, const Ty* last, Ty* dest) noexcept {
+static void move_values(Ty* first, Ty* last, Ty* dest) noexcept {
     std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(Ty));
 }
 
 template<typename Alloc, typename Ty, typename... Dummy>
-static void move_values(const Ty* first, const Ty* last, Ty* dest, Dummy&&...) noexcept {
+static void move_values(Ty* first, Ty* last, Ty* dest, Dummy&&...) noexcept {
     for (; first != last; ++first, ++dest) { new (dest) Ty(std::move(*first)); }
 }
 
@@ -82,7 +153,7 @@ template<typename Ty, typename Alloc>
 /*static*/ auto flexarray_t<Ty, Alloc>::alloc(alloc_type& al, std::size_t sz, std::size_t cap) -> data_t* {
     const std::size_t alloc_sz = get_alloc_sz(cap);
     data_t* p = al.allocate(alloc_sz);
-    new (&p->ref_count) std::atomic<std::size_t>{1};
+    new (&p->ref_count) ref_counter_t{1};
     p->size = sz;
     p->capacity = (alloc_sz * sizeof(data_t) - offsetof(data_t, x)) / sizeof(Ty);
     assert(p->capacity >= cap && get_alloc_sz(p->capacity) == alloc_sz);
@@ -212,13 +283,59 @@ Ty* flexarray_t<Ty, Alloc>::erase(alloc_type& al, const Ty* item_to_erase) {
 // Record container implementation
 namespace detail {
 
+// Control byte is `ctrl_empty`, `ctrl_deleted` or 7 lower bits of the hash code of occupied slot
+enum : std::int8_t { ctrl_empty = -128, ctrl_deleted = -2 };
+
+inline std::int8_t ctrl_h2(std::size_t hash_code) noexcept { return static_cast<std::int8_t>(hash_code & 0x7f); }
+
+// Matches 16 control bytes at once: bit `n` of the mask is set for matched lane `n`; matching is implemented in
+// the library, so it uses SSE2 instructions, if they are available, and the same probing is used everywhere
+struct ctrl_group {
+    using mask_t = std::uint32_t;
+    enum : std::size_t { width = 16 };
+
+    const std::int8_t* ctrl;
+
+    explicit ctrl_group(const std::int8_t* p) noexcept : ctrl(p) {}
+
+    UXS_EXPORT mask_t match(std::int8_t h2) const noexcept;
+    UXS_EXPORT mask_t match_empty() const noexcept;
+    UXS_EXPORT mask_t match_empty_or_deleted() const noexcept;
+
+    static std::size_t lowest(mask_t mask) noexcept {
+#if defined(_MSC_VER)
+        unsigned long n = 0;
+        _BitScanForward(&n, mask);
+        return n;
+#elif defined(__GNUC__)
+        return __builtin_ctz(mask);
+#else
+        std::size_t n = 0;
+        for (; !(mask & 1); mask >>= 1) { ++n; }
+        return n;
+#endif
+    }
+};
+
+// Triangular probing over groups visits every group of power-of-two table of at least `ctrl_group::width` slots
+struct ctrl_probe_seq {
+    std::size_t mask;
+    std::size_t pos;
+    std::size_t step = 0;
+    ctrl_probe_seq(std::size_t hash_code, std::size_t capacity) noexcept
+        : mask(capacity - 1), pos((hash_code >> 7) & mask) {}
+    std::size_t offset(std::size_t lane) const noexcept { return (pos + lane) & mask; }
+    void next() noexcept {
+        step += ctrl_group::width;
+        pos = (pos + step) & mask;
+    }
+};
+
 template<typename CharT, typename Alloc>
-/*static*/ record_value<CharT, Alloc>* record_value<CharT, Alloc>::alloc(alloc_type& al, key_type key) {
-    if (key.size() > max_name_size(al)) { throw std::length_error("too much to reserve"); }
-    const std::size_t alloc_sz = get_alloc_sz(key.size());
-    record_value* node = al.allocate(alloc_sz);
-    node->key_sz_ = key.size();
-    std::copy_n(key.data(), key.size(), node->key_chars_);
+/*static*/ record_value<CharT, Alloc>* record_value<CharT, Alloc>::alloc(alloc_type& al, const key_ref_t& ref) {
+    if (ref.key.size() > max_name_size(al)) { throw std::length_error("too much to reserve"); }
+    record_value* node = al.allocate(get_alloc_sz(ref.key.size()));
+    node->key_.assign(ref);
     return node;
 }
 
@@ -226,43 +343,67 @@ template<typename CharT, typename Alloc>
 void record_t<CharT, Alloc>::data_t::init() noexcept {
     dllist_make_cycle(&head);
     size = 0;
+    index = nullptr;
+    arena_used = 0;
     node_traits::set_head(&head, &head);
-    for (auto& item : est::as_span(hashtbl, bucket_count)) { item = nullptr; }
 }
 
 template<typename CharT, typename Alloc>
-void record_t<CharT, Alloc>::data_t::init_from(data_t* p) noexcept {
-    if (p->size) {
-        head = p->head;
-        head.next->prev = &head;
-        head.prev->next = &head;
-    } else {
-        dllist_make_cycle(&head);
-    }
-    size = p->size;
-    node_traits::set_head(&head, &head);
-    for (auto& item : est::as_span(hashtbl, bucket_count)) { item = nullptr; }
+/*static*/ auto record_t<CharT, Alloc>::alloc(alloc_type& al, std::size_t arena_size) -> data_t* {
+    const std::size_t alloc_sz = get_alloc_sz(arena_size);
+    data_t* p = al.allocate(alloc_sz);
+    new (&p->ref_count) ref_counter_t{1};
+    // the header without requested arena has space for a node, but the arena is kept empty, so it is grown by the
+    // first insertion
+    p->arena_size = arena_size ? static_cast<std::uint32_t>((alloc_sz * sizeof(data_t) - offsetof(data_t, arena)) /
+                                                            sizeof(node_t)) :
+                                 0;
+    assert(p->arena_size >= arena_size && get_alloc_sz(p->arena_size) == alloc_sz);
+    return p;
 }
 
 template<typename CharT, typename Alloc>
-/*static*/ auto record_t<CharT, Alloc>::alloc(alloc_type& al, std::size_t bucket_count) -> data_t* {
-    const std::size_t alloc_sz = get_alloc_sz(bucket_count);
-    data_t* p = al.allocate(alloc_sz);
-    new (&p->ref_count) std::atomic<std::size_t>{1};
-    p->bucket_count = (alloc_sz * sizeof(data_t) - offsetof(data_t, hashtbl)) / sizeof(list_links_t*);
-    assert(p->bucket_count >= bucket_count && get_alloc_sz(p->bucket_count) == alloc_sz);
-    return p;
+/*static*/ auto record_t<CharT, Alloc>::alloc_index(alloc_type& al, std::size_t capacity) -> index_t* {
+    static_assert(std::size_t(ctrl_group::width) <= std::size_t(ctrl_tail_size), "too narrow control byte tail");
+    index_alloc_type index_al(al);
+    index_t* index = index_al.allocate(get_index_alloc_sz(capacity));
+    index->capacity = capacity;
+    index->growth_left = growth_limit(capacity);
+    std::memset(index->ctrl(), static_cast<std::uint8_t>(ctrl_empty), capacity + ctrl_tail_size);
+    return index;
+}
+
+template<typename CharT, typename Alloc>
+void record_t<CharT, Alloc>::construct(alloc_type& al, std::size_t count) {
+    if (count > max_size(al)) { throw std::length_error("too much to reserve"); }
+    p_ = alloc(al, count <= max_arena_size(al) ? count : 0);
+    p_->init();
+    p_->key_pool.set(al);
+    if (count > small_record_max) {
+        try {
+            p_->index = alloc_index(al, capacity_for(count));
+        } catch (...) {
+            dealloc(al, p_);
+            throw;
+        }
+    }
 }
 
 template<typename CharT, typename Alloc>
 void record_t<CharT, Alloc>::construct(alloc_type& al, record_t rec) {
-    construct(al, rec.size());
+    // one arena for all items
+    std::size_t arena_size = 0;
+    for (list_links_t* item = rec.p_->head.next; item != &rec.p_->head; item = item->next) {
+        arena_size += node_t::get_alloc_sz(node_t::from_links(item)->key_.stored_size());
+    }
+    p_ = alloc(al, arena_size <= max_arena_size(al) ? arena_size : 0);
+    p_->init();
+    p_->key_pool = rec.p_->key_pool;
     try {
-        typename node_t::alloc_type node_al(al);
+        if (rec.p_->index) { p_->index = alloc_index(al, capacity_for(rec.size())); }
         for (list_links_t* item = rec.p_->head.next; item != &rec.p_->head; item = item->next) {
             const auto& v = *node_t::from_links(item);
-            node_t* node = node_t::create(node_al, v.key(), v.value());
-            insert_node(node, v.hash_code_);
+            insert_node(new_node(al, make_key(v), v.value()));
         }
     } catch (...) {
         destruct(al);
@@ -292,41 +433,87 @@ void record_t<CharT, Alloc>::assign(alloc_type& al, std::initializer_list<mapped
     insert_impl(al, init);
 }
 
+template<typename CharT, typename Alloc>
+void record_t<CharT, Alloc>::delete_node(alloc_type& al, node_t* node) noexcept {
+    if (is_in_arena(node)) {
+        node->value().~mapped_type();
+    } else {
+        typename node_t::alloc_type node_al(al);
+        node_t::destroy(node_al, node);
+    }
+}
+
 template<typename CharT, typename Alloc>
 void record_t<CharT, Alloc>::destruct_items(alloc_type& al) noexcept {
-    typename node_t::alloc_type node_al(al);
     list_links_t* node = p_->head.next;
     while (node != &p_->head) {
         list_links_t* next = node->next;
-        node_t::destroy(node_al, node_t::from_links(node));
+        delete_node(al, node_t::from_links(node));
         node = next;
     }
 }
 
 template<typename CharT, typename Alloc>
-void record_t<CharT, Alloc>::add_to_hash(node_t* node) noexcept {
-    node_traits::set_head(&node->links_, &p_->head);
-    list_links_t** p_next_bucket = &p_->hashtbl[node->hash_code_ % p_->bucket_count];
-    node->next_bucket_ = *p_next_bucket;
-    *p_next_bucket = &node->links_;
+void record_t<CharT, Alloc>::add_to_hash(list_links_t* node, std::size_t hash_code) noexcept {
+    index_t* index = p_->index;
+    std::int8_t* ctrl = index->ctrl();
+    ctrl_probe_seq seq(hash_code, index->capacity);
+    auto mask = ctrl_group(ctrl + seq.pos).match_empty_or_deleted();
+    while (!mask) {
+        seq.next();
+        mask = ctrl_group(ctrl + seq.pos).match_empty_or_deleted();
+    }
+    std::size_t pos = seq.offset(ctrl_group::lowest(mask));
+    if (ctrl[pos] == ctrl_deleted && find_impl(make_key(*node_t::from_links(node))) != &p_->head) {
+        // items with the same key are found in insertion order, so the deleted slot before them can't be reused
+        seq = ctrl_probe_seq(hash_code, index->capacity);
+        while (!(mask = ctrl_group(ctrl + seq.pos).match_empty())) { seq.next(); }
+        pos = seq.offset(ctrl_group::lowest(mask));
+    }
+    if (ctrl[pos] == ctrl_empty) { --index->growth_left; }
+    ctrl[pos] = ctrl_h2(hash_code);
+    if (pos < ctrl_tail_size) { ctrl[index->capacity + pos] = ctrl[pos]; }
+    index->slots[pos] = slot_t{hash_code, node};
+}
+
+template<typename CharT, typename Alloc>
+void record_t<CharT, Alloc>::remove_from_hash(list_links_t* node) noexcept {
+    index_t* index = p_->index;
+    std::int8_t* ctrl = index->ctrl();
+    if (p_->size == 1) {
+        // the table becomes empty: drop all tombstones
+        std::memset(ctrl, static_cast<std::uint8_t>(ctrl_empty), index->capacity + ctrl_tail_size);
+        index->growth_left = growth_limit(index->capacity);
+        return;
+    }
+    const std::size_t hash_code = node_t::from_links(node)->hash_code();
+    const std::int8_t h2 = ctrl_h2(hash_code);
+    for (ctrl_probe_seq seq(hash_code, index->capacity);; seq.next()) {
+        for (auto mask = ctrl_group(ctrl + seq.pos).match(h2); mask; mask &= mask - 1) {
+            const std::size_t pos = seq.offset(ctrl_group::lowest(mask));
+            if (index->slots[pos].node == node) {
+                ctrl[pos] = ctrl_deleted;
+                if (pos < ctrl_tail_size) { ctrl[index->capacity + pos] = ctrl_deleted; }
+                return;
+            }
+        }
+    }
 }
 
 template<typename CharT, typename Alloc>
-void record_t<CharT, Alloc>::insert_node(node_t* node, std::size_t hash_code) noexcept {
-    node->hash_code_ = hash_code;
-    add_to_hash(node);
+void record_t<CharT, Alloc>::insert_node(node_t* node) noexcept {
+    node_traits::set_head(&node->links_, &p_->head);
+    if (p_->index) { add_to_hash(&node->links_, node->hash_code()); }
     dllist_insert_before(&p_->head, &node->links_);
     ++p_->size;
 }
 
 template<typename CharT, typename Alloc>
 void record_t<CharT, Alloc>::insert_impl(alloc_type& al, std::initializer_list<mapped_type> init) {
-    if (p_->bucket_count - p_->size < init.size()) { rehash(al, init.size()); }
-    typename node_t::alloc_type node_al(al);
+    reserve(al, init.size());
     for (auto first = init.begin(); first != init.end(); ++first) {
-        const auto key = (*first).value_.arr[0].value_.str.cview();
-        node_t* node = node_t::create(node_al, key, (*first).value_.arr[1]);
-        insert_node(node, hasher_t{}(key));
+        const key_ref_t ref = make_key((*first).cell_.value.arr[0].str_view(), has_key_pool_t());
+        insert_node(new_node(al, ref, (*first).cell_.value.arr[1]));
     }
 }
 
@@ -338,15 +525,28 @@ void record_t<CharT, Alloc>::rehash(alloc_type& al, std::size_t extra) {
         if (extra > max_count - p_->size) { throw std::length_error("too much to reserve"); }
         delta_count = std::max(extra, (max_count - p_->size) >> 1);
     }
-    data_t* p_new = alloc(al, p_->size + delta_count);
-    p_new->init_from(p_);
-    dealloc(al, p_);
-    p_ = p_new;
+    index_t* old_index = p_->index;
+    p_->index = alloc_index(al, capacity_for(p_->size + delta_count));
+    if (old_index) { dealloc_index(al, old_index); }
+    // items are added in insertion order, so items with the same key are found in this order
     for (list_links_t* node = p_->head.next; node != &p_->head; node = node->next) {
-        add_to_hash(node_t::from_links(node));
+        add_to_hash(node, node_t::from_links(node)->hash_code());
     }
 }
 
+template<typename CharT, typename Alloc>
+void record_t<CharT, Alloc>::grow_arena(alloc_type& al, std::size_t count) {
+    assert(!p_->size);
+    count = std::max<std::size_t>(count, small_record_max);
+    if (count > max_arena_size(al)) { return; }
+    data_t* p_new = alloc(al, count);
+    p_new->init();
+    p_new->key_pool = p_->key_pool;
+    p_new->index = p_->index;
+    dealloc(al, p_);
+    p_ = p_new;
+}
+
 template<typename CharT, typename Alloc>
 void record_t<CharT, Alloc>::unique_impl(alloc_type& al) {
     record_t new_rec;
@@ -357,52 +557,99 @@ void record_t<CharT, Alloc>::unique_impl(alloc_type& al) {
 template<typename CharT, typename Alloc>
 void record_t<CharT, Alloc>::clear_impl(alloc_type& al, std::false_type) {
     if (p_->ref_count != 1) {
-        reset(al, alloc(al, 0));
+        data_t* p_new = alloc(al, 0);
+        p_new->key_pool = p_->key_pool;
+        reset(al, p_new);
     } else {
         destruct_items(al);
+        if (p_->index) { dealloc_index(al, p_->index); }
     }
     p_->init();
 }
 
 template<typename CharT, typename Alloc>
-void record_t<CharT, Alloc>::clear_impl(alloc_type& al, std::size_t bucket_count) {
+void record_t<CharT, Alloc>::clear_impl(alloc_type& al, std::size_t count) {
     if (p_->ref_count != 1) {
-        if (bucket_count > max_size(al)) { throw std::length_error("too much to reserve"); }
-        reset(al, alloc(al, bucket_count));
-    } else {
-        destruct_items(al);
+        record_t new_rec;
+        new_rec.construct(al, count);
+        new_rec.p_->key_pool = p_->key_pool;
+        reset(al, new_rec.p_);
+        return;
     }
+    destruct_items(al);
+    if (p_->index) { dealloc_index(al, p_->index); }
     p_->init();
+    if (count > small_record_max) { rehash(al, count); }
 }
 
 template<typename CharT, typename Alloc>
 void record_t<CharT, Alloc>::destruct(alloc_type& al) noexcept {
     destruct_items(al);
+    if (p_->index) { dealloc_index(al, p_->index); }
     dealloc(al, p_);
 }
 
 template<typename CharT, typename Alloc>
-list_links_t* record_t<CharT, Alloc>::find_impl(key_type key, std::size_t hash_code) const noexcept {
-    list_links_t* next_bucket = p_->hashtbl[hash_code % p_->bucket_count];
-    while (next_bucket) {
-        const auto& v = *node_t::from_links(next_bucket);
-        if (v.hash_code_ == hash_code && v.key() == key) { return next_bucket; }
-        next_bucket = v.next_bucket_;
+list_links_t* record_t<CharT, Alloc>::find_impl(const key_ref_t& ref) const noexcept {
+    index_t* index = p_->index;
+    const std::int8_t* ctrl = index->ctrl();
+    const std::int8_t h2 = ctrl_h2(ref.hash_code);
+    for (ctrl_probe_seq seq(ref.hash_code, index->capacity);; seq.next()) {
+        const ctrl_group group(ctrl + seq.pos);
+        for (auto mask = group.match(h2); mask; mask &= mask - 1) {
+            const slot_t& slot = index->slots[seq.offset(ctrl_group::lowest(mask))];
+            if (slot.hash_code == ref.hash_code && node_t::from_links(slot.node)->key_.equal_to(ref)) {
+                return slot.node;
+            }
+        }
+        if (group.match_empty()) { return &p_->head; }
+    }
+}
+
+template<typename CharT, typename Alloc>
+list_links_t* record_t<CharT, Alloc>::find_linear(const key_ref_t& ref) const noexcept {
+    list_links_t* node = p_->head.next;
+    while (node != &p_->head && !node_t::from_links(node)->key_.equal_to(ref)) { node = node->next; }
+    return node;
+}
+
+template<typename CharT, typename Alloc>
+void record_t<CharT, Alloc>::add_memory_stats(memory_stats& st) const noexcept {
+    st.record_bytes += get_alloc_sz(p_->arena_size) * sizeof(data_t);
+    st.record_unused_bytes += (p_->arena_size - p_->arena_used) * sizeof(node_t);
+    for (list_links_t* links = p_->head.next; links != &p_->head; links = links->next) {
+        const node_t* node = node_t::from_links(links);
+        if (!is_in_arena(node)) {
+            st.record_node_bytes += node_t::get_alloc_sz(node->key_.stored_size()) * sizeof(node_t);
+        }
+    }
+    if (p_->index) {
+        st.record_index_bytes += get_index_alloc_sz(p_->index->capacity) * sizeof(index_t);
+        st.record_unused_bytes += (p_->index->capacity - p_->size) * (sizeof(slot_t) + 1);
     }
-    return &p_->head;
 }
 
 template<typename CharT, typename Alloc>
 std::size_t record_t<CharT, Alloc>::count(key_type key) const noexcept {
     std::size_t count = 0;
-    const std::size_t hash_code = hasher_t{}(key);
-    list_links_t* next_bucket = p_->hashtbl[hash_code % p_->bucket_count];
-    while (next_bucket) {
-        const auto& v = *node_t::from_links(next_bucket);
-        if (v.hash_code_ == hash_code && v.key() == key) { ++count; }
-        next_bucket = v.next_bucket_;
+    key_ref_t ref;
+    if (!lookup_key(key, ref, has_key_pool_t())) { return 0; }
+    if (!p_->index) {
+        for (list_links_t* node = p_->head.next; node != &p_->head; node = node->next) {
+            if (node_t::from_links(node)->key_.equal_to(ref)) { ++count; }
+        }
+        return count;
+    }
+    const std::int8_t* ctrl = p_->index->ctrl();
+    const std::int8_t h2 = ctrl_h2(ref.hash_code);
+    for (ctrl_probe_seq seq(ref.hash_code, p_->index->capacity);; seq.next()) {
+        const ctrl_group group(ctrl + seq.pos);
+        for (auto mask = group.match(h2); mask; mask &= mask - 1) {
+            const slot_t& slot = p_->index->slots[seq.offset(ctrl_group::lowest(mask))];
+            if (slot.hash_code == ref.hash_code && node_t::from_links(slot.node)->key_.equal_to(ref)) { ++count; }
+        }
+        if (group.match_empty()) { return count; }
     }
-    return count;
 }
 
 template<typename CharT, typename Alloc>
@@ -416,33 +663,25 @@ list_links_t* record_t<CharT, Alloc>::erase(alloc_type& al, list_links_t* node)
         node = new_node;
         reset(al, new_rec.p_);
     }
-    auto& v = *node_t::from_links(node);
-    list_links_t** p_next_bucket = &p_->hashtbl[v.hash_code_ % p_->bucket_count];
-    while (*p_next_bucket != node) { p_next_bucket = &node_t::from_links(*p_next_bucket)->next_bucket_; }
-    *p_next_bucket = v.next_bucket_;
+    if (p_->index) { remove_from_hash(node); }
     list_links_t* next = dllist_remove(node);
-    typename node_t::alloc_type node_al(al);
-    node_t::destroy(node_al, &v);
-    --p_->size;
+    delete_node(al, node_t::from_links(node));
+    if (!--p_->size) { p_->arena_used = 0; }
     return next;
 }
 
 template<typename CharT, typename Alloc>
 std::size_t record_t<CharT, Alloc>::erase(alloc_type& al, key_type key) {
     unique(al);
+    key_ref_t ref;
+    if (!lookup_key(key, ref, has_key_pool_t())) { return 0; }
     const std::size_t old_sz = p_->size;
-    const std::size_t hash_code = hasher_t{}(key);
-    typename node_t::alloc_type node_al(al);
-    list_links_t** p_next_bucket = &p_->hashtbl[hash_code % p_->bucket_count];
-    while (*p_next_bucket) {
-        auto& v = *node_t::from_links(*p_next_bucket);
-        if (v.hash_code_ == hash_code && v.key() == key) {
-            *p_next_bucket = v.next_bucket_;
-            dllist_remove(&v.links_);
-            node_t::destroy(node_al, &v);
-            --p_->size;
-        } else {
-            p_next_bucket = &v.next_bucket_;
+    list_links_t* node = p_->head.next;
+    if (p_->index) {
+        while ((node = find_impl(ref)) != &p_->head) { erase(al, node); }
+    } else {
+        while (node != &p_->head) {
+            node = node_t::from_links(node)->key_.equal_to(ref) ? erase(al, node) : node->next;
         }
     }
     return old_sz - p_->size;
@@ -463,54 +702,83 @@ bool is_record(std::initializer_list<basic_value<CharT, Alloc>> init) noexcept {
 
 template<typename CharT, typename Alloc>
 basic_value<CharT, Alloc>::basic_value(std::initializer_list<basic_value> init, const Alloc& al)
-    : alloc_type(al), type_(detail::is_record(init) ? dtype::record : dtype::array) {
-    if (type_ == dtype::record) {
+    : alloc_type(al) {
+    cell_.type = detail::is_record(init) ? dtype::record : dtype::array;
+    if (cell_.type == dtype::record) {
         typename record_t::alloc_type rec_al(*this);
-        value_.rec.construct(rec_al, init);
+        cell_.value.rec.construct(rec_al, init);
     } else {
         typename value_array_t::alloc_type arr_al(*this);
-        value_.arr.construct(arr_al, init);
+        cell_.value.arr.construct(arr_al, init);
     }
 }
 
 template<typename CharT, typename Alloc>
 basic_value<CharT, Alloc>& basic_value<CharT, Alloc>::operator=(std::basic_string_view<char_type> s) {
-    if (type_ != dtype::string) {
-        if (type_ != dtype::null) { destroy(); }
-        value_.str.construct();
-        type_ = dtype::string;
+    if (cell_.type == dtype::string && !is_short_string()) {
+        if (s.size() > short_string_capacity) {
+            typename char_array_t::alloc_type str_al(*this);
+            cell_.value.str.assign(str_al, s);
+            return *this;
+        }
+    } else if (s.size() > short_string_capacity) {
+        if (cell_.type != dtype::null) { destroy(); }
+        init_string(s);
+        return *this;
     }
-    typename char_array_t::alloc_type str_al(*this);
-    value_.str.assign(str_al, s);
+    // `s` can refer to this string
+    char_type chars[short_string_capacity];
+    std::copy_n(s.data(), s.size(), chars);
+    if (cell_.type != dtype::null) { destroy(); }
+    init_string(std::basic_string_view<char_type>(chars, s.size()));
     return *this;
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::string_reserve(std::size_t sz) {
-    if (type_ != dtype::string) { init_as_string(); }
+    if (cell_.type != dtype::string) { init_as_string(); }
+    if (is_short_string()) {
+        if (sz > short_string_capacity) { convert_to_long_string(sz, {}); }
+        return;
+    }
     typename char_array_t::alloc_type str_al(*this);
-    value_.str.reserve(str_al, sz);
+    cell_.value.str.reserve(str_al, sz);
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::string_resize(std::size_t sz) {
-    if (type_ != dtype::string) { init_as_string(); }
-    typename char_array_t::alloc_type str_al(*this);
-    value_.str.resize(str_al, sz, '\0');
+    string_resize(sz, '\0');
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::string_resize(std::size_t sz, char_type ch) {
-    if (type_ != dtype::string) { init_as_string(); }
+    if (cell_.type != dtype::string) { init_as_string(); }
+    if (is_short_string()) {
+        if (sz <= short_string_capacity) {
+            if (sz > sstr_.size) { std::fill(sstr_.chars + sstr_.size, sstr_.chars + sz, ch); }
+            sstr_.size = static_cast<std::uint8_t>(sz);
+            return;
+        }
+        convert_to_long_string(sz, {});
+    }
     typename char_array_t::alloc_type str_al(*this);
-    value_.str.resize(str_al, sz, ch);
+    cell_.value.str.resize(str_al, sz, ch);
 }
 
 template<typename CharT, typename Alloc>
 basic_value<CharT, Alloc>& basic_value<CharT, Alloc>::string_append(std::basic_string_view<char_type> s) {
-    if (type_ != dtype::string) { init_as_string(); }
+    if (cell_.type != dtype::string) { init_as_string(); }
+    if (is_short_string()) {
+        if (s.size() <= short_string_capacity - sstr_.size) {
+            std::copy_n(s.data(), s.size(), sstr_.chars + sstr_.size);
+            sstr_.size += static_cast<std::uint8_t>(s.size());
+        } else {
+            convert_to_long_string(sstr_.size + s.size(), s);
+        }
+        return *this;
+    }
     typename char_array_t::alloc_type str_al(*this);
-    value_.str.append(str_al, s);
+    cell_.value.str.append(str_al, s);
     return *this;
 }
 
@@ -518,12 +786,12 @@ template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::assign(std::initializer_list<basic_value> init) {
     if (!detail::is_record(init)) { return assign(array_variant_t{}, init.begin(), init.end()); }
     typename record_t::alloc_type rec_al(*this);
-    if (type_ != dtype::record) {
-        if (type_ != dtype::null) { destroy(); }
-        value_.rec.construct(rec_al, init.size());
-        type_ = dtype::record;
+    if (cell_.type != dtype::record) {
+        if (cell_.type != dtype::null) { destroy(); }
+        cell_.value.rec.construct(rec_al, init.size());
+        cell_.type = dtype::record;
     }
-    value_.rec.assign(rec_al, init);
+    cell_.value.rec.assign(rec_al, init);
 }
 
 template<typename CharT, typename Alloc>
@@ -557,17 +825,17 @@ inline bool is_integral(double d) noexcept {
 
 template<typename CharT, typename Alloc>
 est::optional<bool> basic_value<CharT, Alloc>::get_bool() const {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::null: return est::nullopt();
-        case dtype::boolean: return value_.b;
-        case dtype::integer: return value_.i != 0;
-        case dtype::unsigned_integer: return value_.u != 0;
-        case dtype::long_integer: return value_.i64 != 0;
-        case dtype::unsigned_long_integer: return value_.u64 != 0;
-        case dtype::double_precision: return value_.dbl != 0;
+        case dtype::boolean: return cell_.value.b;
+        case dtype::integer: return cell_.value.i != 0;
+        case dtype::unsigned_integer: return cell_.value.u != 0;
+        case dtype::long_integer: return cell_.value.i64 != 0;
+        case dtype::unsigned_long_integer: return cell_.value.u64 != 0;
+        case dtype::double_precision: return cell_.value.dbl != 0;
         case dtype::string: {
             est::optional<bool> result(est::in_place_t{});
-            return from_basic_string(value_.str.cview(), *result) ? result : est::nullopt();
+            return from_basic_string(str_view(), *result) ? result : est::nullopt();
         } break;
         case dtype::array: return est::nullopt();
         case dtype::record: return est::nullopt();
@@ -577,31 +845,31 @@ est::optional<bool> basic_value<CharT, Alloc>::get_bool() const {
 
 template<typename CharT, typename Alloc>
 est::optional<std::int32_t> basic_value<CharT, Alloc>::get_int() const {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::null: return est::nullopt();
         case dtype::boolean: return est::nullopt();
-        case dtype::integer: return value_.i;
+        case dtype::integer: return cell_.value.i;
         case dtype::unsigned_integer:
-            return value_.u <= static_cast<std::uint32_t>(std::numeric_limits<std::int32_t>::max()) ?
-                       est::make_optional(static_cast<std::int32_t>(value_.u)) :
+            return cell_.value.u <= static_cast<std::uint32_t>(std::numeric_limits<std::int32_t>::max()) ?
+                       est::make_optional(static_cast<std::int32_t>(cell_.value.u)) :
                        est::nullopt();
         case dtype::long_integer:
-            return value_.i64 >= std::numeric_limits<std::int32_t>::min() &&
-                           value_.i64 <= std::numeric_limits<std::int32_t>::max() ?
-                       est::make_optional(static_cast<std::int32_t>(value_.i64)) :
+            return cell_.value.i64 >= std::numeric_limits<std::int32_t>::min() &&
+                           cell_.value.i64 <= std::numeric_limits<std::int32_t>::max() ?
+                       est::make_optional(static_cast<std::int32_t>(cell_.value.i64)) :
                        est::nullopt();
         case dtype::unsigned_long_integer:
-            return value_.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max()) ?
-                       est::make_optional(static_cast<std::int32_t>(value_.u64)) :
+            return cell_.value.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max()) ?
+                       est::make_optional(static_cast<std::int32_t>(cell_.value.u64)) :
                        est::nullopt();
         case dtype::double_precision:
-            return value_.dbl >= std::numeric_limits<std::int32_t>::min() &&
-                           value_.dbl <= std::numeric_limits<std::int32_t>::max() ?
-                       est::make_optional(static_cast<std::int32_t>(value_.dbl)) :
+            return cell_.value.dbl >= std::numeric_limits<std::int32_t>::min() &&
+                           cell_.value.dbl <= std::numeric_limits<std::int32_t>::max() ?
+                       est::make_optional(static_cast<std::int32_t>(cell_.value.dbl)) :
                        est::nullopt();
         case dtype::string: {
             est::optional<std::int32_t> result(est::in_place_t{});
-            return from_basic_string(value_.str.cview(), *result) ? result : est::nullopt();
+            return from_basic_string(str_view(), *result) ? result : est::nullopt();
         } break;
         case dtype::array: return est::nullopt();
         case dtype::record: return est::nullopt();
@@ -611,28 +879,28 @@ est::optional<std::int32_t> basic_value<CharT, Alloc>::get_int() const {
 
 template<typename CharT, typename Alloc>
 est::optional<std::uint32_t> basic_value<CharT, Alloc>::get_uint() const {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::null: return est::nullopt();
         case dtype::boolean: return est::nullopt();
         case dtype::integer:
-            return value_.i >= 0 ? est::make_optional(static_cast<std::uint32_t>(value_.i)) : est::nullopt();
-        case dtype::unsigned_integer: return value_.u;
+            return cell_.value.i >= 0 ? est::make_optional(static_cast<std::uint32_t>(cell_.value.i)) : est::nullopt();
+        case dtype::unsigned_integer: return cell_.value.u;
         case dtype::long_integer:
-            return value_.i64 >= 0 &&
-                           value_.i64 <= static_cast<std::int64_t>(std::numeric_limits<std::uint32_t>::max()) ?
-                       est::make_optional(static_cast<std::uint32_t>(value_.i64)) :
+            return cell_.value.i64 >= 0 &&
+                           cell_.value.i64 <= static_cast<std::int64_t>(std::numeric_limits<std::uint32_t>::max()) ?
+                       est::make_optional(static_cast<std::uint32_t>(cell_.value.i64)) :
                        est::nullopt();
         case dtype::unsigned_long_integer:
-            return value_.u64 <= std::numeric_limits<std::uint32_t>::max() ?
-                       est::make_optional(static_cast<std::uint32_t>(value_.u64)) :
+            return cell_.value.u64 <= std::numeric_limits<std::uint32_t>::max() ?
+                       est::make_optional(static_cast<std::uint32_t>(cell_.value.u64)) :
                        est::nullopt();
         case dtype::double_precision:
-            return value_.dbl >= 0 && value_.dbl <= std::numeric_limits<std::uint32_t>::max() ?
-                       est::make_optional(static_cast<std::uint32_t>(value_.dbl)) :
+            return cell_.value.dbl >= 0 && cell_.value.dbl <= std::numeric_limits<std::uint32_t>::max() ?
+                       est::make_optional(static_cast<std::uint32_t>(cell_.value.dbl)) :
                        est::nullopt();
         case dtype::string: {
             est::optional<std::uint32_t> result(est::in_place_t{});
-            return from_basic_string(value_.str.cview(), *result) ? result : est::nullopt();
+            return from_basic_string(str_view(), *result) ? result : est::nullopt();
         } break;
         case dtype::array: return est::nullopt();
         case dtype::record: return est::nullopt();
@@ -642,25 +910,25 @@ est::optional<std::uint32_t> basic_value<CharT, Alloc>::get_uint() const {
 
 template<typename CharT, typename Alloc>
 est::optional<std::int64_t> basic_value<CharT, Alloc>::get_int64() const {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::null: return est::nullopt();
         case dtype::boolean: return est::nullopt();
-        case dtype::integer: return value_.i;
-        case dtype::unsigned_integer: return static_cast<std::int64_t>(value_.u);
-        case dtype::long_integer: return value_.i64;
+        case dtype::integer: return cell_.value.i;
+        case dtype::unsigned_integer: return static_cast<std::int64_t>(cell_.value.u);
+        case dtype::long_integer: return cell_.value.i64;
         case dtype::unsigned_long_integer:
-            return value_.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) ?
-                       est::make_optional(static_cast<std::int64_t>(value_.u64)) :
+            return cell_.value.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) ?
+                       est::make_optional(static_cast<std::int64_t>(cell_.value.u64)) :
                        est::nullopt();
         case dtype::double_precision:
             // Note that double(2^63 - 1) will be rounded up to 2^63, so maximum is excluded
-            return value_.dbl >= static_cast<double>(std::numeric_limits<std::int64_t>::min()) &&
-                           value_.dbl < static_cast<double>(std::numeric_limits<std::int64_t>::max()) ?
-                       est::make_optional(static_cast<std::int64_t>(value_.dbl)) :
+            return cell_.value.dbl >= static_cast<double>(std::numeric_limits<std::int64_t>::min()) &&
+                           cell_.value.dbl < static_cast<double>(std::numeric_limits<std::int64_t>::max()) ?
+                       est::make_optional(static_cast<std::int64_t>(cell_.value.dbl)) :
                        est::nullopt();
         case dtype::string: {
             est::optional<std::int64_t> result(est::in_place_t{});
-            return from_basic_string(value_.str.cview(), *result) ? result : est::nullopt();
+            return from_basic_string(str_view(), *result) ? result : est::nullopt();
         } break;
         case dtype::array: return est::nullopt();
         case dtype::record: return est::nullopt();
@@ -670,23 +938,25 @@ est::optional<std::int64_t> basic_value<CharT, Alloc>::get_int64() const {
 
 template<typename CharT, typename Alloc>
 est::optional<std::uint64_t> basic_value<CharT, Alloc>::get_uint64() const {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::null: return est::nullopt();
         case dtype::boolean: return est::nullopt();
         case dtype::integer:
-            return value_.i >= 0 ? est::make_optional(static_cast<std::uint64_t>(value_.i)) : est::nullopt();
-        case dtype::unsigned_integer: return value_.u;
+            return cell_.value.i >= 0 ? est::make_optional(static_cast<std::uint64_t>(cell_.value.i)) : est::nullopt();
+        case dtype::unsigned_integer: return cell_.value.u;
         case dtype::long_integer:
-            return value_.i64 >= 0 ? est::make_optional(static_cast<std::uint64_t>(value_.i64)) : est::nullopt();
-        case dtype::unsigned_long_integer: return value_.u64;
+            return cell_.value.i64 >= 0 ? est::make_optional(static_cast<std::uint64_t>(cell_.value.i64)) :
+                                          est::nullopt();
+        case dtype::unsigned_long_integer: return cell_.value.u64;
         case dtype::double_precision:
             // Note that double(2^64 - 1) will be rounded up to 2^64, so maximum is excluded
-            return value_.dbl >= 0 && value_.dbl < static_cast<double>(std::numeric_limits<std::uint64_t>::max()) ?
-                       est::make_optional(static_cast<std::uint64_t>(value_.dbl)) :
+            return cell_.value.dbl >= 0 &&
+                           cell_.value.dbl < static_cast<double>(std::numeric_limits<std::uint64_t>::max()) ?
+                       est::make_optional(static_cast<std::uint64_t>(cell_.value.dbl)) :
                        est::nullopt();
         case dtype::string: {
             est::optional<std::uint64_t> result(est::in_place_t{});
-            return from_basic_string(value_.str.cview(), *result) ? result : est::nullopt();
+            return from_basic_string(str_view(), *result) ? result : est::nullopt();
         } break;
         case dtype::array: return est::nullopt();
         case dtype::record: return est::nullopt();
@@ -696,17 +966,17 @@ est::optional<std::uint64_t> basic_value<CharT, Alloc>::get_uint64() const {
 
 template<typename CharT, typename Alloc>
 est::optional<double> basic_value<CharT, Alloc>::get_double() const {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::null: return est::nullopt();
         case dtype::boolean: return est::nullopt();
-        case dtype::integer: return value_.i;
-        case dtype::unsigned_integer: return value_.u;
-        case dtype::long_integer: return static_cast<double>(value_.i64);
-        case dtype::unsigned_long_integer: return static_cast<double>(value_.u64);
-        case dtype::double_precision: return value_.dbl;
+        case dtype::integer: return cell_.value.i;
+        case dtype::unsigned_integer: return cell_.value.u;
+        case dtype::long_integer: return static_cast<double>(cell_.value.i64);
+        case dtype::unsigned_long_integer: return static_cast<double>(cell_.value.u64);
+        case dtype::double_precision: return cell_.value.dbl;
         case dtype::string: {
             est::optional<double> result(est::in_place_t{});
-            return from_basic_string(value_.str.cview(), *result) ? result : est::nullopt();
+            return from_basic_string(str_view(), *result) ? result : est::nullopt();
         } break;
         case dtype::array: return est::nullopt();
         case dtype::record: return est::nullopt();
@@ -716,41 +986,41 @@ est::optional<double> basic_value<CharT, Alloc>::get_double() const {
 
 template<typename CharT, typename Alloc>
 est::optional<std::basic_string<CharT>> basic_value<CharT, Alloc>::get_string() const {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::null: {
             return est::make_optional<std::basic_string<CharT>>(string_literal<CharT, 'n', 'u', 'l', 'l'>{}());
         } break;
         case dtype::boolean: {
-            return est::make_optional<std::basic_string<CharT>>(value_.b ?
+            return est::make_optional<std::basic_string<CharT>>(cell_.value.b ?
                                                                     string_literal<CharT, 't', 'r', 'u', 'e'>{}() :
                                                                     string_literal<CharT, 'f', 'a', 'l', 's', 'e'>{}());
         } break;
         case dtype::integer: {
             inline_basic_dynbuffer<CharT> buf;
-            to_basic_string(buf, value_.i);
+            to_basic_string(buf, cell_.value.i);
             return est::make_optional<std::basic_string<CharT>>(buf.data(), buf.size());
         } break;
         case dtype::unsigned_integer: {
             inline_basic_dynbuffer<CharT> buf;
-            to_basic_string(buf, value_.u);
+            to_basic_string(buf, cell_.value.u);
             return est::make_optional<std::basic_string<CharT>>(buf.data(), buf.size());
         } break;
         case dtype::long_integer: {
             inline_basic_dynbuffer<CharT> buf;
-            to_basic_string(buf, value_.i64);
+            to_basic_string(buf, cell_.value.i64);
             return est::make_optional<std::basic_string<CharT>>(buf.data(), buf.size());
         } break;
         case dtype::unsigned_long_integer: {
             inline_basic_dynbuffer<CharT> buf;
-            to_basic_string(buf, value_.u64);
+            to_basic_string(buf, cell_.value.u64);
             return est::make_optional<std::basic_string<CharT>>(buf.data(), buf.size());
         } break;
         case dtype::double_precision: {
             inline_basic_dynbuffer<CharT> buf;
-            to_basic_string(buf, value_.dbl, fmt_opts{fmt_flags::json_compat});
+            to_basic_string(buf, cell_.value.dbl, fmt_opts{fmt_flags::json_compat});
             return est::make_optional<std::basic_string<CharT>>(buf.data(), buf.size());
         } break;
-        case dtype::string: return est::make_optional<std::basic_string<CharT>>(value_.str.cview());
+        case dtype::string: return est::make_optional<std::basic_string<CharT>>(str_view());
         case dtype::array: return est::nullopt();
         case dtype::record: return est::nullopt();
         default: UXS_UNREACHABLE_CODE;
@@ -761,18 +1031,18 @@ est::optional<std::basic_string<CharT>> basic_value<CharT, Alloc>::get_string()
 
 template<typename CharT, typename Alloc>
 bool basic_value<CharT, Alloc>::is_int() const noexcept {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::integer: return true;
         case dtype::unsigned_integer:
-            return value_.u <= static_cast<std::uint32_t>(std::numeric_limits<std::int32_t>::max());
+            return cell_.value.u <= static_cast<std::uint32_t>(std::numeric_limits<std::int32_t>::max());
         case dtype::long_integer:
-            return value_.i64 >= std::numeric_limits<std::int32_t>::min() &&
-                   value_.i64 <= std::numeric_limits<std::int32_t>::max();
+            return cell_.value.i64 >= std::numeric_limits<std::int32_t>::min() &&
+                   cell_.value.i64 <= std::numeric_limits<std::int32_t>::max();
         case dtype::unsigned_long_integer:
-            return value_.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max());
+            return cell_.value.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max());
         case dtype::double_precision:
-            return value_.dbl >= std::numeric_limits<std::int32_t>::min() &&
-                   value_.dbl <= std::numeric_limits<std::int32_t>::max() && detail::is_integral(value_.dbl);
+            return cell_.value.dbl >= std::numeric_limits<std::int32_t>::min() &&
+                   cell_.value.dbl <= std::numeric_limits<std::int32_t>::max() && detail::is_integral(cell_.value.dbl);
         default: break;
     }
     return false;
@@ -780,16 +1050,16 @@ bool basic_value<CharT, Alloc>::is_int() const noexcept {
 
 template<typename CharT, typename Alloc>
 bool basic_value<CharT, Alloc>::is_uint() const noexcept {
-    switch (type_) {
-        case dtype::integer: return value_.i >= 0;
+    switch (cell_.type) {
+        case dtype::integer: return cell_.value.i >= 0;
         case dtype::unsigned_integer: return true;
         case dtype::long_integer:
-            return value_.i64 >= 0 &&
-                   value_.i64 <= static_cast<std::int64_t>(std::numeric_limits<std::uint32_t>::max());
-        case dtype::unsigned_long_integer: return value_.u64 <= std::numeric_limits<std::uint32_t>::max();
+            return cell_.value.i64 >= 0 &&
+                   cell_.value.i64 <= static_cast<std::int64_t>(std::numeric_limits<std::uint32_t>::max());
+        case dtype::unsigned_long_integer: return cell_.value.u64 <= std::numeric_limits<std::uint32_t>::max();
         case dtype::double_precision:
-            return value_.dbl >= 0 && value_.dbl <= std::numeric_limits<std::uint32_t>::max() &&
-                   detail::is_integral(value_.dbl);
+            return cell_.value.dbl >= 0 && cell_.value.dbl <= std::numeric_limits<std::uint32_t>::max() &&
+                   detail::is_integral(cell_.value.dbl);
         default: break;
     }
     return false;
@@ -797,17 +1067,17 @@ bool basic_value<CharT, Alloc>::is_uint() const noexcept {
 
 template<typename CharT, typename Alloc>
 bool basic_value<CharT, Alloc>::is_int64() const noexcept {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::integer:
         case dtype::unsigned_integer:
         case dtype::long_integer: return true;
         case dtype::unsigned_long_integer:
-            return value_.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+            return cell_.value.u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
         case dtype::double_precision:
             // Note that double(2^63 - 1) will be rounded up to 2^63, so maximum is excluded
-            return value_.dbl >= static_cast<double>(std::numeric_limits<std::int64_t>::min()) &&
-                   value_.dbl < static_cast<double>(std::numeric_limits<std::int64_t>::max()) &&
-                   detail::is_integral(value_.dbl);
+            return cell_.value.dbl >= static_cast<double>(std::numeric_limits<std::int64_t>::min()) &&
+                   cell_.value.dbl < static_cast<double>(std::numeric_limits<std::int64_t>::max()) &&
+                   detail::is_integral(cell_.value.dbl);
         default: break;
     }
     return false;
@@ -815,15 +1085,16 @@ bool basic_value<CharT, Alloc>::is_int64() const noexcept {
 
 template<typename CharT, typename Alloc>
 bool basic_value<CharT, Alloc>::is_uint64() const noexcept {
-    switch (type_) {
-        case dtype::integer: return value_.i >= 0;
+    switch (cell_.type) {
+        case dtype::integer: return cell_.value.i >= 0;
         case dtype::unsigned_integer: return true;
-        case dtype::long_integer: return value_.i64 >= 0;
+        case dtype::long_integer: return cell_.value.i64 >= 0;
         case dtype::unsigned_long_integer: return true;
         case dtype::double_precision:
             // Note that double(2^64 - 1) will be rounded up to 2^64, so maximum is excluded
-            return value_.dbl >= 0 && value_.dbl < static_cast<double>(std::numeric_limits<std::uint64_t>::max()) &&
-                   detail::is_integral(value_.dbl);
+            return cell_.value.dbl >= 0 &&
+                   cell_.value.dbl < static_cast<double>(std::numeric_limits<std::uint64_t>::max()) &&
+                   detail::is_integral(cell_.value.dbl);
         default: break;
     }
     return false;
@@ -831,16 +1102,16 @@ bool basic_value<CharT, Alloc>::is_uint64() const noexcept {
 
 template<typename CharT, typename Alloc>
 bool basic_value<CharT, Alloc>::is_integral() const noexcept {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::integer:
         case dtype::unsigned_integer:
         case dtype::long_integer:
         case dtype::unsigned_long_integer: return true;
         case dtype::double_precision:
             // Note that double(2^64 - 1) will be rounded up to 2^64, so maximum is excluded
-            return value_.dbl >= static_cast<double>(std::numeric_limits<std::int64_t>::min()) &&
-                   value_.dbl < static_cast<double>(std::numeric_limits<std::uint64_t>::max()) &&
-                   detail::is_integral(value_.dbl);
+            return cell_.value.dbl >= static_cast<double>(std::numeric_limits<std::int64_t>::min()) &&
+                   cell_.value.dbl < static_cast<double>(std::numeric_limits<std::uint64_t>::max()) &&
+                   detail::is_integral(cell_.value.dbl);
         default: break;
     }
     return false;
@@ -850,10 +1121,10 @@ bool basic_value<CharT, Alloc>::is_integral() const noexcept {
 
 template<typename CharT, typename Alloc>
 std::size_t basic_value<CharT, Alloc>::size() const noexcept {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::null: return 0;
-        case dtype::array: return value_.arr.size();
-        case dtype::record: return value_.rec.size();
+        case dtype::array: return cell_.value.arr.size();
+        case dtype::record: return cell_.value.rec.size();
         default: break;
     }
     return 1;
@@ -861,10 +1132,10 @@ std::size_t basic_value<CharT, Alloc>::size() const noexcept {
 
 template<typename CharT, typename Alloc>
 auto basic_value<CharT, Alloc>::begin() -> iterator {
-    if (type_ == dtype::record) {
+    if (cell_.type == dtype::record) {
         typename record_t::alloc_type rec_al(*this);
-        value_.rec.unique(rec_al);
-        return iterator(value_.rec.cbegin());
+        cell_.value.rec.unique(rec_al);
+        return iterator(cell_.value.rec.cbegin());
     }
     const auto range = as_array();
     return iterator(range.data(), range.data(), range.data() + range.size());
@@ -872,17 +1143,17 @@ auto basic_value<CharT, Alloc>::begin() -> iterator {
 
 template<typename CharT, typename Alloc>
 auto basic_value<CharT, Alloc>::begin() const noexcept -> const_iterator {
-    if (type_ == dtype::record) { return const_iterator(value_.rec.cbegin()); }
+    if (cell_.type == dtype::record) { return const_iterator(cell_.value.rec.cbegin()); }
     const auto range = as_array();
     return const_iterator(const_cast<value_type*>(range.data()), range.data(), range.data() + range.size());
 }
 
 template<typename CharT, typename Alloc>
 auto basic_value<CharT, Alloc>::end() -> iterator {
-    if (type_ == dtype::record) {
+    if (cell_.type == dtype::record) {
         typename record_t::alloc_type rec_al(*this);
-        value_.rec.unique(rec_al);
-        return iterator(value_.rec.cend());
+        cell_.value.rec.unique(rec_al);
+        return iterator(cell_.value.rec.cend());
     }
     const auto range = as_array();
     return iterator(range.data() + range.size(), range.data(), range.data() + range.size());
@@ -890,7 +1161,7 @@ auto basic_value<CharT, Alloc>::end() -> iterator {
 
 template<typename CharT, typename Alloc>
 auto basic_value<CharT, Alloc>::end() const noexcept -> const_iterator {
-    if (type_ == dtype::record) { return const_iterator(value_.rec.cend()); }
+    if (cell_.type == dtype::record) { return const_iterator(cell_.value.rec.cend()); }
     const auto range = as_array();
     return const_iterator(const_cast<value_type*>(range.data()) + range.size(), range.data(),
                           range.data() + range.size());
@@ -898,31 +1169,35 @@ auto basic_value<CharT, Alloc>::end() const noexcept -> const_iterator {
 
 template<typename CharT, typename Alloc>
 auto basic_value<CharT, Alloc>::find(key_type key) const noexcept -> const_iterator {
-    return type_ == dtype::record ? const_iterator(value_.rec.find(key)) : end();
+    return cell_.type == dtype::record ? const_iterator(cell_.value.rec.find(key)) : end();
 }
 
 template<typename CharT, typename Alloc>
 auto basic_value<CharT, Alloc>::find(key_type key) -> iterator {
-    if (type_ != dtype::record) { return end(); }
+    if (cell_.type != dtype::record) { return end(); }
     typename record_t::alloc_type rec_al(*this);
-    value_.rec.unique(rec_al);
-    return iterator(value_.rec.find(key));
+    cell_.value.rec.unique(rec_al);
+    return iterator(cell_.value.rec.find(key));
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::clear() {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::string: {
+            if (is_short_string()) {
+                sstr_.size = 0;
+                break;
+            }
             typename char_array_t::alloc_type str_al(*this);
-            value_.str.clear(str_al);
+            cell_.value.str.clear(str_al);
         } break;
         case dtype::array: {
             typename value_array_t::alloc_type arr_al(*this);
-            value_.arr.clear(arr_al);
+            cell_.value.arr.clear(arr_al);
         } break;
         case dtype::record: {
             typename record_t::alloc_type rec_al(*this);
-            value_.rec.clear(rec_al);
+            cell_.value.rec.clear(rec_al);
         } break;
         default: break;
     }
@@ -930,122 +1205,149 @@ void basic_value<CharT, Alloc>::clear() {
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::reserve(std::size_t sz) {
-    if (type_ != dtype::array) { init_as_array(); }
+    if (cell_.type == dtype::record) {
+        typename record_t::alloc_type rec_al(*this);
+        cell_.value.rec.unique(rec_al);
+        if (sz > cell_.value.rec.size()) { cell_.value.rec.reserve(rec_al, sz - cell_.value.rec.size()); }
+        return;
+    }
+    if (cell_.type != dtype::array) { init_as_array(); }
     typename value_array_t::alloc_type arr_al(*this);
-    value_.arr.reserve(arr_al, sz);
+    cell_.value.arr.reserve(arr_al, sz);
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::resize(std::size_t sz) {
-    if (type_ != dtype::array) { init_as_array(); }
+    if (cell_.type != dtype::array) { init_as_array(); }
     typename value_array_t::alloc_type arr_al(*this);
-    value_.arr.resize(arr_al, sz, basic_value());
+    cell_.value.arr.resize(arr_al, sz, basic_value());
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::resize(std::size_t sz, const basic_value& v) {
-    if (type_ != dtype::array) { init_as_array(); }
+    if (cell_.type != dtype::array) { init_as_array(); }
     typename value_array_t::alloc_type arr_al(*this);
-    value_.arr.resize(arr_al, sz, v);
+    cell_.value.arr.resize(arr_al, sz, v);
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::erase(std::size_t pos) {
-    if (type_ != dtype::array) { throw database_error("not an array"); }
-    assert(pos < value_.arr.size());
+    if (cell_.type != dtype::array) { throw database_error("not an array"); }
+    assert(pos < cell_.value.arr.size());
     typename value_array_t::alloc_type arr_al(*this);
-    value_.arr.erase(arr_al, value_.arr.cbegin() + pos);
+    cell_.value.arr.erase(arr_al, cell_.value.arr.cbegin() + pos);
 }
 
 template<typename CharT, typename Alloc>
 auto basic_value<CharT, Alloc>::erase(const_iterator it) -> iterator {
     if (it.is_record()) {
-        if (type_ != dtype::record) { throw database_error("not a record"); }
+        if (cell_.type != dtype::record) { throw database_error("not a record"); }
         detail::list_links_t* node = static_cast<detail::list_links_t*>(it.ptr_);
-        uxs_iterator_assert(record_t::node_traits::get_head(node) == value_.rec.cend());
+        uxs_iterator_assert(record_t::node_traits::get_head(node) == cell_.value.rec.cend());
         typename record_t::alloc_type rec_al(*this);
-        return iterator(value_.rec.erase(rec_al, node));
+        return iterator(cell_.value.rec.erase(rec_al, node));
     }
-    if (type_ != dtype::array) { throw database_error("not an array"); }
+    if (cell_.type != dtype::array) { throw database_error("not an array"); }
     basic_value* item = static_cast<basic_value*>(it.ptr_);
-    uxs_iterator_assert(it.begin_ == value_.arr.cbegin() && it.end_ == value_.arr.cend());
+    uxs_iterator_assert(it.begin_ == cell_.value.arr.cbegin() && it.end_ == cell_.value.arr.cend());
     typename value_array_t::alloc_type arr_al(*this);
-    item = value_.arr.erase(arr_al, item);
-    return iterator(item, value_.arr.cbegin(), value_.arr.cend());
+    item = cell_.value.arr.erase(arr_al, item);
+    return iterator(item, cell_.value.arr.cbegin(), cell_.value.arr.cend());
 }
 
 template<typename CharT, typename Alloc>
 std::size_t basic_value<CharT, Alloc>::erase(key_type key) {
-    if (type_ != dtype::record) { throw database_error("not a record"); }
+    if (cell_.type != dtype::record) { throw database_error("not a record"); }
     typename record_t::alloc_type rec_al(*this);
-    return value_.rec.erase(rec_al, key);
+    return cell_.value.rec.erase(rec_al, key);
 }
 
 // --------------------------
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::init_from(const basic_value& other) noexcept {
-    value_ = other.value_;
-    switch (other.type_) {
-        case dtype::string: value_.str.ref(); break;
-        case dtype::array: value_.arr.ref(); break;
-        case dtype::record: value_.rec.ref(); break;
+    copy_cell(other);
+    switch (other.cell_.type) {
+        case dtype::string: {
+            if (!is_short_string()) { cell_.value.str.ref(); }
+        } break;
+        case dtype::array: cell_.value.arr.ref(); break;
+        case dtype::record: cell_.value.rec.ref(); break;
         default: break;
     }
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::destroy() noexcept {
-    switch (type_) {
+    switch (cell_.type) {
         case dtype::string: {
+            if (is_short_string()) { break; }
             typename char_array_t::alloc_type str_al(*this);
-            value_.str.unref(str_al);
+            cell_.value.str.unref(str_al);
         } break;
         case dtype::array: {
             typename value_array_t::alloc_type arr_al(*this);
-            value_.arr.unref(arr_al);
+            cell_.value.arr.unref(arr_al);
         } break;
         case dtype::record: {
             typename record_t::alloc_type rec_al(*this);
-            value_.rec.unref(rec_al);
+            cell_.value.rec.unref(rec_al);
         } break;
         default: break;
     }
-    type_ = dtype::null;
+    cell_.type = dtype::null;
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::init_as_string() {
-    if (type_ != dtype::null) { throw database_error("not a string"); }
-    value_.str.construct();
-    type_ = dtype::string;
+    if (cell_.type != dtype::null) { throw database_error("not a string"); }
+    init_short_string();
+}
+
+template<typename CharT, typename Alloc>
+void basic_value<CharT, Alloc>::convert_to_long_string(std::size_t cap, std::basic_string_view<char_type> tail) {
+    // `tail` can refer to the short string, so characters are copied before the cell is overwritten
+    typename char_array_t::alloc_type str_al(*this);
+    char_array_t str;
+    str.construct();
+    try {
+        str.reserve(str_al, cap);
+        str.append(str_al, std::basic_string_view<char_type>(sstr_.chars, sstr_.size));
+        str.append(str_al, tail);
+    } catch (...) {
+        str.unref(str_al);
+        throw;
+    }
+    cell_.value.str = str;
+    cell_.type = dtype::string;
+    cell_.short_size = long_string;
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::init_as_array() {
-    if (type_ != dtype::null) { throw database_error("not an array"); }
-    value_.arr.construct();
-    type_ = dtype::array;
+    if (cell_.type != dtype::null) { throw database_error("not an array"); }
+    cell_.value.arr.construct();
+    cell_.type = dtype::array;
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::init_as_record() {
-    if (type_ != dtype::null) { throw database_error("not a record"); }
+    if (cell_.type != dtype::null) { throw database_error("not a record"); }
     typename record_t::alloc_type rec_al(*this);
-    value_.rec.construct(rec_al);
-    type_ = dtype::record;
+    cell_.value.rec.construct(rec_al);
+    cell_.type = dtype::record;
 }
 
 template<typename CharT, typename Alloc>
 void basic_value<CharT, Alloc>::convert_to_array() {
     value_array_t arr;
     arr.construct();
-    if (type_ != dtype::null) {
+    if (cell_.type != dtype::null) {
         typename value_array_t::alloc_type arr_al(*this);
         arr.emplace_back(arr_al, std::move(*this));
     }
-    value_.arr = arr;
-    type_ = dtype::array;
+    cell_.value.arr = arr;
+    cell_.type = dtype::array;
 }
 
 }  // namespace db
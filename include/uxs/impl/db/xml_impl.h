@@ -1,5 +1,6 @@
 #pragma once
 
+#include "uxs/db/json.h"
 #include "uxs/db/value.h"
 #include "uxs/db/xml.h"
 
@@ -11,49 +12,52 @@ namespace xml {
 
 // --------------------------
 
+namespace detail {
 template<typename CharT, typename Alloc>
-basic_value<CharT, Alloc> parser::read(std::string_view root_element, const Alloc& al) {
-    static const auto text_to_value = [](std::string_view sval, const Alloc& al) -> basic_value<CharT, Alloc> {
-        switch (classify_value(sval)) {
-            case value_class::empty:
-            case value_class::null_value: return {nullptr, al};
-            case value_class::true_value: return {true, al};
-            case value_class::false_value: return {false, al};
-            case value_class::integer_number: {
-                std::uint64_t u64 = 0;
-                if (from_string(sval, u64) != 0) {
-                    if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max())) {
-                        return {static_cast<std::int32_t>(u64), al};
-                    }
-                    if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max())) {
-                        return {static_cast<std::uint32_t>(u64), al};
-                    }
-                    if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
-                        return {static_cast<std::int64_t>(u64), al};
-                    }
-                    return {u64, al};
+basic_value<CharT, Alloc> text_to_value(std::string_view sval, const Alloc& al) {
+    switch (parser::classify_value(sval)) {
+        case value_class::empty:
+        case value_class::null_value: return {nullptr, al};
+        case value_class::true_value: return {true, al};
+        case value_class::false_value: return {false, al};
+        case value_class::integer_number: {
+            std::uint64_t u64 = 0;
+            if (from_string(sval, u64) != 0) {
+                if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max())) {
+                    return {static_cast<std::int32_t>(u64), al};
                 }
-                // too big integer - treat as double
-                return {from_string<double>(sval), al};
-            } break;
-            case value_class::negative_integer_number: {
-                std::int64_t i64 = 0;
-                if (from_string(sval, i64) != 0) {
-                    if (i64 >= static_cast<std::int64_t>(std::numeric_limits<std::int32_t>::min())) {
-                        return {static_cast<std::int32_t>(i64), al};
-                    }
-                    return {i64, al};
+                if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max())) {
+                    return {static_cast<std::uint32_t>(u64), al};
                 }
-                // too big integer - treat as double
-                return {from_string<double>(sval), al};
-            } break;
-            case value_class::floating_point_number: return {from_string<double>(sval), al};
-            case value_class::ws_with_nl: return make_record<CharT>(al);
-            case value_class::other: return {utf_string_adapter<CharT>{}(sval), al};
-            default: UXS_UNREACHABLE_CODE;
-        }
-    };
+                if (u64 <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                    return {static_cast<std::int64_t>(u64), al};
+                }
+                return {u64, al};
+            }
+            // too big integer - treat as double
+            return {from_string<double>(sval), al};
+        } break;
+        case value_class::negative_integer_number: {
+            std::int64_t i64 = 0;
+            if (from_string(sval, i64) != 0) {
+                if (i64 >= static_cast<std::int64_t>(std::numeric_limits<std::int32_t>::min())) {
+                    return {static_cast<std::int32_t>(i64), al};
+                }
+                return {i64, al};
+            }
+            // too big integer - treat as double
+            return {from_string<double>(sval), al};
+        } break;
+        case value_class::floating_point_number: return {from_string<double>(sval), al};
+        case value_class::ws_with_nl: return make_record<CharT>(al);
+        case value_class::other: return {utf_string_adapter<CharT>{}(sval), al};
+        default: UXS_UNREACHABLE_CODE;
+    }
+}
+}  // namespace detail
 
+template<typename CharT, typename Alloc>
+basic_value<CharT, Alloc> parser::read(std::string_view root_element, const Alloc& al) {
     auto tt = token_type();
     while (!eof() && !(tt == token_t::start_element && name() == root_element)) { tt = next(); }
     if (eof()) { throw database_error("no such element"); }
@@ -83,7 +87,7 @@ basic_value<CharT, Alloc> parser::read(std::string_view root_element, const Allo
                 if (!result.second) { stack.back().first = &result.first.value().emplace_back(al); }
                 for (const auto& attr : attributes()) {
                     stack.back().first->emplace_unique(utf_string_adapter<CharT>{}(attr.first),
-                                                       text_to_value(attr.second, al));
+                                                       detail::text_to_value<CharT>(attr.second, al));
                 }
             } break;
             case token_t::end_element: {
@@ -91,7 +95,7 @@ basic_value<CharT, Alloc> parser::read(std::string_view root_element, const Allo
                     throw database_error(to_string(lexer_.ln) + ": unterminated element " + top.second);
                 }
                 if (!top.first->is_record() && !txt.empty()) {
-                    *(top.first) = text_to_value(std::string_view(txt.data(), txt.size()), al);
+                    *(top.first) = detail::text_to_value<CharT>(std::string_view(txt.data(), txt.size()), al);
                 }
                 stack.pop_back();
                 if (stack.empty()) { return result; }
@@ -102,6 +106,154 @@ basic_value<CharT, Alloc> parser::read(std::string_view root_element, const Allo
     }
 }
 
+template<typename CharT>
+void parser::to_json(std::string_view root_element, json::stream_writer<CharT>& out) {
+    using value_t = basic_value<char>;
+
+    // Elements, which are written directly: the root element and array items following the first one; the first
+    // element of same-named siblings is read to `held` value as with `read()`, and is written when the next sibling
+    // tells whether it is an array item
+    struct level_t {
+        std::string element;
+        bool is_record = false;
+        bool has_held = false;
+        bool is_array = false;
+        std::string held_name;
+        value_t held;
+    };
+
+    auto tt = token_type();
+    while (!eof() && !(tt == token_t::start_element && name() == root_element)) { tt = next(); }
+    if (eof()) { throw database_error("no such element"); }
+
+    const std::allocator<char> al;
+    inline_dynbuffer txt;
+    std::vector<level_t> levels;
+    std::size_t depth = 0;
+    std::vector<std::pair<value_t*, std::string>> stack;
+
+    const auto push_level = [&levels, &depth](std::string_view element) -> level_t& {
+        if (depth == levels.size()) { levels.emplace_back(); }
+        level_t& lvl = levels[depth++];
+        lvl.element.assign(element.data(), element.size());
+        lvl.is_record = lvl.has_held = lvl.is_array = false;
+        return lvl;
+    };
+
+    const auto begin_record = [&out](level_t& lvl) {
+        if (lvl.is_record) { return; }
+        out.begin_object();
+        lvl.is_record = true;
+    };
+
+    const auto flush_held = [&out](level_t& lvl) {
+        if (lvl.is_array) {
+            out.end_array();
+        } else if (lvl.has_held) {
+            out.key(lvl.held_name).value(lvl.held);
+            lvl.held = value_t();
+        }
+        lvl.has_held = lvl.is_array = false;
+    };
+
+    const auto hold = [&flush_held](level_t& lvl, std::string_view name, value_t v) {
+        flush_held(lvl);
+        lvl.has_held = true;
+        lvl.held_name.assign(name.data(), name.size());
+        lvl.held = std::move(v);
+    };
+
+    stack.reserve(32);
+    push_level(root_element);
+
+    tt = next();
+
+    while (true) {
+        switch (tt) {
+            case token_t::eof: throw database_error(to_string(lexer_.ln) + ": unexpected end of file");
+            case token_t::preamble: throw database_error(to_string(lexer_.ln) + ": unexpected document preamble");
+            case token_t::entity: throw database_error(to_string(lexer_.ln) + ": unknown entity name");
+            default: break;
+        }
+
+        if (!stack.empty()) {  // held element is read as with `read()`
+            auto& top = stack.back();
+            switch (tt) {
+                case token_t::plain_text: {
+                    if (!top.first->is_record()) { txt += text(); }
+                } break;
+                case token_t::start_element: {
+                    txt.clear();
+                    auto result = top.first->emplace_unique(name(), al);
+                    stack.emplace_back(&result.first.value(), name());
+                    if (!result.second) { stack.back().first = &result.first.value().emplace_back(al); }
+                    for (const auto& attr : attributes()) {
+                        stack.back().first->emplace_unique(attr.first, detail::text_to_value<char>(attr.second, al));
+                    }
+                } break;
+                case token_t::end_element: {
+                    if (top.second != name()) {
+                        throw database_error(to_string(lexer_.ln) + ": unterminated element " + top.second);
+                    }
+                    if (!top.first->is_record() && !txt.empty()) {
+                        *(top.first) = detail::text_to_value<char>(std::string_view(txt.data(), txt.size()), al);
+                    }
+                    stack.pop_back();
+                } break;
+                default: break;
+            }
+            tt = next();
+            continue;
+        }
+
+        level_t& top = levels[depth - 1];
+        switch (tt) {
+            case token_t::plain_text: {
+                if (!top.is_record) { txt += text(); }
+            } break;
+            case token_t::start_element: {
+                txt.clear();
+                begin_record(top);
+                if (!top.has_held || top.held_name != name()) {
+                    hold(top, name(), value_t(al));
+                    stack.emplace_back(&top.held, name());
+                    for (const auto& attr : attributes()) {
+                        top.held.emplace_unique(attr.first, detail::text_to_value<char>(attr.second, al));
+                    }
+                    break;
+                }
+                if (!top.is_array) {
+                    // null value is dropped, when it is converted to array
+                    out.key(top.held_name).begin_array();
+                    if (!top.held.is_null()) { out.value(top.held); }
+                    top.held = value_t();
+                    top.is_array = true;
+                }
+                level_t& item = push_level(name());
+                for (const auto& attr : attributes()) {
+                    begin_record(item);
+                    hold(item, attr.first, detail::text_to_value<char>(attr.second, al));
+                }
+            } break;
+            case token_t::end_element: {
+                if (top.element != name()) {
+                    throw database_error(to_string(lexer_.ln) + ": unterminated element " + top.element);
+                }
+                if (top.is_record) {
+                    flush_held(top);
+                    out.end_object();
+                } else {
+                    out.value(txt.empty() ? value_t(al) :
+                                            detail::text_to_value<char>(std::string_view(txt.data(), txt.size()), al));
+                }
+                if (--depth == 0) { return; }
+            } break;
+            default: break;
+        }
+        tt = next();
+    }
+}
+
 // --------------------------
 
 namespace detail {
@@ -281,6 +433,97 @@ loop:
     out += '>';
 }
 
+template<typename CharT>
+void json_to_xml(basic_membuffer<CharT>& out, ibuf& in, std::string_view element, unsigned indent_size,
+                 char indent_char, unsigned indent) {
+    struct level_t {
+        bool is_record;
+        std::size_t name_pos;  // element name of the container and array items in `names`
+        std::size_t name_len;
+    };
+
+    inline_dynbuffer names;  // names of levels followed by the key of current record item
+    inline_basic_dynbuffer<level_t, 32> stack;
+    std::size_t item_pos = 0, item_len = element.size();
+
+    const auto write_tag = [&out, &names](bool is_closing, std::size_t pos, std::size_t len) {
+        out += '<';
+        if (is_closing) { out += '/'; }
+        utf_string_adapter<CharT>{}.append(out, std::string_view(names.data() + pos, len));
+        out += '>';
+    };
+
+    const auto new_line = [&out, &indent, indent_char]() {
+        out += '\n';
+        out.append(indent, indent_char);
+    };
+
+    const auto end_container = [&]() {
+        const level_t top = stack.back();
+        stack.pop_back();
+        if (top.is_record) {
+            indent -= indent_size;
+            new_line();
+            write_tag(true, top.name_pos, top.name_len);
+        } else if (stack.empty()) {
+            write_tag(true, top.name_pos, top.name_len);
+        }
+    };
+
+    names.append(element.data(), element.size());
+    write_tag(false, 0, element.size());
+
+    json::read(
+        in,
+        [&](json::token_t tt, std::string_view lval, const json::number& num) {
+            const bool is_root = stack.empty();
+            if (tt == json::token_t('[')) {
+                stack.push_back(level_t{false, item_pos, item_len});
+                return json::parse_step::into;
+            }
+            if (!is_root) {
+                new_line();
+                write_tag(false, item_pos, item_len);
+            }
+            switch (tt) {
+                case json::token_t('{'): {
+                    indent += indent_size;
+                    stack.push_back(level_t{true, item_pos, item_len});
+                    return json::parse_step::into;
+                } break;
+                case json::token_t::null_value: out += string_literal<CharT, 'n', 'u', 'l', 'l'>{}(); break;
+                case json::token_t::true_value: out += string_literal<CharT, 't', 'r', 'u', 'e'>{}(); break;
+                case json::token_t::false_value: out += string_literal<CharT, 'f', 'a', 'l', 's', 'e'>{}(); break;
+                case json::token_t::integer_number:
+                case json::token_t::negative_integer_number:
+                case json::token_t::floating_point_number: {
+                    if (num.is_double) {
+                        to_basic_string(out, num.f, fmt_opts{fmt_flags::json_compat});
+                    } else if (tt == json::token_t::integer_number) {
+                        to_basic_string(out, num.u64);
+                    } else {
+                        to_basic_string(out, num.i64);
+                    }
+                } break;
+                case json::token_t::string: write_text<CharT>(out, utf_string_adapter<CharT>{}(lval)); break;
+                default: UXS_UNREACHABLE_CODE;
+            }
+            write_tag(true, item_pos, item_len);
+            return json::parse_step::into;
+        },
+        [&stack, &item_pos, &item_len]() { item_pos = stack.back().name_pos, item_len = stack.back().name_len; },
+        [&stack, &names, &item_pos, &item_len](std::string_view key) {
+            // the name of the innermost level ends last, the key of the previous item is dropped
+            names.setsize(stack.back().name_pos + stack.back().name_len);
+            item_pos = names.size(), item_len = key.size();
+            names.append(key.data(), key.size());
+        },
+        end_container);
+
+    // the root container isn't popped by the reader
+    if (!stack.empty()) { end_container(); }
+}
+
 }  // namespace detail
 
 }  // namespace xml
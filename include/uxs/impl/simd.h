@@ -0,0 +1,66 @@
+#pragma once
+
+// Internal header for library sources: SIMD instruction set detection and helpers; public headers mustn't include
+// it, so they don't depend on intrinsics and on the instruction set, which the library is built for
+
+#include "uxs/common.h"
+
+#if !defined(UXS_USE_SSE2)
+#    if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#        define UXS_USE_SSE2 1
+#    else
+#        define UXS_USE_SSE2 0
+#    endif
+#endif  // !defined(UXS_USE_SSE2)
+
+#if UXS_USE_SSE2 != 0
+#    include <emmintrin.h>
+#endif  // UXS_USE_SSE2 != 0
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif  // defined(_MSC_VER)
+
+namespace uxs {
+namespace detail {
+
+// Index of the lowest set bit of non-zero `mask`
+inline unsigned lowest_bit(std::uint32_t mask) noexcept {
+#if defined(_MSC_VER)
+    unsigned long n = 0;
+    _BitScanForward(&n, mask);
+    return n;
+#elif defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    unsigned n = 0;
+    for (; !(mask & 1); mask >>= 1) { ++n; }
+    return n;
+#endif
+}
+
+// Sets the high bit of each zero byte, without false positives
+inline std::uint64_t zero_bytes(std::uint64_t x) noexcept {
+    const std::uint64_t lows = 0x7f7f7f7f7f7f7f7full;
+    return ~(((x & lows) + lows) | x | lows);
+}
+
+// Gathers high bits of 8 bytes to 8 lower bits
+inline unsigned gather_msbs(std::uint64_t x) noexcept {
+    return static_cast<unsigned>((((x >> 7) & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56);
+}
+
+// Number of set bits of 16-bit `x`
+inline unsigned popcount16(unsigned x) noexcept {
+    x = x - ((x >> 1) & 0x5555);
+    x = (x & 0x3333) + ((x >> 2) & 0x3333);
+    x = (x + (x >> 4)) & 0x0f0f;
+    return (x + (x >> 8)) & 0x1f;
+}
+
+// Number of bytes of `x` with the high bit set, as `zero_bytes` result has
+inline unsigned popcount_msbs(std::uint64_t x) noexcept {
+    return static_cast<unsigned>((((x >> 7) & 0x0101010101010101ull) * 0x0101010101010101ull) >> 56);
+}
+
+}  // namespace detail
+}  // namespace uxs
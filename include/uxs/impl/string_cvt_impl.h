@@ -161,21 +161,53 @@ struct fp10_t {
     unsigned bits_used = 1;
     std::uint64_t bits[fp10_bits_size];
     bool zero_tail = true;
+    // for long mantissas: higher digits fitting in 64 bits and the count of the rest digits in `bits`
+    std::uint64_t prefix = 0;
+    unsigned prefix_tail = 0;
 };
 
 UXS_EXPORT std::uint64_t bignum_mul32(std::uint64_t* x, unsigned sz, std::uint32_t mul, std::uint32_t bias);
 
+template<typename CharT>
+std::enable_if_t<sizeof(CharT) != 1, bool> accum_8digits(const CharT*&, const CharT*, std::uint64_t&) noexcept {
+    return false;
+}
+
+template<typename CharT>
+std::enable_if_t<sizeof(CharT) == 1, bool> accum_8digits(const CharT*& p, const CharT* end,
+                                                        std::uint64_t& m) noexcept {
+    if (end - p < 8) { return false; }
+    // load 8 characters in little-endian order and check them all at once
+    const auto byte = [p](unsigned n) {
+        return static_cast<std::uint64_t>(static_cast<std::uint8_t>(p[n])) << (8 * n);
+    };
+    std::uint64_t v = byte(0) | byte(1) | byte(2) | byte(3) | byte(4) | byte(5) | byte(6) | byte(7);
+    if (((v + 0x4646464646464646) | (v - 0x3030303030303030)) & 0x8080808080808080) { return false; }
+    // combine digits pairwise: to 2-digit, then to 4-digit and 8-digit numbers
+    v -= 0x3030303030303030;
+    v = 10 * v + (v >> 8);
+    v = ((v & 0x000000ff000000ff) * (100 + (1000000ULL << 32)) +
+         ((v >> 16) & 0x000000ff000000ff) * (1 + (10000ULL << 32))) >>
+        32;
+    m = 100000000U * m + static_cast<std::uint32_t>(v);
+    p += 8;
+    return true;
+}
+
 template<typename CharT>
 const CharT* accum_mantissa(const CharT* p, const CharT* end, fp10_t& fp10) noexcept {
     const UXS_CONSTEXPR std::uint64_t short_lim = 1000000000000000000ULL;
     std::uint64_t* m10 = &fp10.bits[max_fp10_mantissa_size - fp10.bits_used];
     if (fp10.bits_used == 1) {
         std::uint64_t m = *m10;
+        while (m < 10000000000ULL && accum_8digits(p, end, m)) {}
         for (unsigned dig = 0; p < end && (dig = dig_v(*p)) < 10 && m < short_lim; ++p) { m = 10U * m + dig; }
         *m10 = m;
     }
     for (unsigned dig = 0; p < end && (dig = dig_v(*p)) < 10; ++p) {
         if (fp10.bits_used < max_fp10_mantissa_size) {
+            if (fp10.bits_used == 1) { fp10.prefix = *m10, fp10.prefix_tail = 0; }
+            ++fp10.prefix_tail;
             const std::uint64_t higher = bignum_mul32(m10, fp10.bits_used, 10U, dig);
             if (higher) { *--m10 = higher, ++fp10.bits_used; }
         } else {
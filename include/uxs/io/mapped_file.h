@@ -0,0 +1,45 @@
+#pragma once
+
+#include "uxs/span.h"
+
+namespace uxs {
+
+// Read-only memory mapping of a whole file: pages are loaded on demand and shared between processes, which map the
+// same file; the mapping stays valid until `close()` regardless of the file handle
+class UXS_EXPORT_ALL_STUFF_FOR_GNUC mapped_file {
+ public:
+    mapped_file() noexcept = default;
+    explicit mapped_file(const char* fname) { open(fname); }
+    explicit mapped_file(const wchar_t* fname) { open(fname); }
+    ~mapped_file() { close(); }
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) noexcept : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr, other.size_ = 0;
+    }
+    mapped_file& operator=(mapped_file&& other) noexcept {
+        if (&other == this) { return *this; }
+        close();
+        data_ = other.data_, size_ = other.size_;
+        other.data_ = nullptr, other.size_ = 0;
+        return *this;
+    }
+
+    bool valid() const noexcept { return data_ != nullptr; }
+    explicit operator bool() const noexcept { return valid(); }
+
+    const char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+    est::span<const char> view() const noexcept { return est::as_span(data_, size_); }
+
+    // Maps the file: returns `false` if the file can't be opened or mapped, or is empty
+    UXS_EXPORT bool open(const char* fname);
+    UXS_EXPORT bool open(const wchar_t* fname);
+    UXS_EXPORT void close() noexcept;
+
+ private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace uxs
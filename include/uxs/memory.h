@@ -2,6 +2,7 @@
 
 #include "utility.h"
 
+#include <atomic>
 #include <memory>
 
 namespace uxs {
@@ -21,6 +22,29 @@ struct is_allocator<Alloc, std::void_t<typename Alloc::value_type, decltype(std:
     : std::true_type {};
 #endif  // __cplusplus < 201703L
 
+// Reference count policies: `atomic_ref_count` allows sharing data between threads, and `plain_ref_count`
+// avoids locked instructions, but shared data must not be accessed from several threads
+struct atomic_ref_count {
+    template<typename Ty>
+    using counter_type = std::atomic<Ty>;
+};
+
+struct plain_ref_count {
+    template<typename Ty>
+    using counter_type = Ty;
+};
+
+// Reference count policy of containers using the allocator: `Alloc::ref_count_policy` if defined, otherwise
+// `atomic_ref_count`
+template<typename Alloc, typename = void>
+struct alloc_ref_count_policy {
+    using type = atomic_ref_count;
+};
+template<typename Alloc>
+struct alloc_ref_count_policy<Alloc, std::void_t<typename Alloc::ref_count_policy>> {
+    using type = typename Alloc::ref_count_policy;
+};
+
 template<typename ToTy, typename FromTy>
 std::unique_ptr<ToTy> static_pointer_cast(std::unique_ptr<FromTy> p) {
     return std::unique_ptr<ToTy>(static_cast<ToTy*>(p.release()));
@@ -0,0 +1,34 @@
+#include "uxs/io/mapped_file.h"
+
+#include "uxs/string_util.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace uxs;
+
+bool mapped_file::open(const char* fname) {
+    close();
+    const int fd = ::open(fname, O_RDONLY | O_LARGEFILE);
+    if (fd < 0) { return false; }
+    struct stat sb;
+    if (::fstat(fd, &sb) != 0 || !S_ISREG(sb.st_mode) || sb.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* p = ::mmap(nullptr, static_cast<std::size_t>(sb.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { return false; }
+    data_ = static_cast<const char*>(p), size_ = static_cast<std::size_t>(sb.st_size);
+    return true;
+}
+
+bool mapped_file::open(const wchar_t* fname) { return open(from_wide_to_utf8(fname).c_str()); }
+
+void mapped_file::close() noexcept {
+    if (!data_) { return; }
+    ::munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr, size_ = 0;
+}
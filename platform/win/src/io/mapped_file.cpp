@@ -0,0 +1,34 @@
+#include "uxs/io/mapped_file.h"
+
+#include "uxs/string_util.h"
+
+#include <windows.h>
+
+using namespace uxs;
+
+bool mapped_file::open(const wchar_t* fname) {
+    close();
+    HANDLE file = ::CreateFileW(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+    LARGE_INTEGER file_size;
+    if (!::GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        ::CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = ::CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    ::CloseHandle(file);
+    if (!mapping) { return false; }
+    void* p = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (!p) { return false; }
+    data_ = static_cast<const char*>(p), size_ = static_cast<std::size_t>(file_size.QuadPart);
+    return true;
+}
+
+bool mapped_file::open(const char* fname) { return open(from_utf8_to_wide(fname).c_str()); }
+
+void mapped_file::close() noexcept {
+    if (!data_) { return; }
+    ::UnmapViewOfFile(data_);
+    data_ = nullptr, size_ = 0;
+}
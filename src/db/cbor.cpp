@@ -0,0 +1,161 @@
+#include "uxs/impl/db/cbor_impl.h"
+
+namespace uxs {
+namespace db {
+namespace cbor {
+
+namespace {
+double half_to_double(std::uint16_t h) {
+    const unsigned exp = (h >> 10) & 0x1f;
+    const unsigned mant = h & 0x3ff;
+    double v = 0;
+    if (exp == 0) {
+        v = std::ldexp(static_cast<double>(mant), -24);
+    } else if (exp != 31) {
+        v = std::ldexp(static_cast<double>(mant + 0x400), static_cast<int>(exp) - 25);
+    } else {
+        v = mant == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+    }
+    return h & 0x8000 ? -v : v;
+}
+}  // namespace
+
+std::uint64_t detail::decoder::argument(std::uint8_t info) {
+    if (info < 24) { return info; }
+    if (info <= 27) { return read_big_endian(1u << (info - 24)); }
+    if (info == 31) { return binary_item::indefinite_count; }
+    throw database_error("invalid CBOR data item");
+}
+
+bool detail::decoder::decode(binary_item& item, bool skip_strings) {
+    while (true) {
+        const std::uint8_t initial = read_byte();
+        const std::uint8_t major = initial >> 5;
+        const std::uint8_t info = initial & 31;
+        if (initial == 0xff) { return false; }
+        if (info == 31 && (major < 2 || major == 6)) { throw database_error("invalid CBOR data item"); }
+        switch (major) {
+            case 0: {
+                const std::uint64_t n = argument(info);
+                if (n <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max())) {
+                    item.type = dtype::integer, item.i = static_cast<std::int32_t>(n);
+                } else if (n <= static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max())) {
+                    item.type = dtype::unsigned_integer, item.u = static_cast<std::uint32_t>(n);
+                } else if (n <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                    item.type = dtype::long_integer, item.i64 = static_cast<std::int64_t>(n);
+                } else {
+                    item.type = dtype::unsigned_long_integer, item.u64 = n;
+                }
+                return true;
+            }
+            case 1: {
+                // the value is `-1 - n`
+                const std::uint64_t n = argument(info);
+                if (n <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max())) {
+                    item.type = dtype::integer, item.i = -1 - static_cast<std::int32_t>(n);
+                } else if (n <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                    item.type = dtype::long_integer, item.i64 = -1 - static_cast<std::int64_t>(n);
+                } else {
+                    // too big integer - treat as double
+                    item.type = dtype::double_precision, item.d = -1. - static_cast<double>(n);
+                }
+                return true;
+            }
+            case 2:
+            case 3: {
+                item.type = dtype::string;
+                if (info != 31) {
+                    const std::uint64_t n = argument(info);
+                    if (skip_strings) {
+                        skip_bytes(n);
+                    } else {
+                        item.str = read_bytes(n);
+                    }
+                    return true;
+                }
+                // indefinite length string: definite length chunks of the same major type up to break code
+                str.clear();
+                for (std::uint8_t chunk = read_byte(); chunk != 0xff; chunk = read_byte()) {
+                    if ((chunk >> 5) != major || (chunk & 31) == 31) { throw database_error("invalid CBOR data item"); }
+                    const std::uint64_t n = argument(chunk & 31);
+                    if (skip_strings) {
+                        skip_bytes(n);
+                    } else {
+                        read_bytes(n, true);
+                    }
+                }
+                item.str = std::string_view(str.data(), str.size());
+                return true;
+            }
+            case 4:
+            case 5: {
+                item.type = major == 4 ? dtype::array : dtype::record;
+                item.count = argument(info);
+                return true;
+            }
+            case 6: {
+                // tags are ignored
+                argument(info);
+            } break;
+            default: {
+                switch (info) {
+                    case 20:
+                    case 21: item.type = dtype::boolean, item.b = info == 21; return true;
+                    case 22:
+                    case 23: item.type = dtype::null; return true;
+                    case 25: {
+                        item.type = dtype::double_precision;
+                        item.d = half_to_double(static_cast<std::uint16_t>(read_big_endian(2)));
+                        return true;
+                    }
+                    case 26: item.type = dtype::double_precision, item.d = read_float(); return true;
+                    case 27: item.type = dtype::double_precision, item.d = read_double(); return true;
+                    default: throw database_error("unsupported CBOR simple value");
+                }
+            } break;
+        }
+    }
+}
+
+bool detail::decoder::next(binary_item& item) { return decode(item, false); }
+
+void detail::decoder::skip(const binary_item& item) {
+    // count of items to skip in each open container
+    inline_basic_dynbuffer<std::uint64_t, 32> counts;
+    const auto push_container = [&counts](const binary_item& container) {
+        if (container.type == dtype::record && container.count != binary_item::indefinite_count) {
+            if (container.count > (binary_item::indefinite_count >> 1)) {
+                throw database_error("invalid CBOR data item");
+            }
+            counts.push_back(container.count << 1);
+        } else {
+            counts.push_back(container.count);
+        }
+    };
+
+    push_container(item);
+    binary_item nested;
+    while (!counts.empty()) {
+        std::uint64_t& top = counts.back();
+        if (!top) {
+            counts.pop_back();
+            continue;
+        }
+        if (!decode(nested, true)) {
+            if (top != binary_item::indefinite_count) { throw database_error("unexpected break code"); }
+            counts.pop_back();
+            continue;
+        }
+        if (top != binary_item::indefinite_count) { --top; }
+        if (nested.type >= dtype::array) { push_container(nested); }
+    }
+}
+
+template UXS_EXPORT basic_value<char> read(ibuf&, const std::allocator<char>&);
+template UXS_EXPORT basic_value<wchar_t> read(ibuf&, const std::allocator<wchar_t>&);
+template UXS_EXPORT void detail::writer::do_write(const basic_value<char>&);
+template UXS_EXPORT void detail::writer::do_write(const basic_value<wchar_t>&);
+
+}  // namespace cbor
+}  // namespace db
+}  // namespace uxs
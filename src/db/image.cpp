@@ -0,0 +1,242 @@
+#include "uxs/impl/db/image_impl.h"
+
+namespace uxs {
+namespace db {
+namespace image {
+
+namespace {
+const char image_magic[4] = {'U', 'X', 'S', 'I'};
+
+std::uint64_t align8(std::uint64_t n) noexcept { return (n + 7) & ~std::uint64_t(7); }
+
+std::uint32_t index_size_for(std::size_t count) noexcept {
+    std::uint32_t size = count ? 2 : 0;
+    while (size < 2 * count) { size <<= 1; }
+    return size;
+}
+}  // namespace
+
+// --------------------------
+
+detail::builder::builder() { buf_.append(header_size, '\0'); }
+
+std::uint64_t detail::builder::alloc(std::size_t size) {
+    const std::uint64_t offset = align8(buf_.size());
+    buf_.append(static_cast<std::size_t>(offset + size - buf_.size()), '\0');
+    return offset;
+}
+
+void detail::builder::set_scalar(std::uint64_t slot, dtype type, std::uint64_t bits) noexcept {
+    buf_[slot] = static_cast<char>(type);
+    store(slot + 8, bits);
+}
+
+void detail::builder::set_string(std::uint64_t slot, std::string_view s) {
+    buf_[slot] = static_cast<char>(dtype::string);
+    if (s.size() <= max_inline_size) {
+        buf_[slot + 1] = 1;
+        buf_[slot + 2] = static_cast<char>(s.size());
+        if (!s.empty()) { std::memcpy(buf_.data() + slot + 3, s.data(), s.size()); }
+        return;
+    }
+    if (s.size() > std::numeric_limits<std::uint32_t>::max()) { throw database_error("too long string"); }
+    const std::uint64_t offset = alloc(s.size());
+    std::memcpy(buf_.data() + offset, s.data(), s.size());
+    store(slot + 4, static_cast<std::uint32_t>(s.size()));
+    store(slot + 8, offset);
+}
+
+std::uint64_t detail::builder::set_container(std::uint64_t slot, dtype type, std::size_t count) {
+    if (count > (std::size_t(1) << 30)) { throw database_error("too big container"); }
+    buf_[slot] = static_cast<char>(type);
+    store(slot + 4, static_cast<std::uint32_t>(count));
+    if (type == dtype::array) {
+        const std::uint64_t offset = alloc(count * slot_size);
+        store(slot + 8, offset);
+        return offset;
+    }
+    const std::uint32_t index_size = index_size_for(count);
+    const std::uint64_t items_offset = 8 + align8(std::uint64_t(index_size) * 4);
+    const std::uint64_t node = alloc(static_cast<std::size_t>(items_offset + count * 2 * slot_size));
+    store(node, index_size);
+    store(slot + 8, node);
+    return node + items_offset;
+}
+
+void detail::builder::build_index(std::uint64_t slot) noexcept {
+    const auto key_at = [this](std::uint64_t key_slot) {
+        if (buf_[key_slot + 1]) {
+            return std::string_view(buf_.data() + key_slot + 3, static_cast<std::uint8_t>(buf_[key_slot + 2]));
+        }
+        return std::string_view(buf_.data() + load<std::uint64_t>(key_slot + 8), load<std::uint32_t>(key_slot + 4));
+    };
+
+    const std::uint32_t count = load<std::uint32_t>(slot + 4);
+    const std::uint64_t node = load<std::uint64_t>(slot + 8);
+    const std::uint32_t index_size = load<std::uint32_t>(node);
+    const std::uint64_t items = node + 8 + align8(std::uint64_t(index_size) * 4);
+    for (std::uint32_t n = 0; n < count; ++n) {
+        const std::string_view key = key_at(items + std::uint64_t(n) * 2 * slot_size);
+        std::uint32_t h = key_hash(key) & (index_size - 1);
+        // only the first of equal keys is indexed
+        std::uint32_t entry = 0;
+        while ((entry = load<std::uint32_t>(node + 8 + std::uint64_t(h) * 4)) != 0) {
+            if (key_at(items + std::uint64_t(entry - 1) * 2 * slot_size) == key) { break; }
+            h = (h + 1) & (index_size - 1);
+        }
+        if (!entry) { store(node + 8 + std::uint64_t(h) * 4, n + 1); }
+    }
+}
+
+void detail::builder::finish(membuffer& out) {
+    std::memcpy(buf_.data(), image_magic, sizeof(image_magic));
+    store(4, static_cast<std::uint32_t>(image_version));
+    store(8, static_cast<std::uint64_t>(buf_.size()));
+    out.append(buf_.data(), buf_.size());
+}
+
+// --------------------------
+
+document::document(est::span<const char> data) : data_(data.data()), size_(data.size()) {
+    if (size_ < detail::header_size || std::memcmp(data_, image_magic, sizeof(image_magic)) != 0) {
+        throw database_error("not a value image");
+    }
+    if (load<std::uint32_t>(4) != detail::image_version) { throw database_error("unsupported value image version"); }
+    const std::uint64_t size = load<std::uint64_t>(8);
+    if (size < detail::header_size || size > size_) { throw database_error("invalid value image"); }
+    size_ = static_cast<std::size_t>(size);
+}
+
+std::string_view document::string_at(std::uint64_t slot) const {
+    if (data_[slot + 1]) {
+        const std::uint8_t size = static_cast<std::uint8_t>(data_[slot + 2]);
+        if (size > detail::max_inline_size) { throw database_error("invalid value image"); }
+        return std::string_view(data_ + slot + 3, size);
+    }
+    const std::uint32_t size = load<std::uint32_t>(slot + 4);
+    const std::uint64_t offset = load<std::uint64_t>(slot + 8);
+    check(offset, size);
+    return std::string_view(data_ + offset, size);
+}
+
+// --------------------------
+
+std::string_view detail::value_ref_iterator::key() const {
+    if (!is_record_) { throw database_error("cannot use key() for non-record iterators"); }
+    return doc_->string_at(offset_);
+}
+
+value_ref detail::value_ref_iterator::value() const noexcept {
+    return value_ref(doc_, is_record_ ? offset_ + slot_size : offset_);
+}
+
+// --------------------------
+
+basic_value<char> value_ref::scalar() const {
+    switch (type()) {
+        case dtype::null:
+        case dtype::array:
+        case dtype::record: return {};
+        case dtype::boolean: return payload() != 0;
+        case dtype::integer: return static_cast<std::int32_t>(payload());
+        case dtype::unsigned_integer: return static_cast<std::uint32_t>(payload());
+        case dtype::long_integer: return static_cast<std::int64_t>(payload());
+        case dtype::unsigned_long_integer: return payload();
+        case dtype::double_precision: {
+            const std::uint64_t bits = payload();
+            double d = 0;
+            std::memcpy(&d, &bits, sizeof(d));
+            return d;
+        }
+        case dtype::string: return doc_->string_at(offset_);
+        default: throw database_error("invalid value image");
+    }
+}
+
+std::uint64_t value_ref::first_item() const {
+    const std::uint64_t count = this->count();
+    const std::uint64_t node = payload();
+    // nodes are written after slots referring to them, so a node offset pointing back would make a loop
+    if (node < offset_ + detail::slot_size) { throw database_error("invalid value image"); }
+    if (is_array()) {
+        doc_->check(node, count * detail::slot_size);
+        return node;
+    }
+    doc_->check(node, 8);
+    const std::uint64_t items_offset = 8 + align8(std::uint64_t(doc_->load<std::uint32_t>(node)) * 4);
+    doc_->check(node, items_offset + count * 2 * detail::slot_size);
+    return node + items_offset;
+}
+
+std::string_view value_ref::as_string_view() const {
+    if (!is_string()) { throw database_error("not a string"); }
+    return doc_->string_at(offset_);
+}
+
+std::size_t value_ref::size() const noexcept {
+    if (is_null()) { return 0; }
+    return is_array() || is_record() ? count() : 1;
+}
+
+auto value_ref::begin() const -> const_iterator {
+    if (!doc_) { return const_iterator(); }
+    return const_iterator(doc_, is_array() || is_record() ? first_item() : offset_, is_record());
+}
+
+auto value_ref::end() const -> const_iterator {
+    if (!doc_) { return const_iterator(); }
+    if (is_array() || is_record()) {
+        return const_iterator(doc_, first_item() + count() * (is_record() ? 2 : 1) * detail::slot_size, is_record());
+    }
+    return const_iterator(doc_, is_null() ? offset_ : offset_ + detail::slot_size, false);
+}
+
+value_ref value_ref::operator[](std::size_t i) const {
+    if (!is_array()) { return i == 0 && !is_null() ? *this : value_ref(); }
+    if (i >= count()) { return value_ref(); }
+    return value_ref(doc_, first_item() + i * detail::slot_size);
+}
+
+value_ref value_ref::operator[](key_type key) const {
+    const auto it = find(key);
+    return it != end() ? it.value() : value_ref();
+}
+
+value_ref value_ref::at(std::size_t i) const {
+    if (i < size()) { return (*this)[i]; }
+    throw database_error("index out of range");
+}
+
+value_ref value_ref::at(key_type key) const {
+    const auto it = find(key);
+    if (it != end()) { return it.value(); }
+    throw database_error("invalid key");
+}
+
+auto value_ref::find(key_type key) const -> const_iterator {
+    const auto it_end = end();
+    if (!is_record()) { return it_end; }
+    const std::uint64_t items = first_item();
+    const std::uint64_t node = payload();
+    const std::uint32_t index_size = doc_->load<std::uint32_t>(node);
+    const std::uint32_t count = this->count();
+    std::uint32_t h = detail::key_hash(key) & (index_size - 1);
+    for (std::uint32_t n = 0; n < index_size; ++n) {
+        const std::uint32_t entry = doc_->load<std::uint32_t>(node + 8 + std::uint64_t(h) * 4);
+        if (!entry) { break; }
+        if (entry > count) { throw database_error("invalid value image"); }
+        const std::uint64_t item = items + std::uint64_t(entry - 1) * 2 * detail::slot_size;
+        if (doc_->string_at(item) == key) { return const_iterator(doc_, item, true); }
+        h = (h + 1) & (index_size - 1);
+    }
+    return it_end;
+}
+
+template UXS_EXPORT basic_value<char> value_ref::to_value(const std::allocator<char>&) const;
+template UXS_EXPORT basic_value<wchar_t> value_ref::to_value(const std::allocator<wchar_t>&) const;
+template UXS_EXPORT void write(membuffer&, const basic_value<char>&);
+template UXS_EXPORT void write(membuffer&, const basic_value<wchar_t>&);
+
+}  // namespace image
+}  // namespace db
+}  // namespace uxs
@@ -1,4 +1,6 @@
 #include "uxs/impl/db/json_impl.h"
+#include "uxs/impl/simd.h"
+#include "uxs/impl/string_cvt_impl.h"
 
 namespace lex_detail {
 #include "json_lex_defs.h"
@@ -11,15 +13,125 @@ namespace uxs {
 namespace db {
 namespace json {
 
+namespace {
+// start conditions for comments, which are skipped without the analyzer
+enum { sc_comment = lex_detail::sc_string + 1, sc_c_comment, sc_c_comment_star };
+
+// Recognizes and decodes the number in one pass: returns `token_t::eof` if the number is malformed or isn't followed
+// by another character in the buffer, so it must be recognized with the analyzer
+token_t decode_number(const char* first, const char* end, const char*& last, number& num) {
+    const UXS_CONSTEXPR unsigned max_digs = 19;     // significant digits, which fit in 64-bit mantissa
+    const UXS_CONSTEXPR int max_exp = 100000;        // too big exponents are handled by `from_string()`
+    const char* p = first;
+    const bool neg = *p == '-';
+    if (neg && ++p == end) { return token_t::eof; }
+    if (!is_digit(*p)) { return token_t::eof; }
+
+    std::uint64_t m = 0;
+    unsigned n_digs = 0;
+    int exp = 0;
+    bool is_real = false, is_exact = true;
+    // returns `false` if the digit is dropped: the number is still exact if only zeroes are dropped
+    const auto accum = [&m, &n_digs, &is_exact](unsigned dig) {
+        if (n_digs == max_digs) {
+            if (dig) { is_exact = false; }
+            return false;
+        }
+        m = 10U * m + dig;
+        if (m) { ++n_digs; }  // leading zeroes aren't significant
+        return true;
+    };
+
+    if (*p == '0') {  // integral part
+        ++p;
+    } else {
+        do {
+            if (!accum(dig_v(*p))) { ++exp; }
+        } while (++p != end && is_digit(*p));
+    }
+    if (p != end && *p == '.') {  // fractional part
+        if (++p == end || !is_digit(*p)) { return token_t::eof; }
+        is_real = true;
+        do {
+            if (accum(dig_v(*p))) { --exp; }
+        } while (++p != end && is_digit(*p));
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {  // exponent
+        if (++p != end && (*p == '+' || *p == '-')) { ++p; }
+        if (p == end || !is_digit(*p)) { return token_t::eof; }
+        const bool neg_exp = *(p - 1) == '-';
+        int exp10 = 0;
+        is_real = true;
+        do {
+            if (exp10 < max_exp) { exp10 = 10 * exp10 + static_cast<int>(dig_v(*p)); }
+        } while (++p != end && is_digit(*p));
+        if (exp10 >= max_exp) { is_exact = false; }
+        exp += neg_exp ? -exp10 : exp10;
+    }
+    if (p == end || is_digit(*p)) { return token_t::eof; }  // end of buffer or a digit after leading zero
+    last = p;
+
+    const token_t tt = is_real ? token_t::floating_point_number :
+                       neg     ? token_t::negative_integer_number :
+                                 token_t::integer_number;
+    if (!is_exact || (!is_real && exp)) {
+        // too many digits or too big exponent: convert the lexeme; an integer with dropped digits has 20 digits or
+        // more, so it is checked against 64-bit range by `lexeme_to_number()`
+        num = detail::lexeme_to_number(tt, to_string_view(first, last));
+        return tt;
+    }
+
+    num.is_double = is_real;
+    if (is_real) {
+        scvt::fp10_t fp10;
+        fp10.bits[scvt::max_fp10_mantissa_size - 1] = m;
+        fp10.exp = exp;
+        using traits = scvt::fp_traits<double>;
+        std::uint64_t fp2 = scvt::fp10_to_fp2(fp10, traits::bits_per_mantissa, traits::exp_max);
+        if (neg) { fp2 |= static_cast<std::uint64_t>(1 + traits::exp_max) << traits::bits_per_mantissa; }
+        num.f = traits::from_u64(fp2);
+    } else if (!neg) {
+        num.u64 = m;
+    } else if (m <= (1ULL << 63)) {
+        num.i64 = static_cast<std::int64_t>(~m + 1);
+    } else {
+        num.is_double = true, num.f = -static_cast<double>(m);
+    }
+    return tt;
+}
+}  // namespace
+
 detail::lexer::lexer(ibuf& in) : in(in) { stack.push_back(lex_detail::sc_initial); }
 
+detail::lexer::lexer(ibuf& in, const lexer& other)
+    : in(in), ln(other.ln), surrogate(other.surrogate), has_more(other.has_more),
+      decode_numbers(other.decode_numbers), raw_strings(other.raw_strings), putback(other.putback), num(other.num) {
+    str.append(other.str.data(), other.str.endp());
+    stash.append(other.stash.data(), other.stash.endp());
+    stack.append(other.stack.data(), other.stack.endp());
+}
+
 token_t detail::lexer::lex(std::string_view& lval) {
-    unsigned surrogate = 0;
+    using tbl = uxs::detail::char_tbl_t;
+    std::int8_t state = 0;
+    std::size_t llen = 0;
+    const char* first = nullptr;
+    int pat = 0;
 
-    while (in.peek() != ibuf::traits_type::eof()) {
-        using tbl = uxs::detail::char_tbl_t;
-        std::int8_t state = 0;
+    if (putback >= 0) {
+        const token_t tt = token_t(putback);
+        putback = -1;
+        return tt;
+    }
 
+    if (stack.size() > 1) {  // continue analysis of the lexeme interrupted by the end of available input
+        in.peek();
+        llen = stack.size() - 1;
+        first = in.curr();
+        goto analyze;
+    }
+
+    while (in.peek() != ibuf::traits_type::eof()) {
         if (stack[0] == lex_detail::sc_initial) {
             const char* curr = in.curr();
             if (tbl{}.flags()[static_cast<std::uint8_t>(*curr)] & tbl::is_json_ws) {  // skip whitespaces
@@ -33,6 +145,16 @@ token_t detail::lexer::lex(std::string_view& lval) {
                 if (!in.avail()) { continue; }
             }
 
+            if (decode_numbers && (*curr == '-' || is_digit(*curr))) {
+                const char* last = nullptr;
+                const token_t tt = decode_number(curr, in.last(), last, num);
+                if (tt != token_t::eof) {
+                    lval = to_string_view(curr, last);
+                    in.setpos(last - in.first());
+                    return tt;
+                }
+            }
+
             // process the first character
             state = lex_detail::Dtran[lex_detail::dtran_width * static_cast<int>(lex_detail::sc_initial) +
                                       lex_detail::symb2meta[static_cast<std::uint8_t>(*curr)]];
@@ -42,7 +164,7 @@ token_t detail::lexer::lex(std::string_view& lval) {
                 stack[0] = lex_detail::sc_string;
                 continue;
             }
-        } else {  // read string
+        } else if (stack[0] == lex_detail::sc_string) {  // read string
             const char* curr0 = in.curr();
             const char* curr = std::find_if(
                 curr0, in.last(), [](std::uint8_t ch) { return !!(tbl{}.flags()[ch] & tbl::is_string_special); });
@@ -63,6 +185,7 @@ token_t detail::lexer::lex(std::string_view& lval) {
                 }
                 in.advance(1);
                 stack[0] = lex_detail::sc_initial;
+                surrogate = 0;
                 return token_t::string;
             }
 
@@ -73,20 +196,42 @@ token_t detail::lexer::lex(std::string_view& lval) {
             // process '\\' character
             state = lex_detail::Dtran[lex_detail::dtran_width * static_cast<int>(lex_detail::sc_string) +
                                       lex_detail::symb2meta[static_cast<int>('\\')]];
+        } else if (stack[0] == sc_comment) {  // skip till end of line or end of file
+            const char* curr = std::find_if(in.curr(), in.last(), [](char ch) { return ch == '\n' || ch == 0; });
+            in.setpos(curr - in.first());
+            if (!in.avail()) { continue; }
+            if (*curr == 0) { return token_t::eof; }
+            in.advance(1);
+            ++ln;
+            stack[0] = lex_detail::sc_initial;
+            continue;
+        } else {  // skip till `*/`
+            const char* curr = in.curr();
+            for (; curr != in.last(); ++curr) {
+                if (*curr == 0) { throw database_error(to_string(ln) + ": unterminated C-style comment"); }
+                if (*curr == '\n') { ++ln; }
+                if (stack[0] == sc_c_comment_star && *curr == '/') { break; }
+                stack[0] = *curr == '*' ? sc_c_comment_star : sc_c_comment;
+            }
+            in.setpos(curr - in.first());
+            if (!in.avail()) { continue; }
+            in.advance(1);
+            stack[0] = lex_detail::sc_initial;
+            continue;
         }
 
-        int pat = 0;
-
         // accept the first character
-        std::size_t llen = 1;
-        const char* first = in.curr() + 1;
+        llen = 1;
+        first = in.curr() + 1;
         stack.push_back(state);
 
+    analyze:
         while (true) {
             const char* last = in.last();
             if (stack.avail() < static_cast<std::size_t>(last - first)) { last = first + stack.avail(); }
             auto* sptr = stack.endp();
-            pat = lex_detail::lex(first, last, &sptr, &llen, last != in.last() || in ? lex_detail::flag_has_more : 0);
+            pat = lex_detail::lex(first, last, &sptr, &llen,
+                                  last != in.last() || in || has_more ? lex_detail::flag_has_more : 0);
             stack.setsize(sptr - stack.data());
             if (pat >= lex_detail::predef_pat_default) { break; }
             if (last != in.last()) {
@@ -95,7 +240,7 @@ token_t detail::lexer::lex(std::string_view& lval) {
                 first = last;
                 continue;
             }
-            if (!in) { return token_t::eof; }  // end of sequence, first == last
+            if (!in) { return token_t::eof; }  // end of available input, first == last
             // append read buffer to stash
             stash.append(in.curr(), in.last());
             in.setpos(in.capacity());
@@ -108,20 +253,32 @@ token_t detail::lexer::lex(std::string_view& lval) {
         if (stash.empty()) {  // the stash is empty
             in.advance(llen);
         } else {
-            if (llen >= stash.size()) {
-                // all characters in stash buffer are used concatenate full lexeme in stash
-                const std::size_t len_rest = llen - stash.size();
-                stash.append(in.curr(), len_rest);
-                in.advance(len_rest);
-            } else {
-                // at least one character in stash is yet unused
-                // put unused chars back to `ibuf`
-                for (std::size_t n = 0; n < stash.size() - llen; ++n) { in.unget(); }
+            if (llen < stash.size()) {
+                // unused characters are in the stash, so they can't be put back to input buffer,
+                // but by JSON grammar they can't be a beginning of valid token anyway
+                if (stack[0] != lex_detail::sc_initial) {  // inside of a string
+                    throw database_error(to_string(ln) + (pat == lex_detail::pat_escape_invalid ?
+                                                              ": invalid escape sequence" :
+                                                              ": invalid value or unexpected character"));
+                }
+                // the first unused character is returned as the next single-character token, as if the whole
+                // input were available; the rest of characters isn't needed, because this token is always invalid
+                putback = static_cast<std::uint8_t>(stash[llen]);
+                stash.setsize(llen);
             }
+            // all characters in stash buffer are used concatenate full lexeme in stash
+            const std::size_t len_rest = llen - stash.size();
+            stash.append(in.curr(), len_rest);
+            in.advance(len_rest);
             lexeme = stash.data();
             stash.clear();  // it resets end pointer, but retains the contents
         }
 
+        if (raw_strings && pat >= lex_detail::pat_escape_quot && pat < lex_detail::pat_escape_invalid) {
+            str.append(lexeme, llen);  // valid escape sequence is kept as is
+            continue;
+        }
+
         switch (pat) {
             // ------ escape sequences
             case lex_detail::pat_escape_quot: str += '\"'; break;
@@ -158,42 +315,25 @@ token_t detail::lexer::lex(std::string_view& lval) {
             case lex_detail::pat_false: return token_t::false_value;
             case lex_detail::pat_decimal: {
                 lval = std::string_view(lexeme, llen);
+                if (decode_numbers) { num = detail::lexeme_to_number(token_t::integer_number, lval); }
                 return token_t::integer_number;
             } break;
             case lex_detail::pat_neg_decimal: {
                 lval = std::string_view(lexeme, llen);
+                if (decode_numbers) { num = detail::lexeme_to_number(token_t::negative_integer_number, lval); }
                 return token_t::negative_integer_number;
             } break;
             case lex_detail::pat_real: {
                 lval = std::string_view(lexeme, llen);
+                if (decode_numbers) { num = detail::lexeme_to_number(token_t::floating_point_number, lval); }
                 return token_t::floating_point_number;
             } break;
 
             // ------ C++ comment
-            case lex_detail::pat_comment: {  // skip till end of line or end of file
-                int ch = 0;
-                while (true) {
-                    ch = in.get();
-                    if (ch == ibuf::traits_type::eof() || ch == 0) { return token_t::eof; }
-                    if (ch == '\n') { break; }
-                }
-                ++ln;
-            } break;
+            case lex_detail::pat_comment: stack[0] = sc_comment; break;
 
             // ------ C comment
-            case lex_detail::pat_c_comment: {  // skip till `*/`
-                int ch = 0;
-                bool star = false;
-                while (true) {
-                    ch = in.get();
-                    if (ch == ibuf::traits_type::eof() || ch == 0) {
-                        throw database_error(to_string(ln) + ": unterminated C-style comment");
-                    }
-                    if (ch == '\n') { ++ln; }
-                    if (star && ch == '/') { break; }
-                    star = (ch == '*');
-                }
-            } break;
+            case lex_detail::pat_c_comment: stack[0] = sc_c_comment; break;
 
             // ------ other single character
             case lex_detail::predef_pat_default: return token_t(static_cast<std::uint8_t>(lexeme[0]));
@@ -202,15 +342,219 @@ token_t detail::lexer::lex(std::string_view& lval) {
         }
     }
 
+    if (stack[0] >= sc_c_comment && !has_more) {
+        throw database_error(to_string(ln) + ": unterminated C-style comment");
+    }
     return token_t::eof;
 }
 
+void detail::lexer::skip(token_t tt) {
+    // the same grammar as in `read_value()` is checked with the same messages, but values aren't converted
+    struct decode_numbers_guard {
+        lexer& lex;
+        bool decode_numbers;
+        ~decode_numbers_guard() { lex.decode_numbers = decode_numbers; }
+    } guard{*this, decode_numbers};
+    decode_numbers = false;  // values of skipped container aren't needed
+
+    inline_basic_dynbuffer<char, 32> nested;
+    nested += tt == token_t::array ? ']' : '}';
+    std::string_view lval;
+    tt = lex(lval);
+    bool empty_allowed = true;
+    while (true) {
+        if (!empty_allowed || tt != token_t(nested.back())) {
+            if (nested.back() == '}') {
+                if (tt != token_t::string) { throw database_error(to_string(ln) + ": expected valid string"); }
+                if (lex(lval) != token_t(':')) { throw database_error(to_string(ln) + ": expected `:`"); }
+                tt = lex(lval);
+            }
+            if (tt == token_t::array || tt == token_t::object) {
+                nested += tt == token_t::array ? ']' : '}';
+                tt = lex(lval);
+                empty_allowed = true;
+                continue;
+            }
+            if (tt < token_t::null_value) {
+                throw database_error(to_string(ln) + ": invalid value or unexpected character");
+            }
+            tt = lex(lval);
+        }
+        while (tt == token_t(nested.back())) {
+            nested.pop_back();
+            if (nested.empty()) { return; }
+            tt = lex(lval);
+        }
+        if (tt != token_t(',')) {
+            throw database_error(to_string(ln) + ": expected `,` or `" + nested.back() + "`");
+        }
+        tt = lex(lval);
+        empty_allowed = false;
+    }
+}
+
+const char* detail::find_escaped_char(const char* first, const char* last) noexcept {
+#if UXS_USE_SSE2 != 0
+    // check 16 characters at once
+    const __m128i v_quot = _mm_set1_epi8('\"');
+    const __m128i v_rev_sol = _mm_set1_epi8('\\');
+    const __m128i v_ctrl = _mm_set1_epi8(31);
+    for (; last - first >= 16; first += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, v_quot), _mm_cmpeq_epi8(x, v_rev_sol)),
+                                       _mm_cmpeq_epi8(_mm_max_epu8(x, v_ctrl), v_ctrl));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(m));
+        if (mask) { return first + uxs::detail::lowest_bit(mask); }
+    }
+#else   // UXS_USE_SSE2 != 0
+    // check 8 characters at once
+    const auto has_less = [](std::uint64_t x, std::uint8_t n) {
+        return (x - 0x0101010101010101ull * n) & ~x & 0x8080808080808080ull;
+    };
+    for (; last - first >= 8; first += 8) {
+        std::uint64_t x = 0;
+        std::memcpy(&x, first, sizeof(x));
+        if (has_less(x, 32) || has_less(x ^ 0x2222222222222222ull, 1) || has_less(x ^ 0x5c5c5c5c5c5c5c5cull, 1)) {
+            break;
+        }
+    }
+#endif  // UXS_USE_SSE2 != 0
+    return std::find_if(first, last, [](std::uint8_t ch) { return ch == '\"' || ch == '\\' || ch < 32; });
+}
+
+namespace {
+// Copies lexemes to the output formatted in the same way as with `write()`, or without whitespaces at all
+class reformatter {
+ public:
+    reformatter(membuffer& out, bool compact, unsigned indent_size, char object_ws_char, char array_ws_char,
+                char indent_char, unsigned indent) noexcept
+        : out_(out), compact_(compact), indent_size_(indent_size), object_ws_char_(object_ws_char),
+          array_ws_char_(array_ws_char), indent_char_(indent_char), indent_(indent) {}
+
+    void run(ibuf& in) {
+        detail::lexer lexer(in);
+        lexer.raw_strings = true;
+        detail::read_value(
+            lexer,
+            [this](token_t tt, std::string_view lval) {
+                switch (tt) {
+                    case token_t::null_value: out_ += string_literal<char, 'n', 'u', 'l', 'l'>{}(); break;
+                    case token_t::true_value: out_ += string_literal<char, 't', 'r', 'u', 'e'>{}(); break;
+                    case token_t::false_value: out_ += string_literal<char, 'f', 'a', 'l', 's', 'e'>{}(); break;
+                    case token_t::string: {
+                        out_ += '\"';
+                        out_ += lval;
+                        out_ += '\"';
+                    } break;
+                    case token_t::array:
+                    case token_t::object: {
+                        out_ += static_cast<char>(tt);
+                        stack_.push_back(level_t{tt == token_t::object, true});
+                    } break;
+                    default: out_ += lval; break;  // number lexeme
+                }
+                return parse_step::into;
+            },
+            [this]() { begin_item(); },
+            [this](std::string_view key) {
+                begin_item();
+                out_ += '\"';
+                out_ += key;
+                if (compact_) {
+                    out_ += string_literal<char, '\"', ':'>{}();
+                } else {
+                    out_ += string_literal<char, '\"', ':', ' '>{}();
+                }
+            },
+            [this]() { end_container(); });
+        if (!stack_.empty()) { end_container(); }  // the root container isn't popped by the reader
+        std::string_view lval;
+        if (lexer.lex(lval) != token_t::eof) {
+            throw database_error(to_string(lexer.ln) + ": unexpected character after the value");
+        }
+    }
+
+ private:
+    struct level_t {
+        bool is_record;
+        bool is_first;
+    };
+
+    membuffer& out_;
+    bool compact_;
+    unsigned indent_size_;
+    char object_ws_char_;
+    char array_ws_char_;
+    char indent_char_;
+    unsigned indent_;
+    inline_basic_dynbuffer<level_t, 32> stack_;
+
+    void begin_item() {
+        auto& top = stack_.back();
+        const char ws_char = top.is_record ? object_ws_char_ : array_ws_char_;
+        if (top.is_first) {
+            if (!compact_ && ws_char == '\n') {
+                indent_ += indent_size_;
+                out_ += '\n';
+                out_.append(indent_, indent_char_);
+            }
+            top.is_first = false;
+        } else {
+            out_ += ',';
+            if (compact_) { return; }
+            out_ += ws_char;
+            if (ws_char == '\n') { out_.append(indent_, indent_char_); }
+        }
+    }
+
+    void end_container() {
+        const auto top = stack_.back();
+        stack_.pop_back();
+        if (!compact_ && !top.is_first && (top.is_record ? object_ws_char_ : array_ws_char_) == '\n') {
+            indent_ -= indent_size_;
+            out_ += '\n';
+            out_.append(indent_, indent_char_);
+        }
+        out_ += top.is_record ? '}' : ']';
+    }
+};
+}  // namespace
+
+void reformat(membuffer& out, ibuf& in, unsigned indent_size, char object_ws_char, char array_ws_char,
+              char indent_char, unsigned indent) {
+    reformatter(out, false, indent_size, object_ws_char, array_ws_char, indent_char, indent).run(in);
+}
+
+void minify(membuffer& out, ibuf& in) { reformatter(out, true, 0, ' ', ' ', ' ', 0).run(in); }
+
+void validate(ibuf& in) {
+    detail::lexer lexer(in);
+    lexer.raw_strings = true;  // strings aren't decoded, but escape sequences are still checked
+    detail::read_value(
+        lexer, [](token_t, std::string_view) { return parse_step::into; }, []() {}, [](std::string_view) {},
+        []() {});
+    std::string_view lval;
+    if (lexer.lex(lval) != token_t::eof) {
+        throw database_error(to_string(lexer.ln) + ": unexpected character after the value");
+    }
+}
+
 template UXS_EXPORT basic_value<char> read(ibuf&, const std::allocator<char>&);
 template UXS_EXPORT basic_value<wchar_t> read(ibuf&, const std::allocator<wchar_t>&);
+template UXS_EXPORT basic_value<char> detail::read_value(detail::lexer&, const std::allocator<char>&);
+template UXS_EXPORT basic_value<wchar_t> detail::read_value(detail::lexer&, const std::allocator<wchar_t>&);
+template UXS_EXPORT membuffer& detail::write_text(membuffer&, std::string_view);
+template UXS_EXPORT wmembuffer& detail::write_text(wmembuffer&, std::wstring_view);
 template UXS_EXPORT void detail::writer<char>::do_write(const basic_value<char>&, unsigned);
 template UXS_EXPORT void detail::writer<char>::do_write(const basic_value<wchar_t>&, unsigned);
 template UXS_EXPORT void detail::writer<wchar_t>::do_write(const basic_value<char>&, unsigned);
 template UXS_EXPORT void detail::writer<wchar_t>::do_write(const basic_value<wchar_t>&, unsigned);
+template UXS_EXPORT void detail::writer<char>::write_key(std::string_view);
+template UXS_EXPORT void detail::writer<char>::write_key(std::wstring_view);
+template UXS_EXPORT void detail::writer<wchar_t>::write_key(std::string_view);
+template UXS_EXPORT void detail::writer<wchar_t>::write_key(std::wstring_view);
+template class UXS_EXPORT_ALL_STUFF_FOR_GNUC stream_writer<char>;
+template class UXS_EXPORT_ALL_STUFF_FOR_GNUC stream_writer<wchar_t>;
 }  // namespace json
 }  // namespace db
 }  // namespace uxs
@@ -0,0 +1,342 @@
+#include "uxs/impl/db/json_document_impl.h"
+#include "uxs/io/iflatbuf.h"
+
+namespace uxs {
+namespace db {
+namespace json {
+
+document::document(std::string text) : text_(std::move(text)) { parse(); }
+
+document::document(ibuf& in) {
+    while (in.peek() != ibuf::traits_type::eof()) {
+        text_.append(in.curr(), in.avail());
+        in.advance(in.avail());
+    }
+    parse();
+}
+
+database_error document::make_error(std::size_t pos, const char* msg) const {
+    const unsigned ln = 1 + static_cast<unsigned>(std::count(text_.begin(), text_.begin() + pos, '\n'));
+    return database_error(to_string(ln) + ": " + msg);
+}
+
+void document::parse() {
+    if (text_.size() >= std::numeric_limits<std::uint32_t>::max()) { throw database_error("too large document"); }
+
+    tape_.clear();
+    tape_.reserve(1 + text_.size() / 8);
+
+    inline_basic_dynbuffer<std::uint32_t, 32> stack;
+    detail::tape_node_t node{};
+    std::size_t pos = 0;
+
+    const auto push_value = [this, &stack, &node](token_t tt) {
+        if (tt == token_t::array || tt == token_t::object) {
+            stack.push_back(static_cast<std::uint32_t>(tape_.size()));
+            tape_.push_back(detail::tape_node_t{tt, node.offset, 0, 0});
+        } else if (tt >= token_t::null_value) {
+            tape_.push_back(node);
+        } else {
+            throw make_error(node.offset, "invalid value or unexpected character");
+        }
+    };
+
+    push_value(scan(pos, node));
+
+    while (!stack.empty()) {
+        const std::uint32_t top = stack.back();
+        const bool is_array = tape_[top].type == token_t::array;
+        const char close_char = is_array ? ']' : '}';
+
+        auto tt = scan(pos, node);
+        if (tt == token_t(close_char)) {
+            tape_[top].extra = static_cast<std::uint32_t>(tape_.size()) - top - 1;
+            stack.pop_back();
+            continue;
+        }
+
+        if (tape_[top].size++ != 0) {
+            if (tt != token_t(',')) {
+                throw make_error(node.offset, is_array ? "expected `,` or `]`" : "expected `,` or `}`");
+            }
+            tt = scan(pos, node);
+        }
+
+        if (!is_array) {
+            if (tt != token_t::string) { throw make_error(node.offset, "expected valid string"); }
+            tape_.push_back(node);
+            if (scan(pos, node) != token_t(':')) { throw make_error(node.offset, "expected `:`"); }
+            tt = scan(pos, node);
+        }
+
+        push_value(tt);
+    }
+}
+
+token_t document::scan(std::size_t& pos, detail::tape_node_t& node) const {
+    using tbl = uxs::detail::char_tbl_t;
+    const char* first = text_.data();
+    const char* last = first + text_.size();
+    const char* p = first + pos;
+
+    while (true) {  // skip whitespaces and comments
+        p = std::find_if(p, last, [](std::uint8_t ch) { return !(tbl{}.flags()[ch] & tbl::is_json_ws); });
+        if (last - p < 2 || *p != '/') { break; }
+        if (p[1] == '/') {
+            p = std::find(p + 2, last, '\n');
+        } else if (p[1] == '*') {
+            const char* p0 = p;
+            const char c_comment_end[] = {'*', '/'};
+            p = std::search(p + 2, last, std::begin(c_comment_end), std::end(c_comment_end));
+            if (p == last) { throw make_error(p0 - first, "unterminated C-style comment"); }
+            p += 2;
+        } else {
+            break;
+        }
+    }
+
+    node.offset = static_cast<std::uint32_t>(p - first);
+    node.extra = detail::string_plain;
+    if (p == last) {
+        pos = p - first;
+        return token_t::eof;
+    }
+
+    token_t tt = token_t(static_cast<std::uint8_t>(*p));
+    const char* p0 = p++;
+
+    const auto match_literal = [&p, last](std::string_view lit) {
+        if (static_cast<std::size_t>(last - p) < lit.size() || std::string_view(p, lit.size()) != lit) {
+            return false;
+        }
+        p += lit.size();
+        return true;
+    };
+
+    switch (*p0) {
+        case '\"': {
+            while (true) {
+                p = std::find_if(p, last,
+                                 [](std::uint8_t ch) { return !!(tbl{}.flags()[ch] & tbl::is_string_special); });
+                if (p == last || *p != '\\') { break; }
+                node.extra = detail::string_escaped;
+                if (++p == last) { break; }
+                switch (*p++) {
+                    case '\"':
+                    case '\\':
+                    case '/':
+                    case 'b':
+                    case 'f':
+                    case 'n':
+                    case 'r':
+                    case 't': break;
+                    case 'u': {
+                        if (last - p >= 4 && is_xdigit(p[0]) && is_xdigit(p[1]) && is_xdigit(p[2]) &&
+                            is_xdigit(p[3])) {
+                            p += 4;
+                            break;
+                        }
+                    } /* fallthrough */
+                    default: throw make_error(p - first, "invalid escape sequence");
+                }
+            }
+            if (p == last || *p != '\"') { throw make_error(p - first, "unterminated string"); }
+            ++node.offset, ++p;
+            tt = token_t::string;
+        } break;
+
+        case 'n': {
+            if (match_literal("ull")) { tt = token_t::null_value; }
+        } break;
+        case 't': {
+            if (match_literal("rue")) { tt = token_t::true_value; }
+        } break;
+        case 'f': {
+            if (match_literal("alse")) { tt = token_t::false_value; }
+        } break;
+
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9': {
+            // {dec} = 0|[1-9]{dig}*, real = -?({dec}(\.{dig}+)?((e|E)(\+|-)?{dig}+)?)
+            if (*p0 == '-') {
+                if (p == last || !is_digit(*p)) { break; }
+                ++p;
+            }
+            if (p[-1] != '0') {
+                while (p != last && is_digit(*p)) { ++p; }
+            }
+            tt = *p0 == '-' ? token_t::negative_integer_number : token_t::integer_number;
+            if (last - p >= 2 && *p == '.' && is_digit(p[1])) {
+                p += 2;
+                while (p != last && is_digit(*p)) { ++p; }
+                tt = token_t::floating_point_number;
+            }
+            if (p != last && (*p == 'e' || *p == 'E')) {
+                const char* p_exp = p + 1;
+                if (p_exp != last && (*p_exp == '+' || *p_exp == '-')) { ++p_exp; }
+                if (p_exp != last && is_digit(*p_exp)) {
+                    p = p_exp + 1;
+                    while (p != last && is_digit(*p)) { ++p; }
+                    tt = token_t::floating_point_number;
+                }
+            }
+        } break;
+
+        default: break;
+    }
+
+    node.type = tt;
+    node.size = static_cast<std::uint32_t>(p - first) - node.offset - (tt == token_t::string ? 1 : 0);
+    pos = p - first;
+    return tt;
+}
+
+std::string_view document::string_at(std::uint32_t index) const {
+    auto& node = tape_[index];
+    if (node.extra == detail::string_escaped) {
+        // the string is decoded by the lexer, so that it is the same as with `read()`; the lexeme is already checked
+        // by `scan()`, and decoded string is never longer, so it is written in place
+        iflatbuf in(std::string_view(&text_[node.offset - 1], node.size + 2));
+        detail::lexer lexer(in);
+        std::string_view lval;
+        lexer.lex(lval);
+        std::copy(lval.begin(), lval.end(), &text_[node.offset]);
+        node.size = static_cast<std::uint32_t>(lval.size());
+        node.extra = detail::string_decoded;
+    }
+    return std::string_view(&text_[node.offset], node.size);
+}
+
+const std::vector<std::uint32_t>& document::key_index(std::uint32_t index) const {
+    auto& tbl = key_index_[index];
+    if (!tbl.empty()) { return tbl; }
+    std::size_t size = 2;
+    while (size < 2 * tape_[index].size) { size <<= 1; }
+    tbl.resize(size);
+    // only the first of equal keys is indexed
+    const std::uint32_t last = next_sibling(index);
+    for (std::uint32_t key = index + 1; key != last; key = next_sibling(key + 1)) {
+        const std::string_view k = string_at(key);
+        std::size_t h = std::hash<std::string_view>{}(k) & (size - 1);
+        while (tbl[h] && string_at(tbl[h] - 1) != k) { h = (h + 1) & (size - 1); }
+        if (!tbl[h]) { tbl[h] = key + 1; }
+    }
+    return tbl;
+}
+
+// --------------------------
+
+void detail::value_ref_iterator::increment() noexcept {
+    index_ = doc_->next_sibling(is_record_ ? index_ + 1 : index_);
+}
+
+std::string_view detail::value_ref_iterator::key() const {
+    if (!is_record_) { throw database_error("cannot use key() for non-record iterators"); }
+    return doc_->string_at(index_);
+}
+
+value_ref detail::value_ref_iterator::value() const noexcept {
+    return value_ref(doc_, is_record_ ? index_ + 1 : index_);
+}
+
+// --------------------------
+
+dtype value_ref::type() const {
+    if (!doc_) { return dtype::null; }
+    switch (node().type) {
+        case token_t::null_value: return dtype::null;
+        case token_t::true_value:
+        case token_t::false_value: return dtype::boolean;
+        case token_t::integer_number:
+        case token_t::negative_integer_number:
+        case token_t::floating_point_number: return scalar().type();
+        case token_t::string: return dtype::string;
+        case token_t::array: return dtype::array;
+        case token_t::object: return dtype::record;
+        default: UXS_UNREACHABLE_CODE;
+    }
+}
+
+basic_value<char> value_ref::scalar() const {
+    if (!doc_ || is_array() || is_record()) { return {}; }
+    const auto tt = node().type;
+    return detail::token_to_value<char>(tt, tt == token_t::string ? doc_->string_at(index_) : doc_->lexeme_at(index_),
+                                        std::allocator<char>());
+}
+
+std::string_view value_ref::as_string_view() const {
+    if (!is_string()) { throw database_error("not a string"); }
+    return doc_->string_at(index_);
+}
+
+std::size_t value_ref::size() const noexcept {
+    if (is_null()) { return 0; }
+    return is_array() || is_record() ? node().size : 1;
+}
+
+auto value_ref::begin() const noexcept -> const_iterator {
+    if (!doc_) { return const_iterator(); }
+    const bool is_container = is_array() || is_record();
+    return const_iterator(doc_, is_container ? index_ + 1 : index_, is_record());
+}
+
+auto value_ref::end() const noexcept -> const_iterator {
+    if (!doc_) { return const_iterator(); }
+    return const_iterator(doc_, is_null() ? index_ : doc_->next_sibling(index_), is_record());
+}
+
+value_ref value_ref::operator[](std::size_t i) const noexcept {
+    if (!is_array()) { return i == 0 && !is_null() ? *this : value_ref(); }
+    if (i >= node().size) { return value_ref(); }
+    std::uint32_t index = index_ + 1;
+    for (; i != 0; --i) { index = doc_->next_sibling(index); }
+    return value_ref(doc_, index);
+}
+
+value_ref value_ref::operator[](key_type key) const {
+    const auto it = find(key);
+    return it != end() ? it.value() : value_ref();
+}
+
+value_ref value_ref::at(std::size_t i) const {
+    if (i < size()) { return (*this)[i]; }
+    throw database_error("index out of range");
+}
+
+value_ref value_ref::at(key_type key) const {
+    const auto it = find(key);
+    if (it != end()) { return it.value(); }
+    throw database_error("invalid key");
+}
+
+auto value_ref::find(key_type key) const -> const_iterator {
+    const auto it_end = end();
+    if (!is_record()) { return it_end; }
+    if (node().size <= document::small_record_max) {
+        for (auto it = begin(); it != it_end; ++it) {
+            if (it.key() == key) { return it; }
+        }
+        return it_end;
+    }
+    const auto& tbl = doc_->key_index(index_);
+    std::size_t h = std::hash<std::string_view>{}(key) & (tbl.size() - 1);
+    for (; tbl[h]; h = (h + 1) & (tbl.size() - 1)) {
+        if (doc_->string_at(tbl[h] - 1) == key) { return const_iterator(doc_, tbl[h] - 1, true); }
+    }
+    return it_end;
+}
+
+template UXS_EXPORT basic_value<char> value_ref::to_value(const std::allocator<char>&) const;
+template UXS_EXPORT basic_value<wchar_t> value_ref::to_value(const std::allocator<wchar_t>&) const;
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,52 @@
+#include "uxs/db/json_lines.h"
+
+namespace uxs {
+namespace db {
+namespace json {
+
+bool detail::line_splitter::next(std::string& storage, std::string_view& block) {
+    if (!in_) {
+        if (text_.empty()) { return false; }
+        std::size_t pos = std::min(block_size_, text_.size() - 1);
+        while (pos < text_.size() - 1 && text_[pos] != '\n') { ++pos; }
+        block = std::string_view(text_.data(), pos + 1);
+        text_ = text_.subspan(pos + 1);
+        return true;
+    }
+
+    storage.clear();
+    storage.swap(carry_);
+    std::size_t pos = std::string::npos;
+    std::size_t scanned = storage.size();  // the carried tail has no line breaks
+    while (true) {
+        if (storage.size() >= block_size_) {
+            // only characters appended since the previous search are scanned, so a long line costs linear time
+            pos = std::string_view(storage).substr(scanned).rfind('\n');
+            if (pos != std::string::npos) {
+                pos += scanned;
+                break;
+            }
+            scanned = storage.size();
+        }
+        if (in_->peek() == ibuf::traits_type::eof()) { break; }
+        storage.append(in_->curr(), in_->avail());
+        in_->advance(in_->avail());
+    }
+
+    if (pos != std::string::npos) {
+        carry_.assign(storage, pos + 1, std::string::npos);
+        storage.resize(pos + 1);
+    }
+    block = std::string_view(storage.data(), storage.size());
+    return !storage.empty();
+}
+
+bool detail::is_blank_line(std::string_view line) noexcept {
+    using tbl = uxs::detail::char_tbl_t;
+    return std::all_of(line.begin(), line.end(),
+                       [](std::uint8_t ch) { return !!(tbl{}.flags()[ch] & tbl::is_json_ws); });
+}
+
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,10 @@
+#include "uxs/impl/db/json_path_impl.h"
+
+namespace uxs {
+namespace db {
+namespace json {
+template UXS_EXPORT void basic_path<char>::compile(std::string_view);
+template UXS_EXPORT void basic_path<wchar_t>::compile(std::wstring_view);
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
@@ -0,0 +1,107 @@
+#include "uxs/impl/db/msgpack_impl.h"
+
+namespace uxs {
+namespace db {
+namespace msgpack {
+
+bool detail::decoder::decode(binary_item& item, bool skip_strings) {
+    const std::uint8_t format = read_byte();
+    std::uint64_t size = 0;
+    if (format < 0x80) {
+        item.type = dtype::integer, item.i = format;
+        return true;
+    } else if (format < 0x90) {
+        item.type = dtype::record, item.count = format & 0xf;
+        return true;
+    } else if (format < 0xa0) {
+        item.type = dtype::array, item.count = format & 0xf;
+        return true;
+    } else if (format < 0xc0) {
+        size = format & 0x1f;
+    } else if (format >= 0xe0) {
+        item.type = dtype::integer, item.i = static_cast<std::int8_t>(format);
+        return true;
+    } else {
+        switch (format) {
+            case 0xc0: item.type = dtype::null; return true;
+            case 0xc2:
+            case 0xc3: item.type = dtype::boolean, item.b = format == 0xc3; return true;
+            case 0xc4:
+            case 0xd9: size = read_big_endian(1); break;
+            case 0xc5:
+            case 0xda: size = read_big_endian(2); break;
+            case 0xc6:
+            case 0xdb: size = read_big_endian(4); break;
+            case 0xca: item.type = dtype::double_precision, item.d = read_float(); return true;
+            case 0xcb: item.type = dtype::double_precision, item.d = read_double(); return true;
+            case 0xcc: item.type = dtype::integer, item.i = static_cast<std::int32_t>(read_big_endian(1)); return true;
+            case 0xcd: item.type = dtype::integer, item.i = static_cast<std::int32_t>(read_big_endian(2)); return true;
+            case 0xce: {
+                item.type = dtype::unsigned_integer, item.u = static_cast<std::uint32_t>(read_big_endian(4));
+                return true;
+            }
+            case 0xcf: item.type = dtype::unsigned_long_integer, item.u64 = read_big_endian(8); return true;
+            case 0xd0: {
+                item.type = dtype::integer, item.i = static_cast<std::int8_t>(read_big_endian(1));
+                return true;
+            }
+            case 0xd1: {
+                item.type = dtype::integer, item.i = static_cast<std::int16_t>(read_big_endian(2));
+                return true;
+            }
+            case 0xd2: {
+                item.type = dtype::integer, item.i = static_cast<std::int32_t>(read_big_endian(4));
+                return true;
+            }
+            case 0xd3: {
+                item.type = dtype::long_integer, item.i64 = static_cast<std::int64_t>(read_big_endian(8));
+                return true;
+            }
+            case 0xdc: item.type = dtype::array, item.count = read_big_endian(2); return true;
+            case 0xdd: item.type = dtype::array, item.count = read_big_endian(4); return true;
+            case 0xde: item.type = dtype::record, item.count = read_big_endian(2); return true;
+            case 0xdf: item.type = dtype::record, item.count = read_big_endian(4); return true;
+            case 0xc1: throw database_error("invalid MessagePack format");
+            default: throw database_error("unsupported MessagePack extension type");
+        }
+    }
+
+    // string or binary data
+    item.type = dtype::string;
+    if (skip_strings) {
+        skip_bytes(size);
+    } else {
+        item.str = read_bytes(size);
+    }
+    return true;
+}
+
+bool detail::decoder::next(binary_item& item) { return decode(item, false); }
+
+void detail::decoder::skip(const binary_item& item) {
+    // count of items to skip in each open container
+    inline_basic_dynbuffer<std::uint64_t, 32> counts;
+    counts.push_back(item.type == dtype::record ? item.count << 1 : item.count);
+    binary_item nested;
+    while (!counts.empty()) {
+        std::uint64_t& top = counts.back();
+        if (!top) {
+            counts.pop_back();
+            continue;
+        }
+        --top;
+        decode(nested, true);
+        if (nested.type >= dtype::array) {
+            counts.push_back(nested.type == dtype::record ? nested.count << 1 : nested.count);
+        }
+    }
+}
+
+template UXS_EXPORT basic_value<char> read(ibuf&, const std::allocator<char>&);
+template UXS_EXPORT basic_value<wchar_t> read(ibuf&, const std::allocator<wchar_t>&);
+template UXS_EXPORT void detail::writer::do_write(const basic_value<char>&);
+template UXS_EXPORT void detail::writer::do_write(const basic_value<wchar_t>&);
+
+}  // namespace msgpack
+}  // namespace db
+}  // namespace uxs
@@ -1,8 +1,42 @@
 #include "uxs/impl/db/value_impl.h"
+#include "uxs/impl/simd.h"
+
+#include <cstring>
 
 namespace uxs {
 namespace db {
 namespace detail {
+
+#if UXS_USE_SSE2 != 0
+ctrl_group::mask_t ctrl_group::match(std::int8_t h2) const noexcept {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<mask_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8(h2))));
+}
+ctrl_group::mask_t ctrl_group::match_empty() const noexcept { return match(ctrl_empty); }
+ctrl_group::mask_t ctrl_group::match_empty_or_deleted() const noexcept {
+    return static_cast<mask_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))));
+}
+#else   // UXS_USE_SSE2 != 0
+namespace {
+// Converts 16 bytes of `ctrl`: the high bit of each byte is set for matched lanes
+template<typename Func>
+ctrl_group::mask_t ctrl_mask(const std::int8_t* ctrl, Func fn) noexcept {
+    std::uint64_t x[2];
+    std::memcpy(x, ctrl, sizeof(x));
+    return static_cast<ctrl_group::mask_t>(uxs::detail::gather_msbs(fn(x[0])) |
+                                           (uxs::detail::gather_msbs(fn(x[1])) << 8));
+}
+}  // namespace
+ctrl_group::mask_t ctrl_group::match(std::int8_t h2) const noexcept {
+    const std::uint64_t v_h2 = 0x0101010101010101ull * static_cast<std::uint8_t>(h2);
+    return ctrl_mask(ctrl, [v_h2](std::uint64_t x) { return uxs::detail::zero_bytes(x ^ v_h2); });
+}
+ctrl_group::mask_t ctrl_group::match_empty() const noexcept { return match(ctrl_empty); }
+ctrl_group::mask_t ctrl_group::match_empty_or_deleted() const noexcept {
+    return ctrl_mask(ctrl, [](std::uint64_t x) { return x; });
+}
+#endif  // UXS_USE_SSE2 != 0
+
 template class flexarray_t<char, std::allocator<char>>;
 template class flexarray_t<wchar_t, std::allocator<wchar_t>>;
 template class UXS_EXPORT_ALL_STUFF_FOR_GNUC flexarray_t<basic_value<char>, std::allocator<char>>;
@@ -16,5 +50,7 @@ template class basic_value<char>;
 template class basic_value<wchar_t>;
 template UXS_EXPORT bool operator==(const basic_value<char>&, const basic_value<char>&) noexcept;
 template UXS_EXPORT bool operator==(const basic_value<wchar_t>&, const basic_value<wchar_t>&) noexcept;
+template UXS_EXPORT memory_stats get_memory_stats(const basic_value<char>&);
+template UXS_EXPORT memory_stats get_memory_stats(const basic_value<wchar_t>&);
 }  // namespace db
 }  // namespace uxs
@@ -1,4 +1,5 @@
 #include "uxs/impl/db/xml_impl.h"
+#include "uxs/impl/simd.h"
 #include "uxs/string_alg.h"
 
 namespace lex_detail {
@@ -12,12 +13,94 @@ namespace uxs {
 namespace db {
 namespace xml {
 
-parser::parser(ibuf& in) : lexer_(in), name_cache_(16), token_{token_t::none, {}} {}
+namespace {
+
+// Finds the end of plain text: the first `<`, `&` or `\0` character, and counts new lines before it
+const char* find_text_end(const char* first, const char* last, unsigned& ln) {
+#if UXS_USE_SSE2 != 0
+    // check 16 characters at once
+    const __m128i v_zero = _mm_setzero_si128();
+    const __m128i v_lt = _mm_set1_epi8('<');
+    const __m128i v_amp = _mm_set1_epi8('&');
+    const __m128i v_nl = _mm_set1_epi8('\n');
+    for (; last - first >= 16; first += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, v_lt), _mm_cmpeq_epi8(x, v_amp)),
+                                       _mm_cmpeq_epi8(x, v_zero));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(m));
+        unsigned nl_mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, v_nl)));
+        if (mask) {
+            const unsigned n = uxs::detail::lowest_bit(mask);
+            ln += uxs::detail::popcount16(nl_mask & ((1u << n) - 1));
+            return first + n;
+        }
+        if (nl_mask) { ln += uxs::detail::popcount16(nl_mask); }
+    }
+#else   // UXS_USE_SSE2 != 0
+    // check 8 characters at once
+    for (; last - first >= 8; first += 8) {
+        std::uint64_t x = 0;
+        std::memcpy(&x, first, sizeof(x));
+        if (uxs::detail::zero_bytes(x) | uxs::detail::zero_bytes(x ^ 0x3c3c3c3c3c3c3c3cull) |
+            uxs::detail::zero_bytes(x ^ 0x2626262626262626ull)) {
+            break;
+        }
+        ln += uxs::detail::popcount_msbs(uxs::detail::zero_bytes(x ^ 0x0a0a0a0a0a0a0a0aull));
+    }
+#endif  // UXS_USE_SSE2 != 0
+    return std::find_if(first, last, [&ln](std::uint8_t ch) {
+        using tbl = uxs::detail::char_tbl_t;
+        if (ch != '\n') { return !!(tbl{}.flags()[ch] & tbl::is_xml_special); }
+        ++ln;
+        return false;
+    });
+}
+
+// Finds the end of a string chunk: the closing quotation mark, or `<`, `&`, `\n` or `\0` character
+const char* find_string_end(const char* first, const char* last, char quot) {
+#if UXS_USE_SSE2 != 0
+    // check 16 characters at once
+    const __m128i v_zero = _mm_setzero_si128();
+    const __m128i v_lt = _mm_set1_epi8('<');
+    const __m128i v_amp = _mm_set1_epi8('&');
+    const __m128i v_nl = _mm_set1_epi8('\n');
+    const __m128i v_quot = _mm_set1_epi8(quot);
+    for (; last - first >= 16; first += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, v_lt), _mm_cmpeq_epi8(x, v_amp)), _mm_cmpeq_epi8(x, v_nl)),
+            _mm_or_si128(_mm_cmpeq_epi8(x, v_quot), _mm_cmpeq_epi8(x, v_zero)));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(m));
+        if (mask) { return first + uxs::detail::lowest_bit(mask); }
+    }
+#else   // UXS_USE_SSE2 != 0
+    // check 8 characters at once
+    const std::uint64_t v_quot = 0x0101010101010101ull * static_cast<std::uint8_t>(quot);
+    for (; last - first >= 8; first += 8) {
+        std::uint64_t x = 0;
+        std::memcpy(&x, first, sizeof(x));
+        if (uxs::detail::zero_bytes(x) | uxs::detail::zero_bytes(x ^ 0x3c3c3c3c3c3c3c3cull) |
+            uxs::detail::zero_bytes(x ^ 0x2626262626262626ull) | uxs::detail::zero_bytes(x ^ 0x0a0a0a0a0a0a0a0aull) |
+            uxs::detail::zero_bytes(x ^ v_quot)) {
+            break;
+        }
+    }
+#endif  // UXS_USE_SSE2 != 0
+    const char other_quot = (quot == '\"' ? '\'' : '\"');
+    return std::find_if(first, last, [other_quot](std::uint8_t ch) {
+        using tbl = uxs::detail::char_tbl_t;
+        return !!(tbl{}.flags()[ch] & tbl::is_xml_string_special) && ch != other_quot;
+    });
+}
+
+}  // namespace
+
+parser::parser(ibuf& in) : lexer_(in), token_{token_t::none, {}} {}
 
 std::pair<token_t, std::string_view> parser::next_impl() {
     if (is_end_element_pending_) {
         is_end_element_pending_ = false;
-        return {token_t::end_element, name_cache_.front()};
+        return {token_t::end_element, name_};
     }
 
     while (lexer_.in.peek() != ibuf::traits_type::eof()) {
@@ -25,40 +108,33 @@ std::pair<token_t, std::string_view> parser::next_impl() {
 
         switch (*lexer_.in.curr()) {
             case '<': {  // found '<'
-                auto name_cache_it = name_cache_.begin();
-                auto name_cache_prev_it = name_cache_it;
-
                 attrs_.clear();
 
-                const auto read_attribute = [this, &name_cache_it, &name_cache_prev_it](std::string_view lval) {
-                    if (name_cache_it != name_cache_.end()) {
-                        name_cache_it->assign(lval.data(), lval.size());
-                    } else {
-                        name_cache_it = name_cache_.emplace_after(name_cache_prev_it, lval);
-                    }
+                const auto read_attribute = [this](std::string_view lval) {
+                    // the name is saved, because the lexer can reuse its buffers for the value
+                    attr_name_.clear();
+                    attr_name_.append(lval.data(), lval.size());
                     if (lexer_.lex(lval) != detail::lex_token_t::eq) {
                         throw database_error(to_string(lexer_.ln) + ": expected `=`");
                     }
                     if (lexer_.lex(lval) != detail::lex_token_t::string) {
                         throw database_error(to_string(lexer_.ln) + ": expected valid attribute value");
                     }
-                    name_cache_prev_it = name_cache_it;
-                    attrs_.emplace(*name_cache_it++, lval);
+                    attrs_.emplace(std::string_view(attr_name_.data(), attr_name_.size()), lval);
                 };
 
                 switch (lexer_.lex(lval)) {
                     case detail::lex_token_t::start_element_open: {  // <name n1=v1 n2=v2...> or <name n1=v1 n2=v2.../>
-                        name_cache_it->assign(lval.data(), lval.size());
-                        ++name_cache_it;
+                        name_.assign(lval.data(), lval.size());
                         while (true) {
                             auto tt = lexer_.lex(lval);
                             if (tt == detail::lex_token_t::name) {
                                 read_attribute(lval);
                             } else if (tt == detail::lex_token_t::close) {
-                                return {token_t::start_element, name_cache_.front()};
+                                return {token_t::start_element, name_};
                             } else if (tt == detail::lex_token_t::end_element_close) {
                                 is_end_element_pending_ = true;
-                                return {token_t::start_element, name_cache_.front()};
+                                return {token_t::start_element, name_};
                             } else {
                                 throw database_error(to_string(lexer_.ln) + ": expected name, `>` or `/>`");
                             }
@@ -76,14 +152,13 @@ std::pair<token_t, std::string_view> parser::next_impl() {
                         if (compare_strings_nocase(lval, string_literal<char, 'x', 'm', 'l'>{}()) != 0) {
                             throw database_error(to_string(lexer_.ln) + ": invalid document declaration");
                         }
-                        name_cache_it->assign(lval.data(), lval.size());
-                        ++name_cache_it;
+                        name_.assign(lval.data(), lval.size());
                         while (true) {
                             auto tt = lexer_.lex(lval);
                             if (tt == detail::lex_token_t::name) {
                                 read_attribute(lval);
                             } else if (tt == detail::lex_token_t::pi_close) {
-                                return {token_t::preamble, name_cache_.front()};
+                                return {token_t::preamble, name_};
                             } else {
                                 throw database_error(to_string(lexer_.ln) + ": expected name or `?>`");
                             }
@@ -115,12 +190,7 @@ std::pair<token_t, std::string_view> parser::next_impl() {
 
             default: {
                 const char* curr0 = lexer_.in.curr();
-                const char* curr = std::find_if(curr0, lexer_.in.last(), [this](std::uint8_t ch) {
-                    using tbl = uxs::detail::char_tbl_t;
-                    if (ch != '\n') { return !!(tbl{}.flags()[ch] & tbl::is_xml_special); }
-                    ++lexer_.ln;
-                    return false;
-                });
+                const char* curr = find_text_end(curr0, lexer_.in.last(), lexer_.ln);
                 lexer_.in.setpos(curr - lexer_.in.first());
                 return {token_t::plain_text, to_string_view(curr0, curr)};
             } break;
@@ -201,11 +271,8 @@ detail::lex_token_t detail::lexer::lex(std::string_view& lval) {
                 continue;
             }
         } else {  // read string
-            const char other_quot = (current_string_quot == '\"' ? '\'' : '\"');
             const char* curr0 = in.curr();
-            const char* curr = std::find_if(curr0, in.last(), [other_quot](std::uint8_t ch) {
-                return !!(tbl{}.flags()[ch] & tbl::is_xml_string_special) && ch != other_quot;
-            });
+            const char* curr = find_string_end(curr0, in.last(), current_string_quot);
 
             in.setpos(curr - in.first());
             if (!in.avail()) {
@@ -392,10 +459,14 @@ detail::lex_token_t detail::lexer::lex(std::string_view& lval) {
 
 template UXS_EXPORT basic_value<char> parser::read(std::string_view, const std::allocator<char>&);
 template UXS_EXPORT basic_value<wchar_t> parser::read(std::string_view, const std::allocator<wchar_t>&);
+template UXS_EXPORT void parser::to_json(std::string_view, json::stream_writer<char>&);
+template UXS_EXPORT void parser::to_json(std::string_view, json::stream_writer<wchar_t>&);
 template UXS_EXPORT void detail::writer<char>::do_write(const basic_value<char>&, std::string_view, unsigned);
 template UXS_EXPORT void detail::writer<char>::do_write(const basic_value<wchar_t>&, std::wstring_view, unsigned);
 template UXS_EXPORT void detail::writer<wchar_t>::do_write(const basic_value<char>&, std::string_view, unsigned);
 template UXS_EXPORT void detail::writer<wchar_t>::do_write(const basic_value<wchar_t>&, std::wstring_view, unsigned);
+template UXS_EXPORT void detail::json_to_xml(membuffer&, ibuf&, std::string_view, unsigned, char, unsigned);
+template UXS_EXPORT void detail::json_to_xml(wmembuffer&, ibuf&, std::string_view, unsigned, char, unsigned);
 }  // namespace xml
 }  // namespace db
 }  // namespace uxs
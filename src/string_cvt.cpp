@@ -488,34 +488,29 @@ static std::uint64_t fp10_to_fp2_slow(fp10_t& fp10, unsigned bpm, int exp_max) n
     return (static_cast<std::uint64_t>(exp2) << bpm) | (m & ((1ULL << bpm) - 1));  // normalized
 }
 
-std::uint64_t fp10_to_fp2(fp10_t& fp10, unsigned bpm, int exp_max) noexcept {
-    const unsigned sz_num = fp10.bits_used;
-    std::uint64_t m = fp10.bits[max_fp10_mantissa_size - sz_num];
-
-    // Note, that decimal mantissa can contain up to 772 digits. So, all numbers with
-    // powers less than -772 - 324 = -1096 are zeroes in fact. We round this power to -1100
-    if (m == 0 || fp10.exp < -1100) { return 0; }           // zero
-    if (fp10.exp > 310) {                                   // too big power even for one specified digit
-        return static_cast<std::uint64_t>(exp_max) << bpm;  // infinity
-    }
-
-    // If too many digits are specified or decimal power is too great use slow algorithm
-    if (sz_num > 1 || fp10.exp < -pow10_max || fp10.exp > pow10_max) { return fp10_to_fp2_slow(fp10, bpm, exp_max); }
-
+// Converts `m * 10^exp` with `m != 0` and `-pow10_max <= exp <= pow10_max` to binary floating-point value,
+// returns `false` if the round direction is undefined
+static bool fp10_to_fp2_fast(std::uint64_t m, int exp, unsigned bpm, int exp_max, std::uint64_t& fp2) noexcept {
     // Obtain binary exponent
     const int exp_bias = exp_max >> 1;
     const int log = ulog2(m);
-    int exp2 = 1 + exp_bias + log + exp10to2(fp10.exp);
+    int exp2 = 1 + exp_bias + log + exp10to2(exp);
     if (log < 63) { m <<= 63 - log; }
 
     // Obtain binary mantissa
     unsigned shift = 64;
-    const uint96_t coef = get_cached_pow10(fp10.exp);
+    const uint96_t coef = get_cached_pow10(exp);
     std::uint64_t frac = umul96x64_higher128(coef, m, m);
     if (!(m & msb64)) { --shift, --exp2; }
 
-    if (exp2 >= exp_max) { return static_cast<std::uint64_t>(exp_max) << bpm; }  // infinity
-    if (exp2 < -static_cast<int>(bpm)) { return 0; }                             // zero
+    if (exp2 >= exp_max) {  // infinity
+        fp2 = static_cast<std::uint64_t>(exp_max) << bpm;
+        return true;
+    }
+    if (exp2 < -static_cast<int>(bpm)) {  // zero
+        fp2 = 0;
+        return true;
+    }
 
     // When `exp2 <= 0` mantissa will be denormalized further, so store the real mantissa length
     const unsigned n_bits = exp2 > 0 ? 1 + bpm : bpm + exp2;
@@ -533,8 +528,8 @@ std::uint64_t fp10_to_fp2(fp10_t& fp10, unsigned bpm, int exp_max) noexcept {
     frac >>= 32;  // drop lower 32 bits
     if (frac > half) {
         ++m;                        // round to upper
-    } else if (frac >= half - 1) {  // round direction is undefined: use slow algorithm
-        return fp10_to_fp2_slow(fp10, bpm, exp_max);
+    } else if (frac >= half - 1) {  // round direction is undefined
+        return false;
     }
     if (m & (1ULL << n_bits)) {  // overflow
         // Note: the value can become normalized if `exp == 0` or infinity if `exp == exp_max - 1`
@@ -543,8 +538,43 @@ std::uint64_t fp10_to_fp2(fp10_t& fp10, unsigned bpm, int exp_max) noexcept {
     }
 
     // Compose floating point value
-    if (exp2 <= 0) { return m; }                                                   // denormalized
-    return (static_cast<std::uint64_t>(exp2) << bpm) | (m & ((1ULL << bpm) - 1));  // normalized
+    if (exp2 <= 0) {  // denormalized
+        fp2 = m;
+    } else {  // normalized
+        fp2 = (static_cast<std::uint64_t>(exp2) << bpm) | (m & ((1ULL << bpm) - 1));
+    }
+    return true;
+}
+
+std::uint64_t fp10_to_fp2(fp10_t& fp10, unsigned bpm, int exp_max) noexcept {
+    const unsigned sz_num = fp10.bits_used;
+    const std::uint64_t m = fp10.bits[max_fp10_mantissa_size - sz_num];
+
+    // Note, that decimal mantissa can contain up to 772 digits. So, all numbers with
+    // powers less than -772 - 324 = -1096 are zeroes in fact. We round this power to -1100
+    if (m == 0 || fp10.exp < -1100) { return 0; }           // zero
+    if (fp10.exp > 310) {                                   // too big power even for one specified digit
+        return static_cast<std::uint64_t>(exp_max) << bpm;  // infinity
+    }
+
+    std::uint64_t fp2 = 0;
+    if (sz_num == 1) {
+        if (fp10.exp >= -pow10_max && fp10.exp <= pow10_max && fp10_to_fp2_fast(m, fp10.exp, bpm, exp_max, fp2)) {
+            return fp2;
+        }
+    } else if (fp10.prefix != ~0ULL) {
+        // Too many digits are specified: the number is between `prefix * 10^exp` and `(prefix + 1) * 10^exp`,
+        // if both bounds are rounded to the same value, it is the result
+        const int exp = fp10.exp + static_cast<int>(fp10.prefix_tail);
+        std::uint64_t fp2_upper = 0;
+        if (exp >= -pow10_max && exp <= pow10_max && fp10_to_fp2_fast(fp10.prefix, exp, bpm, exp_max, fp2) &&
+            fp10_to_fp2_fast(fp10.prefix + 1, exp, bpm, exp_max, fp2_upper) && fp2 == fp2_upper) {
+            return fp2;
+        }
+    }
+
+    // Too great decimal power or undefined round direction: use slow algorithm
+    return fp10_to_fp2_slow(fp10, bpm, exp_max);
 }
 
 // --------------------------
@@ -0,0 +1,42 @@
+#include "random_value.h"
+#include "test_suite.h"
+
+#include "uxs/db/cbor.h"
+#include "uxs/db/msgpack.h"
+#include "uxs/io/iflatbuf.h"
+#include "uxs/io/oflatbuf.h"
+
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+UXS_TEST_CASE(cbor_round_trip) {
+    std::mt19937 rng(3);
+    for (unsigned i = 0; i < 300; ++i) {
+        const db::value v = random_value(rng, 0);
+        oflatbuf out;
+        db::cbor::write(out, v);
+        const std::string data(out.data(), out.size());
+        iflatbuf in(data);
+        // integers get the narrowest types, which the generated integers already have
+        UXS_CHECK(same_types(db::cbor::read(in), v));
+        chunked_ibuf chunked_in(data, 1 + i % 7);
+        UXS_CHECK(db::cbor::read(chunked_in) == v);
+    }
+}
+
+UXS_TEST_CASE(msgpack_round_trip) {
+    std::mt19937 rng(4);
+    for (unsigned i = 0; i < 300; ++i) {
+        const db::value v = random_value(rng, 0);
+        oflatbuf out;
+        db::msgpack::write(out, v);
+        const std::string data(out.data(), out.size());
+        iflatbuf in(data);
+        // integer formats are read back as the same types
+        UXS_CHECK(same_types(db::msgpack::read(in), v));
+        chunked_ibuf chunked_in(data, 1 + i % 7);
+        UXS_CHECK(db::msgpack::read(chunked_in) == v);
+    }
+}
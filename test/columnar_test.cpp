@@ -0,0 +1,166 @@
+#include "test_suite.h"
+
+#include "uxs/db/columnar.h"
+#include "uxs/io/iflatbuf.h"
+
+#include <cmath>
+#include <random>
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+using column_t = db::column_table::column_t;
+
+// Generates an array of records with keys in varying order, missing keys and numbers of all lexical kinds
+std::string random_rows(std::mt19937& rng, unsigned count) {
+    static const char* numbers[] = {"0",    "17",    "-5",  "2.5", "-0.0", "1e3", "9223372036854775807",
+                                    "9223372036854775808", "18446744073709551615", "18446744073709551616",
+                                    "-9223372036854775808", "-9223372036854775809", "123456789012345678901234"};
+    static const char* strings[] = {"\"a\"", "\"b\"", "\"\"", "\"\\u0444\"", "\"a\\nb\""};
+    std::string s = "[";
+    for (unsigned row = 0; row < count; ++row) {
+        s += row ? ", {" : "{";
+        bool is_first = true;
+        const unsigned first_key = rng() % 2;
+        for (unsigned k = 0; k < 5; ++k) {
+            const unsigned key = (first_key + k) % 5;
+            if (rng() % 4 == 0) { continue; }
+            s += is_first ? "\"" : ", \"";
+            s += "c" + std::to_string(key) + "\": ";
+            is_first = false;
+            switch (key) {
+                case 0: s += numbers[rng() % 4]; break;  // integers and doubles mixed
+                case 1: s += numbers[rng() % (sizeof(numbers) / sizeof(*numbers))]; break;
+                case 2: s += strings[rng() % (sizeof(strings) / sizeof(*strings))]; break;
+                case 3: s += rng() % 3 ? (rng() % 2 ? "true" : "false") : "null"; break;
+                default: s += rng() % 2 ? "null" : std::to_string(rng() % 100); break;
+            }
+        }
+        s += "}";
+    }
+    return s + "]";
+}
+
+db::column_table read_via_dom(const std::string& text) {
+    iflatbuf in(text);
+    return db::make_column_table(db::json::read(in));
+}
+
+db::column_table read_direct(const std::string& text) {
+    iflatbuf in(text);
+    return db::json::read_column_table(in);
+}
+
+bool same_doubles(double a, double b) { return a == b ? std::signbit(a) == std::signbit(b) : a != a && b != b; }
+
+bool same_columns(const column_t& a, const column_t& b) {
+    if (a.type() != b.type() || a.size() != b.size() || a.count() != b.count()) { return false; }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a.is_null(i) != b.is_null(i)) { return false; }
+        switch (a.type()) {
+            case db::column_type::boolean: {
+                if (a.bools()[i] != b.bools()[i]) { return false; }
+            } break;
+            case db::column_type::integer: {
+                if (a.ints()[i] != b.ints()[i]) { return false; }
+            } break;
+            case db::column_type::double_precision: {
+                if (!same_doubles(a.doubles()[i], b.doubles()[i])) { return false; }
+            } break;
+            case db::column_type::string: {
+                if (a.string_at(i) != b.string_at(i)) { return false; }
+            } break;
+            default: break;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+UXS_TEST_CASE(column_dictionary) {
+    db::basic_column_dictionary<char> dict;
+    UXS_CHECK(dict.empty() && dict.find("a") == dict.npos);
+    for (unsigned i = 0; i < 1000; ++i) { UXS_CHECK(dict.intern("s" + std::to_string(i)) == i); }
+    for (unsigned i = 0; i < 1000; ++i) {
+        UXS_CHECK(dict.intern("s" + std::to_string(i)) == i && dict.find("s" + std::to_string(i)) == i);
+        UXS_CHECK(dict[i] == "s" + std::to_string(i));
+    }
+    UXS_CHECK(dict.size() == 1000 && dict.find("s1000") == dict.npos && dict.intern("") == 1000);
+}
+
+UXS_TEST_CASE(column_aggregates) {
+    column_t col;
+    col.push_null();
+    for (int i = 0; i < 200; ++i) {
+        if (i % 3 == 0) {
+            col.push_null();
+        } else {
+            col.push_int(i - 100);
+        }
+    }
+    UXS_CHECK(col.type() == db::column_type::integer && col.size() == 201 && col.null_count() == 68);
+    UXS_CHECK(col.is_null(0) && col.ints()[0] == 0 && col.is_null(1) && !col.is_null(2) && col.ints()[2] == -99);
+    std::int64_t sum = 0;
+    for (int i = 0; i < 200; ++i) { sum += i % 3 ? i - 100 : 0; }
+    UXS_CHECK(col.int_sum() == sum && col.sum() == static_cast<double>(sum));
+    UXS_CHECK(*col.min() == -99 && *col.max() == 99);
+    UXS_CHECK(col.mean() == static_cast<double>(sum) / 133);
+    // integers turn into doubles, other type mismatches are errors
+    col.push_double(0.5);
+    UXS_CHECK(col.type() == db::column_type::double_precision && col.doubles()[2] == -99. && col.count() == 134);
+    UXS_CHECK(col.sum() == static_cast<double>(sum) + 0.5);
+    UXS_CHECK_THROW(col.push_string("a"), db::database_error);
+    UXS_CHECK_THROW(col.push_bool(true), db::database_error);
+
+    column_t nulls;
+    for (int i = 0; i < 70; ++i) { nulls.push_null(); }
+    UXS_CHECK(!nulls.min() && !nulls.max() && nulls.sum() == 0. && nulls.mean() == 0.);
+    nulls.push_string("x");
+    nulls.push_string("y");
+    nulls.push_string("x");
+    UXS_CHECK(nulls.type() == db::column_type::string && nulls.codes()[0] == column_t::null_code);
+    UXS_CHECK(nulls.count_equal("x") == 2 && nulls.count_equal("z") == 0 && nulls.string_at(71) == "y");
+}
+
+UXS_TEST_CASE(column_table_read_same_as_dom) {
+    std::mt19937 rng(37);
+    for (unsigned n = 0; n < 300; ++n) {
+        const std::string text = random_rows(rng, n % 150);
+        const db::column_table expected = read_via_dom(text);
+        const db::column_table table = read_direct(text);
+        UXS_CHECK(table.row_count() == n % 150 && table.column_count() == expected.column_count());
+        for (std::size_t col = 0; col < table.column_count(); ++col) {
+            const column_t* expected_col = expected.find(table.column_name(col));
+            UXS_CHECK(expected_col && same_columns(table.column(col), *expected_col));
+        }
+    }
+}
+
+UXS_TEST_CASE(column_table_numbers) {
+    const db::column_table table = read_direct(
+        "[{\"i\": 9223372036854775807, \"u\": 1, \"n\": -9223372036854775808, \"f\": 1},"
+        " {\"i\": 1, \"u\": 18446744073709551615, \"n\": -9223372036854775809, \"f\": 2.5e-1},"
+        " {\"u\": 123456789012345678901234, \"n\": null}]");
+    UXS_CHECK(table["i"].type() == db::column_type::integer && table["i"].ints()[0] == 9223372036854775807ll);
+    UXS_CHECK(table["i"].is_null(2));
+    UXS_CHECK(table["u"].type() == db::column_type::double_precision && table["u"].doubles()[0] == 1.);
+    UXS_CHECK(table["u"].doubles()[1] == 18446744073709551615. && table["u"].doubles()[2] == 123456789012345678901234.);
+    UXS_CHECK(table["n"].type() == db::column_type::double_precision);
+    UXS_CHECK(table["n"].doubles()[0] == -9223372036854775808. && table["n"].doubles()[1] == -9223372036854775809.);
+    UXS_CHECK(table["f"].doubles()[1] == 0.25 && table["f"].sum() == 1.25);
+}
+
+UXS_TEST_CASE(column_table_errors) {
+    UXS_CHECK_THROW(read_direct("{}"), db::database_error);
+    UXS_CHECK_THROW(read_direct("[1]"), db::database_error);
+    UXS_CHECK_THROW(read_direct("[{\"a\": [1]}]"), db::database_error);
+    UXS_CHECK_THROW(read_direct("[{\"a\": 1, \"a\": 2}]"), db::database_error);
+    UXS_CHECK_THROW(read_direct("[{\"a\": 1}, {\"a\": \"s\"}]"), db::database_error);
+    UXS_CHECK_THROW(read_via_dom("[{\"a\": {}}]"), db::database_error);
+    UXS_CHECK_THROW(read_direct("[{\"a\": 1}"), db::database_error);
+    UXS_CHECK(read_direct("[]").row_count() == 0);
+}
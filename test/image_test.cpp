@@ -0,0 +1,82 @@
+#include "random_value.h"
+#include "test_suite.h"
+
+#include "uxs/db/image.h"
+#include "uxs/io/oflatbuf.h"
+
+#include <cstring>
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+std::string make_image(const db::value& v) {
+    oflatbuf out;
+    db::image::write(out, v);
+    return std::string(out.data(), out.size());
+}
+
+// Zero-filled image of `size` bytes with valid header, so that its root is `null`
+std::string make_header(std::uint64_t size) {
+    std::string data(static_cast<std::size_t>(size), '\0');
+    const std::uint32_t version = db::image::detail::image_version;
+    std::memcpy(&data[0], "UXSI", 4);
+    std::memcpy(&data[4], &version, sizeof(version));
+    std::memcpy(&data[8], &size, sizeof(size));
+    return data;
+}
+
+void set_array(std::string& data, std::uint64_t slot, std::uint32_t count, std::uint64_t node) {
+    data[static_cast<std::size_t>(slot)] = static_cast<char>(db::dtype::array);
+    std::memcpy(&data[static_cast<std::size_t>(slot + 4)], &count, sizeof(count));
+    std::memcpy(&data[static_cast<std::size_t>(slot + 8)], &node, sizeof(node));
+}
+}  // namespace
+
+UXS_TEST_CASE(image_round_trip) {
+    std::mt19937 rng(5);
+    for (unsigned i = 0; i < 300; ++i) {
+        const db::value v = random_value(rng, 0);
+        const std::string data = make_image(v);
+        const db::image::document doc(data);
+        UXS_CHECK(same_types(doc.root().to_value<char>(), v));
+    }
+}
+
+UXS_TEST_CASE(image_corrupt_item_count) {
+    db::value arr = db::make_array();
+    for (int i = 0; i < 3; ++i) { arr.push_back(i); }
+    for (const db::value& v : {arr, db::make_record({{"a", 1}, {"b", 2}})}) {
+        std::string data = make_image(v);
+        // the item count of the root slot is too big for the image
+        data[db::image::detail::root_slot + 4] = data[db::image::detail::root_slot + 5] = '\xff';
+        data[db::image::detail::root_slot + 6] = data[db::image::detail::root_slot + 7] = '\x7f';
+        const db::image::document doc(data);
+        UXS_CHECK_THROW(doc.root().to_value<char>(), db::database_error);
+    }
+}
+
+UXS_TEST_CASE(image_corrupt_node_offset) {
+    // the root array of 6 items refers back to the root slot, so it contains itself
+    std::string data = make_header(128);
+    set_array(data, db::image::detail::root_slot, 6, db::image::detail::root_slot);
+    const db::image::document doc(data);
+    UXS_CHECK_THROW(doc.root().to_value<char>(), db::database_error);
+    UXS_CHECK_THROW(doc.root().begin(), db::database_error);
+}
+
+UXS_TEST_CASE(image_corrupt_shared_nodes) {
+    // both items of each array refer to the same next array, so the tree would double at each level
+    const unsigned depth = 40;
+    const std::uint64_t node_size = 2 * db::image::detail::slot_size;
+    std::string data = make_header(db::image::detail::header_size + (depth + 1) * node_size);
+    set_array(data, db::image::detail::root_slot, 2, db::image::detail::header_size);
+    for (unsigned i = 0; i < depth; ++i) {
+        const std::uint64_t node = db::image::detail::header_size + i * node_size;
+        set_array(data, node, 2, node + node_size);
+        set_array(data, node + db::image::detail::slot_size, 2, node + node_size);
+    }
+    const db::image::document doc(data);
+    UXS_CHECK_THROW(doc.root().to_value<char>(), db::database_error);
+}
@@ -0,0 +1,127 @@
+#include "test_suite.h"
+
+#include "uxs/db/json.h"
+#include "uxs/db/json_bind.h"
+#include "uxs/db/value.h"
+#include "uxs/io/iflatbuf.h"
+
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+struct point {
+    int x = 0;
+    int y = 0;
+};
+
+struct shape {
+    std::string name;
+    bool closed = false;
+    double scale = 1.0;
+    std::uint8_t layer = 0;
+    std::int64_t id = 0;
+    std::vector<point> points;
+    std::vector<bool> visible;
+    std::vector<std::vector<bool>> masks;
+    std::optional<point> origin;
+    std::optional<std::string> comment;
+};
+
+}  // namespace
+
+namespace uxs {
+namespace db {
+namespace json {
+template<>
+struct binding<point> {
+    static constexpr auto fields = std::make_tuple(field("x", &point::x), field("y", &point::y));
+};
+template<>
+struct binding<shape> {
+    static constexpr auto fields = std::make_tuple(
+        field("name", &shape::name), field("closed", &shape::closed), field("scale", &shape::scale),
+        field("layer", &shape::layer), field("id", &shape::id), field("points", &shape::points),
+        field("visible", &shape::visible), field("masks", &shape::masks), field("origin", &shape::origin),
+        field("comment", &shape::comment));
+};
+}  // namespace json
+}  // namespace db
+}  // namespace uxs
+
+namespace {
+
+template<typename Ty>
+Ty read_text(std::string_view text) {
+    iflatbuf in(text);
+    Ty obj{};
+    db::json::read_bound(in, obj);
+    return obj;
+}
+
+template<typename Ty>
+std::string write_text(const Ty& obj, unsigned indent_size = 0) {
+    inline_dynbuffer out;
+    db::json::write_bound(out, obj, indent_size, '\n', ' ');
+    return std::string(out.data(), out.size());
+}
+
+std::string reformat(std::string_view text, unsigned indent_size = 0) {
+    iflatbuf in(text);
+    inline_dynbuffer out;
+    db::json::write(out, db::json::read(in), indent_size, '\n', ' ');
+    return std::string(out.data(), out.size());
+}
+
+const char* shape_text = "{\"name\": \"tri\\nangle\", \"closed\": true, \"scale\": 2.5, \"layer\": 7, "
+                         "\"id\": -9000000000, \"points\": [{\"x\": 1, \"y\": 2}, {\"x\": -3, \"y\": 4}], "
+                         "\"visible\": [true, false, true], \"masks\": [[], [false, true]], "
+                         "\"origin\": {\"x\": 5, \"y\": 6}, \"comment\": null}";
+
+}  // namespace
+
+UXS_TEST_CASE(json_bind_read) {
+    const shape s = read_text<shape>(shape_text);
+    UXS_CHECK(s.name == "tri\nangle" && s.closed && s.scale == 2.5 && s.layer == 7 && s.id == -9000000000ll);
+    UXS_CHECK(s.points.size() == 2 && s.points[1].x == -3 && s.points[1].y == 4);
+    UXS_CHECK(s.visible == std::vector<bool>({true, false, true}));
+    UXS_CHECK(s.masks.size() == 2 && s.masks[0].empty() && s.masks[1] == std::vector<bool>({false, true}));
+    UXS_CHECK(s.origin && s.origin->x == 5 && s.origin->y == 6);
+    UXS_CHECK(!s.comment);
+}
+
+UXS_TEST_CASE(json_bind_unknown_and_missing_fields) {
+    // unknown keys are skipped with their values, missing fields are left unchanged
+    const shape s = read_text<shape>("{\"extra\": {\"name\": \"no\", \"x\": [1, {}]}, \"nam\": \"no\", \"x\": 1, "
+                                     "\"namex\": \"no\", \"points\": [{\"z\": 3, \"y\": 1}]}");
+    UXS_CHECK(s.name.empty() && s.scale == 1.0 && !s.origin);
+    UXS_CHECK(s.points.size() == 1 && s.points[0].x == 0 && s.points[0].y == 1);
+}
+
+UXS_TEST_CASE(json_bind_conversion_errors) {
+    UXS_CHECK_THROW(read_text<shape>("{\"name\": 1}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("{\"name\": null}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("{\"closed\": 1}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("{\"layer\": 256}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("{\"layer\": -1}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("{\"layer\": 1.5}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("{\"id\": 9223372036854775808}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("{\"points\": {}}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("{\"visible\": [1]}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("{\"origin\": []}"), db::database_error);
+    UXS_CHECK_THROW(read_text<shape>("[]"), db::database_error);
+    UXS_CHECK(read_text<shape>("{\"scale\": 3}").scale == 3.0);
+    UXS_CHECK(read_text<shape>("{\"id\": -9223372036854775808}").id == std::numeric_limits<std::int64_t>::min());
+}
+
+UXS_TEST_CASE(json_bind_write_same_as_write) {
+    const shape s = read_text<shape>(shape_text);
+    UXS_CHECK(write_text(s) == reformat(shape_text));
+    UXS_CHECK(write_text(s, 4) == reformat(shape_text, 4));
+    UXS_CHECK(write_text(shape{}) == reformat(write_text(shape{})));
+    UXS_CHECK(write_text(std::vector<bool>{true, false}) == "[true, false]");
+    // the written text is read back to the same structure
+    UXS_CHECK(write_text(read_text<shape>(write_text(s, 2))) == write_text(s));
+}
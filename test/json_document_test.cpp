@@ -0,0 +1,84 @@
+#include "random_json.h"
+#include "random_value.h"
+#include "test_suite.h"
+
+#include "uxs/db/json.h"
+#include "uxs/db/json_document.h"
+#include "uxs/io/iflatbuf.h"
+
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+// Reads the document with `json::read()` or `json::document`, returns `false` if it is invalid
+bool read_value(const std::string& doc, bool use_document, db::value& v) {
+    try {
+        if (use_document) {
+            v = db::json::document(doc).root().to_value();
+        } else {
+            iflatbuf in(doc);
+            v = db::json::read(in);
+        }
+    } catch (const db::database_error&) { return false; }
+    return true;
+}
+
+}  // namespace
+
+UXS_TEST_CASE(json_document_same_as_read) {
+    std::mt19937 rng(8);
+    for (unsigned i = 0; i < 30000; ++i) {
+        std::string doc = random_json(rng, 0);
+        if (i % 2) { doc = damage(rng, doc); }
+        db::value expected, v;
+        const bool is_valid = read_value(doc, false, expected);
+        UXS_CHECK(read_value(doc, true, v) == is_valid);
+        if (is_valid) { UXS_CHECK(same_types(v, expected)); }
+    }
+}
+
+UXS_TEST_CASE(json_document_unpaired_surrogates) {
+    for (const char* doc : {"\"\\ud83d\"", "\"\\ud83dx\"", "\"\\ud83d\\u0041\"", "\"\\ud83dx\\ude00\"",
+                            "\"\\ude00\\ud83d\\n\""}) {
+        db::value expected;
+        UXS_CHECK(read_value(doc, false, expected));
+        UXS_CHECK(db::json::document(doc).root().as_string_view() == expected.as_string_view());
+    }
+}
+
+UXS_TEST_CASE(json_document_find_key) {
+    std::mt19937 rng(9);
+    for (unsigned n : {3, 8, 9, 100}) {
+        // keys are repeated, some of them are escaped
+        std::string doc = "{";
+        for (unsigned i = 0; i < n; ++i) {
+            const unsigned k = static_cast<unsigned>(rng() % n);
+            doc += (i ? ", \"" : "\"") + std::string(k % 3 ? "k" : "\\u006b") + std::to_string(k) + "\": " +
+                   std::to_string(i);
+        }
+        doc += "}";
+        db::value expected;
+        UXS_CHECK(read_value(doc, false, expected));
+        const db::json::document d(doc);
+        for (unsigned k = 0; k <= n; ++k) {
+            const std::string key = "k" + std::to_string(k);
+            const auto it = expected.find(key);
+            UXS_CHECK(d.root().contains(key) == (it != expected.end()));
+            if (it != expected.end()) {
+                UXS_CHECK(d[key].as_int() == expected.at(key).as_int());
+                UXS_CHECK(d.root().find(key).key() == key);
+            }
+        }
+    }
+}
+
+UXS_TEST_CASE(json_document_type_checks) {
+    const db::json::document d("[\"12\", 12, 1e400, 12345678901234567890123]");
+    UXS_CHECK(!d[0].is_int() && !d[0].is_integral() && d[0].is_string());
+    UXS_CHECK(d[1].is_int() && d[1].type() == db::dtype::integer);
+    UXS_CHECK(!d[2].is_integral() && d[2].type() == db::dtype::double_precision);
+    UXS_CHECK(d[3].type() == db::dtype::double_precision);
+}
@@ -0,0 +1,67 @@
+#include "test_suite.h"
+
+#include "uxs/db/json_lines.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+std::string make_lines(std::vector<std::string>& expected) {
+    std::string text;
+    for (unsigned i = 0; i < 50; ++i) {
+        // every 7th line is much longer than the block and spans many input chunks
+        const std::string s(i % 7 == 3 ? 5000 + i : i, 'a' + i % 26);
+        expected.push_back(s);
+        text += "{\"n\": " + std::to_string(i) + ", \"s\": \"" + s + "\"}" + (i % 3 ? "\n" : " \t\n");
+        if (i % 5 == 0) { text += "  \n"; }
+    }
+    return text;
+}
+}  // namespace
+
+UXS_TEST_CASE(json_lines_chunked_input) {
+    std::vector<std::string> expected;
+    const std::string text = make_lines(expected);
+    for (std::size_t chunk_size : {1, 7, 64, 100000}) {
+        for (std::size_t block_size : {1, 100, 1 << 20}) {
+            chunked_ibuf in(text, chunk_size);
+            db::json::lines_read_opts opts;
+            opts.thread_count = 2;
+            opts.block_size = block_size;
+            std::vector<std::string> result;
+            db::json::read_lines(
+                in,
+                [&result](db::value&& v, std::size_t) {
+                    UXS_CHECK(v["n"].as_uint() == result.size());
+                    result.emplace_back(v["s"].as_string());
+                },
+                opts);
+            UXS_CHECK(result == expected);
+        }
+    }
+}
+
+UXS_TEST_CASE(json_lines_text_after_value) {
+    std::vector<std::string> expected;
+    const std::string good = make_lines(expected);
+    for (const char* bad_line : {"1 2", "{\"n\": 1} {}", "[1]]", "\"s\" x"}) {
+        const std::string text = good + bad_line + "\n" + good;
+        for (std::size_t chunk_size : {1, 7, 100000}) {
+            chunked_ibuf in(text, chunk_size);
+            db::json::lines_read_opts opts;
+            opts.thread_count = 2;
+            opts.block_size = 100;
+            try {
+                db::json::read_lines(in, [](db::value&&, std::size_t) {}, opts);
+                UXS_CHECK(false);
+            } catch (const db::database_error& e) {
+                const std::string line_no = std::to_string(std::count(good.begin(), good.end(), '\n') + 1);
+                UXS_CHECK(std::string(e.what()) == line_no + ": unexpected character after the value");
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#include "test_suite.h"
+
+#include "uxs/db/json.h"
+#include "uxs/db/json_path.h"
+#include "uxs/io/iflatbuf.h"
+
+#include <random>
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+// Generates a document with records of a few keys, so duplicate keys are frequent
+std::string random_doc(std::mt19937& rng, unsigned depth) {
+    static const char* scalars[] = {"null", "true", "false", "0", "1", "1.0", "-2", "2.5", "\"x\"", "\"y\""};
+    static const char* keys[] = {"a", "b", "c"};
+    const unsigned kind = depth > 3 ? 0 : rng() % 3;
+    if (kind == 0) { return scalars[rng() % (sizeof(scalars) / sizeof(*scalars))]; }
+    const unsigned n = rng() % 5;
+    std::string s = kind == 1 ? "[" : "{";
+    for (unsigned i = 0; i < n; ++i) {
+        if (i) { s += ", "; }
+        if (kind == 2) { s += std::string("\"") + keys[rng() % 3] + "\": "; }
+        s += random_doc(rng, depth + 1);
+    }
+    return s + (kind == 1 ? "]" : "}");
+}
+
+std::string select_dom(const std::string& doc, const db::json::path& path) {
+    iflatbuf in(doc);
+    const db::value v = db::json::read(in);
+    inline_dynbuffer out;
+    path.for_each_match(v, [&out](const db::value& match) { db::json::write(out, match), out.push_back(';'); });
+    return std::string(out.data(), out.size());
+}
+
+std::string select_stream(const std::string& doc, const db::json::path& path) {
+    iflatbuf in(doc);
+    inline_dynbuffer out;
+    db::json::select(in, path, [&out](db::value&& match) { db::json::write(out, match), out.push_back(';'); });
+    return std::string(out.data(), out.size());
+}
+
+}  // namespace
+
+UXS_TEST_CASE(json_path_dom_matches_stream) {
+    static const char* paths[] = {"$",
+                                  "$.a",
+                                  "$['b'].c",
+                                  "$[0]",
+                                  "$[1].a",
+                                  "$.*",
+                                  "$[*].a",
+                                  "$.a[*]",
+                                  "$.*.*",
+                                  "$[?(@.a)]",
+                                  "$[?(@.a == 1)]",
+                                  "$[?(@.a != 1)]",
+                                  "$[?(@.a < 1)]",
+                                  "$[?(@.a <= 1)]",
+                                  "$[?(@.a > 0)]",
+                                  "$[?(@.a >= 1.0)]",
+                                  "$[?(@.a == 'x')]",
+                                  "$[?(@.a < 'y')].b",
+                                  "$[?(@.b == true)]",
+                                  "$[?(@.c == null)]",
+                                  "$[?(@[0] > 0)]",
+                                  "$.a[?(@.b)].c"};
+    std::mt19937 rng(39);
+    unsigned matched = 0;
+    for (const char* text : paths) {
+        const db::json::path path(text);
+        for (unsigned n = 0; n < 500; ++n) {
+            const std::string doc = random_doc(rng, 0);
+            const std::string dom = select_dom(doc, path);
+            UXS_CHECK(select_stream(doc, path) == dom);
+            if (!dom.empty()) { ++matched; }
+        }
+    }
+    UXS_CHECK(matched > 1000);
+}
+
+UXS_TEST_CASE(json_path_duplicate_keys) {
+    // a key step follows only the first of duplicate keys
+    const std::string doc = "{\"a\": 1, \"b\": {\"a\": 2}, \"a\": 3, \"b\": {\"a\": 4}}";
+    UXS_CHECK(select_dom(doc, db::json::path("$.a")) == "1;");
+    UXS_CHECK(select_stream(doc, db::json::path("$.a")) == "1;");
+    UXS_CHECK(select_stream(doc, db::json::path("$.b.a")) == "2;");
+    UXS_CHECK(select_stream(doc, db::json::path("$.*")) == "1;{\"a\": 2};3;{\"a\": 4};");
+}
+
+UXS_TEST_CASE(json_path_negative_index) {
+    UXS_CHECK_THROW(db::json::path("$[-1]"), db::database_error);
+    UXS_CHECK_THROW(db::json::path("$[+1]"), db::database_error);
+    UXS_CHECK_THROW(db::json::path("$[?(@[-1] == 1)]"), db::database_error);
+    UXS_CHECK(db::json::path("$[10]").steps()[0].index == 10);
+}
@@ -0,0 +1,110 @@
+#include "random_json.h"
+#include "test_suite.h"
+
+#include "uxs/db/json.h"
+#include "uxs/io/iflatbuf.h"
+
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+// Parses the document with `read()` or the push parser fed by chunks and records handler calls; with `relocate` the
+// parser is moved to a new object after each chunk, and the old object is destroyed
+std::string trace(const std::string& doc, std::size_t chunk_size, bool relocate = false) {
+    std::string result;
+    const auto fn_value = [&result](db::json::token_t tt, std::string_view lval) {
+        // the lexeme is defined only for numbers and strings
+        result += "v" + std::to_string(static_cast<int>(tt));
+        if (tt > db::json::token_t::false_value) { result += "(" + std::string(lval) + ")"; }
+        return db::json::parse_step::into;
+    };
+    const auto fn_arr_item = [&result]() { result += "i"; };
+    const auto fn_obj_item = [&result](std::string_view key) { result += "k(" + std::string(key) + ")"; };
+    const auto fn_pop = [&result]() { result += "p"; };
+    try {
+        if (!chunk_size) {
+            iflatbuf in(doc);
+            db::json::read(in, fn_value, fn_arr_item, fn_obj_item, fn_pop);
+        } else {
+            using parser_t = db::json::push_parser<decltype(fn_value), decltype(fn_arr_item), decltype(fn_obj_item),
+                                                   decltype(fn_pop)>;
+            auto parser = est::make_unique<parser_t>(fn_value, fn_arr_item, fn_obj_item, fn_pop);
+            bool more = true;
+            for (std::size_t pos = 0; more && pos < doc.size(); pos += chunk_size) {
+                more = parser->feed(est::as_span(doc.data() + pos, std::min(chunk_size, doc.size() - pos)));
+                if (relocate) { parser = est::make_unique<parser_t>(std::move(*parser)); }
+            }
+            parser->finish();
+        }
+    } catch (const db::database_error& e) { result += std::string("error: ") + e.what(); }
+    return result;
+}
+
+}  // namespace
+
+UXS_TEST_CASE(json_push_parser_chunked_vs_whole) {
+    std::mt19937 rng(1);
+    for (unsigned i = 0; i < 3000; ++i) {
+        std::string doc = random_json(rng, 0);
+        if (i % 3 == 0) { doc = damage(rng, doc); }
+        const std::string expected = trace(doc, 0);
+        for (std::size_t chunk_size : {std::size_t(1), std::size_t(2), std::size_t(3), std::size_t(5), std::size_t(16),
+                                       doc.size() + 1}) {
+            UXS_CHECK(trace(doc, chunk_size) == expected);
+        }
+    }
+}
+
+UXS_TEST_CASE(json_push_parser_stops_after_value) {
+    int count = 0;
+    const auto fn_value = [&count](db::json::token_t, std::string_view) {
+        ++count;
+        return db::json::parse_step::into;
+    };
+    const auto fn_none = []() {};
+    const auto fn_key = [](std::string_view) {};
+    db::json::push_parser<decltype(fn_value), decltype(fn_none), decltype(fn_key), decltype(fn_none)> parser(
+        fn_value, fn_none, fn_key, fn_none);
+    UXS_CHECK(parser.feed(est::as_span("[1, ", 4)));
+    UXS_CHECK(!parser.feed(est::as_span("2] garbage", 10)));
+    parser.finish();
+    UXS_CHECK(count == 3);
+}
+
+UXS_TEST_CASE(json_push_parser_moved_partway) {
+    std::mt19937 rng(3);
+    for (unsigned i = 0; i < 1000; ++i) {
+        std::string doc = random_json(rng, 0);
+        if (i % 3 == 0) { doc = damage(rng, doc); }
+        const std::string expected = trace(doc, 0);
+        for (std::size_t chunk_size : {std::size_t(1), std::size_t(3), std::size_t(16)}) {
+            UXS_CHECK(trace(doc, chunk_size, true) == expected);
+        }
+    }
+}
+
+UXS_TEST_CASE(json_push_parser_copied_partway) {
+    std::string result;
+    const auto fn_value = [&result](db::json::token_t, std::string_view lval) {
+        result += std::string(lval) + ";";
+        return db::json::parse_step::into;
+    };
+    const auto fn_none = []() {};
+    const auto fn_key = [&result](std::string_view key) { result += std::string(key) + ":"; };
+    using parser_t = db::json::push_parser<decltype(fn_value), decltype(fn_none), decltype(fn_key), decltype(fn_none)>;
+    parser_t parser(fn_value, fn_none, fn_key, fn_none);
+    // a key and a number are split between chunks
+    UXS_CHECK(parser.feed(est::as_span("{\"ke", 4)));
+    parser_t copy(parser);
+    UXS_CHECK(parser.feed(est::as_span("y\": 12", 6)));
+    UXS_CHECK(copy.feed(est::as_span("y\": 12", 6)));
+    UXS_CHECK(!parser.feed(est::as_span("3}", 2)));
+    UXS_CHECK(!copy.feed(est::as_span("3}", 2)));
+    parser.finish();
+    copy.finish();
+    // the object is reported before the copy is made
+    UXS_CHECK(result == ";key:key:123;123;");
+}
@@ -0,0 +1,94 @@
+#include "random_json.h"
+#include "test_suite.h"
+
+#include "uxs/db/json.h"
+#include "uxs/db/json_path.h"
+#include "uxs/io/iflatbuf.h"
+
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+// Reads the document with all nested containers entered or skipped with `parse_step::over`
+std::string read_result(const std::string& doc, db::json::parse_step step) {
+    try {
+        iflatbuf in(doc);
+        bool is_root = true;
+        db::json::read(
+            in,
+            [&is_root, step](db::json::token_t tt, std::string_view) {
+                if (is_root || tt >= db::json::token_t::null_value) {
+                    is_root = false;
+                    return db::json::parse_step::into;
+                }
+                return step;
+            },
+            []() {}, [](std::string_view) {}, []() {});
+    } catch (const db::database_error& e) { return e.what(); }
+    return "ok";
+}
+
+}  // namespace
+
+UXS_TEST_CASE(json_read_skipped_container_is_checked) {
+    const std::string doc = "{\"zz\": {\"a\" 1}, \"a\": 1}";
+    UXS_CHECK(read_result(doc, db::json::parse_step::over) == "1: expected `:`");
+    iflatbuf in(doc);
+    UXS_CHECK_THROW(db::json::select(in, db::json::path("$.a"), [](db::value&&) {}), db::database_error);
+}
+
+UXS_TEST_CASE(json_read_skipped_container_same_errors) {
+    std::mt19937 rng(2);
+    for (unsigned i = 0; i < 3000; ++i) {
+        const std::string doc = damage(rng, random_json(rng, 0));
+        UXS_CHECK(read_result(doc, db::json::parse_step::over) == read_result(doc, db::json::parse_step::into));
+    }
+}
+
+UXS_TEST_CASE(json_read_skip_restores_number_decoding) {
+    iflatbuf in("[1, {\"a\" 1}]");
+    db::json::detail::lexer lexer(in);
+    lexer.decode_numbers = true;
+    std::string_view lval;
+    lexer.lex(lval);
+    UXS_CHECK_THROW(lexer.skip(db::json::token_t::array), db::database_error);
+    UXS_CHECK(lexer.decode_numbers);
+}
+
+UXS_TEST_CASE(json_read_integer_range_boundaries) {
+    struct {
+        const char* lexeme;
+        db::dtype type;
+        double f;
+    } cases[] = {
+        {"18446744073709551615", db::dtype::unsigned_long_integer, 0},
+        {"18446744073709551616", db::dtype::double_precision, 18446744073709551616.},
+        {"67305977039962863710", db::dtype::double_precision, 67305977039962863710.},
+        {"99999999999999999999", db::dtype::double_precision, 99999999999999999999.},
+        {"-9223372036854775808", db::dtype::long_integer, 0},
+        {"-9223372036854775809", db::dtype::double_precision, -9223372036854775809.},
+        {"-9999999999999999999", db::dtype::double_precision, -9999999999999999999.},
+        {"-67305977039962863710", db::dtype::double_precision, -67305977039962863710.},
+    };
+    for (const auto& c : cases) {
+        const std::string doc = std::string("[") + c.lexeme + "]";
+        // numbers decoded in one pass and numbers split between chunks, which are recognized by the analyzer
+        for (std::size_t chunk_size : {doc.size(), std::size_t(1), std::size_t(7)}) {
+            chunked_ibuf in(doc, chunk_size);
+            const db::value v = db::json::read(in);
+            UXS_CHECK(v[0].type() == c.type);
+            if (c.type == db::dtype::double_precision) {
+                UXS_CHECK(v[0].as_double() == c.f);
+            } else {
+                UXS_CHECK(v[0].as_string() == c.lexeme);
+            }
+        }
+        const std::string_view lval = c.lexeme;
+        const db::json::number num = db::json::detail::lexeme_to_number(
+            lval[0] == '-' ? db::json::token_t::negative_integer_number : db::json::token_t::integer_number, lval);
+        UXS_CHECK(num.is_double == (c.type == db::dtype::double_precision));
+    }
+}
@@ -0,0 +1,149 @@
+#include "random_json.h"
+#include "random_value.h"
+#include "test_suite.h"
+
+#include "uxs/db/json.h"
+#include "uxs/db/value.h"
+#include "uxs/io/iflatbuf.h"
+#include "uxs/io/oflatbuf.h"
+
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+enum class mode { reformat, minify, validate };
+
+// Output text or the error message; `chunk_size` of 0 gives the whole document at once
+std::string convert(mode m, const std::string& doc, std::size_t chunk_size) {
+    try {
+        chunked_ibuf in(doc, chunk_size ? chunk_size : doc.size() + 1);
+        inline_dynbuffer out;
+        switch (m) {
+            case mode::reformat: db::json::reformat(out, in, 2); break;
+            case mode::minify: db::json::minify(out, in); break;
+            case mode::validate: db::json::validate(in); break;
+        }
+        return std::string(out.data(), out.size());
+    } catch (const db::database_error& e) { return std::string("error: ") + e.what(); }
+}
+
+// Writes the value item by item with `stream_writer`
+template<typename CharT>
+void stream_value(db::json::stream_writer<CharT>& writer, const db::value& v, std::mt19937& rng) {
+    if (v.is_array()) {
+        writer.begin_array();
+        for (const db::value& item : v.as_array()) { stream_value(writer, item, rng); }
+        writer.end_array();
+    } else if (v.is_record()) {
+        writer.begin_object();
+        for (const auto& item : v.as_record()) {
+            writer.key(item.key());
+            stream_value(writer, item.value(), rng);
+        }
+        writer.end_object();
+    } else if (rng() % 4 == 0) {
+        writer.value(v);  // scalars are also written as values
+    } else {
+        switch (v.type()) {
+            case db::dtype::null: writer.value(nullptr); break;
+            case db::dtype::boolean: writer.value(v.as_bool()); break;
+            case db::dtype::integer: writer.value(v.as_int()); break;
+            case db::dtype::unsigned_integer: writer.value(v.as_uint()); break;
+            case db::dtype::long_integer: writer.value(v.as_int64()); break;
+            case db::dtype::unsigned_long_integer: writer.value(v.as_uint64()); break;
+            case db::dtype::double_precision: writer.value(v.as_double()); break;
+            default: writer.value(v.as_string_view()); break;
+        }
+    }
+}
+
+}  // namespace
+
+UXS_TEST_CASE(json_reformat_chunked_same_as_whole) {
+    std::mt19937 rng(7);
+    for (unsigned i = 0; i < 3000; ++i) {
+        const std::string valid = random_json(rng, 0);
+        const std::string doc = i % 2 ? damage(rng, valid) : valid;
+        for (mode m : {mode::reformat, mode::minify, mode::validate}) {
+            const std::string whole = convert(m, doc, 0);
+            for (std::size_t chunk_size = 1; chunk_size <= 5; ++chunk_size) {
+                UXS_CHECK(convert(m, doc, chunk_size) == whole);
+            }
+        }
+        // all three agree on errors, and reformatted text is read to the same value
+        const std::string reformatted = convert(mode::reformat, doc, 0);
+        const std::string minified = convert(mode::minify, doc, 0);
+        if (reformatted.compare(0, 7, "error: ") == 0) {
+            UXS_CHECK(minified == reformatted);
+            UXS_CHECK(convert(mode::validate, doc, 0) == reformatted);
+            continue;
+        }
+        UXS_CHECK(convert(mode::validate, doc, 0).empty());
+        iflatbuf in(doc), in_reformatted(reformatted), in_minified(minified);
+        const db::value v = db::json::read(in);
+        UXS_CHECK(db::json::read(in_reformatted) == v);
+        UXS_CHECK(db::json::read(in_minified) == v);
+    }
+}
+
+UXS_TEST_CASE(json_stream_writer_same_as_write) {
+    struct format_t {
+        unsigned indent_size;
+        char object_ws_char;
+        char array_ws_char;
+        char indent_char;
+        unsigned indent;
+    };
+    const format_t formats[] = {{0, ' ', ' ', ' ', 0}, {4, '\n', ' ', ' ', 0}, {2, '\n', '\n', '\t', 3}};
+    std::mt19937 rng(29);
+    for (unsigned n = 0; n < 300; ++n) {
+        const db::value v = random_value(rng, 0);
+        for (const format_t& f : formats) {
+            inline_dynbuffer expected;
+            db::json::write(expected, v, f.indent_size, f.object_ws_char, f.array_ws_char, f.indent_char, f.indent);
+            inline_dynbuffer out;
+            db::json::stream_writer<char> writer(out, f.indent_size, f.object_ws_char, f.array_ws_char,
+                                                 f.indent_char, f.indent);
+            stream_value(writer, v, rng);
+            UXS_CHECK(std::string_view(out.data(), out.size()) == std::string_view(expected.data(), expected.size()));
+            // stream output and wide characters
+            oflatbuf stream_out;
+            {
+                db::json::stream_writer<char> stream_writer(stream_out, f.indent_size, f.object_ws_char,
+                                                            f.array_ws_char, f.indent_char, f.indent);
+                stream_value(stream_writer, v, rng);
+            }
+            UXS_CHECK(std::string_view(stream_out.view().data(), stream_out.view().size()) ==
+                      std::string_view(expected.data(), expected.size()));
+            inline_wdynbuffer wout;
+            db::json::stream_writer<wchar_t> wwriter(wout, f.indent_size, f.object_ws_char, f.array_ws_char,
+                                                     f.indent_char, f.indent);
+            stream_value(wwriter, v, rng);
+            inline_wdynbuffer wexpected;
+            db::json::write(wexpected, v, f.indent_size, f.object_ws_char, f.array_ws_char, f.indent_char, f.indent);
+            UXS_CHECK(std::wstring_view(wout.data(), wout.size()) ==
+                      std::wstring_view(wexpected.data(), wexpected.size()));
+        }
+    }
+}
+
+UXS_TEST_CASE(json_stream_writer_misuse) {
+    inline_dynbuffer out;
+    const auto writer = [&out]() {
+        out.clear();
+        return db::json::stream_writer<char>(out);
+    };
+    UXS_CHECK_THROW(writer().begin_object().value(1), db::database_error);
+    UXS_CHECK_THROW(writer().begin_object().key("a").key("b"), db::database_error);
+    UXS_CHECK_THROW(writer().begin_object().key("a").end_object(), db::database_error);
+    UXS_CHECK_THROW(writer().begin_array().key("a"), db::database_error);
+    UXS_CHECK_THROW(writer().begin_array().end_object(), db::database_error);
+    UXS_CHECK_THROW(writer().begin_object().end_array(), db::database_error);
+    UXS_CHECK_THROW(writer().end_array(), db::database_error);
+    UXS_CHECK_THROW(writer().key("a"), db::database_error);
+    writer().begin_object().key(std::wstring(L"\u0444")).value(std::wstring_view(L"x\ny")).end_object();
+    UXS_CHECK(std::string_view(out.data(), out.size()) == "{\"\xd1\x84\": \"x\\ny\"}");
+}
@@ -0,0 +1,72 @@
+#include "random_value.h"
+#include "test_suite.h"
+
+#include "uxs/db/parallel_write.h"
+#include "uxs/io/oflatbuf.h"
+
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+struct format_t {
+    unsigned indent_size;
+    char object_ws_char;
+    char array_ws_char;
+    char indent_char;
+    unsigned indent;
+};
+
+std::string write_text(const db::value& v, const format_t& f) {
+    inline_dynbuffer out;
+    db::json::write(out, v, f.indent_size, f.object_ws_char, f.array_ws_char, f.indent_char, f.indent);
+    return std::string(out.data(), out.size());
+}
+
+std::string write_parallel_text(const db::value& v, const format_t& f, const db::parallel_write_opts& opts) {
+    inline_dynbuffer out;
+    db::json::write_parallel(out, v, opts, f.indent_size, f.object_ws_char, f.array_ws_char, f.indent_char,
+                             f.indent);
+    return std::string(out.data(), out.size());
+}
+
+std::string write_parallel_stream(const db::value& v, const format_t& f, const db::parallel_write_opts& opts) {
+    oflatbuf out;
+    db::json::write_parallel(out, v, opts, f.indent_size, f.object_ws_char, f.array_ws_char, f.indent_char,
+                             f.indent);
+    return std::string(out.view().data(), out.view().size());
+}
+
+}  // namespace
+
+UXS_TEST_CASE(json_write_parallel_same_as_write) {
+    const format_t formats[] = {{0, ' ', ' ', ' ', 0},
+                                {4, '\n', ' ', ' ', 0},
+                                {2, '\n', '\n', ' ', 6},
+                                {1, '\n', '\n', '\t', 3}};
+    std::mt19937 rng(43);
+    for (unsigned n = 0; n < 200; ++n) {
+        db::value v = db::make_array();
+        for (unsigned i = 0; i < 3; ++i) { v.push_back(random_value(rng, 0)); }
+        for (const format_t& f : formats) {
+            const std::string expected = write_text(v, f);
+            for (std::size_t chunk_size : {1, 3, 1024}) {
+                db::parallel_write_opts opts;
+                opts.thread_count = 1 + n % 4;
+                opts.chunk_size = chunk_size;
+                opts.max_chunks = n % 3;
+                UXS_CHECK(write_parallel_text(v, f, opts) == expected);
+                UXS_CHECK(write_parallel_stream(v, f, opts) == expected);
+            }
+        }
+    }
+}
+
+UXS_TEST_CASE(json_write_parallel_scalar) {
+    const format_t f{4, '\n', '\n', ' ', 8};
+    const db::value v = db::make_record();
+    UXS_CHECK(write_parallel_text(v, f, db::parallel_write_opts{}) == write_text(v, f));
+    UXS_CHECK(write_parallel_text(db::value(1.5), f, db::parallel_write_opts{}) == "1.5");
+}
@@ -0,0 +1,61 @@
+#include "test_suite.h"
+
+#include "uxs/db/json.h"
+#include "uxs/db/key_pool.h"
+#include "uxs/impl/db/json_impl.h"
+#include "uxs/impl/db/value_impl.h"
+#include "uxs/io/iflatbuf.h"
+
+#include <string>
+
+using namespace uxs;
+
+namespace {
+using alloc_type = db::key_pool_allocator<char>;
+using value_type = db::basic_value<char, alloc_type>;
+
+std::string make_doc(unsigned n) {
+    std::string doc = "[";
+    for (unsigned i = 0; i < n; ++i) {
+        if (i) { doc += ", "; }
+        doc += "{\"id\": " + std::to_string(i) + ", \"name\": \"n\", \"k" + std::to_string(i % 3) + "\": true}";
+    }
+    return doc + "]";
+}
+}  // namespace
+
+UXS_TEST_CASE(key_pool_per_document) {
+    db::key_pool pool;
+    const std::string doc = make_doc(100);
+    iflatbuf in(doc);
+    const value_type v = db::json::read<char>(in, alloc_type(pool));
+    // keys are interned once per pool
+    UXS_CHECK(pool.size() == 5);
+    const auto* id = pool.find("id");
+    UXS_CHECK(id && id->key() == "id" && pool.intern("id") == id);
+    UXS_CHECK(v[0].as_record().begin()->key().data() == v[1].as_record().begin()->key().data());
+    // another document has its own pool
+    db::key_pool other_pool;
+    iflatbuf other_in("{\"other\": 1}");
+    const value_type other = db::json::read<char>(other_in, alloc_type(other_pool));
+    UXS_CHECK(other_pool.size() == 1 && !pool.find("other"));
+    UXS_CHECK(other.at("other").as_int() == 1);
+}
+
+UXS_TEST_CASE(key_pool_find_by_entry) {
+    db::key_pool pool;
+    const std::string doc = make_doc(100);
+    iflatbuf in(doc);
+    const value_type v = db::json::read<char>(in, alloc_type(pool));
+    const auto& id = *pool.find("id");
+    const auto& k1 = *pool.find("k1");
+    for (unsigned i = 0; i < 100; ++i) {
+        UXS_CHECK(v[i].find(id).value().as_uint() == i);
+        UXS_CHECK(v[i].contains(k1) == (i % 3 == 1));
+        UXS_CHECK(v[i].contains(k1) == v[i].contains("k1"));
+    }
+    // the entry of a record without key pool is used as precomputed key and hash code
+    db::value plain = db::make_record({{"id", 5}});
+    UXS_CHECK(plain.find(id).value().as_int() == 5);
+    UXS_CHECK(!plain.contains(k1));
+}
@@ -0,0 +1,22 @@
+#include "test_suite.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    unsigned total = 0, failed = 0;
+    for (const auto& test : uxs_test::registry()) {
+        if (!std::strstr(test.name, filter)) { continue; }
+        ++total;
+        try {
+            test.fn();
+        } catch (const std::exception& e) {
+            ++failed;
+            std::printf("FAILED %s: %s\n", test.name, e.what());
+        }
+    }
+    std::printf("%u of %u tests passed\n", total - failed, total);
+    return failed ? 1 : 0;
+}
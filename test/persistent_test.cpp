@@ -0,0 +1,166 @@
+#include "test_suite.h"
+
+#include "uxs/db/persistent.h"
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+// Item, which counts its live instances, so leaked or doubly destroyed items are detected
+struct tracked {
+    static long live;
+    int v = 0;
+    tracked(int v) : v(v) { ++live; }
+    tracked(const tracked& other) : v(other.v) { ++live; }
+    tracked& operator=(const tracked& other) = default;
+    ~tracked() { --live; }
+};
+long tracked::live = 0;
+
+// Hash functions with few distinct codes, so that keys share the whole hash code or its lower bits
+struct full_collision_hash {
+    std::size_t operator()(std::string_view key) const noexcept { return std::hash<std::string_view>{}(key) % 5; }
+};
+struct partial_collision_hash {
+    std::size_t operator()(std::string_view key) const noexcept {
+        return (std::hash<std::string_view>{}(key) % 7) << 40 | 0x1f;
+    }
+};
+
+bool equal(const db::persistent_vector<tracked>& v, const std::vector<int>& expected) {
+    if (v.size() != expected.size()) { return false; }
+    std::size_t n = 0;
+    for (const tracked& item : v) {
+        if (item.v != expected[n] || v[n].v != expected[n]) { return false; }
+        ++n;
+    }
+    n = 0;
+    v.for_each([&expected, &n](const tracked& item) { n += item.v == expected[n] ? 1 : expected.size() + 1; });
+    return n == expected.size();
+}
+
+template<typename Hash>
+using record_t = db::persistent_record<char, int, std::allocator<int>, Hash>;
+
+template<typename Hash>
+bool equal(const record_t<Hash>& rec, const std::map<std::string, int>& expected) {
+    if (rec.size() != expected.size()) { return false; }
+    for (const auto& item : expected) {
+        const int* v = rec.find(item.first);
+        if (!v || *v != item.second) { return false; }
+    }
+    std::size_t n = 0;
+    bool ok = true;
+    rec.for_each([&expected, &n, &ok](std::string_view key, int v) {
+        const auto it = expected.find(std::string(key));
+        ok = ok && it != expected.end() && it->second == v;
+        ++n;
+    });
+    return ok && n == expected.size();
+}
+
+template<typename Hash>
+void check_record_versions(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::pair<record_t<Hash>, std::map<std::string, int>>> versions;
+    record_t<Hash> rec;
+    std::map<std::string, int> expected;
+    for (unsigned n = 0; n < 3000; ++n) {
+        const std::string key = "key" + std::to_string(rng() % 400);
+        const unsigned op = rng() % 4;
+        if (op < 2) {
+            const int v = static_cast<int>(rng() % 1000);
+            UXS_CHECK(rec.insert_or_assign(key, v) == (expected.find(key) == expected.end()));
+            expected[key] = v;
+        } else if (op == 2) {
+            UXS_CHECK(rec.erase(key) == expected.erase(key));
+        } else {
+            UXS_CHECK(rec.contains(key) == (expected.find(key) != expected.end()));
+            UXS_CHECK(!rec.contains(key + "!"));
+        }
+        if (n % 50 == 0) { versions.emplace_back(rec, expected); }
+    }
+    UXS_CHECK(equal(rec, expected));
+    for (const auto& version : versions) { UXS_CHECK(equal(version.first, version.second)); }
+    // erasing all keys of shared nodes leaves older versions unchanged
+    for (const auto& item : expected) { UXS_CHECK(rec.erase(item.first) == 1); }
+    UXS_CHECK(rec.empty() && rec.erase("key1") == 0);
+    for (const auto& version : versions) { UXS_CHECK(equal(version.first, version.second)); }
+}
+
+}  // namespace
+
+UXS_TEST_CASE(persistent_vector_push_pop_boundaries) {
+    {
+        // sizes around the tail leaf of 32 items, the first full root and the root of two levels
+        const std::size_t boundaries[] = {0, 1, 31, 32, 33, 64, 65, 1024, 1025, 1056, 1057, 32 * 32 * 32 + 33};
+        std::vector<std::pair<db::persistent_vector<tracked>, std::vector<int>>> versions;
+        db::persistent_vector<tracked> v;
+        std::vector<int> expected;
+        for (std::size_t size : boundaries) {
+            while (expected.size() < size) {
+                v.push_back(static_cast<int>(expected.size()));
+                expected.push_back(static_cast<int>(expected.size()));
+            }
+            UXS_CHECK(equal(v, expected));
+            versions.emplace_back(v, expected);
+        }
+        // pop across the same boundaries, modifying items of shared leaves on the way
+        while (!expected.empty()) {
+            v.pop_back();
+            expected.pop_back();
+            if (!expected.empty()) {
+                const std::size_t i = expected.size() * 5 / 7;
+                v.set(i, -1);
+                expected[i] = -1;
+            }
+            const std::size_t size = expected.size();
+            if (size % 31 == 0 || size < 70 || (size >= 1020 && size <= 1060)) { UXS_CHECK(equal(v, expected)); }
+        }
+        UXS_CHECK(v.empty() && equal(v, expected));
+        for (const auto& version : versions) { UXS_CHECK(equal(version.first, version.second)); }
+        // the popped vector grows again without affecting older versions
+        for (int i = 0; i < 1100; ++i) { v.push_back(-i); }
+        for (const auto& version : versions) { UXS_CHECK(equal(version.first, version.second)); }
+    }
+    UXS_CHECK(tracked::live == 0);
+}
+
+UXS_TEST_CASE(persistent_vector_set_shared) {
+    {
+        db::persistent_vector<tracked> v;
+        for (int i = 0; i < 2000; ++i) { v.push_back(i); }
+        const db::persistent_vector<tracked> old = v;
+        v.set(0, -1);
+        v.set(1500, -2);
+        v.set(1999, -3);
+        v.mutable_at(700).v = -4;
+        UXS_CHECK(v[0].v == -1 && v[1500].v == -2 && v.back().v == -3 && v.at(700).v == -4);
+        UXS_CHECK(old[0].v == 0 && old[1500].v == 1500 && old.back().v == 1999 && old.at(700).v == 700);
+        UXS_CHECK_THROW(old.at(2000), db::database_error);
+    }
+    UXS_CHECK(tracked::live == 0);
+}
+
+UXS_TEST_CASE(persistent_record_versions) {
+    check_record_versions<std::hash<std::string_view>>(36);
+    check_record_versions<partial_collision_hash>(37);
+    check_record_versions<full_collision_hash>(38);
+}
+
+UXS_TEST_CASE(persistent_record_collisions) {
+    record_t<full_collision_hash> rec;
+    for (int i = 0; i < 50; ++i) { UXS_CHECK(rec.insert_or_assign("k" + std::to_string(i), i)); }
+    const record_t<full_collision_hash> old = rec;
+    UXS_CHECK(!rec.insert_or_assign("k7", 70));
+    UXS_CHECK(rec.erase("k8") == 1 && rec.erase("k8") == 0);
+    UXS_CHECK(rec.at("k7") == 70 && !rec.contains("k8") && rec.size() == 49);
+    UXS_CHECK(old.at("k7") == 7 && old.at("k8") == 8 && old.size() == 50);
+    UXS_CHECK_THROW(rec.at("k8"), db::database_error);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <random>
+#include <string>
+
+namespace uxs_test {
+
+// Generates a random JSON document with comments, escapes and numbers, which don't fit in 64 bits
+inline std::string random_json(std::mt19937& rng, unsigned depth) {
+    static const char* scalars[] = {"null",   "true",     "false",        "0",        "-12",       "3.25e-3",
+                                    "\"\"",   "\"abc\"",  "\"a\\nb\\\"\"", "\"\\u0041\\u00e9\\ud83d\\ude00\"",
+                                    "1e400",  "12345678901234567890123"};
+    static const char* ws[] = {"", " ", "\n", "\t ", " /* comment */ "};
+    const unsigned kind = depth > 4 ? 0 : rng() % 4;
+    if (kind < 2) { return scalars[rng() % (sizeof(scalars) / sizeof(*scalars))]; }
+    const unsigned n = rng() % 5;
+    std::string s = kind == 2 ? "[" : "{";
+    for (unsigned i = 0; i < n; ++i) {
+        if (i) { s += ','; }
+        s += ws[rng() % 5];
+        if (kind == 3) { s += "\"k" + std::to_string(rng() % 100) + "\"" + ws[rng() % 5] + ":"; }
+        s += ws[rng() % 5] + random_json(rng, depth + 1) + ws[rng() % 5];
+    }
+    return s + (kind == 2 ? "]" : "}");
+}
+
+// Damages the document: truncates it, inserts or replaces a character
+inline std::string damage(std::mt19937& rng, std::string s) {
+    static const char chars[] = "[]{},:\"\\ 1ex";
+    const std::size_t pos = rng() % (s.size() + 1);
+    switch (rng() % 3) {
+        case 0: s.resize(pos); break;
+        case 1: s.insert(pos, 1, chars[rng() % (sizeof(chars) - 1)]); break;
+        default: {
+            if (pos < s.size()) { s[pos] = chars[rng() % (sizeof(chars) - 1)]; }
+        } break;
+    }
+    return s;
+}
+
+}  // namespace uxs_test
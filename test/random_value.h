@@ -0,0 +1,62 @@
+#pragma once
+
+#include "uxs/db/value.h"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace uxs_test {
+
+// Generates a random value tree with numbers of all types at their boundaries, short and long strings
+inline uxs::db::value random_value(std::mt19937& rng, unsigned depth) {
+    static const char* strings[] = {"", "a", "key", "\xd0\xba\xd0\xbb\xd1\x8e\xd1\x87", "tab\tand\nline"};
+    const unsigned kind = depth > 4 ? rng() % 10 : rng() % 12;
+    switch (kind) {
+        case 0: return {};
+        case 1: return rng() % 2 != 0;
+        case 2: return static_cast<std::int32_t>(rng() % 2 ? rng() % 30 : rng());
+        case 3: return -static_cast<std::int32_t>(rng() % 2 ? rng() % 30 : rng() % 0x7fffffff) - 1;
+        case 4: return static_cast<std::uint32_t>(0x80000000u + rng() % 0x7fffffff);
+        case 5: return rng() % 2 ? std::numeric_limits<std::int64_t>::min() : -(std::int64_t(1) << 40);
+        case 6: return rng() % 2 ? std::numeric_limits<std::uint64_t>::max() : std::uint64_t(1) << 63;
+        case 7: return static_cast<double>(rng()) / 7.;
+        case 8: return strings[rng() % (sizeof(strings) / sizeof(*strings))];
+        case 9: {
+            const std::string s(rng() % 300, static_cast<char>('a' + rng() % 26));
+            return std::string_view(s);
+        }
+        case 10: {
+            uxs::db::value v = uxs::db::make_array();
+            for (unsigned n = rng() % 20; n; --n) { v.push_back(random_value(rng, depth + 1)); }
+            return v;
+        }
+        default: {
+            uxs::db::value v = uxs::db::make_record();
+            for (unsigned n = rng() % 20; n; --n) {
+                v.emplace("k" + std::to_string(rng() % 30), random_value(rng, depth + 1));
+            }
+            return v;
+        }
+    }
+}
+
+// Compares values including types of numbers, which `operator==` doesn't distinguish
+inline bool same_types(const uxs::db::value& lhs, const uxs::db::value& rhs) {
+    if (lhs.type() != rhs.type() || lhs.size() != rhs.size()) { return false; }
+    if (lhs.is_array()) {
+        for (std::size_t i = 0; i < lhs.size(); ++i) {
+            if (!same_types(lhs[i], rhs[i])) { return false; }
+        }
+    } else if (lhs.is_record()) {
+        auto it = rhs.as_record().begin();
+        for (const auto& item : lhs.as_record()) {
+            if (item.key() != it->key() || !same_types(item.value(), it->value())) { return false; }
+            ++it;
+        }
+    }
+    return lhs == rhs;
+}
+
+}  // namespace uxs_test
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "uxs/io/ibuf.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Minimal self-registering test suite: test cases defined with `UXS_TEST_CASE` in `test/*.cpp` are run by
+// `test/main.cpp` (all of them, or only those containing the substring given as an argument); the tests are
+// built together with the library sources (except *zip* ones), e.g.
+//   g++ -std=c++17 -Iinclude -I<dir of uxs/config.h> test/*.cpp src/*.cpp src/db/*.cpp src/io/[!z]*.cpp
+//       platform/posix/src/io/*.cpp -lpthread
+
+namespace uxs_test {
+
+struct test_case {
+    const char* name;
+    void (*fn)();
+};
+
+inline std::vector<test_case>& registry() {
+    static std::vector<test_case> tests;
+    return tests;
+}
+
+struct registrar {
+    registrar(const char* name, void (*fn)()) { registry().push_back(test_case{name, fn}); }
+};
+
+class failure : public std::runtime_error {
+ public:
+    failure(const char* file, int line, const char* expr)
+        : std::runtime_error(std::string(file) + ":" + std::to_string(line) + ": check failed: " + expr) {}
+};
+
+// Input buffer, which gives the text to the reader in pieces of `chunk_size` characters
+class chunked_ibuf : public uxs::ibuf {
+ public:
+    chunked_ibuf(std::string_view text, std::size_t chunk_size)
+        : uxs::ibuf(uxs::iomode::in), text_(text), chunk_size_(chunk_size) {}
+
+ private:
+    std::string_view text_;
+    std::size_t chunk_size_;
+    std::size_t pos_ = 0;
+
+    int underflow() override {
+        if (pos_ == text_.size()) { return -1; }
+        const std::size_t n = std::min(chunk_size_, text_.size() - pos_);
+        reset(const_cast<char*>(text_.data() + pos_), 0, n);
+        pos_ += n;
+        return 0;
+    }
+};
+
+}  // namespace uxs_test
+
+#define UXS_TEST_CASE(name) \
+    static void name(); \
+    static const uxs_test::registrar name##_registrar(#name, name); \
+    static void name()
+
+#define UXS_CHECK(...) \
+    do { \
+        if (!(__VA_ARGS__)) { throw uxs_test::failure(__FILE__, __LINE__, #__VA_ARGS__); } \
+    } while (false)
+
+#define UXS_CHECK_THROW(expr, exception) \
+    do { \
+        bool thrown = false; \
+        try { \
+            expr; \
+        } catch (const exception&) { thrown = true; } \
+        if (!thrown) { throw uxs_test::failure(__FILE__, __LINE__, #expr " throws " #exception); } \
+    } while (false)
@@ -0,0 +1,137 @@
+#include "test_suite.h"
+
+#include "uxs/db/value_index.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+// Keys of all scalar types: integers of different types with equal values are equal, `1` and `1.0` are not
+db::value random_key(std::mt19937& rng) {
+    switch (rng() % 12) {
+        case 0: return {};
+        case 1: return rng() % 2 != 0;
+        case 2: return static_cast<std::int32_t>(rng() % 5) - 2;
+        case 3: return static_cast<std::uint32_t>(rng() % 3);
+        case 4: return static_cast<std::int64_t>(rng() % 5) - 2;
+        case 5: return static_cast<std::uint64_t>(rng() % 3);
+        case 6: return static_cast<double>(static_cast<int>(rng() % 5) - 2);
+        case 7: return rng() % 2 ? 0.5 : -0.0;
+        case 8: return rng() % 2 ? std::numeric_limits<std::uint64_t>::max() : std::uint64_t(1) << 63;
+        case 9: return rng() % 2 ? std::numeric_limits<std::int64_t>::min() : 1e19;
+        case 10: return rng() % 2 ? "1" : "a";
+        default: return db::make_array();  // not a scalar: the element is not indexed
+    }
+}
+
+db::value random_rows(std::mt19937& rng, unsigned count) {
+    db::value arr = db::make_array();
+    for (unsigned n = 0; n < count; ++n) {
+        db::value rec = db::make_record();
+        rec["n"] = n;
+        if (rng() % 8) { rec["k"] = random_key(rng); }
+        arr.push_back(std::move(rec));
+    }
+    return arr;
+}
+
+// Elements with the key equal to `key` by `operator==`, in array order
+std::vector<const db::value*> brute_force(const db::value& arr, const db::value& key) {
+    std::vector<const db::value*> result;
+    for (const db::value& item : arr.as_array()) {
+        const auto it = item.find("k");
+        if (it != item.end() && !it.value().is_array() && it.value() == key) { result.push_back(&item); }
+    }
+    return result;
+}
+
+bool same(est::span<const db::value* const> lhs, const std::vector<const db::value*>& rhs) {
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+}  // namespace
+
+UXS_TEST_CASE(value_index_lookup_matches_equality) {
+    std::mt19937 rng(38);
+    for (unsigned iter = 0; iter < 100; ++iter) {
+        const db::value arr = random_rows(rng, iter * 3);
+        const db::hash_index hash_idx(arr, "k");
+        const db::sorted_index sorted_idx(arr, "k");
+        UXS_CHECK(hash_idx.size() == sorted_idx.size());
+        for (unsigned n = 0; n < 50; ++n) {
+            const db::value key = random_key(rng);
+            if (key.is_array()) { continue; }
+            const auto expected = brute_force(arr, key);
+            UXS_CHECK(same(hash_idx.equal_range(key), expected));
+            UXS_CHECK(same(sorted_idx.equal_range(key), expected));
+            UXS_CHECK(hash_idx.count(key) == expected.size() && sorted_idx.count(key) == expected.size());
+            UXS_CHECK(hash_idx.find(key) == (expected.empty() ? nullptr : expected[0]));
+        }
+        // sorted items are ordered, equal keys keep array order
+        const auto items = sorted_idx.items();
+        for (std::size_t i = 1; i < items.size(); ++i) {
+            const db::value& prev = *items[i - 1];
+            const db::value& item = *items[i];
+            const int result = db::detail::compare_index_keys(prev.at(std::string_view("k")),
+                                                              item.at(std::string_view("k")));
+            UXS_CHECK(result < 0 || (result == 0 && prev.at(std::string_view("n")).as_uint() <
+                                                        item.at(std::string_view("n")).as_uint()));
+        }
+    }
+}
+
+UXS_TEST_CASE(value_index_integer_and_double_keys) {
+    db::value arr = db::make_array();
+    for (const db::value& key : {db::value(1), db::value(1u), db::value(std::int64_t(1)),
+                                 db::value(std::uint64_t(1)), db::value(1.0), db::value(true), db::value("1")}) {
+        db::value rec = db::make_record();
+        rec["k"] = key;
+        arr.push_back(std::move(rec));
+    }
+    const db::hash_index hash_idx(arr, "k");
+    const db::sorted_index sorted_idx(arr, "k");
+    const db::value& items = arr;  // non-const access would detach the array from the indexes
+    UXS_CHECK(db::value(1) == db::value(std::uint64_t(1)) && db::value(1) != db::value(1.0));
+    for (const db::value& key : {db::value(1), db::value(std::uint64_t(1))}) {
+        UXS_CHECK(hash_idx.count(key) == 4 && sorted_idx.count(key) == 4);
+        UXS_CHECK(hash_idx.find(key) == &items[0] && sorted_idx.find(key) == &items[0]);
+    }
+    UXS_CHECK(hash_idx.count(1.0) == 1 && hash_idx.find(1.0) == &items[4]);
+    UXS_CHECK(sorted_idx.count(1.0) == 1 && sorted_idx.find(1.0) == &items[4]);
+    UXS_CHECK(hash_idx.count(true) == 1 && hash_idx.count("1") == 1 && hash_idx.count(2) == 0);
+    // the integer goes before the double of the same value
+    UXS_CHECK(sorted_idx.range(db::value(1), db::value(2)).size() == 5);
+    UXS_CHECK(sorted_idx.range(db::value(1.0), db::value(2)).size() == 1);
+    UXS_CHECK(sorted_idx.range(db::value(0.5), db::value(1)).size() == 0);
+}
+
+UXS_TEST_CASE(value_index_key_path_and_updates) {
+    db::value arr = db::make_array();
+    for (int i = 0; i < 100; ++i) {
+        db::value rec = db::make_record();
+        rec["a"]["b"] = i % 10;
+        arr.push_back(std::move(rec));
+    }
+    arr.push_back(db::make_record());
+    arr[100]["a"] = 5;  // no value at the path
+    const db::hash_index hash_idx(arr, {"a", "b"});
+    const db::sorted_index sorted_idx(arr, {"a", "b"});
+    UXS_CHECK(hash_idx.size() == 100 && sorted_idx.size() == 100);
+    UXS_CHECK(hash_idx.count(5) == 10 && sorted_idx.range(db::value(2), db::value(4)).size() == 20);
+    const db::value& const_arr = arr;
+    UXS_CHECK(!hash_idx.is_stale(const_arr) && !sorted_idx.is_stale(const_arr));
+
+    // modification of the source array detaches it from the indexes, which keep the old snapshot
+    arr[0]["a"]["b"] = 5;
+    UXS_CHECK(hash_idx.is_stale(arr) && sorted_idx.is_stale(arr));
+    UXS_CHECK(hash_idx.count(5) == 10 && hash_idx.find(0) == &hash_idx.snapshot()[0]);
+    UXS_CHECK(hash_idx.snapshot()[0].at(std::string_view("a")).at(std::string_view("b")) == db::value(0));
+    const db::hash_index new_idx(arr, {"a", "b"});
+    UXS_CHECK(new_idx.count(5) == 11 && new_idx.count(0) == 9 && !new_idx.is_stale(arr));
+    UXS_CHECK_THROW(db::hash_index(arr[0], "a"), db::database_error);
+}
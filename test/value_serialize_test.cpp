@@ -0,0 +1,73 @@
+#include "random_value.h"
+#include "test_suite.h"
+
+#include "uxs/db/value_serialize.h"
+#include "uxs/io/iflatbuf.h"
+#include "uxs/io/oflatbuf.h"
+
+#include <cstdint>
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+std::string_view as_chars(const boflatbuf& out) {
+    return std::string_view(reinterpret_cast<const char*>(out.data()), out.size());
+}
+}  // namespace
+
+UXS_TEST_CASE(value_serialize_type_tag_format) {
+    // the stream has the same format as values serialized with `dtype` based on `int`
+    db::value v = db::make_record({{"n", 5}, {"b", true}, {"s", "str"}});
+    v["a"].emplace_back();
+    boflatbuf expected;
+    expected << static_cast<std::int32_t>(db::dtype::record) << std::uint64_t(4);
+    expected << std::string_view("n") << static_cast<std::int32_t>(db::dtype::integer) << std::int32_t(5);
+    expected << std::string_view("b") << static_cast<std::int32_t>(db::dtype::boolean) << true;
+    expected << std::string_view("s") << static_cast<std::int32_t>(db::dtype::string) << std::string_view("str");
+    expected << std::string_view("a") << static_cast<std::int32_t>(db::dtype::array) << std::uint64_t(1);
+    expected << static_cast<std::int32_t>(db::dtype::null);
+    boflatbuf out;
+    out << v;
+    UXS_CHECK(as_chars(out) == as_chars(expected));
+    biflatbuf in(out.view());
+    db::value v2;
+    UXS_CHECK(!!(in >> v2));
+    UXS_CHECK(v2 == v);
+}
+
+UXS_TEST_CASE(value_serialize_round_trip) {
+    std::mt19937 rng(6);
+    for (unsigned i = 0; i < 300; ++i) {
+        db::value v = random_value(rng, 0);
+        if (i % 50 == 0) { v = std::string_view(std::string(200000 + i, 'x')); }
+        boflatbuf out;
+        out << v;
+        biflatbuf in(out.view());
+        db::value v2;
+        UXS_CHECK(!!(in >> v2));
+        UXS_CHECK(same_types(v2, v));
+        boflatbuf parallel_out;
+        db::parallel_write_opts opts;
+        opts.chunk_size = 4;
+        db::serialize_parallel(parallel_out, v, opts);
+        UXS_CHECK(as_chars(parallel_out) == as_chars(out));
+    }
+}
+
+UXS_TEST_CASE(value_serialize_corrupt_string_size) {
+    const std::uint64_t sizes[] = {std::uint64_t(1) << 62, 0x7fffffffffffffffull, 1000};
+    for (std::uint64_t sz : sizes) {
+        // a string value and a record key, which declare more characters than there are in the stream
+        boflatbuf str;
+        str << static_cast<std::int32_t>(db::dtype::string) << sz << std::string_view("abc");
+        boflatbuf key;
+        key << static_cast<std::int32_t>(db::dtype::record) << std::uint64_t(1) << sz << std::string_view("abc");
+        for (const boflatbuf* out : {&str, &key}) {
+            biflatbuf in(out->view());
+            db::value v;
+            UXS_CHECK(!(in >> v));
+        }
+    }
+}
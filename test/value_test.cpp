@@ -0,0 +1,166 @@
+#include "random_value.h"
+#include "test_suite.h"
+
+#include "uxs/db/counting_allocator.h"
+#include "uxs/db/json.h"
+#include "uxs/db/key_pool.h"
+#include "uxs/db/value.h"
+#include "uxs/impl/db/json_impl.h"
+#include "uxs/impl/db/value_impl.h"
+#include "uxs/io/iflatbuf.h"
+#include "uxs/io/oflatbuf.h"
+
+#include <functional>
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+// Builds a random value tree with the allocator: records of all sizes, erased keys and items, spare capacity
+// of arrays, and copies sharing data with other items
+template<typename Alloc>
+db::basic_value<char, Alloc> random_tree(std::mt19937& rng, const Alloc& al) {
+    oflatbuf text;
+    db::json::write(text, random_value(rng, 0));
+    iflatbuf in(std::string_view(text.view().data(), text.view().size()));
+    db::basic_value<char, Alloc> v = db::make_array<char>(al);
+    v.push_back(db::json::read<char>(in, al));
+    v.reserve(10);
+    v.emplace_back(al) = std::string_view(std::string(rng() % 100, 'x'));
+    db::basic_value<char, Alloc> rec = db::make_record<char>(al);
+    const unsigned count = rng() % 40;
+    for (unsigned n = 0; n < count; ++n) { rec.emplace("key" + std::to_string(n), al).value() = n; }
+    for (unsigned n = 0; n < count / 2; n += 2) { rec.erase("key" + std::to_string(n)); }
+    v.push_back(std::move(rec));
+    if (v[0].is_array() && v[0].size() > 1) { v[0].erase(0); }
+    return v;
+}
+
+}  // namespace
+
+UXS_TEST_CASE(value_duplicate_keys_found_in_insertion_order) {
+    for (unsigned n = 0; n < 50; ++n) {
+        const std::string dup = "dup" + std::to_string(n);
+        db::value v = db::make_record();
+        for (unsigned i = 0; i < 100; ++i) { v.emplace("k" + std::to_string(i), 1); }
+        v.emplace(dup, 0);
+        // leave deleted slots before the first duplicate in the index
+        for (unsigned i = 0; i < 99; ++i) { v.erase("k" + std::to_string(i)); }
+        v.emplace(dup, 1);
+        UXS_CHECK(v.count(dup) == 2);
+        UXS_CHECK(v[dup].as_int() == 0);
+        // the index is grown several times
+        for (unsigned i = 0; i < 1000; ++i) { v.emplace("t" + std::to_string(i), 1); }
+        v.emplace(dup, 2);
+        UXS_CHECK(v.count(dup) == 3);
+        UXS_CHECK(v[dup].as_int() == 0);
+        UXS_CHECK(v.find(dup).value().as_int() == 0);
+        v.erase(v.find(dup));
+        UXS_CHECK(v[dup].as_int() == 1);
+    }
+}
+
+UXS_TEST_CASE(value_duplicate_json_keys) {
+    for (unsigned n_other : {0, 20}) {
+        std::string text = "{\"dup\": 0";
+        for (unsigned i = 0; i < n_other; ++i) { text += ", \"k" + std::to_string(i) + "\": 1"; }
+        text += ", \"dup\": 1}";
+        iflatbuf in(text);
+        const db::value v = db::json::read(in);
+        UXS_CHECK(v.count("dup") == 2);
+        UXS_CHECK(v.at("dup").as_int() == 0);
+    }
+}
+
+UXS_TEST_CASE(value_small_record_nodes_in_arena) {
+    using alloc_type = db::counting_allocator<char>;
+    using value_type = db::basic_value<char, alloc_type>;
+    db::allocation_counters counters;
+    const alloc_type al(counters);
+    {
+        // the header and the arena grown by the first insertion
+        value_type v = db::make_record<char>(al);
+        for (unsigned i = 0; i < 8; ++i) { v.emplace("key" + std::to_string(i), i); }
+        UXS_CHECK(counters.allocations == 2);
+    }
+    counters.allocations = 0;
+    {
+        value_type v = db::make_record<char>({{"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}}, al);
+        UXS_CHECK(counters.allocations == 1);
+    }
+    counters.allocations = 0;
+    {
+        iflatbuf in("{\"a\": 1, \"b\": 2, \"c\": 3, \"d\": 4}");
+        const value_type v = db::json::read<char>(in, al);
+        UXS_CHECK(v.size() == 4);
+        UXS_CHECK(counters.allocations == 2);
+        UXS_CHECK(get_memory_stats(v).record_node_bytes == 0);
+    }
+    UXS_CHECK(counters.bytes == 0);
+}
+
+UXS_TEST_CASE(value_string_view_lifetime) {
+    const std::less<const char*> less;
+    db::value arr = db::make_array();
+    arr.emplace_back("short");
+    arr.emplace_back(std::string(100, 'a'));
+    // the view of a short string refers to the value cell
+    const char* cell = reinterpret_cast<const char*>(&arr[0]);
+    const auto short_view = arr[0].as_string_view();
+    UXS_CHECK(!less(short_view.data(), cell) && less(short_view.data(), cell + sizeof(db::value)));
+    // characters of a long string aren't relocated with the value
+    const auto long_view = arr[1].as_string_view();
+    for (unsigned i = 0; i < 100; ++i) { arr.emplace_back(i); }
+    UXS_CHECK(arr[1].as_string_view().data() == long_view.data());
+    UXS_CHECK(arr[0].as_string_view() == "short");
+}
+
+UXS_TEST_CASE(value_memory_stats_match_counted_bytes) {
+    std::mt19937 rng(50);
+    db::allocation_counters counters;
+    {
+        using alloc_type = db::counting_allocator<char>;
+        const alloc_type al(counters);
+        for (unsigned n = 0; n < 300; ++n) {
+            const auto v = random_tree(rng, al);
+            const db::memory_stats st = get_memory_stats(v);
+            UXS_CHECK(st.total_bytes() == counters.bytes && st.shared_count == 0 && st.shared_bytes == 0);
+            UXS_CHECK(st.unused_bytes() <= st.total_bytes() && st.value_count >= 4);
+        }
+    }
+    UXS_CHECK(counters.bytes == 0 && counters.blocks == 0);
+    {
+        // the counting allocator keeps the key pool of the adapted allocator
+        using alloc_type = db::counting_allocator<char, db::key_pool_allocator<char>>;
+        db::key_pool pool;
+        const alloc_type al(counters, db::key_pool_allocator<char>(pool));
+        for (unsigned n = 0; n < 100; ++n) {
+            const auto v = random_tree(rng, al);
+            UXS_CHECK(get_memory_stats(v).total_bytes() == counters.bytes);
+            if (v[2].size()) { UXS_CHECK(pool.find(v[2].as_record().begin()->key()) != nullptr); }
+        }
+    }
+    UXS_CHECK(counters.bytes == 0 && counters.blocks == 0 && counters.peak_bytes > 0);
+}
+
+UXS_TEST_CASE(value_memory_stats_shared_data) {
+    using alloc_type = db::counting_allocator<char>;
+    std::mt19937 rng(51);
+    db::allocation_counters counters;
+    const alloc_type al(counters);
+    for (unsigned n = 0; n < 100; ++n) {
+        const auto shared = random_tree(rng, al);
+        const std::size_t shared_bytes = get_memory_stats(shared).total_bytes();
+        auto v = random_tree(rng, al);
+        // copies share the data, which is counted once
+        v.push_back(shared);
+        v.push_back(shared);
+        v[0] = shared;
+        const db::memory_stats st = get_memory_stats(v);
+        UXS_CHECK(st.shared_count == 1 && st.shared_bytes == shared_bytes);
+        UXS_CHECK(st.total_bytes() == counters.bytes);
+    }
+    UXS_CHECK(counters.bytes == 0 && counters.blocks == 0);
+}
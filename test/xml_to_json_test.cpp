@@ -0,0 +1,148 @@
+#include "random_json.h"
+#include "test_suite.h"
+
+#include "uxs/db/json.h"
+#include "uxs/db/value.h"
+#include "uxs/db/xml.h"
+#include "uxs/io/iflatbuf.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace uxs;
+using namespace uxs_test;
+
+namespace {
+
+// Input buffer, which gives the text in pieces of `chunk_size` characters and records the size of the output
+// written before the rest of input is requested
+class probing_ibuf : public ibuf {
+ public:
+    probing_ibuf(std::string_view text, std::size_t chunk_size, const inline_dynbuffer& out)
+        : ibuf(iomode::in), text_(text), chunk_size_(chunk_size), out_(out) {}
+
+    std::size_t output_before_half() const { return output_before_half_; }
+
+ private:
+    std::string_view text_;
+    std::size_t chunk_size_;
+    const inline_dynbuffer& out_;
+    std::size_t pos_ = 0;
+    std::size_t output_before_half_ = 0;
+
+    int underflow() override {
+        if (pos_ == text_.size()) { return -1; }
+        if (pos_ <= text_.size() / 2) { output_before_half_ = out_.size(); }
+        const std::size_t n = std::min(chunk_size_, text_.size() - pos_);
+        reset(const_cast<char*>(text_.data() + pos_), 0, n);
+        pos_ += n;
+        return 0;
+    }
+};
+
+std::string to_json_text(std::string_view doc, std::string_view root, std::size_t* output_before_half = nullptr) {
+    inline_dynbuffer out;
+    probing_ibuf in(doc, 64, out);
+    db::xml::parser parser(in);
+    db::json::stream_writer<char> writer(out);
+    parser.to_json(root, writer);
+    if (output_before_half) { *output_before_half = in.output_before_half(); }
+    return std::string(out.data(), out.size());
+}
+
+std::string read_and_write(std::string_view doc, std::string_view root) {
+    iflatbuf in(doc);
+    db::xml::parser parser(in);
+    inline_dynbuffer out;
+    db::json::write(out, parser.read<char>(root));
+    return std::string(out.data(), out.size());
+}
+
+std::string make_items(unsigned n) {
+    std::string s;
+    for (unsigned i = 0; i < n; ++i) { s += "<item><id>" + std::to_string(i) + "</id></item>"; }
+    return s;
+}
+
+// XML text of JSON document converted with `from_json()` or through the DOM, or the error message
+std::string json_to_xml(const std::string& doc, bool via_dom, unsigned indent_size, std::size_t chunk_size) {
+    try {
+        chunked_ibuf in(doc, chunk_size);
+        inline_dynbuffer out;
+        if (via_dom) {
+            db::xml::write(out, db::json::read(in), "root", indent_size, ' ', 1);
+        } else {
+            db::xml::from_json(out, in, "root", indent_size, ' ', 1);
+        }
+        return std::string(out.data(), out.size());
+    } catch (const db::database_error& e) { return std::string("error: ") + e.what(); }
+}
+
+}  // namespace
+
+UXS_TEST_CASE(xml_to_json_buffering) {
+    // items of the root element are written while they are read, only the first item is held
+    const std::string flat = "<feed>" + make_items(1000) + "</feed>";
+    std::size_t output_before_half = 0;
+    UXS_CHECK(to_json_text(flat, "feed", &output_before_half) == read_and_write(flat, "feed"));
+    UXS_CHECK(output_before_half > 1000);
+    // the single `items` element is the first of its name, so it is held with all its items to the end
+    const std::string nested = "<feed><items>" + make_items(1000) + "</items></feed>";
+    UXS_CHECK(to_json_text(nested, "feed", &output_before_half) == read_and_write(nested, "feed"));
+    UXS_CHECK(output_before_half <= 1);
+}
+
+UXS_TEST_CASE(xml_to_json_non_adjacent_siblings) {
+    const std::string adjacent = "<r><a>1</a><a>3</a><b>2</b></r>";
+    UXS_CHECK(to_json_text(adjacent, "r") == read_and_write(adjacent, "r"));
+    // non-adjacent same-named elements become duplicate keys, but are gathered to one array by `read()`
+    const std::string doc = "<r><a>1</a><b>2</b><a>3</a></r>";
+    UXS_CHECK(to_json_text(doc, "r") == "{\"a\": 1, \"b\": 2, \"a\": 3}");
+    UXS_CHECK(read_and_write(doc, "r") == "{\"a\": [1, 3], \"b\": 2}");
+}
+
+UXS_TEST_CASE(xml_attributes) {
+    // many long attributes make the buffer grow while views to it are kept sorted
+    std::string long_value(100, 'v');
+    std::string doc = "<r z=\"26\" a=\"1\" m='13' a=\"dup\"";
+    for (unsigned i = 0; i < 20; ++i) { doc += " k" + std::to_string(19 - i) + "=\"" + long_value + "\""; }
+    doc += "><e/></r>";
+    iflatbuf in(doc);
+    db::xml::parser parser(in);
+    UXS_CHECK(parser.next() == db::xml::token_t::start_element);
+    const auto& attrs = parser.attributes();
+    UXS_CHECK(attrs.size() == 23);
+    UXS_CHECK(std::is_sorted(attrs.begin(), attrs.end(),
+                             [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; }));
+    UXS_CHECK(attrs.begin()->first == "a" && attrs.begin()->second == "1");
+    UXS_CHECK(attrs.find("m") != attrs.end() && attrs.find("m")->second == "13");
+    UXS_CHECK(attrs.find("b") == attrs.end());
+    UXS_CHECK(attrs.count("a") == 1 && attrs.count("b") == 0);
+    UXS_CHECK(attrs.at("z") == "26" && attrs.value<int>("z") == 26);
+    UXS_CHECK(attrs.at("k7") == long_value && attrs.at("k19") == long_value);
+    UXS_CHECK_THROW(attrs.at("b"), std::out_of_range);
+    // the first of same-named attributes is kept
+    auto& mutable_attrs = parser.attributes();
+    const auto result = mutable_attrs.emplace("z", "0");
+    UXS_CHECK(!result.second && result.first->second == "26");
+    UXS_CHECK(mutable_attrs.emplace("b", "2").second && mutable_attrs.at("b") == "2");
+    UXS_CHECK((mutable_attrs.begin() + 1)->first == "b" && mutable_attrs.at("k0") == long_value);
+    UXS_CHECK(parser.next() == db::xml::token_t::start_element);
+    UXS_CHECK(parser.attributes().empty());
+}
+
+UXS_TEST_CASE(xml_from_json_same_as_write) {
+    std::mt19937 rng(48);
+    unsigned errors = 0;
+    for (unsigned n = 0; n < 3000; ++n) {
+        std::string doc = random_json(rng, 0);
+        if (n % 3 == 0) { doc = damage(rng, doc); }
+        const unsigned indent_size = n % 2 ? 2 : 0;
+        const std::string expected = json_to_xml(doc, true, indent_size, doc.size() + 1);
+        // damaged documents give the same error
+        UXS_CHECK(json_to_xml(doc, false, indent_size, 1 + n % 7) == expected);
+        if (expected.compare(0, 6, "error:") == 0) { ++errors; }
+    }
+    UXS_CHECK(errors > 100);
+}